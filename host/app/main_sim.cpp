@@ -0,0 +1,131 @@
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+#include "sim_tasks.h"
+#include "sim_reproduccion.h"
+#include "sim_telemetria.h"
+#include "sim_ui.h"
+#include "sim_broker_mqtt.h"
+#include "InfluxDbClient.h"
+#include "metrics.h"
+
+/* =======================
+   ORION_SIM
+   =======================
+   Corre el firmware completo en tiempo virtual y resume lo que pasó.
+
+     orion_sim [--horas N | --dias N] [--modo cloud|local|hibrido|menu]
+               [--semilla N] [--dht-error P] [--serial] [--pantalla]
+               [--mosquitto HOST] [--reproducir CAPTURA] [--telemetria ARCHIVO]
+               [--ritmo X]
+
+   --mosquitto manda el MQTT a un broker real (p. ej. 127.0.0.1) en vez
+   del broker simulado, en claro al 1883 (con mqtt_tls, al 8883: sin TLS
+   salvo que se compile con ORION_SIM_TLS_OPENSSL).
+   --reproducir alimenta GPS, DHT y LDR con una captura (cap start en la
+   placa); sin --horas dura lo que la captura.
+   --telemetria escribe cada publicación MQTT/Influx para compararla con diff.
+   --ritmo ata el reloj virtual al real (1 = tiempo real, 10 = 10x); por
+   defecto corre lo más rápido posible. */
+
+void setup();
+
+// Índices del menú principal (ui_task.cpp)
+#define MENU_TOTAL 5
+#define MENU_LOCAL 0
+#define MENU_CLOUD 1
+#define MENU_HIBRIDO 2
+
+static void uso() {
+  fprintf(stderr,
+          "uso: orion_sim [--horas N | --dias N] [--modo cloud|local|hibrido|menu] [--semilla N]\n"
+          "               [--dht-error P] [--serial] [--pantalla] [--mosquitto HOST]\n"
+          "               [--reproducir CAPTURA] [--telemetria ARCHIVO] [--ritmo X]\n");
+}
+
+int main(int argc, char** argv) {
+  double horas = 1.0;
+  const char* modo = "cloud";
+  bool verSerial = false;
+  bool verPantalla = false;
+  bool horasFijadas = false;
+  const char* captura = nullptr;
+  const char* telemetria = nullptr;
+  double ritmo = 0.0;
+
+  for (int i = 1; i < argc; i++) {
+    const char* a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (!strcmp(a, "--horas") && v) { horas = atof(v); horasFijadas = true; i++; }
+    else if (!strcmp(a, "--dias") && v) { horas = atof(v) * 24.0; horasFijadas = true; i++; }
+    else if (!strcmp(a, "--modo") && v) { modo = v; i++; }
+    else if (!strcmp(a, "--semilla") && v) { randomSeed(strtoul(v, nullptr, 10)); i++; }
+    else if (!strcmp(a, "--dht-error") && v) { simEntorno().dhtTasaError = atof(v); i++; }
+    else if (!strcmp(a, "--mosquitto") && v) { setenv("ORION_SIM_RED_REAL", "1", 1); setenv("ORION_SIM_HOST", v, 1); i++; }
+    else if (!strcmp(a, "--reproducir") && v) { captura = v; i++; }
+    else if (!strcmp(a, "--telemetria") && v) { telemetria = v; i++; }
+    else if (!strcmp(a, "--ritmo") && v) { ritmo = atof(v); i++; }
+    else if (!strcmp(a, "--serial")) verSerial = true;
+    else if (!strcmp(a, "--pantalla")) verPantalla = true;
+    else { uso(); return 2; }
+  }
+
+  simSilenciarSerial(!verSerial);
+  simBrokerIniciar();
+  if (captura && !simReproduccionCargar(captura)) {
+    fprintf(stderr, "no se pudo leer la captura %s\n", captura);
+    return 2;
+  }
+  if (telemetria && !simTelemetriaAbrir(telemetria)) {
+    fprintf(stderr, "no se pudo crear %s\n", telemetria);
+    return 2;
+  }
+
+  auto inicioReal = std::chrono::steady_clock::now();
+  setup();
+  simHeapLinea();
+
+  if (!strcmp(modo, "cloud")) simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  else if (!strcmp(modo, "local")) simUiElegir(MENU_TOTAL, MENU_LOCAL);
+  else if (!strcmp(modo, "hibrido")) simUiElegir(MENU_TOTAL, MENU_HIBRIDO);
+
+  if (captura) {
+    simReproduccionIniciar();
+    if (!horasFijadas) horas = (simReproduccionDuracionUs() / 1e6 + 10.0) / 3600.0;
+  }
+
+  // Con --ritmo se avanza en bloques de 50 ms y se espera al reloj real
+  uint64_t inicioUs = simAhoraUs();
+  auto inicioRitmo = std::chrono::steady_clock::now();
+  uint64_t finUs = inicioUs + (uint64_t)(horas * 3600.0 * 1e6);
+  uint64_t bloqueUs = ritmo > 0 ? 50000ULL : 3600ULL * 1000000ULL;
+  while (simAhoraUs() < finUs) {
+    uint64_t hasta = std::min(finUs, simAhoraUs() + bloqueUs);
+    simEjecutarHastaUs(hasta);
+    if (ritmo > 0) {
+      std::chrono::duration<double> objetivo((simAhoraUs() - inicioUs) / 1e6 / ritmo);
+      std::this_thread::sleep_until(inicioRitmo + std::chrono::duration_cast<std::chrono::steady_clock::duration>(objetivo));
+    }
+  }
+  simTelemetriaCerrar();
+
+  double realS = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicioReal).count();
+  double virtualS = simAhoraUs() / 1e6;
+
+  simSilenciarSerial(false);
+  printf("virtual %.0f s  real %.2f s  x%.0f\n", virtualS, realS, realS > 0 ? virtualS / realS : 0.0);
+  printf("pasos ui %llu red %llu io %llu i2c %llu  watchdog %u  reinicios %u\n",
+         (unsigned long long)simPasosTarea(TAREA_UI), (unsigned long long)simPasosTarea(TAREA_RED),
+         (unsigned long long)simPasosTarea(TAREA_IO), (unsigned long long)simPasosTarea(TAREA_I2C),
+         simDisparosWatchdog(), simReinicios());
+  printf("mqtt recibidos %zu (sensores %zu)  influx %u  uart2 desbordes %u\n", simBrokerHistorial().size(),
+         simBrokerContar("orion/+/sensors/state"), simInfluxEscrituras(), simUartDesbordes(2));
+  printf("telemetria %llu mensajes (%.0f/s reales)", (unsigned long long)simTelemetriaRegistros(),
+         realS > 0 ? simTelemetriaRegistros() / realS : 0.0);
+  if (captura) printf("  captura: %u bytes GPS reproducidos", simReproduccionBytesGps());
+  printf("\n");
+  metricasMuestrearSistema();
+  metricasImprimir(Serial);
+  if (verPantalla) printf("%s", simUiPantalla());
+  return simDisparosWatchdog() ? 1 : 0;
+}
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "sim_ota.h"
+
+/* =======================
+   ORION_OTA
+   =======================
+   Arma los paquetes que aceptan POST /ota y la orden MQTT ota/set (ota.h).
+
+     orion_ota plana|lzss IMAGEN.bin SALIDA.oota
+     orion_ota delta BASE.bin IMAGEN.bin SALIDA.oota
+
+   BASE.bin tiene que ser exactamente la imagen que corre en la placa (la
+   cabecera lleva su SHA-256). La cabecera sale firmada con OTA_CLAVE
+   (-DORION_OTA_CLAVE=... al configurar): la misma que la de la placa. Imprime el SHA-256 de la imagen para ota/set:
+     mosquitto_pub -t orion/<id>/ota/set -m "http://servidor/SALIDA.oota <sha>" */
+
+static bool leer(const char* ruta, std::vector<uint8_t>& out) {
+  FILE* f = fopen(ruta, "rb");
+  if (!f) return false;
+  uint8_t buf[65536];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) out.insert(out.end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+static int uso() {
+  fprintf(stderr, "uso: orion_ota plana|lzss IMAGEN.bin SALIDA.oota\n"
+                  "     orion_ota delta BASE.bin IMAGEN.bin SALIDA.oota\n");
+  return 2;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 4) return uso();
+  OtaTipo tipo;
+  if (!strcmp(argv[1], "plana")) tipo = OTA_PLANA;
+  else if (!strcmp(argv[1], "lzss")) tipo = OTA_LZSS;
+  else if (!strcmp(argv[1], "delta") && argc >= 5) tipo = OTA_DELTA;
+  else return uso();
+
+  std::vector<uint8_t> base, imagen;
+  const char* rutaImagen = tipo == OTA_DELTA ? argv[3] : argv[2];
+  const char* salida = tipo == OTA_DELTA ? argv[4] : argv[3];
+  if ((tipo == OTA_DELTA && !leer(argv[2], base)) || !leer(rutaImagen, imagen)) {
+    fprintf(stderr, "orion_ota: no se pudo leer la imagen\n");
+    return 1;
+  }
+  if (imagen.empty() || imagen[0] != 0xE9) {
+    fprintf(stderr, "orion_ota: %s no es una imagen de ESP32 (falta 0xE9)\n", rutaImagen);
+    return 1;
+  }
+
+  std::vector<uint8_t> paquete = simOtaPaquete(tipo, imagen, tipo == OTA_DELTA ? &base : nullptr);
+  FILE* f = fopen(salida, "wb");
+  if (!f || fwrite(paquete.data(), 1, paquete.size(), f) != paquete.size()) {
+    fprintf(stderr, "orion_ota: no se pudo escribir %s\n", salida);
+    return 1;
+  }
+  fclose(f);
+  printf("%s: %zu B de imagen -> %zu B (%.1f%%)\nsha256 %s\n", salida, imagen.size(), paquete.size(),
+         100.0 * paquete.size() / imagen.size(), simOtaShaHex(imagen).c_str());
+  return 0;
+}
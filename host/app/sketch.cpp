@@ -0,0 +1,2 @@
+// El .ino es C++: se compila tal cual para el host
+#include "../../src/Orion_Iot_Main_Code.ino"
@@ -0,0 +1,218 @@
+#include <benchmark/benchmark.h>
+
+#include <Arduino.h>
+#include <LDR_10K.h>
+#include <TinyGPS++.h>
+#include <WebSerial.h>
+
+#include "local_server.h"
+#include "cloud_mode.h"
+#include "io_task.h"
+#include "historial.h"
+#include "texto.h"
+#include "sim_tasks.h"
+#include "nmea_muestra.h"
+
+/* =======================
+   MICROBENCHMARKS (HOST)
+   =======================
+   Caminos que el firmware recorre en cada ciclo. El tiempo es de CPU del
+   host, útil para comparar versiones, no para estimar el del ESP32.
+   Las asignaciones por iteración salen del contador de malloc del
+   simulador (allocs_per_iter / max_bytes_used en el JSON). */
+
+void setup();
+
+// ---------------------------------------------------------
+// ASIGNACIONES (MemoryManager de Google Benchmark)
+// ---------------------------------------------------------
+class MemoriaSim : public benchmark::MemoryManager {
+public:
+  void Start() override {
+    simHeapReiniciarPico();
+    _inicio = simHeapContadores();
+  }
+
+  void Stop(Result* r) override { Stop(*r); }
+
+  void Stop(Result& r) override {
+    SimHeapContadores fin = simHeapContadores();
+    r.num_allocs = (int64_t)(fin.reservas - _inicio.reservas);
+    r.total_allocated_bytes = (int64_t)(fin.bytesReservados - _inicio.bytesReservados);
+    r.max_bytes_used = fin.pico - _inicio.vivo;
+    r.net_heap_growth = fin.vivo - _inicio.vivo;
+  }
+
+private:
+  SimHeapContadores _inicio;
+};
+
+static LecturaSensores lecturaFija() {
+  LecturaSensores l = {};
+  l.temp = 24;
+  l.hum = 55;
+  l.lux = 63;
+  l.luxRaw = 2530;
+  l.gpsValido = true;
+  l.lat = 19.432608;
+  l.lng = -99.133209;
+  l.alt = 2240.3;
+  l.satsValido = true;
+  l.sats = 8;
+  return l;
+}
+
+// ---------------------------------------------------------
+// COMANDOS WEBSERIAL
+// ---------------------------------------------------------
+static void BM_Palabras(benchmark::State& state) {
+  ArenaFija<64> arena;
+  for (auto _ : state) {
+    for (int i = 0; i < 4; i++) benchmark::DoNotOptimize(arena.palabra("servo set 2 135", ' ', i));
+    arena.reiniciar();
+  }
+}
+BENCHMARK(BM_Palabras);
+
+// Solo comandos que no encolan órdenes: la tarea IO no corre aquí
+static void BM_ProcesarComando(benchmark::State& state, const char* cmd) {
+  for (auto _ : state) {
+    procesarComando(cmd);
+    WebSerial.salida.clear();
+  }
+}
+BENCHMARK_CAPTURE(BM_ProcesarComando, relay_get, "relay get 2");
+BENCHMARK_CAPTURE(BM_ProcesarComando, sensor_all, "sensor all");
+BENCHMARK_CAPTURE(BM_ProcesarComando, servo_error, "servo set 9 90");
+BENCHMARK_CAPTURE(BM_ProcesarComando, desconocido, "foo bar");
+
+// ---------------------------------------------------------
+// LDR
+// ---------------------------------------------------------
+static void BM_LdrPorcentaje(benchmark::State& state) {
+  LDR_10K ldr(36, 300, 4095);
+  ldr.begin(12);
+  ldr.setSmoothing((uint8_t)state.range(0));
+  simFijarAnalogico(36, 2530);
+  for (auto _ : state) benchmark::DoNotOptimize(ldr.getPercentageLDR());
+}
+BENCHMARK(BM_LdrPorcentaje)->Arg(1)->Arg(8);
+
+// ---------------------------------------------------------
+// JSON (MQTT / Home Assistant)
+// ---------------------------------------------------------
+static void BM_JsonSensores(benchmark::State& state) {
+  LecturaSensores l = lecturaFija();
+  char buf[300];
+  for (auto _ : state) benchmark::DoNotOptimize(cloudJsonSensores(l, buf, sizeof(buf)));
+}
+BENCHMARK(BM_JsonSensores);
+
+static void BM_JsonGps(benchmark::State& state) {
+  PuntoTrayecto p = { 1943261, -9913321, 2240, 0 };
+  char buf[200];
+  for (auto _ : state) benchmark::DoNotOptimize(cloudJsonGps(p, buf, sizeof(buf)));
+}
+BENCHMARK(BM_JsonGps);
+
+static void BM_JsonDiscoveryLuz(benchmark::State& state) {
+  char buf[600];
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cloudJsonDiscovery("light", "Luz Cocina", "relay1", "", false, 1, buf, sizeof(buf)));
+  }
+}
+BENCHMARK(BM_JsonDiscoveryLuz);
+
+static void BM_JsonDiscoverySensor(benchmark::State& state) {
+  char buf[600];
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cloudJsonDiscovery("sensor", "Temperatura", "temperature", "temperature", true, 0, buf, sizeof(buf)));
+  }
+}
+BENCHMARK(BM_JsonDiscoverySensor);
+
+// ---------------------------------------------------------
+// INFLUX (line protocol)
+// ---------------------------------------------------------
+static void BM_InfluxLinea(benchmark::State& state) {
+  LecturaSensores l = lecturaFija();
+  PuntoTrayecto p = { 1943261, -9913321, 2240, 0 };
+  char buf[256];
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cloudLineaInflux(l, state.range(0) ? &p : nullptr, nullptr, 1767225600000ULL, buf, sizeof(buf)));
+  }
+}
+BENCHMARK(BM_InfluxLinea)->Arg(0)->Arg(1);  // 1: con posición nueva
+
+// ---------------------------------------------------------
+// GPS
+// ---------------------------------------------------------
+static void BM_GpsEncode(benchmark::State& state) {
+  TinyGPSPlus gps;
+  for (auto _ : state) {
+    for (const char* p = NMEA_MUESTRA; *p; p++) gps.encode(*p);
+  }
+  benchmark::DoNotOptimize(gps.location.lat());
+  state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)(sizeof(NMEA_MUESTRA) - 1));
+}
+BENCHMARK(BM_GpsEncode);
+
+// ---------------------------------------------------------
+// TRAYECTO
+// ---------------------------------------------------------
+// Un fix por iteración sobre una vuelta de ~1 km con curvas
+static void BM_TrayectoAgregar(benchmark::State& state) {
+  trayectoReiniciar();
+  uint32_t i = 0;
+  for (auto _ : state) {
+    double a = (i % 600) * (2 * PI / 600);
+    trayectoAgregar(19.4326 + 0.0015 * sin(a), -99.1332 + 0.0015 * cos(3 * a), 2240, i * 1000);
+    i++;
+  }
+  state.counters["guardados_pct"] = 100.0 * trayectoTotal() / (double)state.iterations();
+}
+BENCHMARK(BM_TrayectoAgregar);
+
+static void BM_TrayectoPolyline(benchmark::State& state) {
+  PuntoTrayecto lote[TRAYECTO_LOTE_MAX];
+  for (int i = 0; i < TRAYECTO_LOTE_MAX; i++) lote[i] = { 1943261 + 37 * i, -9913321 - 21 * i * i, 2240, i * 7000u };
+  char buf[768];
+  for (auto _ : state) benchmark::DoNotOptimize(cloudJsonTrayecto(lote, TRAYECTO_LOTE_MAX, 0, buf, sizeof(buf)));
+}
+BENCHMARK(BM_TrayectoPolyline);
+
+// ---------------------------------------------------------
+// HISTORIAL
+// ---------------------------------------------------------
+// Decodifica 24 h de temperatura (ciclo diario con ruido de ±0.2 °C)
+static void BM_HistorialLeer(benchmark::State& state) {
+  historialIniciar();
+  uint32_t t0 = millis();
+  for (uint32_t m = 1; m <= 1440; m++) {
+    historialMuestra(SERIE_TEMP, 240 + (int32_t)lround(40 * sin(m * 2 * PI / 1440)) + (int32_t)(m * 7 % 5) - 2);
+    historialPaso(t0 + m * HISTORIAL_PERIODO_MS);
+  }
+  static PuntoHistorial puntos[1440];
+  for (auto _ : state) benchmark::DoNotOptimize(historialLeer(SERIE_TEMP, 0, puntos, 1440));
+
+  EstadisticaSerie est;
+  historialEstadistica(SERIE_TEMP, est);
+  state.counters["bits_por_punto"] = (double)est.bits / est.puntos;
+}
+BENCHMARK(BM_HistorialLeer);
+
+// ---------------------------------------------------------
+int main(int argc, char** argv) {
+  // Firmware arrancado y con una lectura de sensores en la tarea IO
+  simSilenciarSerial(true);
+  setup();
+  simEjecutarMs(3000);
+
+  static MemoriaSim memoria;
+  benchmark::RegisterMemoryManager(&memoria);
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -0,0 +1,88 @@
+#ifndef NMEA_MUESTRA_H
+#define NMEA_MUESTRA_H
+
+// Diez segundos de salida a 1 Hz con el formato de un NEO-6M con fix en
+// CDMX (RMC, VTG, GGA, GSA, 3x GSV, GLL). Checksums válidos.
+static const char NMEA_MUESTRA[] =
+  "$GPRMC,174210.00,A,1925.95648,N,09907.99254,W,0.412,118.52,191026,,,A*75\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174210.00,1925.95648,N,09907.99254,W,1,08,1.01,2240.3,M,-8.9,M,,*61\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95648,N,09907.99254,W,174210.00,A,A*77\r\n"
+  "$GPRMC,174211.00,A,1925.95669,N,09907.99288,W,0.412,118.52,191026,,,A*76\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174211.00,1925.95669,N,09907.99288,W,1,08,1.01,2240.4,M,-8.9,M,,*65\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95669,N,09907.99288,W,174211.00,A,A*74\r\n"
+  "$GPRMC,174212.00,A,1925.95690,N,09907.99322,W,0.412,118.52,191026,,,A*72\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174212.00,1925.95690,N,09907.99322,W,1,08,1.01,2240.5,M,-8.9,M,,*60\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95690,N,09907.99322,W,174212.00,A,A*70\r\n"
+  "$GPRMC,174213.00,A,1925.95711,N,09907.99356,W,0.412,118.52,191026,,,A*78\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174213.00,1925.95711,N,09907.99356,W,1,08,1.01,2240.6,M,-8.9,M,,*69\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95711,N,09907.99356,W,174213.00,A,A*7A\r\n"
+  "$GPRMC,174214.00,A,1925.95732,N,09907.99390,W,0.412,118.52,191026,,,A*74\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174214.00,1925.95732,N,09907.99390,W,1,08,1.01,2240.7,M,-8.9,M,,*64\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95732,N,09907.99390,W,174214.00,A,A*76\r\n"
+  "$GPRMC,174215.00,A,1925.95753,N,09907.99424,W,0.412,118.52,191026,,,A*7A\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174215.00,1925.95753,N,09907.99424,W,1,08,1.01,2240.8,M,-8.9,M,,*65\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95753,N,09907.99424,W,174215.00,A,A*78\r\n"
+  "$GPRMC,174216.00,A,1925.95774,N,09907.99458,W,0.412,118.52,191026,,,A*77\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174216.00,1925.95774,N,09907.99458,W,1,08,1.01,2240.9,M,-8.9,M,,*69\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95774,N,09907.99458,W,174216.00,A,A*75\r\n"
+  "$GPRMC,174217.00,A,1925.95795,N,09907.99492,W,0.412,118.52,191026,,,A*7F\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174217.00,1925.95795,N,09907.99492,W,1,08,1.01,2241.0,M,-8.9,M,,*69\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95795,N,09907.99492,W,174217.00,A,A*7D\r\n"
+  "$GPRMC,174218.00,A,1925.95816,N,09907.99526,W,0.412,118.52,191026,,,A*7A\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174218.00,1925.95816,N,09907.99526,W,1,08,1.01,2241.1,M,-8.9,M,,*6D\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95816,N,09907.99526,W,174218.00,A,A*78\r\n"
+  "$GPRMC,174219.00,A,1925.95837,N,09907.99560,W,0.412,118.52,191026,,,A*7A\r\n"
+  "$GPVTG,118.52,T,,M,0.412,N,0.763,K,A*37\r\n"
+  "$GPGGA,174219.00,1925.95837,N,09907.99560,W,1,08,1.01,2241.2,M,-8.9,M,,*6E\r\n"
+  "$GPGSA,A,3,02,05,12,13,15,18,24,25,,,,,1.84,1.01,1.54*05\r\n"
+  "$GPGSV,3,1,11,02,42,311,33,05,18,047,28,12,71,129,40,13,09,201,21*79\r\n"
+  "$GPGSV,3,2,11,15,33,268,35,18,25,089,30,24,55,020,38,25,62,175,41*70\r\n"
+  "$GPGSV,3,3,11,29,05,331,,31,12,145,18,32,02,060,*4B\r\n"
+  "$GPGLL,1925.95837,N,09907.99560,W,174219.00,A,A*78\r\n";
+
+#endif
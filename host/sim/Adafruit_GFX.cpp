@@ -0,0 +1,115 @@
+#include "Adafruit_GFX.h"
+
+Adafruit_GFX::Adafruit_GFX(int16_t w, int16_t h) : _width(w), _height(h) {
+  limpiarTexto();
+}
+
+void Adafruit_GFX::limpiarTexto() {
+  for (int f = 0; f < SIM_GFX_FILAS; f++) {
+    memset(_texto[f], ' ', SIM_GFX_COLS);
+    _texto[f][SIM_GFX_COLS] = '\0';
+  }
+}
+
+void Adafruit_GFX::borrarTextoEn(int16_t x, int16_t y, int16_t w, int16_t h) {
+  for (int f = y / 8; f <= (y + h - 1) / 8 && f < SIM_GFX_FILAS; f++) {
+    for (int c = x / 6; c <= (x + w - 1) / 6 && c < SIM_GFX_COLS; c++) {
+      if (f >= 0 && c >= 0) _texto[f][c] = ' ';
+    }
+  }
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+  fillRect(0, 0, _width, _height, color);
+  limpiarTexto();
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  for (int16_t i = 0; i < w; i++) drawPixel(x + i, y, color);
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < h; i++) drawPixel(x, y + i, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+  int16_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int16_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int16_t err = dx + dy;
+  for (;;) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    int16_t e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y, h, color);
+  drawFastVLine(x + w - 1, y, h, color);
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < w; i++) drawFastVLine(x + i, y, h, color);
+  if (color == 0) borrarTextoEn(x, y, w, h);
+}
+
+void Adafruit_GFX::drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
+  int16_t x = r, y = 0, err = 0;
+  while (x >= y) {
+    drawPixel(x0 + x, y0 + y, color); drawPixel(x0 + y, y0 + x, color);
+    drawPixel(x0 - y, y0 + x, color); drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 - x, y0 - y, color); drawPixel(x0 - y, y0 - x, color);
+    drawPixel(x0 + y, y0 - x, color); drawPixel(x0 + x, y0 - y, color);
+    y++;
+    err += 1 + 2 * y;
+    if (2 * (err - x) + 1 > 0) { x--; err += 1 - 2 * x; }
+  }
+}
+
+void Adafruit_GFX::drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color) {
+  int16_t bytesFila = (w + 7) / 8;
+  for (int16_t j = 0; j < h; j++) {
+    for (int16_t i = 0; i < w; i++) {
+      if (pgm_read_byte(&bitmap[j * bytesFila + i / 8]) & (0x80 >> (i & 7))) {
+        drawPixel(x + i, y + j, color);
+      }
+    }
+  }
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+  if (c == '\n') {
+    _cursorX = 0;
+    _cursorY += 8 * _textSize;
+    return 1;
+  }
+  if (c == '\r') return 1;
+
+  if (_wrap && _cursorX + 6 * _textSize > _width) {
+    _cursorX = 0;
+    _cursorY += 8 * _textSize;
+  }
+
+  // Fondo (si se pidió) y patrón de 5x7 con los bits del código
+  if (_textBg != _textColor) fillRect(_cursorX, _cursorY, 6 * _textSize, 8 * _textSize, _textBg);
+  for (int col = 0; col < 5; col++) {
+    uint8_t patron = (uint8_t)((c * (col + 3)) | 0x41);
+    for (int fila = 0; fila < 7; fila++) {
+      if (patron & (1 << fila)) {
+        for (int sx = 0; sx < _textSize; sx++)
+          for (int sy = 0; sy < _textSize; sy++)
+            drawPixel(_cursorX + col * _textSize + sx, _cursorY + fila * _textSize + sy, _textColor);
+      }
+    }
+  }
+
+  int f = _cursorY / 8, cc = _cursorX / 6;
+  if (f >= 0 && f < SIM_GFX_FILAS && cc >= 0 && cc < SIM_GFX_COLS) _texto[f][cc] = (char)c;
+
+  _cursorX += 6 * _textSize;
+  return 1;
+}
@@ -0,0 +1,61 @@
+#ifndef SIM_ADAFRUIT_GFX_H
+#define SIM_ADAFRUIT_GFX_H
+
+#include "Arduino.h"
+
+/* Shim de Adafruit_GFX: primitivas sobre drawPixel() y una capa de texto.
+   No trae la fuente glcd: cada carácter se pinta como un patrón de 5x7
+   derivado de su código y además se guarda en una rejilla de 21x8
+   celdas para que las pruebas puedan leer lo que muestra la pantalla. */
+
+#define SIM_GFX_COLS 21
+#define SIM_GFX_FILAS 8
+
+class Adafruit_GFX : public Print {
+public:
+  Adafruit_GFX(int16_t w, int16_t h);
+
+  virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+
+  virtual void fillScreen(uint16_t color);
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+  void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+  void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+  void drawBitmap(int16_t x, int16_t y, const uint8_t bitmap[], int16_t w, int16_t h, uint16_t color);
+
+  void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+  void setTextSize(uint8_t s) { _textSize = s ? s : 1; }
+  void setTextColor(uint16_t c) { _textColor = c; _textBg = c; }
+  void setTextColor(uint16_t c, uint16_t bg) { _textColor = c; _textBg = bg; }
+  void setTextWrap(bool w) { _wrap = w; }
+  void cp437(bool) {}
+  int16_t getCursorX() const { return _cursorX; }
+  int16_t getCursorY() const { return _cursorY; }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+  size_t write(uint8_t c) override;
+  using Print::write;
+
+  // --- Lado simulador ---
+  char celdaTexto(int fila, int col) const { return _texto[fila][col]; }
+
+protected:
+  int16_t _width;
+  int16_t _height;
+  int16_t _cursorX = 0;
+  int16_t _cursorY = 0;
+  uint8_t _textSize = 1;
+  uint16_t _textColor = 1;
+  uint16_t _textBg = 1;
+  bool _wrap = true;
+  char _texto[SIM_GFX_FILAS][SIM_GFX_COLS + 1];
+
+  void limpiarTexto();
+  void borrarTextoEn(int16_t x, int16_t y, int16_t w, int16_t h);
+};
+
+#endif
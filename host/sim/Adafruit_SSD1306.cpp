@@ -0,0 +1,167 @@
+#include "Adafruit_SSD1306.h"
+
+static SimPanelSSD1306 panel;
+static bool panelConectado = false;
+
+SimPanelSSD1306* simPanel() {
+  return &panel;
+}
+
+// ---------------------------------------------------------
+// PANTALLA EMULADA
+// ---------------------------------------------------------
+static uint8_t parametrosDe(uint8_t cmd) {
+  switch (cmd) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      return 1;
+    case 0x21: case 0x22:
+      return 2;
+    default:
+      return 0;
+  }
+}
+
+bool SimPanelSSD1306::escribir(const uint8_t* datos, size_t n) {
+  if (n == 0) return true;  // Sondeo de dirección
+  uint8_t control = datos[0];
+
+  if (control == 0x40) {
+    for (size_t i = 1; i < n; i++) {
+      gddram[pag * 128 + col] = datos[i];
+      if (col < colFin) {
+        col++;
+      } else {
+        col = colIni;
+        pag = pag < pagFin ? pag + 1 : pagIni;
+      }
+    }
+    return true;
+  }
+
+  for (size_t i = 1; i < n; i++) {
+    uint8_t b = datos[i];
+    if (pendientes) {
+      params[nParams++] = b;
+      if (--pendientes == 0) {
+        if (ultimo == 0x21) { colIni = params[0] & 127; colFin = params[1] & 127; col = colIni; }
+        if (ultimo == 0x22) { pagIni = params[0] & 7; pagFin = params[1] & 7; pag = pagIni; }
+      }
+      continue;
+    }
+    ultimo = b;
+    nParams = 0;
+    pendientes = parametrosDe(b);
+    if (b == 0xAE) encendida = false;
+    if (b == 0xAF) encendida = true;
+  }
+  return true;
+}
+
+size_t SimPanelSSD1306::leer(uint8_t* datos, size_t n) {
+  memset(datos, 0, n);
+  return n;
+}
+
+// ---------------------------------------------------------
+// DRIVER
+// ---------------------------------------------------------
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t, uint32_t clkDuring, uint32_t clkAfter)
+  : Adafruit_GFX(w, h), _wire(twi), _clkDuring(clkDuring), _clkAfter(clkAfter) {
+  _buffer = (uint8_t*)calloc(1, (size_t)w * ((h + 7) / 8));
+  _visible[0] = '\0';
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+  free(_buffer);
+}
+
+void Adafruit_SSD1306::comandos(const uint8_t* c, size_t n) {
+  _wire->beginTransmission(_addr);
+  _wire->write((uint8_t)0x00);
+  _wire->write(c, n);
+  _wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+  comandos(&c, 1);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t, uint8_t i2caddr, bool, bool periphBegin) {
+  _addr = i2caddr ? i2caddr : 0x3C;
+  if (!panelConectado) {
+    simI2cConectar(_addr, &panel);
+    panelConectado = true;
+  }
+  if (periphBegin) _wire->begin();
+
+  clearDisplay();
+  static const uint8_t init[] = { 0xAE, 0xD5, 0x80, 0xA8, 0x3F, 0xD3, 0x00, 0x40, 0x8D, 0x14,
+                                  0x20, 0x00, 0xA1, 0xC8, 0xDA, 0x12, 0x81, 0xCF, 0xD9, 0xF1,
+                                  0xDB, 0x40, 0xA4, 0xA6, 0x2E, 0xAF };
+  _wire->setClock(_clkDuring);
+  comandos(init, sizeof(init));
+  _wire->setClock(_clkAfter);
+  return true;
+}
+
+void Adafruit_SSD1306::clearDisplay() {
+  memset(_buffer, 0, (size_t)_width * ((_height + 7) / 8));
+  limpiarTexto();
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+  uint8_t& b = _buffer[x + (y / 8) * _width];
+  if (color == SSD1306_WHITE) b |= (1 << (y & 7));
+  else if (color == SSD1306_BLACK) b &= ~(1 << (y & 7));
+  else b ^= (1 << (y & 7));
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) const {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return false;
+  return _buffer[x + (y / 8) * _width] & (1 << (y & 7));
+}
+
+void Adafruit_SSD1306::display() {
+  static const uint8_t ventana[] = { 0x22, 0x00, 0xFF, 0x21, 0x00, 0x7F };
+  _wire->setClock(_clkDuring);
+  comandos(ventana, sizeof(ventana));
+
+  size_t total = (size_t)_width * ((_height + 7) / 8);
+  const size_t bloque = I2C_BUFFER_LENGTH - 1;
+  for (size_t i = 0; i < total; i += bloque) {
+    size_t n = std::min(bloque, total - i);
+    _wire->beginTransmission(_addr);
+    _wire->write((uint8_t)0x40);
+    _wire->write(_buffer + i, n);
+    _wire->endTransmission();
+  }
+  _wire->setClock(_clkAfter);
+  capturarTexto();
+}
+
+uint8_t* Adafruit_SSD1306::getBuffer() {
+  capturarTexto();
+  return _buffer;
+}
+
+void Adafruit_SSD1306::capturarTexto() {
+  char* p = _visible;
+  for (int f = 0; f < SIM_GFX_FILAS; f++) {
+    memcpy(p, _texto[f], SIM_GFX_COLS);
+    p += SIM_GFX_COLS;
+    *p++ = '\n';
+  }
+  *p = '\0';
+  _volcados++;
+}
+
+void Adafruit_SSD1306::invertDisplay(bool i) {
+  ssd1306_command(i ? 0xA7 : 0xA6);
+}
+
+void Adafruit_SSD1306::dim(bool d) {
+  uint8_t c[] = { 0x81, (uint8_t)(d ? 0 : 0xCF) };
+  comandos(c, sizeof(c));
+}
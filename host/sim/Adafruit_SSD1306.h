@@ -0,0 +1,80 @@
+#ifndef SIM_ADAFRUIT_SSD1306_H
+#define SIM_ADAFRUIT_SSD1306_H
+
+#include "Adafruit_GFX.h"
+#include "Wire.h"
+
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+#define SSD1306_INVERSE 2
+#define BLACK SSD1306_BLACK
+#define WHITE SSD1306_WHITE
+
+#define SSD1306_EXTERNALVCC 0x01
+#define SSD1306_SWITCHCAPVCC 0x02
+
+/* Mismo protocolo que la librería real: comandos y GDDRAM por I2C en
+   bloques de hasta I2C_BUFFER_LENGTH, subiendo el reloj a clkDuring
+   mientras dura display(). La pantalla emulada (SimPanelSSD1306) vive
+   en el bus simulado y reconstruye la imagen desde esos bytes. */
+class Adafruit_SSD1306 : public Adafruit_GFX {
+public:
+  Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1,
+                   uint32_t clkDuring = 400000UL, uint32_t clkAfter = 100000UL);
+  ~Adafruit_SSD1306();
+
+  bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0, bool reset = true,
+             bool periphBegin = true);
+  void display();
+  void clearDisplay();
+  void invertDisplay(bool i);
+  void dim(bool dim);
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+  bool getPixel(int16_t x, int16_t y) const;
+  // El firmware vuelca la GDDRAM por su cuenta (bus_i2c): quien se lleva
+  // el buffer lo presenta, así textoVisible() sigue a la pantalla
+  uint8_t* getBuffer();
+  void ssd1306_command(uint8_t c);
+
+  // --- Lado simulador ---
+  // Texto de la última imagen enviada con display() o getBuffer(), una fila por línea
+  const char* textoVisible() const { return _visible; }
+  bool muestra(const char* fragmento) const { return strstr(_visible, fragmento) != nullptr; }
+  uint32_t volcados() const { return _volcados; }
+
+private:
+  TwoWire* _wire;
+  uint8_t _addr = 0x3C;
+  uint32_t _clkDuring;
+  uint32_t _clkAfter;
+  uint8_t* _buffer;
+  char _visible[SIM_GFX_FILAS * (SIM_GFX_COLS + 1) + 1];
+  uint32_t _volcados = 0;
+
+  void comandos(const uint8_t* c, size_t n);
+  void capturarTexto();
+};
+
+// Pantalla emulada conectada al bus (la crea begin() si no existe)
+class SimPanelSSD1306 : public SimDispositivoI2C {
+public:
+  bool escribir(const uint8_t* datos, size_t n) override;
+  size_t leer(uint8_t* datos, size_t n) override;
+  uint32_t clockMax() const override { return 1000000; }  // Tolera 1 MHz en la práctica
+
+  bool pixel(int x, int y) const { return gddram[(y / 8) * 128 + x] & (1 << (y & 7)); }
+  bool encendida = false;
+  uint8_t gddram[128 * 8] = {};
+
+private:
+  uint8_t col = 0, colIni = 0, colFin = 127;
+  uint8_t pag = 0, pagIni = 0, pagFin = 7;
+  uint8_t pendientes = 0;  // Parámetros que faltan del último comando
+  uint8_t ultimo = 0;
+  uint8_t params[2] = {};
+  uint8_t nParams = 0;
+};
+
+SimPanelSSD1306* simPanel();
+
+#endif
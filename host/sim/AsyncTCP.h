@@ -0,0 +1,6 @@
+#ifndef SIM_ASYNCTCP_H
+#define SIM_ASYNCTCP_H
+
+#include "Arduino.h"
+
+#endif
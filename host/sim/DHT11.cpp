@@ -0,0 +1,38 @@
+#include "DHT11.h"
+#include "sim_reproduccion.h"
+
+int DHT11::leer(int& t, int& h) {
+  if (_delayMs) delay(_delayMs);
+  delayMicroseconds(simEntorno().dhtDuracionUs);
+  _lecturas++;
+  int estado;
+  if (simReproduccionDht(t, h, estado)) return estado;
+  if (simDhtFalla()) return ERROR_TIMEOUT;
+  t = (int)lround(simTemperatura());
+  h = (int)lround(simHumedad());
+  return 0;
+}
+
+int DHT11::readTemperature() {
+  int t, h;
+  int r = leer(t, h);
+  return r ? r : t;
+}
+
+int DHT11::readHumidity() {
+  int t, h;
+  int r = leer(t, h);
+  return r ? r : h;
+}
+
+int DHT11::readTemperatureHumidity(int& temperature, int& humidity) {
+  return leer(temperature, humidity);
+}
+
+String DHT11::getErrorString(int errorCode) {
+  switch (errorCode) {
+    case ERROR_TIMEOUT: return "Error 253 Reading from DHT11 timed out.";
+    case ERROR_CHECKSUM: return "Error 254 Checksum mismatch while reading from DHT11.";
+    default: return "Error Unknown.";
+  }
+}
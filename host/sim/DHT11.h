@@ -0,0 +1,33 @@
+#ifndef SIM_DHT11_H
+#define SIM_DHT11_H
+
+#include "Arduino.h"
+
+/* Shim de la librería DHT11 (Dhruba Saha). Cada lectura ocupa
+   simEntorno().dhtDuracionUs de tiempo virtual, como el protocolo real. */
+class DHT11 {
+public:
+  static const int ERROR_CHECKSUM = 254;
+  static const int ERROR_TIMEOUT = 253;
+  static const int TIMEOUT_DURATION = 1000;
+
+  explicit DHT11(int pin) : _pin(pin) {}
+  void setDelay(unsigned long delayMs) { _delayMs = delayMs; }
+
+  int readTemperature();
+  int readHumidity();
+  int readTemperatureHumidity(int& temperature, int& humidity);
+  static String getErrorString(int errorCode);
+
+  // --- Lado simulador ---
+  uint32_t lecturas() const { return _lecturas; }
+
+private:
+  int _pin;
+  unsigned long _delayMs = 500;
+  uint32_t _lecturas = 0;
+
+  int leer(int& t, int& h);
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef SIM_ESP32SERVO_H
+#define SIM_ESP32SERVO_H
+
+#include "Arduino.h"
+
+// El ángulo queda visible para las pruebas con read()
+class Servo {
+public:
+  int attach(int pin) { _pin = pin; return 1; }
+  int attach(int pin, int, int) { return attach(pin); }
+  void detach() { _pin = -1; }
+  bool attached() const { return _pin >= 0; }
+  void write(int angulo) { _angulo = constrain(angulo, 0, 180); _escrituras++; }
+  void writeMicroseconds(int us) { write(map(us, 544, 2400, 0, 180)); }
+  int read() const { return _angulo; }
+  void setPeriodHertz(int) {}
+
+  uint32_t escrituras() const { return _escrituras; }
+
+private:
+  int _pin = -1;
+  int _angulo = 90;
+  uint32_t _escrituras = 0;
+};
+
+#endif
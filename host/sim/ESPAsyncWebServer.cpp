@@ -0,0 +1,191 @@
+#include "ESPAsyncWebServer.h"
+#include "ESPmDNS.h"
+#include "sim_tasks.h"
+#include "sim_board.h"
+
+MDNSResponder MDNS;
+
+static std::vector<AsyncWebServer*> servidores;
+static uint32_t arranques = 0;
+
+// ---------------------------------------------------------
+// PETICIÓN
+// ---------------------------------------------------------
+AsyncWebServerRequest::~AsyncWebServerRequest() {
+  delete _respuesta;
+}
+
+bool AsyncWebServerRequest::hasParam(const String& nombre, bool) const {
+  return getParam(nombre) != nullptr;
+}
+
+const AsyncWebParameter* AsyncWebServerRequest::getParam(const String& nombre, bool) const {
+  for (auto& p : _params) {
+    if (p.name() == nombre) return &p;
+  }
+  return nullptr;
+}
+
+AsyncWebServerResponse* AsyncWebServerRequest::beginResponse(int code, const String& contentType, const String& content) {
+  AsyncWebServerResponse* r = new AsyncWebServerResponse();
+  r->_code = code;
+  r->_tipo = contentType;
+  r->_cuerpo = content;
+  return r;
+}
+
+AsyncResponseStream* AsyncWebServerRequest::beginResponseStream(const String& contentType) {
+  AsyncResponseStream* r = new AsyncResponseStream();
+  r->_tipo = contentType;
+  return r;
+}
+
+void AsyncWebServerRequest::send(AsyncWebServerResponse* response) {
+  delete _respuesta;
+  _respuesta = response;
+}
+
+void AsyncWebServerRequest::send(FS& fs, const String& path, const String& contentType, bool) {
+  File f = fs.open(path, FILE_READ);
+  if (!f) {
+    send(404);
+    return;
+  }
+  AsyncResponseStream* r = beginResponseStream(contentType);
+  uint8_t buf[256];
+  size_t n;
+  while ((n = f.read(buf, sizeof(buf))) > 0) r->write(buf, n);
+  f.close();
+  send(r);
+}
+
+void AsyncWebServerRequest::send(int code, const String& contentType, const String& content) {
+  send(beginResponse(code, contentType, content));
+}
+
+// ---------------------------------------------------------
+// SERVIDOR
+// ---------------------------------------------------------
+AsyncWebServer::~AsyncWebServer() {
+  end();
+}
+
+void AsyncWebServer::begin() {
+  if (_activo) return;
+  _activo = true;
+  arranques++;
+  servidores.push_back(this);
+}
+
+void AsyncWebServer::end() {
+  _activo = false;
+  servidores.erase(std::remove(servidores.begin(), servidores.end(), this), servidores.end());
+}
+
+AsyncWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite metodo, ArRequestHandlerFunction fn) {
+  _rutas.push_back({ uri, metodo, fn, nullptr });
+  return _handler;
+}
+
+AsyncWebHandler& AsyncWebServer::on(const char* uri, WebRequestMethodComposite metodo, ArRequestHandlerFunction fn,
+                                    ArUploadHandlerFunction subida) {
+  _rutas.push_back({ uri, metodo, fn, subida });
+  return _handler;
+}
+
+ArUploadHandlerFunction AsyncWebServer::subida(AsyncWebServerRequest& req) {
+  for (auto& r : _rutas) {
+    if ((r.metodo & req.method()) && r.uri == req.url().c_str()) return r.subida;
+  }
+  return nullptr;
+}
+
+bool AsyncWebServer::atender(AsyncWebServerRequest& req) {
+  for (auto& r : _rutas) {
+    if ((r.metodo & req.method()) && r.uri == req.url().c_str()) {
+      r.fn(&req);
+      return true;
+    }
+  }
+  if (_noEncontrado) {
+    _noEncontrado(&req);
+    return true;
+  }
+  return false;
+}
+
+static void decodificar(const std::string& consulta, std::vector<AsyncWebParameter>& out) {
+  size_t i = 0;
+  while (i < consulta.size()) {
+    size_t fin = consulta.find('&', i);
+    if (fin == std::string::npos) fin = consulta.size();
+    std::string par = consulta.substr(i, fin - i);
+    size_t igual = par.find('=');
+    std::string nombre = par.substr(0, igual);
+    std::string valor = igual == std::string::npos ? "" : par.substr(igual + 1);
+    std::string limpio;
+    for (size_t k = 0; k < valor.size(); k++) {
+      if (valor[k] == '+') limpio += ' ';
+      else if (valor[k] == '%' && k + 2 < valor.size()) {
+        limpio += (char)strtol(valor.substr(k + 1, 2).c_str(), nullptr, 16);
+        k += 2;
+      } else limpio += valor[k];
+    }
+    out.emplace_back(String(nombre.c_str()), String(limpio.c_str()));
+    i = fin + 1;
+  }
+}
+
+SimRespuestaHttp simHttp(const char* metodo, const char* url, const char* cuerpo) {
+  std::string u(url);
+  std::string ruta = u.substr(0, u.find('?'));
+  AsyncWebServerRequest req(strcmp(metodo, "POST") == 0 ? HTTP_POST : HTTP_GET, String(ruta.c_str()));
+  if (u.find('?') != std::string::npos) decodificar(u.substr(u.find('?') + 1), req._params);
+  if (cuerpo) decodificar(cuerpo, req._params);
+
+  for (AsyncWebServer* s : servidores) {
+    if (s->atender(req)) {
+      if (!req._respuesta) return { 500, "", "" };
+      return { req._respuesta->_code, req._respuesta->_tipo.c_str(), req._respuesta->_cuerpo.c_str() };
+    }
+  }
+  return { servidores.empty() ? 0 : 404, "", "" };
+}
+
+SimRespuestaHttp simHttpSubir(const char* url, const uint8_t* datos, size_t n, uint32_t bytesPorSeg) {
+  AsyncWebServerRequest req(HTTP_POST, String(url));
+  AsyncWebServer* destino = nullptr;
+  ArUploadHandlerFunction fn;
+  for (AsyncWebServer* s : servidores) {
+    if ((fn = s->subida(req))) {
+      destino = s;
+      break;
+    }
+  }
+  if (!destino) return { servidores.empty() ? 0 : 404, "", "" };
+
+  const size_t SEGMENTO = 1436;
+  uint64_t inicioUs = simAhoraUs();
+  std::vector<uint8_t> trozo;
+  {
+    SimHeapAjeno ajeno;  // El buffer de recepción es de lwIP
+    trozo.resize(SEGMENTO);
+  }
+  String nombre("firmware.oota");
+  size_t i = 0;
+  do {
+    size_t largo = std::min(SEGMENTO, n - i);
+    memcpy(trozo.data(), datos + i, largo);
+    fn(&req, nombre, i, trozo.data(), largo, i + largo >= n);
+    i += largo;
+    uint64_t llegaUs = inicioUs + (uint64_t)i * 1000000 / bytesPorSeg;
+    if (llegaUs > simAhoraUs()) simEjecutarHastaUs(llegaUs);
+  } while (i < n);
+  destino->atender(req);
+  if (!req._respuesta) return { 500, "", "" };
+  return { req._respuesta->_code, req._respuesta->_tipo.c_str(), req._respuesta->_cuerpo.c_str() };
+}
+
+uint32_t simHttpServidoresActivos() {
+  return (uint32_t)servidores.size();
+}
@@ -0,0 +1,127 @@
+#ifndef SIM_ESPASYNCWEBSERVER_H
+#define SIM_ESPASYNCWEBSERVER_H
+
+#include "Arduino.h"
+#include "AsyncTCP.h"
+#include "FS.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+/* Shim de ESPAsyncWebServer: registra rutas y las atiende de forma
+   síncrona desde simHttp(), que hace de navegador en las pruebas. */
+
+typedef enum { HTTP_GET = 0b01, HTTP_POST = 0b10, HTTP_ANY = 0b11 } WebRequestMethod;
+typedef uint8_t WebRequestMethodComposite;
+
+class AsyncWebParameter {
+public:
+  AsyncWebParameter(const String& nombre, const String& valor) : _nombre(nombre), _valor(valor) {}
+  const String& name() const { return _nombre; }
+  const String& value() const { return _valor; }
+
+private:
+  String _nombre;
+  String _valor;
+};
+
+class AsyncWebServerRequest;
+
+class AsyncWebServerResponse {
+public:
+  virtual ~AsyncWebServerResponse() {}
+  void addHeader(const String&, const String&) {}
+  int _code = 200;
+  String _tipo;
+  String _cuerpo;
+};
+
+class AsyncResponseStream : public AsyncWebServerResponse, public Print {
+public:
+  size_t write(uint8_t c) override { _cuerpo += (char)c; return 1; }
+  size_t write(const uint8_t* b, size_t n) override { _cuerpo.concat((const char*)b, n); return n; }
+  void setCode(int code) { _code = code; }
+};
+
+class AsyncWebServerRequest {
+public:
+  AsyncWebServerRequest(WebRequestMethod metodo, const String& url) : _metodo(metodo), _url(url) {}
+  ~AsyncWebServerRequest();
+
+  WebRequestMethod method() const { return _metodo; }
+  const String& url() const { return _url; }
+  bool hasParam(const String& nombre, bool post = false) const;
+  const AsyncWebParameter* getParam(const String& nombre, bool post = false) const;
+  size_t params() const { return _params.size(); }
+  const AsyncWebParameter* getParam(size_t i) const { return i < _params.size() ? &_params[i] : nullptr; }
+
+  void send(int code, const String& contentType = String(), const String& content = String());
+  void send(AsyncWebServerResponse* response);
+  void send(FS& fs, const String& path, const String& contentType = String(), bool download = false);
+  AsyncWebServerResponse* beginResponse(int code, const String& contentType = String(),
+                                        const String& content = String());
+  AsyncResponseStream* beginResponseStream(const String& contentType);
+
+  // --- Lado simulador ---
+  std::vector<AsyncWebParameter> _params;
+  AsyncWebServerResponse* _respuesta = nullptr;
+
+private:
+  WebRequestMethod _metodo;
+  String _url;
+};
+
+typedef std::function<void(AsyncWebServerRequest*)> ArRequestHandlerFunction;
+typedef std::function<void(AsyncWebServerRequest*, const String& filename, size_t index, uint8_t* data, size_t len,
+                           bool final)> ArUploadHandlerFunction;
+
+class AsyncWebHandler {};
+
+class AsyncWebServer {
+public:
+  explicit AsyncWebServer(uint16_t puerto) : _puerto(puerto) {}
+  ~AsyncWebServer();
+  void begin();
+  void end();
+  AsyncWebHandler& on(const char* uri, ArRequestHandlerFunction fn) { return on(uri, HTTP_ANY, fn); }
+  AsyncWebHandler& on(const char* uri, WebRequestMethodComposite metodo, ArRequestHandlerFunction fn);
+  AsyncWebHandler& on(const char* uri, WebRequestMethodComposite metodo, ArRequestHandlerFunction fn,
+                      ArUploadHandlerFunction subida);
+  void onNotFound(ArRequestHandlerFunction fn) { _noEncontrado = fn; }
+  void reset() { _rutas.clear(); }
+
+  // --- Lado simulador ---
+  bool activo() const { return _activo; }
+  bool atender(AsyncWebServerRequest& req);
+  ArUploadHandlerFunction subida(AsyncWebServerRequest& req);
+  size_t rutas() const { return _rutas.size(); }
+
+private:
+  struct Ruta {
+    std::string uri;
+    WebRequestMethodComposite metodo;
+    ArRequestHandlerFunction fn;
+    ArUploadHandlerFunction subida;
+  };
+  uint16_t _puerto;
+  bool _activo = false;
+  std::vector<Ruta> _rutas;
+  ArRequestHandlerFunction _noEncontrado;
+  AsyncWebHandler _handler;
+};
+
+// Petición HTTP al servidor activo: "GET /selftest.json?x=1". Devuelve el código
+struct SimRespuestaHttp {
+  int codigo;
+  std::string tipo;
+  std::string cuerpo;
+};
+SimRespuestaHttp simHttp(const char* metodo, const char* url, const char* cuerpo = nullptr);
+uint32_t simHttpServidoresActivos();
+
+// POST multipart de un archivo: trozos de 1436 B (un segmento TCP) a
+// 'bytesPorSeg', corriendo las tareas entre trozo y trozo. Si el handler
+// tarda más (flash), el siguiente trozo espera, como con la ventana TCP.
+SimRespuestaHttp simHttpSubir(const char* url, const uint8_t* datos, size_t n, uint32_t bytesPorSeg);
+
+#endif
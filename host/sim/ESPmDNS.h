@@ -0,0 +1,22 @@
+#ifndef SIM_ESPMDNS_H
+#define SIM_ESPMDNS_H
+
+#include "Arduino.h"
+
+class MDNSResponder {
+public:
+  bool begin(const char* hostname) { strlcpy(_host, hostname, sizeof(_host)); _activo = true; return true; }
+  void end() { _activo = false; }
+  bool addService(const char*, const char*, uint16_t) { return true; }
+
+  bool activo() const { return _activo; }
+  const char* host() const { return _host; }
+
+private:
+  bool _activo = false;
+  char _host[33] = "";
+};
+
+extern MDNSResponder MDNS;
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SIM_ESP_H
+#define SIM_ESP_H
+
+#include <stdint.h>
+
+class EspClass {
+public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint64_t getEfuseMac();
+  uint32_t getCpuFreqMHz();
+  uint32_t getCycleCount();   // Ciclos del reloj virtual a getCpuFreqMHz()
+  const char* getChipModel() { return "ESP32-SIM"; }
+  const char* getSdkVersion() { return "sim"; }
+  uint32_t getSketchSize() { return 0; }
+  uint32_t getFreeSketchSpace() { return 0x1E0000; }
+  void restart();
+};
+
+extern EspClass ESP;
+
+#endif
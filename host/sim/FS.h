@@ -0,0 +1,76 @@
+#ifndef SIM_FS_H
+#define SIM_FS_H
+
+#include "Arduino.h"
+#include <memory>
+#include <string>
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+/* Sistema de archivos del core (fs::FS / fs::File) sobre una carpeta del
+   host. Lo monta LittleFS (LittleFS.h); la carpeta la da simFsRaiz(). */
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct ArchivoSim;
+
+class File : public Stream {
+public:
+  File() {}
+  explicit File(std::shared_ptr<ArchivoSim> a) : _a(std::move(a)) {}
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t size) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  size_t read(uint8_t* buf, size_t size);
+  int peek() override;
+  void flush();
+  bool seek(uint32_t pos, SeekMode modo = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void close();
+  operator bool() const;
+  const char* path() const;
+  const char* name() const;
+  bool isDirectory() const { return false; }
+
+private:
+  std::shared_ptr<ArchivoSim> _a;
+};
+
+class FS {
+public:
+  File open(const char* path, const char* mode = FILE_READ, bool create = false);
+  File open(const String& path, const char* mode = FILE_READ, bool create = false) {
+    return open(path.c_str(), mode, create);
+  }
+  bool exists(const char* path);
+  bool exists(const String& path) { return exists(path.c_str()); }
+  bool remove(const char* path);
+  bool remove(const String& path) { return remove(path.c_str()); }
+  bool rename(const char* desde, const char* hacia);
+
+protected:
+  bool _montado = false;
+};
+
+}  // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+// --- Lado simulador ---
+const char* simFsRaiz();                      // ORION_SIM_FS o una carpeta temporal nueva
+std::string simFsRuta(const char* path);      // Ruta del host para un path del firmware
+size_t simFsUsado();
+
+#endif
@@ -0,0 +1,99 @@
+#include "Arduino.h"
+
+#define UART_MAX 3
+static HardwareSerial* uarts[UART_MAX];
+static bool serialSilenciado = false;
+
+HardwareSerial Serial(0);
+HardwareSerial Serial1(1);
+HardwareSerial Serial2(2);
+
+HardwareSerial::HardwareSerial(int uartNum)
+  : _num(uartNum), _iniciado(false), _baud(0), _rxPin(-1), _rxCap(256), _rx(nullptr), _ini(0), _n(0), _desbordes(0) {
+  // Varios objetos pueden compartir UART (como en el ESP32): gana el último begin()
+  if (uartNum >= 0 && uartNum < UART_MAX && !uarts[uartNum]) uarts[uartNum] = this;
+}
+
+void HardwareSerial::begin(unsigned long baud, uint32_t, int8_t rxPin, int8_t, bool, unsigned long) {
+  _baud = baud;
+  _rxPin = rxPin;
+  if (_rxPin >= 0) simFijarEntrada(_rxPin, HIGH);  // Línea en reposo
+  if (!_rx) _rx = (uint8_t*)malloc(_rxCap);
+  _ini = _n = 0;
+  _iniciado = true;
+  if (_num >= 0 && _num < UART_MAX) uarts[_num] = this;
+  if (_num == 2) simGpsIniciar();  // El módulo GPS de la placa cuelga de UART2
+}
+
+void HardwareSerial::end() {
+  _iniciado = false;
+  free(_rx);
+  _rx = nullptr;
+  _n = 0;
+}
+
+size_t HardwareSerial::setRxBufferSize(size_t size) {
+  if (_iniciado) return 0;  // Igual que en el core: solo antes de begin()
+  _rxCap = size;
+  return size;
+}
+
+int HardwareSerial::available() {
+  return (int)_n;
+}
+
+int HardwareSerial::read() {
+  if (!_n) return -1;
+  uint8_t c = _rx[_ini];
+  _ini = (_ini + 1) % _rxCap;
+  _n--;
+  return c;
+}
+
+size_t HardwareSerial::read(uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (n < size && _n) buffer[n++] = (uint8_t)read();
+  return n;
+}
+
+int HardwareSerial::peek() {
+  return _n ? _rx[_ini] : -1;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (_num == 0 && !serialSilenciado) fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+size_t HardwareSerial::inyectar(const uint8_t* data, size_t len) {
+  if (!_iniciado) return 0;
+  // El pin ve el bit de arranque: una ISR de flanco o nivel sobre RX salta
+  if (_rxPin >= 0 && len) {
+    simFijarEntrada(_rxPin, LOW);
+    simFijarEntrada(_rxPin, HIGH);
+  }
+  size_t aceptados = 0;
+  for (size_t i = 0; i < len; i++) {
+    if (_n == _rxCap) {
+      _desbordes += len - i;
+      break;
+    }
+    _rx[(_ini + _n) % _rxCap] = data[i];
+    _n++;
+    aceptados++;
+  }
+  return aceptados;
+}
+
+HardwareSerial* simUart(int num) {
+  if (num < 0 || num >= UART_MAX) return nullptr;
+  return uarts[num];
+}
+
+void simSilenciarSerial(bool silenciar) {
+  serialSilenciado = silenciar;
+}
@@ -0,0 +1,56 @@
+#ifndef SIM_HARDWARESERIAL_H
+#define SIM_HARDWARESERIAL_H
+
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+
+/* UART simulada. UART0 (Serial) escribe en stdout salvo simSilenciarSerial().
+   El resto recibe lo que inyecte el simulador (GPS, grabaciones) y lo entrega
+   respetando el buffer RX: lo que no cabe se cuenta como desbordamiento. */
+class HardwareSerial : public Stream {
+public:
+  explicit HardwareSerial(int uartNum);
+
+  void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1,
+             bool invert = false, unsigned long timeoutMs = 20000UL);
+  void end();
+  size_t setRxBufferSize(size_t size);
+  void updateBaudRate(unsigned long baud) { _baud = baud; }
+  unsigned long baudRate() const { return _baud; }
+
+  int available() override;
+  int read() override;
+  size_t read(uint8_t* buffer, size_t size);
+  size_t read(char* buffer, size_t size) { return read((uint8_t*)buffer, size); }
+  int peek() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  using Print::write;
+  operator bool() const { return true; }
+
+  // --- Lado simulador ---
+  int numero() const { return _num; }
+  bool iniciado() const { return _iniciado; }
+  size_t inyectar(const uint8_t* data, size_t len);  // Devuelve bytes aceptados
+  uint32_t desbordes() const { return _desbordes; }
+
+private:
+  int _num;
+  bool _iniciado;
+  unsigned long _baud;
+  int8_t _rxPin;  // Cada inyección lo pulsa en bajo (bit de arranque)
+  size_t _rxCap;
+  uint8_t* _rx;
+  size_t _ini;
+  size_t _n;
+  uint32_t _desbordes;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+HardwareSerial* simUart(int num);
+
+#endif
@@ -0,0 +1,33 @@
+#include "Arduino.h"
+
+IPAddress::IPAddress(uint32_t addr) {
+  memcpy(_addr, &addr, 4);
+}
+
+IPAddress::operator uint32_t() const {
+  uint32_t v;
+  memcpy(&v, _addr, 4);
+  return v;
+}
+
+bool IPAddress::fromString(const char* address) {
+  unsigned a, b, c, d;
+  char extra;
+  if (!address || sscanf(address, "%u.%u.%u.%u%c", &a, &b, &c, &d, &extra) != 4) return false;
+  if (a > 255 || b > 255 || c > 255 || d > 255) return false;
+  _addr[0] = a;
+  _addr[1] = b;
+  _addr[2] = c;
+  _addr[3] = d;
+  return true;
+}
+
+String IPAddress::toString() const {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%u.%u.%u.%u", _addr[0], _addr[1], _addr[2], _addr[3]);
+  return String(buf);
+}
+
+size_t IPAddress::printTo(Print& p) const {
+  return p.print(toString());
+}
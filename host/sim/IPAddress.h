@@ -0,0 +1,29 @@
+#ifndef SIM_IPADDRESS_H
+#define SIM_IPADDRESS_H
+
+#include <stdint.h>
+#include "Printable.h"
+#include "WString.h"
+
+class IPAddress : public Printable {
+public:
+  IPAddress() : _addr{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _addr{a, b, c, d} {}
+  IPAddress(uint32_t addr);
+  IPAddress(const uint8_t* addr) : _addr{addr[0], addr[1], addr[2], addr[3]} {}
+  IPAddress(const char* address) : IPAddress() { fromString(address); }
+
+  bool fromString(const char* address);
+  String toString() const;
+
+  operator uint32_t() const;
+  uint8_t operator[](int index) const { return _addr[index]; }
+  bool operator==(const IPAddress& o) const { return memcmp(_addr, o._addr, 4) == 0; }
+
+  size_t printTo(Print& p) const override;
+
+private:
+  uint8_t _addr[4];
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "InfluxDbClient.h"
+#include "WiFi.h"
+#include "sim_telemetria.h"
+
+static std::vector<std::string> lineas;
+static bool fallar = false;
+static uint32_t escrituras = 0;
+
+const std::vector<std::string>& simInfluxLineas() {
+  return lineas;
+}
+
+void simInfluxLimpiar() {
+  lineas.clear();
+}
+
+void simInfluxFallar(bool f) {
+  fallar = f;
+}
+
+uint32_t simInfluxEscrituras() {
+  return escrituras;
+}
+
+// ---------------------------------------------------------
+// POINT
+// ---------------------------------------------------------
+static String escapar(const String& s) {
+  String out;
+  for (unsigned int i = 0; i < s.length(); i++) {
+    char c = s.charAt(i);
+    if (c == ',' || c == '=' || c == ' ') out += '\\';
+    out += c;
+  }
+  return out;
+}
+
+Point::Point(const String& measurement) : _measurement(measurement) {}
+
+void Point::addTag(const String& name, String value) {
+  if (_tags.length()) _tags += ',';
+  _tags += escapar(name);
+  _tags += '=';
+  _tags += escapar(value);
+}
+
+void Point::agregar(const String& name, const String& valor) {
+  if (_fields.length()) _fields += ',';
+  _fields += escapar(name);
+  _fields += '=';
+  _fields += valor;
+}
+
+void Point::addField(const String& name, const char* value) {
+  String v = "\"";
+  for (const char* p = value; *p; p++) {
+    if (*p == '"' || *p == '\\') v += '\\';
+    v += *p;
+  }
+  v += '"';
+  agregar(name, v);
+}
+
+void Point::setTime(WritePrecision precision) {
+  uint64_t us = simAhoraUs();
+  switch (precision) {
+    case WritePrecision::S: _time = String((unsigned long long)(us / 1000000)); break;
+    case WritePrecision::MS: _time = String((unsigned long long)(us / 1000)); break;
+    case WritePrecision::US: _time = String((unsigned long long)us); break;
+    case WritePrecision::NS: _time = String((unsigned long long)us * 1000ULL); break;
+    default: _time = ""; break;
+  }
+}
+
+void Point::clearFields() {
+  _fields = "";
+  _time = "";
+}
+
+void Point::clearTags() {
+  _tags = "";
+}
+
+String Point::toLineProtocol(const String& includeTags) const {
+  String linea = escapar(_measurement);
+  if (_tags.length()) {
+    linea += ',';
+    linea += _tags;
+  }
+  if (includeTags.length()) {
+    linea += ',';
+    linea += includeTags;
+  }
+  linea += ' ';
+  linea += _fields;
+  if (_time.length()) {
+    linea += ' ';
+    linea += _time;
+  }
+  return linea;
+}
+
+// ---------------------------------------------------------
+// CLIENTE
+// ---------------------------------------------------------
+InfluxDBClient::InfluxDBClient(const String& serverUrl, const String&, const String&, const String&)
+  : _url(serverUrl) {}
+
+InfluxDBClient::InfluxDBClient(const String& serverUrl, const String&, const String&, const String&, const char*)
+  : _url(serverUrl) {}
+
+bool InfluxDBClient::validateConnection() {
+  delay(120);  // Ida y vuelta HTTP
+  if (fallar || !WiFi.isConnected()) {
+    _status = fallar ? 503 : -1;
+    _error = fallar ? "Service Unavailable" : "connection refused";
+    _conectado = false;
+    return false;
+  }
+  _status = 204;
+  _error = "";
+  _conectado = true;
+  return true;
+}
+
+bool InfluxDBClient::writeRecord(const char* record) {
+  delay(40);
+  if (fallar || !WiFi.isConnected() || simRedCortada()) {
+    _status = fallar ? 503 : -1;
+    _error = fallar ? "Service Unavailable" : "connection refused";
+    return false;
+  }
+  // Un lote trae varias líneas: se guardan (y cuentan) de a una
+  SimHeapAjeno ajeno;
+  std::string resto = record;
+  size_t inicio = 0;
+  while (inicio < resto.size()) {
+    size_t fin = resto.find('\n', inicio);
+    if (fin == std::string::npos) fin = resto.size();
+    std::string linea = resto.substr(inicio, fin - inicio);
+    lineas.push_back(linea);
+    escrituras++;
+    simTelemetriaRegistrar("influx", linea.c_str());
+    inicio = fin + 1;
+  }
+  _status = 204;
+  _error = "";
+  return true;
+}
+
+bool InfluxDBClient::writePoint(Point& point) {
+  if (!point.hasFields()) return false;
+  return writeRecord(point.toLineProtocol());
+}
@@ -0,0 +1,106 @@
+#ifndef SIM_INFLUXDB_CLIENT_H
+#define SIM_INFLUXDB_CLIENT_H
+
+#include "Arduino.h"
+#include <string>
+#include <vector>
+
+/* Shim de InfluxDB-Client-for-Arduino. Point genera el mismo line
+   protocol; InfluxDBClient no hace HTTP sino que deja cada línea en un
+   sumidero que leen las pruebas (y opcionalmente en el archivo indicado
+   por ORION_SIM_INFLUX_ARCHIVO). */
+
+enum class WritePrecision { NoTime = 0, S, MS, US, NS };
+
+class Point {
+public:
+  explicit Point(const String& measurement);
+
+  void addTag(const String& name, String value);
+  void addField(const String& name, int value) { agregar(name, String(value) + "i"); }
+  void addField(const String& name, long value) { agregar(name, String(value) + "i"); }
+  void addField(const String& name, unsigned int value) { agregar(name, String(value) + "i"); }
+  void addField(const String& name, unsigned long value) { agregar(name, String(value) + "i"); }
+  void addField(const String& name, long long value) { agregar(name, String(value) + "i"); }
+  void addField(const String& name, float value, int decimalPlaces = 2) { agregar(name, String(value, decimalPlaces)); }
+  void addField(const String& name, double value, int decimalPlaces = 2) { agregar(name, String(value, decimalPlaces)); }
+  void addField(const String& name, bool value) { agregar(name, value ? "true" : "false"); }
+  void addField(const String& name, const char* value);
+  void addField(const String& name, const String& value) { addField(name, value.c_str()); }
+
+  void setTime(WritePrecision precision = WritePrecision::S);
+  void setTime(unsigned long long timestamp) { _time = String(timestamp); }
+  void setTime(const String& timestamp) { _time = timestamp; }
+
+  void clearFields();
+  void clearTags();
+  bool hasFields() const { return _fields.length() > 0; }
+  bool hasTags() const { return _tags.length() > 0; }
+  bool hasTime() const { return _time.length() > 0; }
+  String getName() const { return _measurement; }
+  String toLineProtocol(const String& includeTags = "") const;
+
+private:
+  String _measurement;
+  String _tags;
+  String _fields;
+  String _time;
+
+  void agregar(const String& name, const String& valor);
+};
+
+class WriteOptions {
+public:
+  WriteOptions& writePrecision(WritePrecision p) { _precision = p; return *this; }
+  WriteOptions& batchSize(uint16_t n) { _batch = n; return *this; }
+  WriteOptions& bufferSize(uint16_t n) { _buffer = n; return *this; }
+  WriteOptions& flushInterval(uint16_t s) { _flushS = s; return *this; }
+  WritePrecision _precision = WritePrecision::NoTime;
+  uint16_t _batch = 1;
+  uint16_t _buffer = 5;
+  uint16_t _flushS = 60;
+};
+
+class HTTPOptions {
+public:
+  HTTPOptions& httpReadTimeout(int ms) { _timeoutMs = ms; return *this; }
+  HTTPOptions& connectionReuse(bool r) { _reuse = r; return *this; }
+  int _timeoutMs = 5000;
+  bool _reuse = false;
+};
+
+class InfluxDBClient {
+public:
+  InfluxDBClient(const String& serverUrl, const String& org, const String& bucket, const String& authToken);
+  InfluxDBClient(const String& serverUrl, const String& org, const String& bucket, const String& authToken,
+                 const char* certInfo);
+
+  bool validateConnection();
+  bool writePoint(Point& point);
+  bool writeRecord(const String& record) { return writeRecord(record.c_str()); }
+  bool writeRecord(const char* record);
+  bool flushBuffer() { return true; }
+  bool isBufferEmpty() const { return true; }
+  bool isConnected() const { return _conectado; }
+  void setWriteOptions(const WriteOptions& wo) { _opciones = wo; }
+  void setHTTPOptions(const HTTPOptions& ho) { _http = ho; }
+  String getLastErrorMessage() const { return _error; }
+  int getLastStatusCode() const { return _status; }
+  String getServerUrl() const { return _url; }
+
+private:
+  String _url;
+  String _error;
+  int _status = 0;
+  bool _conectado = false;
+  WriteOptions _opciones;
+  HTTPOptions _http;
+};
+
+// --- Lado simulador ---
+const std::vector<std::string>& simInfluxLineas();
+void simInfluxLimpiar();
+void simInfluxFallar(bool fallar);  // writePoint/validate devuelven error (HTTP 503)
+uint32_t simInfluxEscrituras();
+
+#endif
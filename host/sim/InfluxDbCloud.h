@@ -0,0 +1,8 @@
+#ifndef SIM_INFLUXDB_CLOUD_H
+#define SIM_INFLUXDB_CLOUD_H
+
+#include "InfluxDbClient.h"
+
+#define InfluxDbCloud2CACert ""
+
+#endif
@@ -0,0 +1,183 @@
+#include "LittleFS.h"
+#include "sim_board.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+LittleFSFS LittleFS;
+
+namespace fs {
+
+struct ArchivoSim {
+  FILE* f = nullptr;
+  std::string path;
+  std::string nombre;
+};
+
+}  // namespace fs
+
+// ---------------------------------------------------------
+// CARPETA DEL HOST
+// ---------------------------------------------------------
+const char* simFsRaiz() {
+  static std::string raiz;
+  if (raiz.empty()) {
+    const char* env = getenv("ORION_SIM_FS");
+    if (env) {
+      raiz = env;
+      mkdir(env, 0755);
+    } else {
+      char plantilla[] = "/tmp/orion_fs_XXXXXX";
+      raiz = mkdtemp(plantilla) ? plantilla : "/tmp";
+    }
+  }
+  return raiz.c_str();
+}
+
+std::string simFsRuta(const char* path) {
+  std::string r = simFsRaiz();
+  if (path[0] != '/') r += '/';
+  return r + path;
+}
+
+size_t simFsUsado() {
+  size_t total = 0;
+  DIR* d = opendir(simFsRaiz());
+  if (!d) return 0;
+  while (dirent* e = readdir(d)) {
+    struct stat st;
+    std::string ruta = std::string(simFsRaiz()) + "/" + e->d_name;
+    if (stat(ruta.c_str(), &st) == 0 && S_ISREG(st.st_mode)) total += (size_t)st.st_size;
+  }
+  closedir(d);
+  return total;
+}
+
+// ---------------------------------------------------------
+// FS
+// ---------------------------------------------------------
+bool LittleFSFS::begin(bool, const char*, uint8_t, const char*) {
+  simFsRaiz();
+  _montado = true;
+  return true;
+}
+
+bool LittleFSFS::format() {
+  DIR* d = opendir(simFsRaiz());
+  if (!d) return false;
+  while (dirent* e = readdir(d)) {
+    if (e->d_name[0] == '.') continue;
+    unlink((std::string(simFsRaiz()) + "/" + e->d_name).c_str());
+  }
+  closedir(d);
+  return true;
+}
+
+namespace fs {
+
+File FS::open(const char* path, const char* mode, bool) {
+  if (!_montado) return File();
+  const char* modoC = !strcmp(mode, "w") ? "w+b" : !strcmp(mode, "a") ? "a+b" : "rb";
+  FILE* f = fopen(simFsRuta(path).c_str(), modoC);
+  if (!f) return File();
+  auto a = std::make_shared<ArchivoSim>();
+  a->f = f;
+  a->path = path;
+  const char* barra = strrchr(path, '/');
+  a->nombre = barra ? barra + 1 : path;
+  return File(a);
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return _montado && stat(simFsRuta(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+  return _montado && unlink(simFsRuta(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* desde, const char* hacia) {
+  return _montado && ::rename(simFsRuta(desde).c_str(), simFsRuta(hacia).c_str()) == 0;
+}
+
+// ---------------------------------------------------------
+// FILE
+// ---------------------------------------------------------
+size_t File::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!_a || !_a->f) return 0;
+  // Partición llena: como en LittleFS, la escritura se queda corta
+  size_t libre = SIM_FS_CAPACIDAD > simFsUsado() ? SIM_FS_CAPACIDAD - simFsUsado() : 0;
+  if (size > libre) size = libre;
+  return fwrite(buf, 1, size, _a->f);
+}
+
+int File::available() {
+  if (!_a || !_a->f) return 0;
+  return (int)(size() - position());
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  if (!_a || !_a->f) return 0;
+  return fread(buf, 1, size, _a->f);
+}
+
+int File::peek() {
+  if (!_a || !_a->f) return -1;
+  int c = fgetc(_a->f);
+  if (c != EOF) ungetc(c, _a->f);
+  return c == EOF ? -1 : c;
+}
+
+void File::flush() {
+  if (_a && _a->f) fflush(_a->f);
+}
+
+bool File::seek(uint32_t pos, SeekMode modo) {
+  if (!_a || !_a->f) return false;
+  int origen = modo == SeekCur ? SEEK_CUR : modo == SeekEnd ? SEEK_END : SEEK_SET;
+  return fseek(_a->f, (long)pos, origen) == 0;
+}
+
+size_t File::position() const {
+  if (!_a || !_a->f) return 0;
+  long p = ftell(_a->f);
+  return p < 0 ? 0 : (size_t)p;
+}
+
+size_t File::size() const {
+  if (!_a || !_a->f) return 0;
+  fflush(_a->f);
+  struct stat st;
+  return fstat(fileno(_a->f), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+  if (_a && _a->f) {
+    fclose(_a->f);
+    _a->f = nullptr;
+  }
+}
+
+File::operator bool() const {
+  return _a && _a->f;
+}
+
+const char* File::path() const {
+  return _a ? _a->path.c_str() : "";
+}
+
+const char* File::name() const {
+  return _a ? _a->nombre.c_str() : "";
+}
+
+}  // namespace fs
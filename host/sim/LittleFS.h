@@ -0,0 +1,21 @@
+#ifndef SIM_LITTLEFS_H
+#define SIM_LITTLEFS_H
+
+#include "FS.h"
+
+// Partición "spiffs" del esquema por defecto (4 MB): 1.375 MB
+#define SIM_FS_CAPACIDAD 0x160000
+
+class LittleFSFS : public fs::FS {
+public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs", uint8_t maxOpenFiles = 10,
+             const char* partitionLabel = "spiffs");
+  void end() { _montado = false; }
+  bool format();
+  size_t totalBytes() { return SIM_FS_CAPACIDAD; }
+  size_t usedBytes() { return simFsUsado(); }
+};
+
+extern LittleFSFS LittleFS;
+
+#endif
@@ -0,0 +1,94 @@
+#include "Preferences.h"
+#include <map>
+#include <string>
+#include <vector>
+
+typedef std::map<std::string, std::vector<uint8_t>> EspacioNvs;
+
+static std::map<std::string, EspacioNvs>& nvs() {
+  static std::map<std::string, EspacioNvs> m;
+  return m;
+}
+static uint32_t escrituras = 0;
+
+static bool claveValida(const char* key) {
+  return key && *key && strlen(key) <= 15;
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char*) {
+  if (!claveValida(name)) return false;
+  strlcpy(_ns, name, sizeof(_ns));
+  _abierto = true;
+  _soloLectura = readOnly;
+  return true;
+}
+
+void Preferences::end() {
+  _abierto = false;
+}
+
+bool Preferences::clear() {
+  if (!_abierto || _soloLectura) return false;
+  SimHeapAjeno ajeno;
+  nvs()[_ns].clear();
+  escrituras++;
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!_abierto || _soloLectura || !claveValida(key)) return false;
+  SimHeapAjeno ajeno;
+  escrituras++;
+  return nvs()[_ns].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  if (!_abierto || !claveValida(key)) return false;
+  SimHeapAjeno ajeno;
+  EspacioNvs& e = nvs()[_ns];
+  return e.find(key) != e.end();
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+  if (!_abierto || _soloLectura || !claveValida(key)) return 0;
+  SimHeapAjeno ajeno;
+  const uint8_t* p = (const uint8_t*)value;
+  nvs()[_ns][key].assign(p, p + len);
+  escrituras++;
+  return len;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  if (!_abierto || !claveValida(key)) return 0;
+  SimHeapAjeno ajeno;
+  EspacioNvs& e = nvs()[_ns];
+  auto it = e.find(key);
+  return it == e.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  size_t n = getBytesLength(key);
+  if (!n || n > maxLen) return 0;
+  memcpy(buf, nvs()[_ns][key].data(), n);
+  return n;
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLen) {
+  return getBytes(key, value, maxLen);
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+  size_t n = getBytesLength(key);
+  if (!n) return defaultValue;
+  // La clave ya existe: operator[] no reserva y el String sí es del firmware
+  return String((const char*)nvs()[_ns][key].data());
+}
+
+void simNvsBorrar() {
+  SimHeapAjeno ajeno;
+  nvs().clear();
+}
+
+uint32_t simNvsEscrituras() {
+  return escrituras;
+}
@@ -0,0 +1,53 @@
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include "Arduino.h"
+
+/* Shim de Preferences (NVS): un mapa en memoria por espacio de nombres
+   que sobrevive a end()/begin() y a reiniciar los módulos del firmware
+   dentro de la misma prueba. Respeta el límite de 15 caracteres por
+   clave y cuenta las escrituras (desgaste de flash). */
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false, const char* partition_label = nullptr);
+  void end();
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+
+  size_t putBool(const char* key, bool value) { return putBytes(key, &value, sizeof(value)); }
+  size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+  size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+  size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+  size_t putFloat(const char* key, float value) { return putBytes(key, &value, sizeof(value)); }
+  size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value) + 1); }
+  size_t putString(const char* key, const String& value) { return putString(key, value.c_str()); }
+  size_t putBytes(const char* key, const void* value, size_t len);
+
+  bool getBool(const char* key, bool defaultValue = false) { return leer(key, defaultValue); }
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return leer(key, defaultValue); }
+  int32_t getInt(const char* key, int32_t defaultValue = 0) { return leer(key, defaultValue); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return leer(key, defaultValue); }
+  float getFloat(const char* key, float defaultValue = NAN) { return leer(key, defaultValue); }
+  size_t getString(const char* key, char* value, size_t maxLen);
+  String getString(const char* key, const String& defaultValue = String());
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buf, size_t maxLen);
+
+private:
+  template <typename T>
+  T leer(const char* key, T defecto) {
+    T v;
+    return getBytesLength(key) == sizeof(T) && getBytes(key, &v, sizeof(T)) == sizeof(T) ? v : defecto;
+  }
+  char _ns[16] = "";
+  bool _abierto = false;
+  bool _soloLectura = false;
+};
+
+// --- Lado simulador ---
+void simNvsBorrar();          // Flash de fábrica
+uint32_t simNvsEscrituras();  // put*/remove/clear desde el arranque
+
+#endif
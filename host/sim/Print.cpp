@@ -0,0 +1,59 @@
+#include "Arduino.h"
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    if (write(*buffer++)) n++;
+    else break;
+  }
+  return n;
+}
+
+// Como el core de arduino-esp32: 64 B en la pila y malloc para lo que no cabe
+size_t Print::printf(const char* format, ...) {
+  char buf[64];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if (len < 0) return 0;
+  if ((size_t)len >= sizeof(buf)) {
+    char* grande = (char*)malloc(len + 1);
+    if (!grande) return 0;
+    va_start(args, format);
+    vsnprintf(grande, len + 1, format, args);
+    va_end(args);
+    size_t n = write((const uint8_t*)grande, len);
+    free(grande);
+    return n;
+  }
+  return write((const uint8_t*)buf, len);
+}
+
+size_t Print::printNumber(unsigned long long n, int base) {
+  char buf[68];
+  char* p = &buf[sizeof(buf) - 1];
+  *p = '\0';
+  if (base < 2) base = 10;
+  do {
+    int d = (int)(n % base);
+    *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+    n /= base;
+  } while (n);
+  return write(p);
+}
+
+size_t Print::printSigned(long long n, int base) {
+  if (base == 10 && n < 0) {
+    size_t t = print('-');
+    return t + printNumber((unsigned long long)(-(n + 1)) + 1, 10);
+  }
+  if (base == 10) return printNumber((unsigned long long)n, 10);
+  return printNumber((unsigned long long)(unsigned long)n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
@@ -0,0 +1,49 @@
+#ifndef SIM_PRINT_H
+#define SIM_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <string.h>
+#include "WString.h"
+#include "Printable.h"
+
+class Print {
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* str) { return str ? write((const uint8_t*)str, strlen(str)) : 0; }
+  size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+  virtual void flush() {}
+
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  size_t print(const __FlashStringHelper* s) { return write((const char*)s); }
+  size_t print(const String& s) { return write(s.c_str(), s.length()); }
+  size_t print(const char* s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char n, int base = 10) { return printNumber((unsigned long long)n, base); }
+  size_t print(int n, int base = 10) { return printSigned((long long)n, base); }
+  size_t print(unsigned int n, int base = 10) { return printNumber((unsigned long long)n, base); }
+  size_t print(long n, int base = 10) { return printSigned((long long)n, base); }
+  size_t print(unsigned long n, int base = 10) { return printNumber((unsigned long long)n, base); }
+  size_t print(long long n, int base = 10) { return printSigned(n, base); }
+  size_t print(unsigned long long n, int base = 10) { return printNumber(n, base); }
+  size_t print(double n, int digits = 2);
+  size_t print(const Printable& p) { return p.printTo(*this); }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  template <typename T>
+  size_t println(const T& v, int extra) { size_t n = print(v, extra); return n + println(); }
+  size_t println(const char* s) { size_t n = print(s); return n + println(); }
+
+private:
+  size_t printNumber(unsigned long long n, int base);
+  size_t printSigned(long long n, int base);
+};
+
+#endif
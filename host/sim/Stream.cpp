@@ -0,0 +1,29 @@
+#include "Arduino.h"
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+  size_t n = 0;
+  unsigned long t0 = millis();
+  while (n < length && millis() - t0 < _timeout) {
+    if (available() > 0) {
+      buffer[n++] = (uint8_t)read();
+    } else {
+      yield();
+    }
+  }
+  return n;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String out;
+  unsigned long t0 = millis();
+  while (millis() - t0 < _timeout) {
+    if (available() > 0) {
+      int c = read();
+      if (c == terminator) break;
+      out += (char)c;
+    } else {
+      yield();
+    }
+  }
+  return out;
+}
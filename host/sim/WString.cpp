@@ -0,0 +1,368 @@
+#include "Arduino.h"
+
+// ---------------------------------------------------------
+// CONVERSIONES
+// ---------------------------------------------------------
+static void enteroATexto(unsigned long long v, bool negativo, unsigned char base, char* out) {
+  char tmp[68];
+  int n = 0;
+  if (base < 2) base = 10;
+  do {
+    int d = (int)(v % base);
+    tmp[n++] = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+    v /= base;
+  } while (v);
+  int i = 0;
+  if (negativo) out[i++] = '-';
+  while (n) out[i++] = tmp[--n];
+  out[i] = '\0';
+}
+
+static void firmadoATexto(long long v, unsigned char base, char* out) {
+  // Como en Arduino: solo base 10 muestra signo
+  if (base == 10 && v < 0) {
+    enteroATexto((unsigned long long)(-(v + 1)) + 1, true, base, out);
+  } else if (base == 10) {
+    enteroATexto((unsigned long long)v, false, base, out);
+  } else {
+    enteroATexto((unsigned long long)(unsigned long)v, false, base, out);
+  }
+}
+
+// ---------------------------------------------------------
+// CONSTRUCTORES
+// ---------------------------------------------------------
+void String::init() {
+  _buf = nullptr;
+  _len = 0;
+  _cap = 0;
+}
+
+void String::invalidate() {
+  free(_buf);
+  init();
+}
+
+bool String::reserve(unsigned int size) {
+  if (_buf && _cap >= size) return true;
+  char* nuevo = (char*)realloc(_buf, size + 1);
+  if (!nuevo) return false;
+  if (!_buf) nuevo[0] = '\0';
+  _buf = nuevo;
+  _cap = size;
+  return true;
+}
+
+bool String::copy(const char* cstr, unsigned int length) {
+  if (!reserve(length)) {
+    invalidate();
+    return false;
+  }
+  _len = length;
+  memmove(_buf, cstr, length);
+  _buf[length] = '\0';
+  return true;
+}
+
+String::String(const char* cstr) {
+  init();
+  if (cstr) copy(cstr, strlen(cstr));
+}
+
+String::String(const String& str) {
+  init();
+  *this = str;
+}
+
+String::String(String&& str) noexcept {
+  _buf = str._buf;
+  _len = str._len;
+  _cap = str._cap;
+  str.init();
+}
+
+String::String(const __FlashStringHelper* str) {
+  init();
+  if (str) copy((const char*)str, strlen((const char*)str));
+}
+
+String::String(char c) {
+  init();
+  char buf[2] = { c, '\0' };
+  copy(buf, 1);
+}
+
+#define STRING_DESDE_ENTERO(tipo, firmado)                    \
+  String::String(tipo value, unsigned char base) {            \
+    init();                                                   \
+    char buf[68];                                             \
+    if (firmado) firmadoATexto((long long)value, base, buf);  \
+    else enteroATexto((unsigned long long)value, false, base, buf); \
+    copy(buf, strlen(buf));                                   \
+  }
+
+STRING_DESDE_ENTERO(unsigned char, false)
+STRING_DESDE_ENTERO(int, true)
+STRING_DESDE_ENTERO(unsigned int, false)
+STRING_DESDE_ENTERO(long, true)
+STRING_DESDE_ENTERO(unsigned long, false)
+STRING_DESDE_ENTERO(long long, true)
+STRING_DESDE_ENTERO(unsigned long long, false)
+
+String::String(float value, unsigned int decimalPlaces) {
+  init();
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, (double)value);
+  copy(buf, strlen(buf));
+}
+
+String::String(double value, unsigned int decimalPlaces) {
+  init();
+  char buf[48];
+  snprintf(buf, sizeof(buf), "%.*f", decimalPlaces, value);
+  copy(buf, strlen(buf));
+}
+
+String::~String() {
+  free(_buf);
+}
+
+String& String::operator=(const String& rhs) {
+  if (this == &rhs) return *this;
+  if (rhs._buf) copy(rhs._buf, rhs._len);
+  else invalidate();
+  return *this;
+}
+
+String& String::operator=(String&& rhs) noexcept {
+  if (this != &rhs) {
+    free(_buf);
+    _buf = rhs._buf;
+    _len = rhs._len;
+    _cap = rhs._cap;
+    rhs.init();
+  }
+  return *this;
+}
+
+String& String::operator=(const char* cstr) {
+  if (cstr) copy(cstr, strlen(cstr));
+  else invalidate();
+  return *this;
+}
+
+// ---------------------------------------------------------
+// CONCATENACIÓN
+// ---------------------------------------------------------
+bool String::concat(const char* cstr, unsigned int length) {
+  if (!cstr) return false;
+  if (length == 0) return true;
+  unsigned int nuevoLen = _len + length;
+  if (!reserve(nuevoLen)) return false;
+  memmove(_buf + _len, cstr, length);
+  _len = nuevoLen;
+  _buf[_len] = '\0';
+  return true;
+}
+
+bool String::concat(const String& str) {
+  // Copia previa por si se concatena consigo misma
+  if (&str == this) {
+    String tmp(str);
+    return concat(tmp.c_str(), tmp.length());
+  }
+  return concat(str.c_str(), str._len);
+}
+
+bool String::concat(const char* cstr) {
+  if (!cstr) return false;
+  return concat(cstr, strlen(cstr));
+}
+
+bool String::concat(char c) {
+  return concat(&c, 1);
+}
+
+bool String::concat(unsigned char num) { return concat(String(num)); }
+bool String::concat(int num) { return concat(String(num)); }
+bool String::concat(unsigned int num) { return concat(String(num)); }
+bool String::concat(long num) { return concat(String(num)); }
+bool String::concat(unsigned long num) { return concat(String(num)); }
+bool String::concat(long long num) { return concat(String(num)); }
+bool String::concat(unsigned long long num) { return concat(String(num)); }
+bool String::concat(float num) { return concat(String(num)); }
+bool String::concat(double num) { return concat(String(num)); }
+
+String operator+(const String& lhs, const String& rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, const char* rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const char* lhs, const String& rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, char rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, int rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, unsigned int rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, long rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, unsigned long rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, float rhs) { String r(lhs); r.concat(rhs); return r; }
+String operator+(const String& lhs, double rhs) { String r(lhs); r.concat(rhs); return r; }
+
+// ---------------------------------------------------------
+// COMPARACIÓN Y BÚSQUEDA
+// ---------------------------------------------------------
+int String::compareTo(const String& s) const {
+  return strcmp(c_str(), s.c_str());
+}
+
+bool String::equals(const String& s) const {
+  return _len == s._len && compareTo(s) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+  if (!cstr) return _len == 0;
+  return strcmp(c_str(), cstr) == 0;
+}
+
+bool String::equalsIgnoreCase(const String& s) const {
+  if (_len != s._len) return false;
+  for (unsigned int i = 0; i < _len; i++) {
+    if (tolower((unsigned char)_buf[i]) != tolower((unsigned char)s._buf[i])) return false;
+  }
+  return true;
+}
+
+bool String::startsWith(const String& prefix) const {
+  if (_len < prefix._len) return false;
+  return startsWith(prefix, 0);
+}
+
+bool String::startsWith(const String& prefix, unsigned int offset) const {
+  if (offset > _len || prefix._len > _len - offset) return false;
+  return strncmp(c_str() + offset, prefix.c_str(), prefix._len) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+  if (_len < suffix._len) return false;
+  return strcmp(c_str() + _len - suffix._len, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  if (index >= _len) return 0;
+  return _buf[index];
+}
+
+void String::setCharAt(unsigned int index, char c) {
+  if (index < _len) _buf[index] = c;
+}
+
+char& String::operator[](unsigned int index) {
+  static char basura;
+  if (index >= _len) {
+    basura = 0;
+    return basura;
+  }
+  return _buf[index];
+}
+
+void String::toCharArray(char* buf, unsigned int bufsize, unsigned int index) const {
+  if (!bufsize || !buf) return;
+  if (index >= _len) {
+    buf[0] = '\0';
+    return;
+  }
+  unsigned int n = bufsize - 1;
+  if (n > _len - index) n = _len - index;
+  memcpy(buf, _buf + index, n);
+  buf[n] = '\0';
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+  if (fromIndex >= _len) return -1;
+  const char* p = strchr(_buf + fromIndex, ch);
+  return p ? (int)(p - _buf) : -1;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+  if (fromIndex >= _len) return -1;
+  const char* p = strstr(_buf + fromIndex, str.c_str());
+  return p ? (int)(p - _buf) : -1;
+}
+
+int String::lastIndexOf(char ch) const {
+  if (!_len) return -1;
+  const char* p = strrchr(_buf, ch);
+  return p ? (int)(p - _buf) : -1;
+}
+
+String String::substring(unsigned int left, unsigned int right) const {
+  if (left > right) std::swap(left, right);
+  String out;
+  if (left >= _len) return out;
+  if (right > _len) right = _len;
+  out.copy(_buf + left, right - left);
+  return out;
+}
+
+// ---------------------------------------------------------
+// MODIFICACIÓN
+// ---------------------------------------------------------
+void String::replace(char find, char repl) {
+  for (unsigned int i = 0; i < _len; i++) {
+    if (_buf[i] == find) _buf[i] = repl;
+  }
+}
+
+void String::replace(const String& find, const String& repl) {
+  if (!_len || !find._len) return;
+  String out;
+  unsigned int i = 0;
+  while (i < _len) {
+    if (strncmp(_buf + i, find.c_str(), find._len) == 0) {
+      out.concat(repl);
+      i += find._len;
+    } else {
+      out.concat(_buf[i]);
+      i++;
+    }
+  }
+  *this = std::move(out);
+}
+
+void String::remove(unsigned int index) {
+  remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= _len) return;
+  if (count > _len - index) count = _len - index;
+  memmove(_buf + index, _buf + index + count, _len - index - count + 1);
+  _len -= count;
+}
+
+void String::toLowerCase() {
+  for (unsigned int i = 0; i < _len; i++) _buf[i] = (char)tolower((unsigned char)_buf[i]);
+}
+
+void String::toUpperCase() {
+  for (unsigned int i = 0; i < _len; i++) _buf[i] = (char)toupper((unsigned char)_buf[i]);
+}
+
+void String::trim() {
+  if (!_len) return;
+  unsigned int ini = 0;
+  while (ini < _len && isspace((unsigned char)_buf[ini])) ini++;
+  unsigned int fin = _len;
+  while (fin > ini && isspace((unsigned char)_buf[fin - 1])) fin--;
+  _len = fin - ini;
+  if (ini) memmove(_buf, _buf + ini, _len);
+  _buf[_len] = '\0';
+}
+
+long String::toInt() const {
+  return _len ? atol(_buf) : 0;
+}
+
+float String::toFloat() const {
+  return (float)toDouble();
+}
+
+double String::toDouble() const {
+  return _len ? atof(_buf) : 0.0;
+}
@@ -0,0 +1,41 @@
+#include "WebSerial.h"
+
+WebSerialClass WebSerial;
+
+void WebSerialClass::begin(AsyncWebServer* server, const char*) {
+  _server = server;
+  inicios++;
+}
+
+size_t WebSerialClass::write(uint8_t c) {
+  SimHeapAjeno ajeno;
+  salida.push_back((char)c);
+  return 1;
+}
+
+size_t WebSerialClass::write(const uint8_t* b, size_t n) {
+  SimHeapAjeno ajeno;
+  salida.append((const char*)b, n);
+  return n;
+}
+
+void WebSerialClass::recibir(const char* texto) {
+  if (!_server || !_server->activo()) return;
+  if (_fnBytes) {
+    std::string copia;
+    {
+      SimHeapAjeno ajeno;
+      copia = texto;
+    }
+    _fnBytes((uint8_t*)&copia[0], copia.size());
+  } else if (_fnTexto) {
+    _fnTexto(String(texto));
+  }
+}
+
+std::string simWebSerialEnviar(const char* comando) {
+  WebSerial.salida.clear();
+  WebSerial.recibir(comando);
+  SimHeapAjeno ajeno;
+  return WebSerial.salida;
+}
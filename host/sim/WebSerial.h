@@ -0,0 +1,37 @@
+#ifndef SIM_WEBSERIAL_H
+#define SIM_WEBSERIAL_H
+
+#include "ESPAsyncWebServer.h"
+#include <functional>
+#include <string>
+
+/* Shim de WebSerial: lo que imprime el firmware se acumula en un buffer
+   y simWebSerialEnviar() hace de consola web. */
+class WebSerialClass : public Print {
+public:
+  void begin(AsyncWebServer* server, const char* url = "/webserial");
+  void onMessage(void (*fn)(uint8_t* data, size_t len)) { _fnBytes = fn; _fnTexto = nullptr; }
+  void onMessage(std::function<void(const String&)> fn) { _fnTexto = fn; _fnBytes = nullptr; }
+  void loop() {}
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* b, size_t n) override;
+  using Print::write;
+
+  // --- Lado simulador ---
+  bool iniciado() const { return _server != nullptr; }
+  void recibir(const char* texto);
+  std::string salida;
+  uint32_t inicios = 0;
+
+private:
+  AsyncWebServer* _server = nullptr;
+  void (*_fnBytes)(uint8_t*, size_t) = nullptr;
+  std::function<void(const String&)> _fnTexto;
+};
+
+extern WebSerialClass WebSerial;
+
+// Envía un comando como si se tecleara en la consola y devuelve la respuesta
+std::string simWebSerialEnviar(const char* comando);
+
+#endif
@@ -0,0 +1,352 @@
+#include "WiFi.h"
+#include <vector>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+
+WiFiClass WiFi;
+
+// ---------------------------------------------------------
+// SERVICIOS EN PROCESO
+// ---------------------------------------------------------
+struct Escucha {
+  uint16_t puerto;
+  SimFabricaConexion fabrica;
+  void* ctx;
+};
+
+static std::vector<Escucha> escuchas;
+static std::vector<SimConexion*> activas;
+static bool redCortada = false;
+static uint32_t conexionesOk = 0;
+static uint32_t conexionesFallidas = 0;
+
+void SimConexion::enviar(const uint8_t* datos, size_t n) {
+  if (!_abierta || !_rx) return;
+  _rx->insert(_rx->end(), datos, datos + n);
+}
+
+void SimConexion::cerrar() {
+  _abierta = false;
+}
+
+void simRedEscuchar(uint16_t puerto, SimFabricaConexion fabrica, void* ctx) {
+  for (auto& e : escuchas) {
+    if (e.puerto == puerto) {
+      e.fabrica = fabrica;
+      e.ctx = ctx;
+      return;
+    }
+  }
+  escuchas.push_back({ puerto, fabrica, ctx });
+}
+
+void simRedCortar(bool cortada) {
+  redCortada = cortada;
+  if (cortada) {
+    for (SimConexion* c : activas) c->cerrar();
+  }
+}
+
+bool simRedCortada() {
+  return redCortada;
+}
+
+uint32_t simRedConexiones() {
+  return conexionesOk;
+}
+
+uint32_t simRedConexionesFallidas() {
+  return conexionesFallidas;
+}
+
+static bool redReal() {
+  const char* v = getenv("ORION_SIM_RED_REAL");
+  return v && v[0] == '1';
+}
+
+// ---------------------------------------------------------
+// WIFI
+// ---------------------------------------------------------
+static std::vector<SimRedWiFi> redesVisibles = {
+  { "Starlink 2.4", "L3tr4s_123", -58 },
+  { "Orion-Lab", "orion2024", -67 },
+  { "INFINITUM_5G", "xxxxxxxx", -81 },
+};
+static bool aceptarCualquiera = true;
+
+void simWiFiRedes(const SimRedWiFi* redes, size_t n) {
+  redesVisibles.assign(redes, redes + n);
+}
+
+void simWiFiAceptarCualquiera(bool aceptar) {
+  aceptarCualquiera = aceptar;
+}
+
+void simWiFiCaer() {
+  WiFi.disconnect();
+  simRedCortar(true);
+  simRedCortar(false);
+}
+
+static const SimRedWiFi* buscarRed(const char* ssid) {
+  for (auto& r : redesVisibles) {
+    if (strcmp(r.ssid, ssid) == 0) return &r;
+  }
+  return nullptr;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* pass) {
+  strlcpy(_ssid, ssid ? ssid : "", sizeof(_ssid));
+  if (_modo == WIFI_OFF) _modo = WIFI_STA;
+  _conectado = false;
+  _conectando = false;
+
+  const SimRedWiFi* red = buscarRed(_ssid);
+  bool ok = aceptarCualquiera || (red && strcmp(red->pass, pass ? pass : "") == 0);
+  if (ok) {
+    _conectando = true;
+    _listoUs = simAhoraUs() + (uint64_t)SIM_WIFI_CONEXION_MS * 1000;
+  }
+  return WL_DISCONNECTED;
+}
+
+void WiFiClass::actualizar() {
+  if (_conectando && simAhoraUs() >= _listoUs) {
+    _conectando = false;
+    _conectado = true;
+  }
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool) {
+  _conectado = false;
+  _conectando = false;
+  if (wifioff) _modo = WIFI_OFF;
+  return true;
+}
+
+bool WiFiClass::isConnected() {
+  actualizar();
+  return _conectado;
+}
+
+wl_status_t WiFiClass::status() {
+  return isConnected() ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+bool WiFiClass::setHostname(const char* nombre) {
+  strlcpy(_hostname, nombre, sizeof(_hostname));
+  return true;
+}
+
+IPAddress WiFiClass::localIP() {
+  return isConnected() ? IPAddress(192, 168, 1, 77) : IPAddress(0, 0, 0, 0);
+}
+
+int8_t WiFiClass::RSSI() {
+  if (!isConnected()) return 0;
+  const SimRedWiFi* red = buscarRed(_ssid);
+  return (int8_t)(red ? red->rssi : -70);
+}
+
+String WiFiClass::SSID() {
+  return String(_ssid);
+}
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+  static const uint8_t simMac[6] = { 0x24, 0x6F, 0x28, 0xA1, 0xB2, 0xC3 };
+  memcpy(mac, simMac, 6);
+  return mac;
+}
+
+String WiFiClass::macAddress() {
+  uint8_t m[6];
+  macAddress(m);
+  char buf[18];
+  snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X", m[0], m[1], m[2], m[3], m[4], m[5]);
+  return String(buf);
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool) {
+  _escaneo = WIFI_SCAN_RUNNING;
+  _escaneoListoUs = simAhoraUs() + (uint64_t)SIM_WIFI_ESCANEO_MS * 1000;
+  if (!async) {
+    simSaltarA(_escaneoListoUs);
+    return scanComplete();
+  }
+  return WIFI_SCAN_RUNNING;
+}
+
+int16_t WiFiClass::scanComplete() {
+  if (_escaneo == WIFI_SCAN_RUNNING && simAhoraUs() >= _escaneoListoUs) {
+    _escaneo = (int)redesVisibles.size();
+  }
+  return _escaneo == -3 ? WIFI_SCAN_FAILED : _escaneo;
+}
+
+void WiFiClass::scanDelete() {
+  _escaneo = -3;
+}
+
+String WiFiClass::SSID(uint8_t i) {
+  return i < redesVisibles.size() ? String(redesVisibles[i].ssid) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t i) {
+  return i < redesVisibles.size() ? redesVisibles[i].rssi : 0;
+}
+
+// ---------------------------------------------------------
+// WIFICLIENT
+// ---------------------------------------------------------
+WiFiClient::WiFiClient() {}
+
+WiFiClient::~WiFiClient() {
+  stop();
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip.toString().c_str(), port);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  stop();
+  if (!WiFi.isConnected() || redCortada) {
+    conexionesFallidas++;
+    return 0;
+  }
+
+  if (!redReal()) {
+    for (auto& e : escuchas) {
+      if (e.puerto != port) continue;
+      SimHeapAjeno ajeno;  // La sesión es del servidor simulado
+      _conexion = e.fabrica(e.ctx);
+      if (!_conexion) break;
+      _conexion->_rx = &_rx;
+      _conexion->_abierta = true;
+      activas.push_back(_conexion);
+      conexionesOk++;
+      return 1;
+    }
+  }
+
+  // Socket real (bloqueante hasta _timeoutS, como lwip). ORION_SIM_HOST
+  // redirige los servidores fijos del firmware a un mosquitto local.
+  const char* destino = getenv("ORION_SIM_HOST");
+  if (destino && destino[0]) host = destino;
+  struct addrinfo pista = {};
+  struct addrinfo* res = nullptr;
+  pista.ai_family = AF_INET;
+  pista.ai_socktype = SOCK_STREAM;
+  char puerto[8];
+  snprintf(puerto, sizeof(puerto), "%u", port);
+  if (getaddrinfo(host, puerto, &pista, &res) != 0 || !res) {
+    conexionesFallidas++;
+    return 0;
+  }
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  int r = ::connect(fd, res->ai_addr, res->ai_addrlen);
+  freeaddrinfo(res);
+  if (r != 0 && errno == EINPROGRESS) {
+    struct pollfd p = { fd, POLLOUT, 0 };
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (poll(&p, 1, (int)_timeoutS * 1000) == 1 && getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) {
+      r = 0;
+    }
+  }
+  if (r != 0) {
+    ::close(fd);
+    conexionesFallidas++;
+    return 0;
+  }
+  int uno = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &uno, sizeof(uno));
+  _fd = fd;
+  conexionesOk++;
+  return 1;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  if (_conexion) {
+    if (!_conexion->abierta()) return 0;
+    _conexion->recibir(buf, size);
+    return size;
+  }
+  if (_fd >= 0) {
+    ssize_t n = ::send(_fd, buf, size, MSG_NOSIGNAL);
+    return n > 0 ? (size_t)n : 0;
+  }
+  return 0;
+}
+
+void WiFiClient::leerSocket() {
+  if (_fd < 0) return;
+  uint8_t tmp[512];
+  for (;;) {
+    ssize_t n = ::recv(_fd, tmp, sizeof(tmp), 0);
+    if (n > 0) {
+      _rx.insert(_rx.end(), tmp, tmp + n);
+      continue;
+    }
+    if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+      ::close(_fd);
+      _fd = -2;  // Cerrado por el otro extremo, quedan datos en _rx
+    }
+    return;
+  }
+}
+
+int WiFiClient::available() {
+  leerSocket();
+  return (int)_rx.size();
+}
+
+int WiFiClient::read() {
+  if (!available()) return -1;
+  int c = _rx.front();
+  _rx.pop_front();
+  return c;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+  size_t n = std::min(size, (size_t)available());
+  for (size_t i = 0; i < n; i++) {
+    buf[i] = _rx.front();
+    _rx.pop_front();
+  }
+  return (int)n;
+}
+
+int WiFiClient::peek() {
+  return available() ? _rx.front() : -1;
+}
+
+void WiFiClient::stop() {
+  if (_conexion) {
+    activas.erase(std::remove(activas.begin(), activas.end(), _conexion), activas.end());
+    _conexion->_rx = nullptr;
+    _conexion->_abierta = false;
+    _conexion->alCerrar();
+    _conexion = nullptr;
+  }
+  if (_fd >= 0) ::close(_fd);
+  _fd = -1;
+  _rx.clear();
+}
+
+uint8_t WiFiClient::connected() {
+  if (_conexion) {
+    if (!WiFi.isConnected()) _conexion->cerrar();
+    return _conexion->abierta() || !_rx.empty();
+  }
+  if (_fd == -1) return 0;
+  leerSocket();
+  return _fd >= 0 || !_rx.empty();
+}
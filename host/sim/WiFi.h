@@ -0,0 +1,103 @@
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+#include "Arduino.h"
+#include "Client.h"
+#include "sim_red.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+typedef enum { WIFI_PS_NONE = 0, WIFI_PS_MIN_MODEM = 1, WIFI_PS_MAX_MODEM = 2 } wifi_ps_type_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED (-2)
+
+#define SIM_WIFI_CONEXION_MS 1200
+#define SIM_WIFI_ESCANEO_MS 2200
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t m) { _modo = m; return true; }
+  wifi_mode_t getMode() const { return _modo; }
+  wl_status_t begin(const char* ssid, const char* pass = nullptr);
+  bool disconnect(bool wifioff = false, bool eraseap = false);
+  bool isConnected();
+  wl_status_t status();
+  bool setSleep(bool activar) { return setSleep(activar ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE); }
+  bool setSleep(wifi_ps_type_t tipo) { _sleep = tipo; return true; }
+  wifi_ps_type_t getSleep() const { return _sleep; }
+  bool setHostname(const char* nombre);
+  const char* getHostname() const { return _hostname; }
+  bool setAutoReconnect(bool) { return true; }
+
+  IPAddress localIP();
+  IPAddress gatewayIP() { return IPAddress(192, 168, 1, 1); }
+  IPAddress subnetMask() { return IPAddress(255, 255, 255, 0); }
+  int8_t RSSI();
+  String SSID();
+  String macAddress();
+  uint8_t* macAddress(uint8_t* mac);
+
+  int16_t scanNetworks(bool async = false, bool showHidden = false);
+  int16_t scanComplete();
+  void scanDelete();
+  String SSID(uint8_t i);
+  int32_t RSSI(uint8_t i);
+
+private:
+  wifi_mode_t _modo = WIFI_OFF;
+  wifi_ps_type_t _sleep = WIFI_PS_MIN_MODEM;
+  char _hostname[33] = "esp32";
+  char _ssid[33] = "";
+  bool _conectando = false;
+  bool _conectado = false;
+  uint64_t _listoUs = 0;
+  int _escaneo = -3;  // -3 = sin resultados
+  uint64_t _escaneoListoUs = 0;
+
+  void actualizar();
+};
+
+extern WiFiClass WiFi;
+
+class WiFiClient : public Client {
+public:
+  WiFiClient();
+  ~WiFiClient();
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+  void setNoDelay(bool) {}
+  int setTimeout(uint32_t segundos) { _timeoutS = segundos; return 0; }
+  using Print::write;
+
+private:
+  SimConexion* _conexion = nullptr;
+  std::deque<uint8_t> _rx;
+  int _fd = -1;
+  uint32_t _timeoutS = 3;
+
+  void leerSocket();
+};
+
+#endif
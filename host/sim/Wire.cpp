@@ -0,0 +1,81 @@
+#include "Wire.h"
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+static SimDispositivoI2C* dispositivos[128];
+static uint64_t bytesBus = 0;
+static uint64_t ocupadoUs = 0;
+static uint32_t erroresClock = 0;
+
+void simI2cConectar(uint8_t direccion, SimDispositivoI2C* dispositivo) {
+  if (direccion < 128) dispositivos[direccion] = dispositivo;
+}
+
+void simI2cDesconectar(uint8_t direccion) {
+  if (direccion < 128) dispositivos[direccion] = nullptr;
+}
+
+uint64_t simI2cBytes() { return bytesBus; }
+uint64_t simI2cOcupadoUs() { return ocupadoUs; }
+uint32_t simI2cErroresClock() { return erroresClock; }
+
+bool TwoWire::begin(int, int, uint32_t frequency) {
+  if (frequency) _clock = frequency;
+  return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+  _clock = frequency ? frequency : 100000;
+  return true;
+}
+
+void TwoWire::cobrarBus(size_t bytes) {
+  // START + dirección + datos (9 bits c/u con ACK) + STOP
+  uint64_t bits = 2 + 9 * (uint64_t)(bytes + 1);
+  uint64_t us = (bits * 1000000ULL + _clock - 1) / _clock;
+  bytesBus += bytes + 1;
+  ocupadoUs += us;
+  simAvanzarUs(us);
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _addr = address;
+  _txLen = 0;
+  _txActiva = true;
+}
+
+size_t TwoWire::write(uint8_t c) {
+  if (!_txActiva || _txLen >= sizeof(_tx)) return 0;
+  _tx[_txLen++] = c;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t n) {
+  size_t escritos = 0;
+  while (escritos < n && write(data[escritos])) escritos++;
+  return escritos;
+}
+
+uint8_t TwoWire::endTransmission(bool) {
+  _txActiva = false;
+  SimDispositivoI2C* d = _addr < 128 ? dispositivos[_addr] : nullptr;
+  cobrarBus(d ? _txLen : 0);
+  if (!d) return 2;  // NACK en la dirección
+  if (_clock > d->clockMax()) erroresClock++;
+  return d->escribir(_tx, _txLen) ? 0 : 3;
+}
+
+size_t TwoWire::requestFrom(uint8_t address, size_t len, bool) {
+  _rxLen = _rxPos = 0;
+  if (len > sizeof(_rx)) len = sizeof(_rx);
+  SimDispositivoI2C* d = address < 128 ? dispositivos[address] : nullptr;
+  if (!d) {
+    cobrarBus(0);
+    return 0;
+  }
+  if (_clock > d->clockMax()) erroresClock++;
+  _rxLen = d->leer(_rx, len);
+  cobrarBus(_rxLen);
+  return _rxLen;
+}
@@ -0,0 +1,70 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include "Arduino.h"
+
+/* Bus I2C simulado. Cada transacción cuesta en tiempo virtual lo que
+   tardaría en el bus real a la frecuencia de setClock() (9 bits por byte
+   más START/STOP), así que un volcado del SSD1306 "ocupa" el bus. */
+
+class SimDispositivoI2C {
+public:
+  virtual ~SimDispositivoI2C() {}
+  // Escritura completa de una transacción. false = NACK
+  virtual bool escribir(const uint8_t* datos, size_t n) = 0;
+  // Lectura de n bytes tras una escritura (registro) previa
+  virtual size_t leer(uint8_t* datos, size_t n) = 0;
+  // Frecuencia máxima que acepta el dispositivo (Hz)
+  virtual uint32_t clockMax() const { return 400000; }
+};
+
+void simI2cConectar(uint8_t direccion, SimDispositivoI2C* dispositivo);
+void simI2cDesconectar(uint8_t direccion);
+uint64_t simI2cBytes();          // Bytes transferidos (incluye direcciones)
+uint64_t simI2cOcupadoUs();      // Tiempo total de bus ocupado
+uint32_t simI2cErroresClock();   // Transacciones por encima de clockMax()
+
+#define I2C_BUFFER_LENGTH 128
+
+class TwoWire : public Stream {
+public:
+  explicit TwoWire(uint8_t bus) : _bus(bus) {}
+
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  bool end() { return true; }
+  bool setClock(uint32_t frequency);
+  uint32_t getClock() const { return _clock; }
+  void setTimeOut(uint16_t ms) { _timeoutMs = ms; }
+
+  void beginTransmission(uint8_t address);
+  uint8_t endTransmission(bool sendStop = true);
+  size_t requestFrom(uint8_t address, size_t len, bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t len) { return (uint8_t)requestFrom(address, (size_t)len, true); }
+  uint8_t requestFrom(int address, int len) { return (uint8_t)requestFrom((uint8_t)address, (size_t)len, true); }
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* data, size_t n) override;
+  using Print::write;
+  int available() override { return (int)(_rxLen - _rxPos); }
+  int read() override { return _rxPos < _rxLen ? _rx[_rxPos++] : -1; }
+  int peek() override { return _rxPos < _rxLen ? _rx[_rxPos] : -1; }
+
+private:
+  uint8_t _bus;
+  uint32_t _clock = 100000;
+  uint16_t _timeoutMs = 50;
+  uint8_t _addr = 0;
+  uint8_t _tx[I2C_BUFFER_LENGTH];
+  size_t _txLen = 0;
+  bool _txActiva = false;
+  uint8_t _rx[I2C_BUFFER_LENGTH];
+  size_t _rxLen = 0;
+  size_t _rxPos = 0;
+
+  void cobrarBus(size_t bytes);
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef SIM_ESP32_HAL_ADC_H
+#define SIM_ESP32_HAL_ADC_H
+
+#include <stdint.h>
+
+typedef enum {
+  ADC_0db,
+  ADC_2_5db,
+  ADC_6db,
+  ADC_11db
+} adc_attenuation_t;
+
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t attenuation);
+void analogSetAttenuation(adc_attenuation_t attenuation);
+
+#endif
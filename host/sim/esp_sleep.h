@@ -0,0 +1,9 @@
+#ifndef SIM_ESP_SLEEP_H
+#define SIM_ESP_SLEEP_H
+
+#include "esp_task_wdt.h"  // esp_err_t
+
+// Subconjunto de esp_sleep.h: el light sleep lo decide esp_pm (esp_pm.h)
+esp_err_t esp_sleep_enable_gpio_wakeup();
+
+#endif
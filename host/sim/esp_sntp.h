@@ -0,0 +1,14 @@
+#ifndef SIM_ESP_SNTP_H
+#define SIM_ESP_SNTP_H
+
+#include <stdint.h>
+#include <sys/time.h>
+
+// Subconjunto de esp_sntp.h de ESP-IDF; el servidor lo modela sim_ntp.cpp
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
+void sntp_set_sync_interval(uint32_t interval_ms);
+uint32_t sntp_get_sync_interval();
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef SIM_ESP_TASK_WDT_H
+#define SIM_ESP_TASK_WDT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+typedef struct {
+  uint32_t timeout_ms;
+  uint32_t idle_core_mask;
+  bool trigger_panic;
+} esp_task_wdt_config_t;
+
+// El planificador simulado comprueba los latidos (ver tasks_sim.cpp)
+esp_err_t esp_task_wdt_init(const esp_task_wdt_config_t* cfg);
+esp_err_t esp_task_wdt_reconfigure(const esp_task_wdt_config_t* cfg);
+esp_err_t esp_task_wdt_add(void* tarea);
+esp_err_t esp_task_wdt_reset();
+
+#endif
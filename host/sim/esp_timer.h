@@ -0,0 +1,9 @@
+#ifndef SIM_ESP_TIMER_H
+#define SIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+// Reloj monotónico en µs (virtual)
+int64_t esp_timer_get_time();
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef SIM_FREERTOS_QUEUE_H
+#define SIM_FREERTOS_QUEUE_H
+
+#include "FreeRTOS.h"
+
+struct SimCola;
+typedef SimCola* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t longitud, UBaseType_t tamItem);
+void vQueueDelete(QueueHandle_t cola);
+BaseType_t xQueueSend(QueueHandle_t cola, const void* item, TickType_t espera);
+BaseType_t xQueueSendToBack(QueueHandle_t cola, const void* item, TickType_t espera);
+BaseType_t xQueueSendFromISR(QueueHandle_t cola, const void* item, BaseType_t* despertar);
+BaseType_t xQueueOverwrite(QueueHandle_t cola, const void* item);
+BaseType_t xQueueReceive(QueueHandle_t cola, void* item, TickType_t espera);
+BaseType_t xQueuePeek(QueueHandle_t cola, void* item, TickType_t espera);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t cola);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t cola);
+BaseType_t xQueueReset(QueueHandle_t cola);
+
+#endif
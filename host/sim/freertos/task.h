@@ -0,0 +1,23 @@
+#ifndef SIM_FREERTOS_TASK_H
+#define SIM_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+// vTaskDelay avanza el reloj virtual como delay()
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previo, TickType_t periodo);
+TickType_t xTaskGetTickCount();
+void vTaskDelete(TaskHandle_t tarea);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t tarea);
+BaseType_t xTaskGetCoreID(TaskHandle_t tarea);
+BaseType_t xPortGetCoreID();
+
+// No se soportan tareas libres en el host: devuelve pdFAIL
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* nombre, uint32_t pila,
+                                   void* arg, UBaseType_t prioridad, TaskHandle_t* handle,
+                                   BaseType_t core);
+
+#endif
@@ -0,0 +1,111 @@
+#include "Arduino.h"
+
+// ---------------------------------------------------------
+// COLAS
+// ---------------------------------------------------------
+struct SimCola {
+  UBaseType_t longitud;
+  UBaseType_t tamItem;
+  UBaseType_t ini;
+  UBaseType_t n;
+  uint8_t* datos;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t longitud, UBaseType_t tamItem) {
+  SimCola* q = (SimCola*)calloc(1, sizeof(SimCola));
+  if (!q) return nullptr;
+  q->longitud = longitud;
+  q->tamItem = tamItem;
+  q->datos = (uint8_t*)malloc((size_t)longitud * tamItem);
+  return q;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+  if (!q) return;
+  free(q->datos);
+  free(q);
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t) {
+  if (!q || q->n == q->longitud) return errQUEUE_FULL;
+  memcpy(q->datos + ((q->ini + q->n) % q->longitud) * q->tamItem, item, q->tamItem);
+  q->n++;
+  return pdTRUE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t q, const void* item, TickType_t espera) {
+  return xQueueSend(q, item, espera);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t q, const void* item, BaseType_t* despertar) {
+  if (despertar) *despertar = pdFALSE;
+  return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t q, const void* item) {
+  if (!q) return pdFALSE;
+  q->ini = 0;
+  q->n = 0;
+  return xQueueSend(q, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t) {
+  if (!q || q->n == 0) return pdFALSE;
+  memcpy(item, q->datos + q->ini * q->tamItem, q->tamItem);
+  q->ini = (q->ini + 1) % q->longitud;
+  q->n--;
+  return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void* item, TickType_t) {
+  if (!q || q->n == 0) return pdFALSE;
+  memcpy(item, q->datos + q->ini * q->tamItem, q->tamItem);
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  return q ? q->n : 0;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+  return q ? q->longitud - q->n : 0;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+  if (q) q->ini = q->n = 0;
+  return pdPASS;
+}
+
+// ---------------------------------------------------------
+// TAREAS (lo que no depende del planificador)
+// ---------------------------------------------------------
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks);
+}
+
+void vTaskDelayUntil(TickType_t* previo, TickType_t periodo) {
+  TickType_t destino = *previo + periodo;
+  TickType_t ahora = xTaskGetTickCount();
+  if ((int32_t)(destino - ahora) > 0) delay(destino - ahora);
+  *previo = destino;
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)millis();
+}
+
+void vTaskDelete(TaskHandle_t) {}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void*, UBaseType_t,
+                                   TaskHandle_t* handle, BaseType_t) {
+  if (handle) *handle = nullptr;
+  return pdFAIL;
+}
+
+BaseType_t xTaskGetCoreID(TaskHandle_t) {
+  return 0;
+}
+
+BaseType_t xPortGetCoreID() {
+  return 0;
+}
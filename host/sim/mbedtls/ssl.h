@@ -0,0 +1,104 @@
+#ifndef SIM_MBEDTLS_SSL_H
+#define SIM_MBEDTLS_SSL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mbedtls/x509_crt.h"
+
+/* Subconjunto de la API de mbedTLS que usa cliente_tls.cpp. No cifra: los
+   datos pasan tal cual por el BIO (el broker simulado habla MQTT en claro
+   en el 8883). Lo que sí modela es el costo del handshake en tiempo virtual
+   y heap, y la caché de sesiones del servidor (sim_tls.h).
+   Compilado con ORION_SIM_TLS_OPENSSL y con socket real (--mosquitto), el
+   handshake y el cifrado los hace OpenSSL contra el listener TLS real. */
+
+#define MBEDTLS_SSL_IS_CLIENT              0
+#define MBEDTLS_SSL_TRANSPORT_STREAM       0
+#define MBEDTLS_SSL_PRESET_DEFAULT         0
+#define MBEDTLS_SSL_VERIFY_NONE            0
+#define MBEDTLS_SSL_VERIFY_REQUIRED        2
+#define MBEDTLS_SSL_SESSION_TICKETS_DISABLED 0
+#define MBEDTLS_SSL_SESSION_TICKETS_ENABLED  1
+
+// Tamaños por defecto de ESP-IDF (CONFIG_MBEDTLS_SSL_IN/OUT_CONTENT_LEN)
+#define MBEDTLS_SSL_IN_CONTENT_LEN  16384
+#define MBEDTLS_SSL_OUT_CONTENT_LEN 4096
+
+#define MBEDTLS_ERR_SSL_BAD_INPUT_DATA     -0x7100
+#define MBEDTLS_ERR_SSL_ALLOC_FAILED       -0x7F00
+#define MBEDTLS_ERR_SSL_CONN_EOF           -0x7280
+#define MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY  -0x7880
+#define MBEDTLS_ERR_SSL_WANT_READ          -0x6900
+#define MBEDTLS_ERR_SSL_WANT_WRITE         -0x6880
+#define MBEDTLS_ERR_SSL_TIMEOUT            -0x6800
+#define MBEDTLS_ERR_X509_CERT_VERIFY_FAILED -0x2700
+
+typedef int mbedtls_ssl_send_t(void* ctx, const unsigned char* buf, size_t len);
+typedef int mbedtls_ssl_recv_t(void* ctx, unsigned char* buf, size_t len);
+typedef int mbedtls_ssl_recv_timeout_t(void* ctx, unsigned char* buf, size_t len, uint32_t timeout);
+
+typedef struct mbedtls_ssl_session {
+  uint32_t id;             // 0 = vacía
+  unsigned char* ticket;   // Como el real: se copia con la sesión
+  size_t ticket_len;
+  void* real;              // SSL_SESSION* con OpenSSL
+} mbedtls_ssl_session;
+
+typedef struct mbedtls_ssl_config {
+  int authmode;
+  int tickets;
+  mbedtls_x509_crt* ca;
+  int (*f_vrfy)(void*, mbedtls_x509_crt*, int, uint32_t*);
+  void* p_vrfy;
+  int (*f_rng)(void*, unsigned char*, size_t);
+  void* p_rng;
+} mbedtls_ssl_config;
+
+typedef struct mbedtls_ssl_context {
+  const mbedtls_ssl_config* conf;
+  char* hostname;
+  unsigned char* in_buf;
+  unsigned char* out_buf;
+  size_t in_len;
+  size_t in_pos;
+  void* p_bio;
+  mbedtls_ssl_send_t* f_send;
+  mbedtls_ssl_recv_t* f_recv;
+  int estado;              // 0 = sin empezar, 1 = en curso, 2 = listo
+  uint64_t listoUs;
+  int reanudando;
+  unsigned char* transitorio;
+  mbedtls_ssl_session ofrecida;
+  mbedtls_ssl_session actual;
+  void* real;              // Estado OpenSSL (sim_tls.cpp)
+} mbedtls_ssl_context;
+
+void mbedtls_ssl_init(mbedtls_ssl_context* ssl);
+void mbedtls_ssl_free(mbedtls_ssl_context* ssl);
+void mbedtls_ssl_config_init(mbedtls_ssl_config* conf);
+void mbedtls_ssl_config_free(mbedtls_ssl_config* conf);
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config* conf, int endpoint, int transport, int preset);
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config* conf, int authmode);
+void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config* conf, mbedtls_x509_crt* ca, void* crl);
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config* conf, int (*f_rng)(void*, unsigned char*, size_t), void* p_rng);
+void mbedtls_ssl_conf_verify(mbedtls_ssl_config* conf, int (*f_vrfy)(void*, mbedtls_x509_crt*, int, uint32_t*),
+                             void* p_vrfy);
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config* conf, int use_tickets);
+
+int mbedtls_ssl_setup(mbedtls_ssl_context* ssl, const mbedtls_ssl_config* conf);
+int mbedtls_ssl_session_reset(mbedtls_ssl_context* ssl);
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context* ssl, const char* hostname);
+void mbedtls_ssl_set_bio(mbedtls_ssl_context* ssl, void* p_bio, mbedtls_ssl_send_t* f_send,
+                         mbedtls_ssl_recv_t* f_recv, mbedtls_ssl_recv_timeout_t* f_recv_timeout);
+int mbedtls_ssl_handshake(mbedtls_ssl_context* ssl);
+int mbedtls_ssl_read(mbedtls_ssl_context* ssl, unsigned char* buf, size_t len);
+int mbedtls_ssl_write(mbedtls_ssl_context* ssl, const unsigned char* buf, size_t len);
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context* ssl);
+int mbedtls_ssl_close_notify(mbedtls_ssl_context* ssl);
+
+void mbedtls_ssl_session_init(mbedtls_ssl_session* session);
+void mbedtls_ssl_session_free(mbedtls_ssl_session* session);
+int mbedtls_ssl_get_session(const mbedtls_ssl_context* ssl, mbedtls_ssl_session* session);
+int mbedtls_ssl_set_session(mbedtls_ssl_context* ssl, const mbedtls_ssl_session* session);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef SIM_MBEDTLS_X509_CRT_H
+#define SIM_MBEDTLS_X509_CRT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MBEDTLS_ERR_X509_INVALID_FORMAT -0x2180
+
+// Solo guarda el PEM: el simulador no verifica firmas
+typedef struct mbedtls_x509_crt {
+  unsigned char* raw;
+  size_t len;
+} mbedtls_x509_crt;
+
+void mbedtls_x509_crt_init(mbedtls_x509_crt* crt);
+int mbedtls_x509_crt_parse(mbedtls_x509_crt* crt, const unsigned char* buf, size_t len);
+void mbedtls_x509_crt_free(mbedtls_x509_crt* crt);
+
+#endif
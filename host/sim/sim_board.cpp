@@ -0,0 +1,756 @@
+#include "Arduino.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "sim_reproduccion.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "driver/gpio.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include <malloc.h>
+#include <errno.h>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+// ---------------------------------------------------------
+// RELOJ VIRTUAL Y EVENTOS
+// ---------------------------------------------------------
+struct EventoSim {
+  uint64_t cuandoUs;
+  uint64_t orden;
+  SimEventoFn fn;
+  void* ctx;
+};
+
+static uint64_t ahoraUs = 0;
+static uint64_t contadorOrden = 0;
+static std::vector<EventoSim> eventos;  // Montículo: el más próximo en front()
+static bool disparando = false;
+
+static bool eventoPosterior(const EventoSim& a, const EventoSim& b) {
+  if (a.cuandoUs != b.cuandoUs) return a.cuandoUs > b.cuandoUs;
+  return a.orden > b.orden;
+}
+
+void simProgramar(uint64_t cuandoUs, SimEventoFn fn, void* ctx) {
+  eventos.push_back({ cuandoUs, contadorOrden++, fn, ctx });
+  std::push_heap(eventos.begin(), eventos.end(), eventoPosterior);
+}
+
+void simSaltarA(uint64_t destinoUs) {
+  if (destinoUs < ahoraUs) return;
+
+  // Un evento puede llamar a delay(): solo el primer nivel dispara eventos
+  if (disparando) {
+    ahoraUs = destinoUs;
+    return;
+  }
+
+  disparando = true;
+  while (!eventos.empty() && eventos.front().cuandoUs <= destinoUs) {
+    std::pop_heap(eventos.begin(), eventos.end(), eventoPosterior);
+    EventoSim e = eventos.back();
+    eventos.pop_back();
+    if (e.cuandoUs > ahoraUs) ahoraUs = e.cuandoUs;
+    e.fn(e.ctx);
+  }
+  disparando = false;
+  if (destinoUs > ahoraUs) ahoraUs = destinoUs;
+}
+
+void simAvanzarUs(uint64_t us) {
+  simSaltarA(ahoraUs + us);
+}
+
+void simAvanzarMs(uint32_t ms) {
+  simAvanzarUs((uint64_t)ms * 1000);
+}
+
+uint64_t simAhoraUs() {
+  return ahoraUs;
+}
+
+uint64_t simProximoEventoUs() {
+  return eventos.empty() ? UINT64_MAX : eventos.front().cuandoUs;
+}
+
+unsigned long millis() {
+  return (unsigned long)(uint32_t)(ahoraUs / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)(uint32_t)ahoraUs;
+}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)ahoraUs;
+}
+
+void delay(uint32_t ms) {
+  simAvanzarMs(ms);
+}
+
+void delayMicroseconds(uint32_t us) {
+  simAvanzarUs(us);
+}
+
+void yield() {
+  // Las esperas activas (PubSubClient, Stream) deben ver pasar el tiempo
+  simAvanzarUs(100);
+}
+
+// ---------------------------------------------------------
+// GPIO / ADC
+// ---------------------------------------------------------
+struct PinSim {
+  uint8_t modo;
+  uint8_t nivel;
+  uint16_t analogico;
+  uint32_t escrituras;
+  void (*isr)();
+  int flanco;       // RISING/FALLING/CHANGE o GPIO_INTR_* de nivel
+  bool apagada;     // gpio_intr_disable()
+  bool despierta;   // gpio_wakeup_enable()
+};
+
+static PinSim pines[SIM_PINES];
+static uint8_t adcBits = 12;
+
+#define POT_PIN_SIM 35
+#define LDR_PIN_SIM 34
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= SIM_PINES) return;
+  pines[pin].modo = mode;
+  if (mode == INPUT_PULLUP) pines[pin].nivel = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (pin >= SIM_PINES) return;
+  pines[pin].nivel = val ? HIGH : LOW;
+  pines[pin].escrituras++;
+}
+
+int digitalRead(uint8_t pin) {
+  if (pin >= SIM_PINES) return LOW;
+  return pines[pin].nivel;
+}
+
+uint16_t analogRead(uint8_t pin) {
+  if (pin >= SIM_PINES) return 0;
+  uint16_t raw12 = (pin == LDR_PIN_SIM) ? simLdrRaw() : pines[pin].analogico;
+  if (adcBits >= 12) return (uint16_t)(raw12 << (adcBits - 12));
+  return (uint16_t)(raw12 >> (12 - adcBits));
+}
+
+void analogReadResolution(uint8_t bits) {
+  adcBits = bits;
+}
+
+void analogSetPinAttenuation(uint8_t, adc_attenuation_t) {}
+void analogSetAttenuation(adc_attenuation_t) {}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode) {
+  if (pin >= SIM_PINES) return;
+  pines[pin].isr = isr;
+  pines[pin].flanco = mode;
+  pines[pin].apagada = false;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin >= SIM_PINES) return;
+  pines[pin].isr = nullptr;
+}
+
+int simNivelPin(uint8_t pin) {
+  return pin < SIM_PINES ? pines[pin].nivel : LOW;
+}
+
+int simModoPin(uint8_t pin) {
+  return pin < SIM_PINES ? pines[pin].modo : 0;
+}
+
+uint32_t simEscriturasPin(uint8_t pin) {
+  return pin < SIM_PINES ? pines[pin].escrituras : 0;
+}
+
+// Registros GPIO: una escritura cambia todos los pines de la máscara a la vez
+static uint32_t escriturasRegistro = 0;
+
+void simRegEscribir(uint32_t reg, uint32_t valor) {
+  if (reg != GPIO_OUT_REG && reg != GPIO_OUT_W1TS_REG && reg != GPIO_OUT_W1TC_REG) return;
+  escriturasRegistro++;
+  for (uint8_t pin = 0; pin < 32; pin++) {
+    bool enMascara = valor & (1UL << pin);
+    if (reg == GPIO_OUT_W1TS_REG && enMascara) pines[pin].nivel = HIGH;
+    else if (reg == GPIO_OUT_W1TC_REG && enMascara) pines[pin].nivel = LOW;
+    else if (reg == GPIO_OUT_REG) pines[pin].nivel = enMascara ? HIGH : LOW;
+  }
+}
+
+uint32_t simRegLeer(uint32_t reg) {
+  if (reg != GPIO_IN_REG && reg != GPIO_OUT_REG) return 0;
+  uint32_t valor = 0;
+  for (uint8_t pin = 0; pin < 32; pin++) {
+    if (pines[pin].nivel == HIGH) valor |= (1UL << pin);
+  }
+  return valor;
+}
+
+uint32_t simEscriturasRegistroGpio() {
+  return escriturasRegistro;
+}
+
+void simFijarEntrada(uint8_t pin, int nivel) {
+  if (pin >= SIM_PINES) return;
+  int previo = pines[pin].nivel;
+  pines[pin].nivel = nivel ? HIGH : LOW;
+  if (!pines[pin].isr || pines[pin].apagada || previo == pines[pin].nivel) return;
+
+  bool bajada = previo == HIGH && pines[pin].nivel == LOW;
+  int f = pines[pin].flanco;
+  if (f == CHANGE || (f == FALLING && bajada) || (f == RISING && !bajada) ||
+      (f == GPIO_INTR_LOW_LEVEL && bajada) || (f == GPIO_INTR_HIGH_LEVEL && !bajada)) {
+    pines[pin].isr();
+  }
+}
+
+// ---------------------------------------------------------
+// ENERGÍA (driver/gpio.h, esp_pm.h, esp_sleep.h)
+// ---------------------------------------------------------
+esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t tipo) {
+  if (pin < 0 || pin >= SIM_PINES) return ESP_ERR_INVALID_ARG;
+  pines[pin].flanco = tipo;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t pin) {
+  if (pin < 0 || pin >= SIM_PINES) return ESP_ERR_INVALID_ARG;
+  PinSim& p = pines[pin];
+  p.apagada = false;
+  // Nivel: si el pin ya está en él, la interrupción queda pendiente
+  bool enNivel = (p.flanco == GPIO_INTR_LOW_LEVEL && p.nivel == LOW) || (p.flanco == GPIO_INTR_HIGH_LEVEL && p.nivel == HIGH);
+  if (p.isr && enNivel) p.isr();
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t pin) {
+  if (pin < 0 || pin >= SIM_PINES) return ESP_ERR_INVALID_ARG;
+  pines[pin].apagada = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t tipo) {
+  if (pin < 0 || pin >= SIM_PINES) return ESP_ERR_INVALID_ARG;
+  if (tipo != GPIO_INTR_LOW_LEVEL && tipo != GPIO_INTR_HIGH_LEVEL) return ESP_ERR_INVALID_ARG;
+  // Como en ESP-IDF: también pasa la interrupción del pin a ese nivel
+  pines[pin].flanco = tipo;
+  pines[pin].despierta = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t pin) {
+  if (pin < 0 || pin >= SIM_PINES) return ESP_ERR_INVALID_ARG;
+  pines[pin].despierta = false;
+  return ESP_OK;
+}
+
+int simTipoInterrupcion(uint8_t pin) {
+  return pin < SIM_PINES ? pines[pin].flanco : 0;
+}
+
+bool simPinDespierta(uint8_t pin) {
+  return pin < SIM_PINES && pines[pin].despierta;
+}
+
+struct SimCerrojoPm {
+  esp_pm_lock_type_t tipo;
+  int tomado;
+};
+
+#define SIM_CERROJOS_PM 4
+static SimCerrojoPm cerrojosPm[SIM_CERROJOS_PM];
+static uint8_t totalCerrojosPm = 0;
+static SimPm estadoPm = { 240, 240, false, 0, false };
+static bool ticklessIdle = true;
+
+esp_err_t esp_pm_configure(const void* config) {
+  const esp_pm_config_t* c = (const esp_pm_config_t*)config;
+  if (!c || c->min_freq_mhz > c->max_freq_mhz) return ESP_ERR_INVALID_ARG;
+  if (c->light_sleep_enable && !ticklessIdle) return ESP_ERR_NOT_SUPPORTED;
+  estadoPm.mhzMax = c->max_freq_mhz;
+  estadoPm.mhzMin = c->min_freq_mhz;
+  estadoPm.suenoLigero = c->light_sleep_enable;
+  return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_create(esp_pm_lock_type_t tipo, int, const char*, esp_pm_lock_handle_t* out) {
+  if (!out || totalCerrojosPm == SIM_CERROJOS_PM) return ESP_ERR_INVALID_ARG;
+  cerrojosPm[totalCerrojosPm] = { tipo, 0 };
+  *out = &cerrojosPm[totalCerrojosPm++];
+  return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t h) {
+  if (!h) return ESP_ERR_INVALID_ARG;
+  h->tomado++;
+  return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t h) {
+  if (!h || !h->tomado) return ESP_ERR_INVALID_ARG;  // En ESP-IDF: ESP_ERR_INVALID_STATE
+  h->tomado--;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+  estadoPm.despertarGpio = true;
+  return ESP_OK;
+}
+
+SimPm simPm() {
+  SimPm r = estadoPm;
+  r.cerrojos = 0;
+  for (uint8_t i = 0; i < totalCerrojosPm; i++) r.cerrojos += cerrojosPm[i].tomado;
+  return r;
+}
+
+void simPmTicklessIdle(bool disponible) {
+  ticklessIdle = disponible;
+}
+
+void simFijarAnalogico(uint8_t pin, uint16_t raw12) {
+  if (pin < SIM_PINES) pines[pin].analogico = raw12 > 4095 ? 4095 : raw12;
+}
+
+void simPulsarBoton(uint8_t pin) {
+  simFijarEntrada(pin, LOW);
+  simAvanzarMs(30);
+  simFijarEntrada(pin, HIGH);
+}
+
+// ---------------------------------------------------------
+// UART
+// ---------------------------------------------------------
+size_t simUartInyectar(int num, const uint8_t* data, size_t len) {
+  HardwareSerial* u = simUart(num);
+  return u ? u->inyectar(data, len) : 0;
+}
+
+uint32_t simUartDesbordes(int num) {
+  HardwareSerial* u = simUart(num);
+  return u ? u->desbordes() : 0;
+}
+
+// ---------------------------------------------------------
+// ALEATORIOS (xorshift, reproducible entre ejecuciones)
+// ---------------------------------------------------------
+static uint32_t semilla = 0x4f52494f;  // "ORIO"
+
+static uint32_t siguienteAleatorio() {
+  semilla ^= semilla << 13;
+  semilla ^= semilla >> 17;
+  semilla ^= semilla << 5;
+  return semilla;
+}
+
+long random(long max) {
+  if (max <= 0) return 0;
+  return (long)(siguienteAleatorio() % (uint32_t)max);
+}
+
+long random(long min, long max) {
+  if (min >= max) return min;
+  return min + random(max - min);
+}
+
+void randomSeed(unsigned long s) {
+  semilla = s ? (uint32_t)s : 1;
+}
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  if (inMax == inMin) return outMin;
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// ---------------------------------------------------------
+// ENTORNO FÍSICO
+// ---------------------------------------------------------
+static SimEntorno entorno;
+
+SimEntorno& simEntorno() {
+  return entorno;
+}
+
+double simHoraDelDia() {
+  double horas = entorno.horaInicio + (double)ahoraUs / 3.6e9;
+  return fmod(horas, 24.0);
+}
+
+// Mínimo a las 5:00, máximo a las 17:00
+static double cicloDiario() {
+  return -cos((simHoraDelDia() - 5.0) / 24.0 * TWO_PI);
+}
+
+double simTemperatura() {
+  return entorno.tempMedia + entorno.tempAmplitud * cicloDiario();
+}
+
+double simHumedad() {
+  return entorno.humMedia - entorno.humAmplitud * cicloDiario();
+}
+
+uint16_t simLdrRaw() {
+  uint16_t grabado;
+  if (simReproduccionLdr(grabado)) return grabado;
+
+  // Luz solar entre 6:00 y 19:00 con rampa senoidal
+  double h = simHoraDelDia();
+  double luz = 0.0;
+  if (h > 6.0 && h < 19.0) luz = sin((h - 6.0) / 13.0 * PI);
+  int raw = entorno.ldrNoche + (int)((entorno.ldrDia - entorno.ldrNoche) * luz);
+  if (entorno.ldrRuido) raw += (int)(siguienteAleatorio() % (2u * entorno.ldrRuido + 1)) - entorno.ldrRuido;
+  return (uint16_t)constrain(raw, 0, 4095);
+}
+
+bool simDhtFalla() {
+  if (entorno.dhtTasaError <= 0.0) return false;
+  return (siguienteAleatorio() % 1000000u) < (uint32_t)(entorno.dhtTasaError * 1000000.0);
+}
+
+// ---------------------------------------------------------
+// GPS (NMEA 1 Hz en UART2)
+// ---------------------------------------------------------
+static bool gpsGenerando = false;
+static uint64_t gpsInicioUs = 0;
+
+static void nmeaConChecksum(char* out, size_t cap, const char* cuerpo) {
+  uint8_t cs = 0;
+  for (const char* p = cuerpo; *p; p++) cs ^= (uint8_t)*p;
+  snprintf(out, cap, "$%s*%02X\r\n", cuerpo, cs);
+}
+
+static void gradosNmea(double grados, bool esLat, char* out, size_t cap, char* hemisferio) {
+  *hemisferio = esLat ? (grados >= 0 ? 'N' : 'S') : (grados >= 0 ? 'E' : 'W');
+  grados = fabs(grados);
+  int g = (int)grados;
+  double minutos = (grados - g) * 60.0;
+  if (esLat) snprintf(out, cap, "%02d%09.6f", g, minutos);
+  else snprintf(out, cap, "%03d%09.6f", g, minutos);
+}
+
+static void eventoGps(void*) {
+  if (!gpsGenerando) return;
+
+  uint64_t t = ahoraUs;
+  bool fix = (t - gpsInicioUs) >= (uint64_t)entorno.gpsFixMs * 1000;
+
+  // Avance por rumbo y velocidad (aproximación plana, suficiente para trayectos cortos)
+  if (fix && entorno.gpsVelocidadMps > 0.0) {
+    double d = entorno.gpsVelocidadMps;  // metros en 1 s
+    double rumbo = radians(entorno.gpsRumboGrados);
+    entorno.gpsLat += (d * cos(rumbo)) / 111320.0;
+    entorno.gpsLng += (d * sin(rumbo)) / (111320.0 * cos(radians(entorno.gpsLat)));
+  }
+
+  uint32_t seg = (uint32_t)(t / 1000000) + (uint32_t)(entorno.horaInicio * 3600.0);
+  char hora[16];
+  snprintf(hora, sizeof(hora), "%02u%02u%02u.00", (seg / 3600) % 24, (seg / 60) % 60, seg % 60);
+
+  double latFix = entorno.gpsLat, lngFix = entorno.gpsLng;
+  if (entorno.gpsRuidoM > 0.0) {
+    double r = entorno.gpsRuidoM;
+    latFix += ((siguienteAleatorio() % 2001) / 1000.0 - 1.0) * r / 111320.0;
+    lngFix += ((siguienteAleatorio() % 2001) / 1000.0 - 1.0) * r / (111320.0 * cos(radians(latFix)));
+  }
+
+  char lat[20], lng[20], ns, ew;
+  gradosNmea(latFix, true, lat, sizeof(lat), &ns);
+  gradosNmea(lngFix, false, lng, sizeof(lng), &ew);
+
+  char cuerpo[128], linea[140];
+  if (fix) {
+    snprintf(cuerpo, sizeof(cuerpo), "GPGGA,%s,%s,%c,%s,%c,1,%02u,0.9,%.1f,M,-8.0,M,,",
+             hora, lat, ns, lng, ew, entorno.gpsSats, entorno.gpsAlt);
+  } else {
+    snprintf(cuerpo, sizeof(cuerpo), "GPGGA,%s,,,,,0,%02u,,,,,,,", hora, entorno.gpsSats / 2);
+  }
+  nmeaConChecksum(linea, sizeof(linea), cuerpo);
+  simUartInyectar(2, (const uint8_t*)linea, strlen(linea));
+
+  double nudos = entorno.gpsVelocidadMps * 1.943844;
+  if (fix) {
+    snprintf(cuerpo, sizeof(cuerpo), "GPRMC,%s,A,%s,%c,%s,%c,%.2f,%.1f,010126,,,A",
+             hora, lat, ns, lng, ew, nudos, entorno.gpsRumboGrados);
+  } else {
+    snprintf(cuerpo, sizeof(cuerpo), "GPRMC,%s,V,,,,,,,010126,,,N", hora);
+  }
+  nmeaConChecksum(linea, sizeof(linea), cuerpo);
+  simUartInyectar(2, (const uint8_t*)linea, strlen(linea));
+
+  simProgramar(t + 1000000, eventoGps, nullptr);
+}
+
+void simGpsIniciar() {
+  if (gpsGenerando || !entorno.gpsActivo) return;
+  gpsGenerando = true;
+  gpsInicioUs = ahoraUs;
+  simProgramar(ahoraUs + 1000000, eventoGps, nullptr);
+}
+
+void simGpsDetener() {
+  gpsGenerando = false;
+}
+
+// ---------------------------------------------------------
+// HEAP
+// ---------------------------------------------------------
+// malloc/free del proceso pasan por aquí para llevar la cuenta de bytes
+// vivos (glibc permite sustituirlas). Lo que el simulador reserva para sí
+// dentro de un SimHeapAjeno se descuenta aparte.
+extern "C" {
+void* __libc_malloc(size_t n);
+void* __libc_calloc(size_t n, size_t tam);
+void* __libc_realloc(void* p, size_t n);
+void* __libc_memalign(size_t alineacion, size_t n);
+void __libc_free(void* p);
+}
+
+static long long heapVivo = 0;
+static long long heapAjeno = 0;
+static int profundidadAjeno = 0;
+static long long heapLinea = 0;
+static size_t heapMinimo = SIM_HEAP_TOTAL;
+static uint64_t heapReservas = 0;
+static uint64_t heapBytesReservados = 0;
+static long long heapPico = 0;
+
+// Fragmentación: desde simHeapLinea() cada reserva del firmware ocupa un
+// tramo de un heap de SIM_HEAP_TOTAL con primer hueco que quepa, más la
+// cabecera de multi_heap. El bloque libre mayor sale de estos tramos, así
+// que reservas de vida larga entre temporales lo achican como en la placa.
+// Los tramos dicen además de quién es cada bloque: uno del simulador que
+// libera el firmware (o al revés) se descuenta del lado que lo reservó.
+#define SIM_HEAP_CABECERA 8
+
+struct TramoHeap {
+  size_t inicio;
+  size_t largo;
+};
+
+static bool modelando = false;
+static bool dentroModelo = false;
+static std::map<size_t, size_t>* huecos = nullptr;           // inicio -> largo
+static std::unordered_map<void*, TramoHeap>* tramos = nullptr;
+static uint64_t sinBloque = 0;
+
+static void modeloReservar(void* p, size_t n) {
+  size_t largo = ((n + 7) & ~(size_t)7) + SIM_HEAP_CABECERA;
+  auto it = huecos->begin();
+  while (it != huecos->end() && it->second < largo) ++it;
+  if (it == huecos->end()) {
+    sinBloque++;  // En la placa, este malloc habría devuelto NULL
+    (*tramos)[p] = { 0, 0 };
+    return;
+  }
+  size_t inicio = it->first;
+  size_t resto = it->second - largo;
+  huecos->erase(it);
+  if (resto) (*huecos)[inicio + largo] = resto;
+  (*tramos)[p] = { inicio, largo };
+}
+
+// false si el bloque no era del firmware
+static bool modeloLiberar(void* p) {
+  auto t = tramos->find(p);
+  if (t == tramos->end()) return false;
+  size_t inicio = t->second.inicio;
+  size_t largo = t->second.largo;
+  tramos->erase(t);
+  if (!largo) return true;
+
+  // Se une con los huecos vecinos
+  auto sig = huecos->lower_bound(inicio);
+  if (sig != huecos->end() && inicio + largo == sig->first) {
+    largo += sig->second;
+    sig = huecos->erase(sig);
+  }
+  if (sig != huecos->begin()) {
+    auto ant = std::prev(sig);
+    if (ant->first + ant->second == inicio) {
+      ant->second += largo;
+      return true;
+    }
+  }
+  (*huecos)[inicio] = largo;
+  return true;
+}
+
+static inline void contarHeap(void* p, int signo) {
+  if (!p) return;
+  long long n = (long long)malloc_usable_size(p) * signo;
+  heapVivo += n;
+
+  // Las estructuras del modelo reservan con profundidadAjeno > 0
+  bool ajeno = profundidadAjeno > 0;
+  if (modelando && !dentroModelo) {
+    dentroModelo = true;
+    profundidadAjeno++;
+    if (signo < 0) ajeno = !modeloLiberar(p);
+    else if (!ajeno) modeloReservar(p, (size_t)n);
+    profundidadAjeno--;
+    dentroModelo = false;
+  }
+
+  if (ajeno) {
+    heapAjeno += n;
+    return;
+  }
+  if (signo > 0) {
+    heapReservas++;
+    heapBytesReservados += n;
+    if (heapVivo - heapAjeno > heapPico) heapPico = heapVivo - heapAjeno;
+  }
+}
+
+extern "C" void* malloc(size_t n) {
+  void* p = __libc_malloc(n);
+  contarHeap(p, 1);
+  return p;
+}
+
+extern "C" void* calloc(size_t n, size_t tam) {
+  void* p = __libc_calloc(n, tam);
+  contarHeap(p, 1);
+  return p;
+}
+
+extern "C" void* realloc(void* p, size_t n) {
+  contarHeap(p, -1);
+  void* q = __libc_realloc(p, n);
+  if (q) contarHeap(q, 1);
+  else if (n) contarHeap(p, 1);  // Si falla, el bloque original sigue vivo
+  return q;
+}
+
+extern "C" void* memalign(size_t alineacion, size_t n) {
+  void* p = __libc_memalign(alineacion, n);
+  contarHeap(p, 1);
+  return p;
+}
+
+extern "C" void* aligned_alloc(size_t alineacion, size_t n) {
+  return memalign(alineacion, n);
+}
+
+extern "C" int posix_memalign(void** out, size_t alineacion, size_t n) {
+  void* p = memalign(alineacion, n);
+  if (!p) return ENOMEM;
+  *out = p;
+  return 0;
+}
+
+extern "C" void free(void* p) {
+  contarHeap(p, -1);
+  __libc_free(p);
+}
+
+SimHeapAjeno::SimHeapAjeno() {
+  profundidadAjeno++;
+}
+
+SimHeapAjeno::~SimHeapAjeno() {
+  profundidadAjeno--;
+}
+
+static size_t heapUsado() {
+  long long usado = heapVivo - heapAjeno - heapLinea;
+  return usado > 0 ? (size_t)usado : 0;
+}
+
+void simHeapLinea() {
+  heapLinea = heapVivo - heapAjeno;
+  SimHeapAjeno ajeno;
+  dentroModelo = true;
+  if (!huecos) huecos = new std::map<size_t, size_t>();
+  if (!tramos) tramos = new std::unordered_map<void*, TramoHeap>();
+  huecos->clear();
+  tramos->clear();
+  (*huecos)[0] = SIM_HEAP_TOTAL;
+  dentroModelo = false;
+  modelando = true;
+}
+
+uint64_t simHeapSinBloque() {
+  return sinBloque;
+}
+
+SimHeapContadores simHeapContadores() {
+  return { heapReservas, heapBytesReservados, heapVivo - heapAjeno, heapPico };
+}
+
+void simHeapReiniciarPico() {
+  heapPico = heapVivo - heapAjeno;
+}
+
+static size_t heapLibre() {
+  size_t usado = heapUsado();
+  size_t libre = usado >= SIM_HEAP_TOTAL ? 0 : SIM_HEAP_TOTAL - usado;
+  if (libre < heapMinimo) heapMinimo = libre;
+  return libre;
+}
+
+size_t heap_caps_get_free_size(uint32_t) { return heapLibre(); }
+size_t heap_caps_get_minimum_free_size(uint32_t) { heapLibre(); return heapMinimo; }
+size_t heap_caps_get_largest_free_block(uint32_t) {
+  size_t libre = heapLibre();
+  if (!modelando) return libre;
+  size_t mayor = 0;
+  for (const auto& h : *huecos) mayor = std::max(mayor, h.second);
+  return std::min(mayor, libre);
+}
+
+// ---------------------------------------------------------
+// ESP
+// ---------------------------------------------------------
+EspClass ESP;
+static uint32_t reinicios = 0;
+
+uint32_t EspClass::getHeapSize() { return SIM_HEAP_TOTAL; }
+uint32_t EspClass::getFreeHeap() { return (uint32_t)heapLibre(); }
+uint32_t EspClass::getMinFreeHeap() { heapLibre(); return (uint32_t)heapMinimo; }
+uint32_t EspClass::getMaxAllocHeap() { return (uint32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT); }
+uint64_t EspClass::getEfuseMac() { return 0x0000C3B2A1286F24ULL; }  // Mismos bytes que WiFi.macAddress()
+uint32_t EspClass::getCpuFreqMHz() { return 240; }
+uint32_t EspClass::getCycleCount() { return (uint32_t)(simAhoraUs() * getCpuFreqMHz()); }
+
+void EspClass::restart() {
+  // En el host no se reinicia el proceso: se cuenta y se sigue
+  reinicios++;
+}
+
+uint32_t simReinicios() {
+  return reinicios;
+}
+
+// ---------------------------------------------------------
+// LIBC (glibc < 2.38 no trae strlcpy/strlcat; newlib sí)
+// ---------------------------------------------------------
+#if !defined(__GLIBC__) || __GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t n = strlen(src);
+  if (size) {
+    size_t c = n < size - 1 ? n : size - 1;
+    memcpy(dst, src, c);
+    dst[c] = '\0';
+  }
+  return n;
+}
+
+size_t strlcat(char* dst, const char* src, size_t size) {
+  size_t d = strnlen(dst, size);
+  if (d == size) return size + strlen(src);
+  return d + strlcpy(dst + d, src, size - d);
+}
+#endif
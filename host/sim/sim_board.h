@@ -0,0 +1,120 @@
+#ifndef SIM_BOARD_H
+#define SIM_BOARD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* =======================
+   CONTROL DEL SIMULADOR
+   =======================
+   API solo para host/: la usan main_sim.cpp, las pruebas y los shims.
+   El firmware nunca la llama. */
+
+// --- RELOJ VIRTUAL ---
+uint64_t simAhoraUs();
+void simAvanzarUs(uint64_t us);   // Avanza y dispara los eventos programados
+void simSaltarA(uint64_t us);     // Igual, hasta un instante absoluto (nunca retrocede)
+void simAvanzarMs(uint32_t ms);
+
+// Eventos a un instante virtual (GPS, botones, reproducción...). Se disparan
+// dentro de simAvanzarUs, en orden, aunque el reloj avance dentro de un delay().
+typedef void (*SimEventoFn)(void* ctx);
+void simProgramar(uint64_t cuandoUs, SimEventoFn fn, void* ctx);
+uint64_t simProximoEventoUs();    // UINT64_MAX si no hay
+
+// --- GPIO / ADC ---
+#define SIM_PINES 40
+int simNivelPin(uint8_t pin);
+int simModoPin(uint8_t pin);
+uint32_t simEscriturasPin(uint8_t pin);   // Número de digitalWrite() recibidos
+uint32_t simEscriturasRegistroGpio();     // REG_WRITE a GPIO_OUT* (escenas)
+void simFijarEntrada(uint8_t pin, int nivel);  // Dispara la ISR si corresponde
+void simFijarAnalogico(uint8_t pin, uint16_t raw12);
+void simPulsarBoton(uint8_t pin);         // Flanco de bajada + subida (botón a GND)
+int simTipoInterrupcion(uint8_t pin);     // FALLING... o GPIO_INTR_LOW_LEVEL/HIGH_LEVEL
+bool simPinDespierta(uint8_t pin);        // gpio_wakeup_enable() vigente
+
+// --- ENERGÍA (esp_pm.h, esp_sleep.h) ---
+struct SimPm {
+  int mhzMax;
+  int mhzMin;
+  bool suenoLigero;     // light_sleep_enable aceptado
+  int cerrojos;         // Tomados ahora (todos los tipos)
+  bool despertarGpio;   // esp_sleep_enable_gpio_wakeup()
+};
+SimPm simPm();
+// false: como un sdkconfig sin CONFIG_FREERTOS_USE_TICKLESS_IDLE, esp_pm_configure rechaza el light sleep
+void simPmTicklessIdle(bool disponible);
+
+// --- UART ---
+void simSilenciarSerial(bool silenciar);
+size_t simUartInyectar(int num, const uint8_t* data, size_t len);
+uint32_t simUartDesbordes(int num);
+
+// --- ENTORNO FÍSICO (modelos de sensores) ---
+struct SimEntorno {
+  // Ciclo diario (la hora virtual empieza en horaInicio)
+  double horaInicio = 8.0;
+  double tempMedia = 24.0;
+  double tempAmplitud = 4.0;
+  double humMedia = 55.0;
+  double humAmplitud = 10.0;
+  double dhtTasaError = 0.0;      // Probabilidad de fallo por lectura
+  uint32_t dhtDuracionUs = 23000; // Lo que bloquea una lectura real
+
+  uint16_t ldrNoche = 350;
+  uint16_t ldrDia = 3800;
+  uint16_t ldrRuido = 0;          // Amplitud de ruido uniforme (cuentas ADC)
+
+  bool gpsActivo = true;          // Generador NMEA en UART2
+  uint32_t gpsFixMs = 30000;      // Tiempo hasta el primer fix
+  uint8_t gpsSats = 8;
+  double gpsLat = 19.432608;      // CDMX
+  double gpsLng = -99.133209;
+  double gpsAlt = 2240.0;
+  double gpsVelocidadMps = 0.0;
+  double gpsRumboGrados = 0.0;
+  double gpsRuidoM = 0.0;         // Error uniforme de cada fix (no mueve la posición real)
+};
+
+SimEntorno& simEntorno();
+double simHoraDelDia();               // 0..24 según reloj virtual
+double simTemperatura();
+double simHumedad();
+uint16_t simLdrRaw();
+bool simDhtFalla();                   // Sorteo según dhtTasaError
+
+// Arranca/para el generador NMEA (1 Hz, GGA + RMC) sobre UART2
+void simGpsIniciar();
+void simGpsDetener();
+
+// --- HEAP ---
+#define SIM_HEAP_TOTAL (320u * 1024u)
+void simHeapLinea();                  // Toma el uso actual como "arranque"
+// Desde simHeapLinea() las reservas del firmware se ubican en un heap
+// modelado (primer hueco): heap_caps_get_largest_free_block() refleja la
+// fragmentación. Reservas que no encontraron bloque contiguo:
+uint64_t simHeapSinBloque();
+
+// Lo que reserva el simulador dentro de este ámbito (historial del broker,
+// líneas de Influx...) no cuenta como heap del firmware.
+struct SimHeapAjeno {
+  SimHeapAjeno();
+  ~SimHeapAjeno();
+};
+
+// Reservas del firmware desde el arranque (sin lo ajeno); host/bench las
+// usa para las asignaciones por iteración.
+struct SimHeapContadores {
+  uint64_t reservas;
+  uint64_t bytesReservados;
+  int64_t vivo;
+  int64_t pico;          // Máximo de "vivo" desde simHeapReiniciarPico()
+};
+SimHeapContadores simHeapContadores();
+void simHeapReiniciarPico();
+
+// --- MISC ---
+uint32_t simReinicios();              // Veces que el firmware llamó ESP.restart()
+
+#endif
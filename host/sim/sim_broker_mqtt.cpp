@@ -0,0 +1,341 @@
+#include "sim_broker_mqtt.h"
+#include "sim_red.h"
+#include "sim_board.h"
+#include "sim_telemetria.h"
+#include <map>
+#include <algorithm>
+
+// ---------------------------------------------------------
+// ESTADO DEL BROKER
+// ---------------------------------------------------------
+class SesionMqtt;
+
+static std::vector<SesionMqtt*> sesiones;
+static std::vector<SimMensajeMqtt> historial;
+static std::map<std::string, std::string> retenidos;
+static bool rechazar = false;
+static uint32_t conexiones = 0;
+static uint64_t bytesRecibidos = 0;
+static uint32_t expiradas = 0;
+static bool vigilando = false;
+
+bool simMqttCoincide(const char* filtro, const char* topic) {
+  while (*filtro) {
+    if (*filtro == '#') return true;
+    if (*filtro == '+') {
+      while (*topic && *topic != '/') topic++;
+      filtro++;
+      continue;
+    }
+    if (*filtro != *topic) return false;
+    filtro++;
+    topic++;
+  }
+  return *topic == '\0';
+}
+
+static void escribirLongitud(std::string& out, size_t n) {
+  do {
+    uint8_t b = n % 128;
+    n /= 128;
+    if (n) b |= 0x80;
+    out.push_back((char)b);
+  } while (n);
+}
+
+static void escribirCadena(std::string& out, const std::string& s) {
+  out.push_back((char)(s.size() >> 8));
+  out.push_back((char)(s.size() & 0xFF));
+  out += s;
+}
+
+static std::string paquetePublish(const std::string& topic, const std::string& payload, bool retain) {
+  std::string cuerpo;
+  escribirCadena(cuerpo, topic);
+  cuerpo += payload;
+  std::string out;
+  out.push_back((char)(0x30 | (retain ? 1 : 0)));
+  escribirLongitud(out, cuerpo.size());
+  return out + cuerpo;
+}
+
+// ---------------------------------------------------------
+// SESIÓN (una por conexión TCP simulada)
+// ---------------------------------------------------------
+class SesionMqtt : public SimConexion {
+public:
+  std::string clientId;
+  std::vector<std::string> filtros;
+  bool conectada = false;
+  uint16_t keepaliveS = 0;
+  uint64_t ultimoUs = 0;   // Último paquete del cliente
+
+  void recibir(const uint8_t* datos, size_t n) override {
+    SimHeapAjeno ajeno;
+    bytesRecibidos += n;
+    ultimoUs = simAhoraUs();
+    buf.append((const char*)datos, n);
+    procesar();
+  }
+
+  void alCerrar() override {
+    quitar();
+    delete this;
+  }
+
+  // MQTT 3.1.1: sin nada del cliente en 1.5 keepalive, el broker corta
+  bool vencida(uint64_t ahora) const {
+    return conectada && keepaliveS && ahora - ultimoUs > (uint64_t)keepaliveS * 1500000;
+  }
+
+  void expirar() {
+    quitar();
+    cerrar();
+  }
+
+  void entregar(const std::string& topic, const std::string& payload, bool retain) {
+    if (!conectada || !abierta()) return;
+    for (auto& f : filtros) {
+      if (simMqttCoincide(f.c_str(), topic.c_str())) {
+        std::string p = paquetePublish(topic, payload, retain);
+        enviar((const uint8_t*)p.data(), p.size());
+        return;
+      }
+    }
+  }
+
+private:
+  std::string buf;
+
+  void quitar() {
+    sesiones.erase(std::remove(sesiones.begin(), sesiones.end(), this), sesiones.end());
+    conectada = false;
+  }
+
+  void responder(std::initializer_list<uint8_t> bytes) {
+    std::vector<uint8_t> v(bytes);
+    enviar(v.data(), v.size());
+  }
+
+  static std::string leerCadena(const std::string& p, size_t& i) {
+    if (i + 2 > p.size()) return std::string();
+    size_t n = ((uint8_t)p[i] << 8) | (uint8_t)p[i + 1];
+    i += 2;
+    std::string s = p.substr(i, n);
+    i += n;
+    return s;
+  }
+
+  void procesar() {
+    for (;;) {
+      if (buf.size() < 2) return;
+      size_t largo = 0, mult = 1, i = 1;
+      for (;;) {
+        if (i >= buf.size()) return;
+        uint8_t b = (uint8_t)buf[i++];
+        largo += (b & 0x7F) * mult;
+        mult *= 128;
+        if (!(b & 0x80)) break;
+      }
+      if (buf.size() < i + largo) return;
+      uint8_t cabecera = (uint8_t)buf[0];
+      std::string cuerpo = buf.substr(i, largo);
+      buf.erase(0, i + largo);
+      paquete(cabecera, cuerpo);
+      if (!abierta()) return;
+    }
+  }
+
+  void paquete(uint8_t cabecera, const std::string& p) {
+    size_t i = 0;
+    switch (cabecera >> 4) {
+      case 1: {  // CONNECT
+        leerCadena(p, i);  // "MQTT"
+        i += 1;            // Nivel
+        i += 1;            // Flags
+        keepaliveS = i + 2 <= p.size() ? ((uint8_t)p[i] << 8) | (uint8_t)p[i + 1] : 0;
+        i += 2;
+        clientId = leerCadena(p, i);
+        if (rechazar) {
+          responder({ 0x20, 0x02, 0x00, 0x05 });
+          cerrar();
+          return;
+        }
+        // Un clientId repetido expulsa a la sesión anterior
+        for (SesionMqtt* s : std::vector<SesionMqtt*>(sesiones)) {
+          if (s != this && s->clientId == clientId) s->cerrar();
+        }
+        conectada = true;
+        conexiones++;
+        sesiones.push_back(this);
+        responder({ 0x20, 0x02, 0x00, 0x00 });
+        break;
+      }
+      case 3: {  // PUBLISH
+        uint8_t qos = (cabecera >> 1) & 3;
+        bool retain = cabecera & 1;
+        std::string topic = leerCadena(p, i);
+        uint16_t id = 0;
+        if (qos) {
+          id = ((uint8_t)p[i] << 8) | (uint8_t)p[i + 1];
+          i += 2;
+        }
+        std::string payload = p.substr(i);
+        if (qos == 1) responder({ 0x40, 0x02, (uint8_t)(id >> 8), (uint8_t)id });
+        difundir(topic, payload, retain, clientId);
+        break;
+      }
+      case 8: {  // SUBSCRIBE
+        uint16_t id = ((uint8_t)p[0] << 8) | (uint8_t)p[1];
+        i = 2;
+        std::string ack;
+        ack.push_back((char)0x90);
+        std::vector<std::string> nuevos;
+        while (i < p.size()) {
+          std::string f = leerCadena(p, i);
+          i++;  // QoS pedido
+          if (std::find(filtros.begin(), filtros.end(), f) == filtros.end()) filtros.push_back(f);
+          nuevos.push_back(f);
+        }
+        escribirLongitud(ack, 2 + nuevos.size());
+        ack.push_back((char)(id >> 8));
+        ack.push_back((char)(id & 0xFF));
+        for (size_t k = 0; k < nuevos.size(); k++) ack.push_back(0);
+        enviar((const uint8_t*)ack.data(), ack.size());
+        for (auto& r : retenidos) {
+          for (auto& f : nuevos) {
+            if (simMqttCoincide(f.c_str(), r.first.c_str())) {
+              std::string pub = paquetePublish(r.first, r.second, true);
+              enviar((const uint8_t*)pub.data(), pub.size());
+              break;
+            }
+          }
+        }
+        break;
+      }
+      case 10: {  // UNSUBSCRIBE
+        uint16_t id = ((uint8_t)p[0] << 8) | (uint8_t)p[1];
+        i = 2;
+        while (i < p.size()) {
+          std::string f = leerCadena(p, i);
+          filtros.erase(std::remove(filtros.begin(), filtros.end(), f), filtros.end());
+        }
+        responder({ 0xB0, 0x02, (uint8_t)(id >> 8), (uint8_t)id });
+        break;
+      }
+      case 12:  // PINGREQ
+        responder({ 0xD0, 0x00 });
+        break;
+      case 14:  // DISCONNECT
+        quitar();
+        cerrar();
+        break;
+      default:
+        break;
+    }
+  }
+
+public:
+  static void difundir(const std::string& topic, const std::string& payload, bool retain, const std::string& origen) {
+    {
+      SimHeapAjeno ajeno;
+      historial.push_back({ topic, payload, retain, simAhoraUs(), origen });
+      simTelemetriaRegistrar("mqtt", topic.c_str(), payload.c_str());
+      if (retain) {
+        if (payload.empty()) retenidos.erase(topic);
+        else retenidos[topic] = payload;
+      }
+    }
+    for (SesionMqtt* s : std::vector<SesionMqtt*>(sesiones)) s->entregar(topic, payload, false);
+  }
+};
+
+static SimConexion* nuevaSesion(void*) {
+  return new SesionMqtt();
+}
+
+static void vigilarKeepalive(void*) {
+  SimHeapAjeno ajeno;
+  uint64_t ahora = simAhoraUs();
+  for (SesionMqtt* s : std::vector<SesionMqtt*>(sesiones)) {
+    if (s->vencida(ahora)) {
+      expiradas++;
+      s->expirar();
+    }
+  }
+  simProgramar(ahora + 1000000, vigilarKeepalive, nullptr);
+}
+
+// ---------------------------------------------------------
+// API
+// ---------------------------------------------------------
+void simBrokerIniciar(uint16_t puerto) {
+  simRedEscuchar(puerto, nuevaSesion, nullptr);
+  if (!vigilando) {
+    vigilando = true;
+    simProgramar(simAhoraUs() + 1000000, vigilarKeepalive, nullptr);
+  }
+}
+
+void simBrokerLimpiar() {
+  SimHeapAjeno ajeno;
+  historial.clear();
+  retenidos.clear();
+}
+
+void simBrokerRechazarConexiones(bool r) {
+  rechazar = r;
+}
+
+void simBrokerPublicar(const char* topic, const char* payload, bool retain) {
+  SimHeapAjeno ajeno;
+  SesionMqtt::difundir(topic, payload, retain, "");
+}
+
+const std::vector<SimMensajeMqtt>& simBrokerHistorial() {
+  return historial;
+}
+
+const SimMensajeMqtt* simBrokerUltimo(const char* filtro) {
+  for (auto it = historial.rbegin(); it != historial.rend(); ++it) {
+    if (simMqttCoincide(filtro, it->topic.c_str())) return &*it;
+  }
+  return nullptr;
+}
+
+size_t simBrokerContar(const char* filtro) {
+  size_t n = 0;
+  for (auto& m : historial) {
+    if (simMqttCoincide(filtro, m.topic.c_str())) n++;
+  }
+  return n;
+}
+
+const char* simBrokerRetenido(const char* topic) {
+  auto it = retenidos.find(topic);
+  return it == retenidos.end() ? nullptr : it->second.c_str();
+}
+
+uint32_t simBrokerConexiones() {
+  return conexiones;
+}
+
+size_t simBrokerClientes() {
+  size_t n = 0;
+  for (SesionMqtt* s : sesiones) n += s->abierta() ? 1 : 0;
+  return n;
+}
+
+size_t simBrokerFiltros() {
+  size_t n = 0;
+  for (SesionMqtt* s : sesiones) n += s->abierta() ? s->filtros.size() : 0;
+  return n;
+}
+
+uint32_t simBrokerExpiradas() {
+  return expiradas;
+}
+
+uint64_t simBrokerBytesRecibidos() {
+  return bytesRecibidos;
+}
@@ -0,0 +1,42 @@
+#ifndef SIM_BROKER_MQTT_H
+#define SIM_BROKER_MQTT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/* Broker MQTT 3.1.1 mínimo en proceso (QoS 0/1 de entrada, entrega en
+   QoS 0, retained, comodines + y #, corte por keepalive). Escucha en la
+   red simulada; las pruebas lo usan para inyectar comandos y revisar lo
+   publicado. */
+
+struct SimMensajeMqtt {
+  std::string topic;
+  std::string payload;
+  bool retain;
+  uint64_t tUs;
+  std::string cliente;  // "" = inyectado por el simulador
+};
+
+void simBrokerIniciar(uint16_t puerto = 1883);  // El del firmware; 8883 para mqtt_tls (TLS simulado, en claro)
+void simBrokerLimpiar();                     // Historial y retenidos
+void simBrokerRechazarConexiones(bool rechazar);
+
+// Publicación externa (como si viniera de Home Assistant)
+void simBrokerPublicar(const char* topic, const char* payload, bool retain = false);
+
+const std::vector<SimMensajeMqtt>& simBrokerHistorial();
+const SimMensajeMqtt* simBrokerUltimo(const char* filtro);  // nullptr si no hay
+size_t simBrokerContar(const char* filtro);
+const char* simBrokerRetenido(const char* topic);           // nullptr si no hay
+
+uint32_t simBrokerConexiones();              // CONNECT aceptados
+size_t simBrokerClientes();                  // Sesiones abiertas ahora
+size_t simBrokerFiltros();                   // Suscripciones activas (todas las sesiones)
+uint32_t simBrokerExpiradas();               // Sesiones cortadas por keepalive vencido (1.5x)
+uint64_t simBrokerBytesRecibidos();
+
+bool simMqttCoincide(const char* filtro, const char* topic);
+
+#endif
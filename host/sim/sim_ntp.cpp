@@ -0,0 +1,61 @@
+#include "sim_ntp.h"
+#include "Arduino.h"
+#include "WiFi.h"
+#include "esp_sntp.h"
+
+#define NTP_REINTENTO_MS 15000  // SNTP_RETRY_TIMEOUT de lwIP
+
+static SimNtp ntp;
+static sntp_sync_time_cb_t alSincronizar = nullptr;
+static uint32_t intervaloMs = 3600000;  // CONFIG_LWIP_SNTP_UPDATE_DELAY
+static uint32_t arranques = 0;
+static uint32_t sincronizaciones = 0;
+static bool programado = false;
+
+SimNtp& simNtp() {
+  return ntp;
+}
+
+uint64_t simUtcVerdaderoMs(uint64_t monoUs) {
+  int64_t correccion = (int64_t)monoUs * ntp.derivaPpm / 1000000;
+  return ntp.epochInicioMs + (uint64_t)((int64_t)monoUs - correccion) / 1000;
+}
+
+uint32_t simNtpArranques() {
+  return arranques;
+}
+
+uint32_t simNtpSincronizaciones() {
+  return sincronizaciones;
+}
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) {
+  alSincronizar = callback;
+}
+
+void sntp_set_sync_interval(uint32_t interval_ms) {
+  intervaloMs = interval_ms;
+}
+
+uint32_t sntp_get_sync_interval() {
+  return intervaloMs;
+}
+
+// Respuesta del servidor: la placa fija su hora y avisa
+static void consultar(void*) {
+  bool responde = ntp.disponible && WiFi.isConnected();
+  if (responde) {
+    uint64_t utcMs = simUtcVerdaderoMs(simAhoraUs());
+    struct timeval tv = { (time_t)(utcMs / 1000), (suseconds_t)(utcMs % 1000) * 1000 };
+    sincronizaciones++;
+    if (alSincronizar) alSincronizar(&tv);
+  }
+  simProgramar(simAhoraUs() + (uint64_t)(responde ? intervaloMs : NTP_REINTENTO_MS) * 1000, consultar, nullptr);
+}
+
+void configTzTime(const char*, const char*, const char*, const char*) {
+  arranques++;
+  if (programado) return;  // El SNTP ya corre: solo cambian zona y servidores
+  programado = true;
+  simProgramar(simAhoraUs() + (uint64_t)ntp.respuestaMs * 1000, consultar, nullptr);
+}
@@ -0,0 +1,26 @@
+#ifndef SIM_NTP_H
+#define SIM_NTP_H
+
+#include <stdint.h>
+
+/* =======================
+   NTP SIMULADO
+   =======================
+   Lo que ve el SNTP de la placa: la hora verdadera, una respuesta que
+   tarda y un cristal que no va exacto. El reloj virtual es el monotónico
+   de la placa (esp_timer); la hora verdadera avanza derivaPpm más lento
+   si el cristal adelanta. */
+
+struct SimNtp {
+  uint64_t epochInicioMs = 1767225600000ULL;  // 2026-01-01 00:00 UTC en el instante virtual 0
+  int32_t derivaPpm = 0;        // Error del cristal (+: el monotónico adelanta)
+  uint32_t respuestaMs = 1500;  // Del arranque del SNTP a la primera hora
+  bool disponible = true;       // false: sin respuesta, se reintenta cada 15 s
+};
+
+SimNtp& simNtp();
+uint64_t simUtcVerdaderoMs(uint64_t monoUs);  // Hora real de un instante virtual
+uint32_t simNtpArranques();                   // configTzTime() recibidos
+uint32_t simNtpSincronizaciones();
+
+#endif
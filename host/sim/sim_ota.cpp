@@ -0,0 +1,268 @@
+#include "sim_ota.h"
+#include "sim_board.h"
+#include "sim_red.h"
+#include "esp_ota_ops.h"
+#include <string.h>
+#include <string>
+#include <deque>
+
+// ---------------------------------------------------------
+// PARTICIONES (tabla min_spiffs)
+// ---------------------------------------------------------
+static const esp_partition_t particiones[2] = {
+  { ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_0, 0x10000, 0x1E0000, "app0", false },
+  { ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, 0x1F0000, 0x1E0000, "app1", false },
+};
+static std::vector<uint8_t> contenido[2];
+static int corriendo = 0;
+static int arranque = 0;
+static uint32_t sectoresBorrados = 0;
+static bool fallarArranque = false;
+
+// Una sola escritura OTA a la vez, como en la placa
+struct SesionOta {
+  bool abierta = false;
+  int particion = 0;
+  size_t escritos = 0;
+  uint32_t borradosHasta = 0;   // Sectores ya borrados (escritura secuencial)
+};
+static SesionOta sesion;
+static esp_ota_handle_t ultimoManejador = 0;
+
+static int indiceDe(const esp_partition_t* p) {
+  if (p == &particiones[0]) return 0;
+  if (p == &particiones[1]) return 1;
+  return -1;
+}
+
+static std::vector<uint8_t>& flash(int i) {
+  if (contenido[i].empty()) {
+    SimHeapAjeno ajeno;  // La flash no es heap
+    contenido[i].assign(particiones[i].size, 0xFF);
+  }
+  return contenido[i];
+}
+
+static void borrar(int i, uint32_t sector) {
+  std::vector<uint8_t>& f = flash(i);
+  memset(f.data() + sector * SIM_FLASH_SECTOR, 0xFF, SIM_FLASH_SECTOR);
+  sectoresBorrados++;
+  simAvanzarUs(SIM_FLASH_BORRADO_US);
+}
+
+void simOtaImagen(const std::vector<uint8_t>& imagen) {
+  std::vector<uint8_t>& f = flash(corriendo);
+  std::fill(f.begin(), f.end(), 0xFF);
+  std::copy(imagen.begin(), imagen.end(), f.begin());
+}
+
+std::vector<uint8_t> simOtaContenido(const char* etiqueta, size_t n) {
+  for (int i = 0; i < 2; i++) {
+    if (strcmp(particiones[i].label, etiqueta) == 0) {
+      std::vector<uint8_t>& f = flash(i);
+      SimHeapAjeno ajeno;
+      return std::vector<uint8_t>(f.begin(), f.begin() + std::min(n, f.size()));
+    }
+  }
+  return {};
+}
+
+const char* simOtaCorriendo() {
+  return particiones[corriendo].label;
+}
+
+const char* simOtaArranque() {
+  return particiones[arranque].label;
+}
+
+bool simOtaArrancar() {
+  bool cambio = arranque != corriendo;
+  corriendo = arranque;
+  return cambio;
+}
+
+uint32_t simOtaSectoresBorrados() {
+  return sectoresBorrados;
+}
+
+void simOtaFallarArranque(bool fallar) {
+  fallarArranque = fallar;
+}
+
+// ---------------------------------------------------------
+// esp_partition / esp_ota_ops
+// ---------------------------------------------------------
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label) {
+  for (const esp_partition_t& p : particiones) {
+    if (p.type != type) continue;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && p.subtype != subtype) continue;
+    if (label && strcmp(p.label, label) != 0) continue;
+    return &p;
+  }
+  return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size) {
+  int i = indiceDe(partition);
+  if (i < 0 || src_offset + size > partition->size) return ESP_ERR_INVALID_ARG;
+  memcpy(dst, flash(i).data() + src_offset, size);
+  simAvanzarUs(10 + size * SIM_FLASH_LECTURA_US_KB / 1024);
+  return ESP_OK;
+}
+
+const esp_partition_t* esp_ota_get_running_partition(void) {
+  return &particiones[corriendo];
+}
+
+const esp_partition_t* esp_ota_get_boot_partition(void) {
+  return &particiones[arranque];
+}
+
+const esp_partition_t* esp_ota_get_next_update_partition(const esp_partition_t* start_from) {
+  int i = start_from ? indiceDe(start_from) : corriendo;
+  return i < 0 ? nullptr : &particiones[1 - i];
+}
+
+esp_err_t esp_ota_begin(const esp_partition_t* partition, size_t image_size, esp_ota_handle_t* out_handle) {
+  int i = indiceDe(partition);
+  if (i < 0 || i == corriendo || sesion.abierta) return ESP_ERR_INVALID_ARG;
+  if (image_size != OTA_SIZE_UNKNOWN && image_size != OTA_WITH_SEQUENTIAL_WRITES && image_size > partition->size) {
+    return ESP_ERR_INVALID_SIZE;
+  }
+  sesion = SesionOta();
+  sesion.abierta = true;
+  sesion.particion = i;
+  // Sin escritura secuencial se borra de entrada (la partición entera si no se sabe el tamaño)
+  if (image_size != OTA_WITH_SEQUENTIAL_WRITES) {
+    size_t bytes = image_size == OTA_SIZE_UNKNOWN ? partition->size : image_size;
+    for (uint32_t s = 0; s * SIM_FLASH_SECTOR < bytes; s++) borrar(i, s);
+    sesion.borradosHasta = (bytes + SIM_FLASH_SECTOR - 1) / SIM_FLASH_SECTOR;
+  }
+  *out_handle = ++ultimoManejador;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_write(esp_ota_handle_t handle, const void* data, size_t size) {
+  if (!sesion.abierta || handle != ultimoManejador) return ESP_ERR_INVALID_ARG;
+  const uint8_t* bytes = (const uint8_t*)data;
+  if (sesion.escritos == 0 && size && bytes[0] != 0xE9) return ESP_ERR_OTA_VALIDATE_FAILED;
+  if (sesion.escritos + size > particiones[sesion.particion].size) return ESP_ERR_INVALID_SIZE;
+
+  uint32_t ultimo = (uint32_t)((sesion.escritos + size + SIM_FLASH_SECTOR - 1) / SIM_FLASH_SECTOR);
+  while (sesion.borradosHasta < ultimo) borrar(sesion.particion, sesion.borradosHasta++);
+  memcpy(flash(sesion.particion).data() + sesion.escritos, bytes, size);
+  sesion.escritos += size;
+  simAvanzarUs(size * SIM_FLASH_PROGRAMA_US_KB / 1024);
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_end(esp_ota_handle_t handle) {
+  if (!sesion.abierta || handle != ultimoManejador) return ESP_ERR_INVALID_ARG;
+  sesion.abierta = false;
+  return sesion.escritos ? ESP_OK : ESP_ERR_OTA_VALIDATE_FAILED;
+}
+
+esp_err_t esp_ota_abort(esp_ota_handle_t handle) {
+  if (!sesion.abierta || handle != ultimoManejador) return ESP_ERR_INVALID_ARG;
+  sesion.abierta = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_ota_set_boot_partition(const esp_partition_t* partition) {
+  int i = indiceDe(partition);
+  if (i < 0) return ESP_ERR_INVALID_ARG;
+  if (fallarArranque) return ESP_FAIL;  // Error de escritura en otadata
+  // ESP-IDF no acepta una partición sin imagen válida
+  if (flash(i)[0] != 0xE9) return ESP_ERR_OTA_VALIDATE_FAILED;
+  arranque = i;
+  return ESP_OK;
+}
+
+// ---------------------------------------------------------
+// SERVIDOR DE IMÁGENES
+// ---------------------------------------------------------
+struct ArchivoOta {
+  std::string ruta;
+  std::vector<uint8_t> datos;
+};
+static std::deque<ArchivoOta> archivos;  // deque: las conexiones apuntan a su archivo
+static uint32_t anchoBanda = 50000;
+static uint64_t bytesServidos = 0;
+
+#define SIM_OTA_TICK_US 10000
+
+// Una petición por conexión; el cuerpo sale a 'anchoBanda' en ticks de 10 ms
+class ConexionOta : public SimConexion {
+public:
+  std::string peticion;
+  const ArchivoOta* archivo = nullptr;
+  size_t enviados = 0;
+  bool cerradaCliente = false;
+
+  void recibir(const uint8_t* datos, size_t n) override {
+    if (archivo) return;
+    SimHeapAjeno ajeno;
+    peticion.append((const char*)datos, n);
+    if (peticion.find("\r\n\r\n") == std::string::npos) return;
+
+    std::string ruta;
+    if (peticion.compare(0, 4, "GET ") == 0) ruta = peticion.substr(4, peticion.find(' ', 4) - 4);
+    for (const ArchivoOta& a : archivos) {
+      if (a.ruta == ruta) archivo = &a;
+    }
+    if (!archivo) {
+      const char* r = "HTTP/1.0 404 Not Found\r\n\r\n";
+      enviar((const uint8_t*)r, strlen(r));
+      cerrar();
+      return;
+    }
+    std::string cabecera = "HTTP/1.0 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: " +
+                           std::to_string(archivo->datos.size()) + "\r\n\r\n";
+    enviar((const uint8_t*)cabecera.data(), cabecera.size());
+    simProgramar(simAhoraUs() + SIM_OTA_TICK_US, empujar, this);
+  }
+
+  void alCerrar() override { cerradaCliente = true; }
+
+  static void empujar(void* ctx) {
+    ConexionOta* c = (ConexionOta*)ctx;
+    if (c->cerradaCliente || !c->abierta()) return;
+    SimHeapAjeno ajeno;  // El buffer RX es de lwIP
+    size_t n = std::min((size_t)anchoBanda * SIM_OTA_TICK_US / 1000000, c->archivo->datos.size() - c->enviados);
+    c->enviar(c->archivo->datos.data() + c->enviados, n);
+    c->enviados += n;
+    bytesServidos += n;
+    if (c->enviados == c->archivo->datos.size()) c->cerrar();
+    else simProgramar(simAhoraUs() + SIM_OTA_TICK_US, empujar, c);
+  }
+};
+
+// Las conexiones quedan vivas hasta el final: puede quedar un tick programado
+static std::vector<ConexionOta*> conexiones;
+
+static SimConexion* nuevaConexion(void*) {
+  ConexionOta* c = new ConexionOta();
+  conexiones.push_back(c);
+  return c;
+}
+
+void simOtaServir(const char* ruta, const std::vector<uint8_t>& datos) {
+  SimHeapAjeno ajeno;
+  simRedEscuchar(SIM_OTA_PUERTO, nuevaConexion, nullptr);
+  for (ArchivoOta& a : archivos) {
+    if (a.ruta == ruta) {
+      a.datos = datos;
+      return;
+    }
+  }
+  archivos.push_back({ ruta, datos });
+}
+
+void simOtaAnchoBanda(uint32_t bytesPorSeg) {
+  anchoBanda = bytesPorSeg;
+}
+
+uint64_t simOtaBytesServidos() {
+  return bytesServidos;
+}
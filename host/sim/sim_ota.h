@@ -0,0 +1,53 @@
+#ifndef SIM_OTA_H
+#define SIM_OTA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "ota.h"
+
+/* =======================
+   FLASH, OTA E IMÁGENES
+   =======================
+   Las dos particiones de aplicación en memoria, con los tiempos de la
+   flash SPI cobrados en el reloj virtual (esp_ota_ops.h), un bootloader
+   que se invoca a mano (en el host no se reinicia el proceso) y un
+   servidor HTTP de imágenes con ancho de banda limitado. */
+
+#define SIM_FLASH_SECTOR 4096
+#define SIM_FLASH_BORRADO_US 30000     // Borrado de un sector de 4 KB
+#define SIM_FLASH_PROGRAMA_US_KB 1600  // Programar 1 KB (páginas de 256 B)
+#define SIM_FLASH_LECTURA_US_KB 25     // Leer 1 KB (QIO a 80 MHz)
+
+// La imagen que corre, como si se hubiera cargado por cable
+void simOtaImagen(const std::vector<uint8_t>& imagen);
+std::vector<uint8_t> simOtaContenido(const char* etiqueta, size_t n);
+const char* simOtaCorriendo();
+const char* simOtaArranque();   // Lo que elegirá el bootloader
+
+// Reinicio: el bootloader arranca la partición de arranque. Después hay
+// que llamar a otaIniciar() y otaRestaurarModos() como haría setup().
+// true si cambió de imagen
+bool simOtaArrancar();
+uint32_t simOtaSectoresBorrados();
+void simOtaFallarArranque(bool fallar);  // esp_ota_set_boot_partition devuelve error
+
+// --- Servidor de imágenes (HTTP/1.0 en SIM_OTA_PUERTO) ---
+#define SIM_OTA_PUERTO 8070
+void simOtaServir(const char* ruta, const std::vector<uint8_t>& datos);
+void simOtaAnchoBanda(uint32_t bytesPorSeg);   // Por defecto 50 KB/s
+uint64_t simOtaBytesServidos();
+
+// --- Paquetes .oota (sim_ota_paquete.cpp; también host/app/orion_ota) ---
+// largoBits 0: 4 para código (coincidencias cortas) y 8 para el parche,
+// que es casi todo ceros y gana con referencias largas
+std::vector<uint8_t> simOtaLzss(const std::vector<uint8_t>& datos, uint8_t ventanaBits, uint8_t largoBits);
+std::vector<uint8_t> simOtaParche(const std::vector<uint8_t>& base, const std::vector<uint8_t>& nueva);
+std::vector<uint8_t> simOtaPaquete(OtaTipo tipo, const std::vector<uint8_t>& imagen,
+                                   const std::vector<uint8_t>* base = nullptr,
+                                   uint8_t ventanaBits = OTA_VENTANA_MAX_BITS, uint8_t largoBits = 0);
+void simOtaSha(const std::vector<uint8_t>& datos, uint8_t sha[32]);
+std::string simOtaShaHex(const std::vector<uint8_t>& datos);
+
+#endif
@@ -0,0 +1,222 @@
+#include "sim_ota.h"
+#include "sim_board.h"
+#include "mbedtls/sha256.h"
+#include <string.h>
+#include <unordered_map>
+
+/* Lado "servidor" de ota.h: comprime y arma parches. Nada de esto corre
+   en la placa, así que no se cuida la memoria: tablas hash completas. */
+
+// ---------------------------------------------------------
+// LZSS (bits de mayor a menor, como los lee lzBit())
+// ---------------------------------------------------------
+class EscritorBits {
+public:
+  explicit EscritorBits(std::vector<uint8_t>& out) : _out(out) {}
+
+  void poner(uint32_t valor, uint8_t bits) {
+    while (bits--) {
+      _byte = _byte << 1 | ((valor >> bits) & 1);
+      if (++_n == 8) {
+        _out.push_back(_byte);
+        _byte = 0;
+        _n = 0;
+      }
+    }
+  }
+
+  // Relleno con ceros: el lector lo toma como el inicio de una referencia que nunca se completa
+  void cerrar() {
+    if (_n) _out.push_back(_byte << (8 - _n));
+    _n = 0;
+  }
+
+private:
+  std::vector<uint8_t>& _out;
+  uint8_t _byte = 0;
+  uint8_t _n = 0;
+};
+
+static inline uint32_t hash3(const uint8_t* p) {
+  return ((uint32_t)p[0] << 16 ^ (uint32_t)p[1] << 8 ^ p[2]) * 2654435761u >> 16;
+}
+
+std::vector<uint8_t> simOtaLzss(const std::vector<uint8_t>& datos, uint8_t ventanaBits, uint8_t largoBits) {
+  SimHeapAjeno ajeno;
+  const size_t n = datos.size();
+  const size_t ventana = (size_t)1 << ventanaBits;
+  const size_t largoMax = ((size_t)1 << largoBits) - 1 + OTA_LZ_MIN;
+  const int profundidad = 256;
+
+  std::vector<int32_t> cabeza(1 << 16, -1);
+  std::vector<int32_t> anterior(n, -1);
+  auto indexar = [&](size_t i) {
+    if (i + 3 > n) return;
+    uint32_t h = hash3(&datos[i]);
+    anterior[i] = cabeza[h];
+    cabeza[h] = (int32_t)i;
+  };
+
+  std::vector<uint8_t> out;
+  out.reserve(n / 2);
+  EscritorBits bits(out);
+  size_t i = 0;
+  while (i < n) {
+    size_t mejor = 0, distancia = 0;
+    if (i + 3 <= n) {
+      int32_t c = cabeza[hash3(&datos[i])];
+      for (int d = 0; c >= 0 && i - c <= ventana && d < profundidad; d++, c = anterior[c]) {
+        size_t largo = 0;
+        while (largo < largoMax && i + largo < n && datos[c + largo] == datos[i + largo]) largo++;
+        if (largo > mejor) {
+          mejor = largo;
+          distancia = i - c;
+          if (largo == largoMax) break;
+        }
+      }
+    }
+    // Una referencia (1 + W + L bits) le gana a 3 literales (27 bits)
+    if (mejor >= 3) {
+      bits.poner(0, 1);
+      bits.poner((uint32_t)(distancia - 1), ventanaBits);
+      bits.poner((uint32_t)(mejor - OTA_LZ_MIN), largoBits);
+      for (size_t k = 0; k < mejor; k++) indexar(i + k);
+      i += mejor;
+    } else {
+      bits.poner(1, 1);
+      bits.poner(datos[i], 8);
+      indexar(i);
+      i++;
+    }
+  }
+  bits.cerrar();
+  return out;
+}
+
+// ---------------------------------------------------------
+// PARCHE (estilo bsdiff: DIFF aproximado + INSERT)
+// ---------------------------------------------------------
+static void varint(std::vector<uint8_t>& out, uint32_t v) {
+  while (v >= 0x80) {
+    out.push_back((uint8_t)(v | 0x80));
+    v >>= 7;
+  }
+  out.push_back((uint8_t)v);
+}
+
+static inline uint64_t clave8(const uint8_t* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Cuánto de 'nueva' desde i se parece a 'base' desde j: el prefijo con más
+// coincidencias netas, cortando tras 16 diferencias de más. Un puntero que
+// cambió en cada palabra no corta el tramo; un bloque nuevo sí.
+static size_t extender(const std::vector<uint8_t>& base, const std::vector<uint8_t>& nueva, size_t i, int64_t j) {
+  if (j < 0 || (size_t)j >= base.size()) return 0;
+  int64_t puntaje = 0, mejorPuntaje = 0;
+  size_t mejor = 0;
+  for (size_t k = 0; i + k < nueva.size() && j + k < base.size(); k++) {
+    puntaje += nueva[i + k] == base[j + k] ? 1 : -1;
+    if (puntaje > mejorPuntaje) {
+      mejorPuntaje = puntaje;
+      mejor = k + 1;
+    } else if (puntaje < mejorPuntaje - 16) {
+      break;
+    }
+  }
+  return mejor;
+}
+
+std::vector<uint8_t> simOtaParche(const std::vector<uint8_t>& base, const std::vector<uint8_t>& nueva) {
+  SimHeapAjeno ajeno;
+  std::unordered_map<uint64_t, uint32_t> indice;
+  indice.reserve(base.size());
+  for (size_t j = 0; j + 8 <= base.size(); j++) indice.emplace(clave8(&base[j]), (uint32_t)j);
+
+  std::vector<uint8_t> out, insertar;
+  auto volcarInsert = [&]() {
+    if (insertar.empty()) return;
+    out.push_back(OTA_DELTA_INSERT);
+    varint(out, (uint32_t)insertar.size());
+    out.insert(out.end(), insertar.begin(), insertar.end());
+    insertar.clear();
+  };
+
+  size_t i = 0;
+  int64_t desplazamiento = 0;  // j - i del último DIFF
+  int64_t cursor = 0;          // Fin del último DIFF en la base
+  while (i < nueva.size()) {
+    // Primero la alineación que venía; si no, la de un bloque idéntico de 8 B
+    int64_t j = (int64_t)i + desplazamiento;
+    size_t largo = extender(base, nueva, i, j);
+    if (largo < 8 && i + 8 <= nueva.size()) {
+      auto it = indice.find(clave8(&nueva[i]));
+      if (it != indice.end()) {
+        j = it->second;
+        largo = extender(base, nueva, i, j);
+      }
+    }
+    if (largo < 8) {
+      insertar.push_back(nueva[i++]);
+      continue;
+    }
+
+    volcarInsert();
+    int32_t salto = (int32_t)(j - cursor);
+    out.push_back(OTA_DELTA_DIFF);
+    varint(out, (uint32_t)salto << 1 ^ (uint32_t)(salto >> 31));  // Zigzag
+    varint(out, (uint32_t)largo);
+    for (size_t k = 0; k < largo; k++) out.push_back((uint8_t)(nueva[i + k] - base[j + k]));
+    desplazamiento = j - (int64_t)i;
+    cursor = j + largo;
+    i += largo;
+  }
+  volcarInsert();
+  return out;
+}
+
+// ---------------------------------------------------------
+// PAQUETE
+// ---------------------------------------------------------
+void simOtaSha(const std::vector<uint8_t>& datos, uint8_t sha[32]) {
+  mbedtls_sha256(datos.data(), datos.size(), sha, 0);
+}
+
+std::string simOtaShaHex(const std::vector<uint8_t>& datos) {
+  uint8_t sha[32];
+  simOtaSha(datos, sha);
+  char hex[65];
+  for (int i = 0; i < 32; i++) snprintf(hex + 2 * i, 3, "%02x", sha[i]);
+  SimHeapAjeno ajeno;
+  return std::string(hex);
+}
+
+std::vector<uint8_t> simOtaPaquete(OtaTipo tipo, const std::vector<uint8_t>& imagen, const std::vector<uint8_t>* base,
+                                   uint8_t ventanaBits, uint8_t largoBits) {
+  SimHeapAjeno ajeno;
+  if (!largoBits) largoBits = tipo == OTA_DELTA ? 8 : 4;
+  OtaCabecera cab = {};
+  memcpy(cab.magia, OTA_MAGIA, 4);
+  cab.version = OTA_VERSION;
+  cab.tipo = tipo;
+  cab.ventanaBits = ventanaBits;
+  cab.largoBits = largoBits;
+  cab.largo = (uint32_t)imagen.size();
+  simOtaSha(imagen, cab.sha);
+  if (tipo == OTA_DELTA && base) {
+    cab.largoBase = (uint32_t)base->size();
+    simOtaSha(*base, cab.shaBase);
+  }
+  otaFirmar(cab, cab.firma);
+
+  std::vector<uint8_t> cuerpo;
+  if (tipo == OTA_PLANA) cuerpo = imagen;
+  else if (tipo == OTA_LZSS) cuerpo = simOtaLzss(imagen, ventanaBits, largoBits);
+  else cuerpo = simOtaLzss(simOtaParche(base ? *base : std::vector<uint8_t>(), imagen), ventanaBits, largoBits);
+
+  std::vector<uint8_t> paquete((const uint8_t*)&cab, (const uint8_t*)&cab + sizeof(cab));
+  paquete.insert(paquete.end(), cuerpo.begin(), cuerpo.end());
+  return paquete;
+}
@@ -0,0 +1,52 @@
+#ifndef SIM_RED_H
+#define SIM_RED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <deque>
+
+/* =======================
+   RED SIMULADA
+   =======================
+   Servicios en proceso (broker MQTT, sumidero Influx...) escuchando en un
+   puerto. WiFiClient::connect() les entrega los bytes en cuanto se
+   escriben y la respuesta queda en el buffer RX del cliente. Si nadie
+   escucha en ese puerto, o con ORION_SIM_RED_REAL=1, se usa un socket
+   POSIX real; ORION_SIM_HOST=127.0.0.1 lo manda a un mosquitto local. */
+
+class SimConexion {
+public:
+  virtual ~SimConexion() {}
+  virtual void recibir(const uint8_t* datos, size_t n) = 0;  // Bytes del firmware
+  virtual void alCerrar() {}
+
+  // Respuesta hacia el firmware
+  void enviar(const uint8_t* datos, size_t n);
+  void cerrar();  // Cierre desde el servidor
+  bool abierta() const { return _abierta; }
+
+  // Uso interno de WiFiClient
+  std::deque<uint8_t>* _rx = nullptr;
+  bool _abierta = true;
+};
+
+typedef SimConexion* (*SimFabricaConexion)(void* ctx);
+void simRedEscuchar(uint16_t puerto, SimFabricaConexion fabrica, void* ctx);
+
+// Corte de red: las conexiones abiertas se caen y connect() falla
+void simRedCortar(bool cortada);
+bool simRedCortada();
+uint32_t simRedConexiones();       // connect() con éxito desde el arranque
+uint32_t simRedConexionesFallidas();
+
+// --- WiFi ---
+struct SimRedWiFi {
+  const char* ssid;
+  const char* pass;
+  int32_t rssi;
+};
+void simWiFiRedes(const SimRedWiFi* redes, size_t n);  // Redes visibles
+void simWiFiAceptarCualquiera(bool aceptar);           // Por defecto true
+void simWiFiCaer();                                    // Simula pérdida de AP
+
+#endif
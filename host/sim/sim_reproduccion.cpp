@@ -0,0 +1,181 @@
+#include "sim_reproduccion.h"
+#include "sim_board.h"
+#include "HardwareSerial.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct BloqueGps {
+  uint32_t ms;
+  std::string bytes;
+};
+
+struct LecturaDht {
+  uint32_t ms;
+  int temp, hum, estado;
+};
+
+struct LecturaLdr {
+  uint32_t ms;
+  uint16_t raw;
+};
+
+static std::vector<BloqueGps> gps;
+static std::vector<LecturaDht> dht;
+static std::vector<LecturaLdr> ldr;
+static bool cargada = false;
+static bool activa = false;
+static uint64_t inicioUs = 0;
+static size_t siguienteGps = 0;
+static uint32_t bytesGps = 0;
+static uint32_t ultimoMs = 0;
+
+// ---------------------------------------------------------
+// CARGA
+// ---------------------------------------------------------
+static int hex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  return 0;
+}
+
+static std::string desescapar(const char* p) {
+  std::string out;
+  for (; *p && *p != '\n' && *p != '\r'; p++) {
+    if (*p != '\\' || !p[1]) {
+      out += *p;
+      continue;
+    }
+    p++;
+    if (*p == 'r') out += '\r';
+    else if (*p == 'n') out += '\n';
+    else if (*p == 'x' && p[1] && p[2]) {
+      out += (char)(hex(p[1]) * 16 + hex(p[2]));
+      p += 2;
+    } else out += *p;
+  }
+  return out;
+}
+
+bool simReproduccionCargar(const char* ruta) {
+  FILE* f = fopen(ruta, "r");
+  if (!f) return false;
+
+  SimHeapAjeno ajeno;
+  gps.clear();
+  dht.clear();
+  ldr.clear();
+  ultimoMs = 0;
+
+  char linea[4096];
+  while (fgets(linea, sizeof(linea), f)) {
+    // En un log serial el registro va tras "CAP:", quizá a mitad de línea
+    const char* p = strstr(linea, "CAP:");
+    p = p ? p + 4 : linea;
+
+    char tipo = p[0];
+    if (p[1] != ' ') continue;
+    char* fin;
+    uint32_t ms = strtoul(p + 2, &fin, 10);
+    if (fin == p + 2 || *fin != ' ') continue;
+    const char* resto = fin + 1;
+
+    if (tipo == 'G') {
+      gps.push_back({ ms, desescapar(resto) });
+    } else if (tipo == 'D') {
+      LecturaDht d = { ms, 0, 0, 0 };
+      if (sscanf(resto, "%d %d %d", &d.temp, &d.hum, &d.estado) != 3) continue;
+      dht.push_back(d);
+    } else if (tipo == 'L') {
+      ldr.push_back({ ms, (uint16_t)atoi(resto) });
+    } else {
+      continue;
+    }
+    if (ms > ultimoMs) ultimoMs = ms;
+  }
+  fclose(f);
+
+  cargada = true;
+  activa = false;
+  // El GPS de la placa lo sustituye la captura
+  simEntorno().gpsActivo = false;
+  simGpsDetener();
+  return !gps.empty() || !dht.empty() || !ldr.empty();
+}
+
+// ---------------------------------------------------------
+// LÍNEA DE TIEMPO
+// ---------------------------------------------------------
+static uint32_t msActual() {
+  return (uint32_t)((simAhoraUs() - inicioUs) / 1000);
+}
+
+// Inyecta el bloque que toca y programa el siguiente
+static void eventoGps(void*) {
+  if (!activa || siguienteGps >= gps.size()) return;
+  const BloqueGps& b = gps[siguienteGps++];
+  bytesGps += simUartInyectar(2, (const uint8_t*)b.bytes.data(), b.bytes.size());
+  if (siguienteGps < gps.size()) {
+    simProgramar(inicioUs + (uint64_t)gps[siguienteGps].ms * 1000, eventoGps, nullptr);
+  }
+}
+
+void simReproduccionIniciar() {
+  if (!cargada) return;
+  activa = true;
+  inicioUs = simAhoraUs();
+  siguienteGps = 0;
+  bytesGps = 0;
+  if (!gps.empty()) simProgramar(inicioUs + (uint64_t)gps[0].ms * 1000, eventoGps, nullptr);
+}
+
+bool simReproduccionActiva() {
+  return activa;
+}
+
+bool simReproduccionTerminada() {
+  return activa && msActual() > ultimoMs;
+}
+
+uint64_t simReproduccionDuracionUs() {
+  return (uint64_t)ultimoMs * 1000;
+}
+
+uint32_t simReproduccionBytesGps() {
+  return bytesGps;
+}
+
+// Último registro con ms <= ahora (o el primero si aún no llega ninguno)
+template <typename T>
+static const T* vigente(const std::vector<T>& v) {
+  if (v.empty()) return nullptr;
+  uint32_t ahora = msActual();
+  size_t lo = 0, hi = v.size();
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (v[mid].ms <= ahora) lo = mid + 1;
+    else hi = mid;
+  }
+  return &v[lo ? lo - 1 : 0];
+}
+
+bool simReproduccionDht(int& temp, int& hum, int& estado) {
+  if (!activa) return false;
+  const LecturaDht* d = vigente(dht);
+  if (!d) return false;
+  temp = d->temp;
+  hum = d->hum;
+  estado = d->estado;
+  return true;
+}
+
+bool simReproduccionLdr(uint16_t& raw) {
+  if (!activa) return false;
+  const LecturaLdr* l = vigente(ldr);
+  if (!l) return false;
+  raw = l->raw;
+  return true;
+}
@@ -0,0 +1,30 @@
+#ifndef SIM_REPRODUCCION_H
+#define SIM_REPRODUCCION_H
+
+#include <stdint.h>
+
+/* =======================
+   REPRODUCCIÓN DE CAPTURAS
+   =======================
+   Alimenta el firmware con una captura de src/captura (archivo de
+   LittleFS o log serial con líneas "CAP:"): los bytes G entran por UART2
+   en su instante y DHT11/ADC del LDR devuelven la última lectura D/L.
+   La línea de tiempo es virtual, así que el resultado es el mismo a
+   cualquier ritmo de ejecución. */
+
+// Carga la captura y apaga el generador NMEA. Llamar antes de setup().
+bool simReproduccionCargar(const char* ruta);
+
+// La captura empieza (ms 0) en el instante virtual actual
+void simReproduccionIniciar();
+
+bool simReproduccionActiva();
+bool simReproduccionTerminada();
+uint64_t simReproduccionDuracionUs();
+uint32_t simReproduccionBytesGps();
+
+// Lectura vigente para los shims. false si no hay reproducción o registros
+bool simReproduccionDht(int& temp, int& hum, int& estado);
+bool simReproduccionLdr(uint16_t& raw);
+
+#endif
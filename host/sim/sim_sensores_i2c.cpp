@@ -0,0 +1,135 @@
+#include "sim_sensores_i2c.h"
+#include "sim_board.h"
+#include <math.h>
+
+// ---------------------------------------------------------
+// BME280
+// ---------------------------------------------------------
+// Calibración de ejemplo de la hoja de datos (T/P) y de un módulo real (H)
+static const uint16_t T1 = 27504;
+static const int16_t T2 = 26435, T3 = -1000;
+static const uint16_t P1 = 36477;
+static const int16_t P2 = -10685, P3 = 3024, P4 = 2855, P5 = 140, P6 = -7, P7 = 15500, P8 = -14600, P9 = 6000;
+static const uint8_t H1 = 75, H3 = 0;
+static const int16_t H2 = 362, H4 = 313, H5 = 50;
+static const int8_t H6 = 30;
+
+static void poner16(uint8_t* r, uint16_t v) {
+  r[0] = v & 0xFF;
+  r[1] = v >> 8;
+}
+
+// Compensación en double (BME280 §8.1)
+static double tFineDe(int32_t adcT) {
+  double v1 = (adcT / 16384.0 - T1 / 1024.0) * T2;
+  double v2 = (adcT / 131072.0 - T1 / 8192.0) * (adcT / 131072.0 - T1 / 8192.0) * T3;
+  return v1 + v2;
+}
+
+static double presionPa(int32_t adcP, double tFine) {
+  double v1 = tFine / 2.0 - 64000.0;
+  double v2 = v1 * v1 * P6 / 32768.0;
+  v2 = v2 + v1 * P5 * 2.0;
+  v2 = v2 / 4.0 + P4 * 65536.0;
+  v1 = (P3 * v1 * v1 / 524288.0 + P2 * v1) / 524288.0;
+  v1 = (1.0 + v1 / 32768.0) * P1;
+  double p = 1048576.0 - adcP;
+  p = (p - v2 / 4096.0) * 6250.0 / v1;
+  v1 = P9 * p * p / 2147483648.0;
+  v2 = p * P8 / 32768.0;
+  return p + (v1 + v2 + P7) / 16.0;
+}
+
+static double humedadPct(int32_t adcH, double tFine) {
+  double h = tFine - 76800.0;
+  h = (adcH - (H4 * 64.0 + H5 / 16384.0 * h)) *
+      (H2 / 65536.0 * (1.0 + H6 / 67108864.0 * h * (1.0 + H3 / 67108864.0 * h)));
+  return h * (1.0 - H1 * h / 524288.0);
+}
+
+// Menor adc en [0, limite) cuyo valor llega al objetivo (f monótona)
+template <typename F>
+static int32_t invertir(F f, double objetivo, int32_t limite, bool creciente) {
+  int32_t lo = 0, hi = limite - 1;
+  while (lo < hi) {
+    int32_t mid = lo + (hi - lo) / 2;
+    bool llega = creciente ? f(mid) >= objetivo : f(mid) <= objetivo;
+    if (llega) hi = mid;
+    else lo = mid + 1;
+  }
+  return lo;
+}
+
+SimBme280::SimBme280(uint8_t chipId) {
+  regs[0xD0] = chipId;
+  const int16_t tp[] = { (int16_t)T1, T2, T3, (int16_t)P1, P2, P3, P4, P5, P6, P7, P8, P9 };
+  for (int i = 0; i < 12; i++) poner16(regs + 0x88 + 2 * i, (uint16_t)tp[i]);
+  regs[0xA1] = H1;
+  poner16(regs + 0xE1, (uint16_t)H2);
+  regs[0xE3] = H3;
+  regs[0xE4] = (uint8_t)(H4 >> 4);
+  regs[0xE5] = (uint8_t)((H4 & 0x0F) | ((H5 & 0x0F) << 4));
+  regs[0xE6] = (uint8_t)(H5 >> 4);
+  regs[0xE7] = (uint8_t)H6;
+  // Valores de reset de los registros de datos
+  regs[0xF7] = regs[0xFA] = regs[0xFD] = 0x80;
+}
+
+void SimBme280::medir() {
+  // Modo sleep: los registros de datos no cambian
+  if ((regs[0xF4] & 0x03) == 0) return;
+
+  int32_t adcT = invertir([](int32_t a) { return tFineDe(a) / 5120.0; }, simTemperatura(), 1 << 20, true);
+  double tFine = tFineDe(adcT);
+  int32_t adcP = invertir([&](int32_t a) { return presionPa(a, tFine); }, presionHpa * 100.0, 1 << 20, false);
+
+  regs[0xF7] = adcP >> 12;
+  regs[0xF8] = (adcP >> 4) & 0xFF;
+  regs[0xF9] = (adcP & 0x0F) << 4;
+  regs[0xFA] = adcT >> 12;
+  regs[0xFB] = (adcT >> 4) & 0xFF;
+  regs[0xFC] = (adcT & 0x0F) << 4;
+
+  if (regs[0xD0] == 0x60 && (regs[0xF2] & 0x07)) {
+    int32_t adcH = invertir([&](int32_t a) { return humedadPct(a, tFine); }, simHumedad(), 1 << 16, true);
+    regs[0xFD] = adcH >> 8;
+    regs[0xFE] = adcH & 0xFF;
+  }
+}
+
+bool SimBme280::escribir(const uint8_t* datos, size_t n) {
+  if (n == 0) return true;  // Sondeo
+  puntero = datos[0];
+  // Escritura en ráfaga: pares registro/valor
+  for (size_t i = 0; i + 1 < n; i += 2) {
+    uint8_t reg = datos[i];
+    if (reg == 0xE0 && datos[i + 1] == 0xB6) regs[0xF2] = regs[0xF4] = regs[0xF5] = 0;  // Soft reset
+    else if (reg >= 0xF2) regs[reg] = datos[i + 1];
+  }
+  return true;
+}
+
+size_t SimBme280::leer(uint8_t* datos, size_t n) {
+  if (puntero >= 0xF7) medir();
+  for (size_t i = 0; i < n; i++) datos[i] = regs[(uint8_t)(puntero + i)];
+  return n;
+}
+
+// ---------------------------------------------------------
+// BH1750
+// ---------------------------------------------------------
+bool SimBh1750::escribir(const uint8_t* datos, size_t n) {
+  if (n == 0) return true;
+  uint8_t c = datos[0];
+  if (c == 0x00) encendido = midiendo = false;
+  else if (c == 0x01) encendido = true;
+  else if (c == 0x10 || c == 0x11 || c == 0x13) midiendo = encendido;
+  return true;
+}
+
+size_t SimBh1750::leer(uint8_t* datos, size_t n) {
+  uint32_t cuenta = midiendo ? (uint32_t)lround(lux * 1.2) : 0;
+  if (cuenta > 0xFFFF) cuenta = 0xFFFF;
+  for (size_t i = 0; i < n; i++) datos[i] = i == 0 ? cuenta >> 8 : i == 1 ? cuenta & 0xFF : 0;
+  return n;
+}
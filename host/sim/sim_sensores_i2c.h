@@ -0,0 +1,40 @@
+#ifndef SIM_SENSORES_I2C_H
+#define SIM_SENSORES_I2C_H
+
+#include "Wire.h"
+
+/* Sensores de expansión para el bus simulado. No se conectan solos: la
+   prueba los cuelga con simI2cConectar() antes de arrancarPlaca(), como
+   quien enchufa un módulo en la cabecera I2C. */
+
+// BME280 (o BMP280 con chipId 0x58). Temperatura y humedad salen del
+// entorno simulado; los ADC se calculan invirtiendo la compensación en
+// coma flotante de la hoja de datos, con la calibración típica de Bosch.
+class SimBme280 : public SimDispositivoI2C {
+public:
+  explicit SimBme280(uint8_t chipId = 0x60);
+  bool escribir(const uint8_t* datos, size_t n) override;
+  size_t leer(uint8_t* datos, size_t n) override;
+
+  double presionHpa = 1013.25;
+
+private:
+  uint8_t regs[256] = {};
+  uint8_t puntero = 0;
+  void medir();
+};
+
+// BH1750 en modo continuo: 'lux' con la cuenta de 1.2 por lux
+class SimBh1750 : public SimDispositivoI2C {
+public:
+  bool escribir(const uint8_t* datos, size_t n) override;
+  size_t leer(uint8_t* datos, size_t n) override;
+
+  double lux = 250.0;
+
+private:
+  bool encendido = false;
+  bool midiendo = false;
+};
+
+#endif
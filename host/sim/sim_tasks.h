@@ -0,0 +1,19 @@
+#ifndef SIM_TASKS_H
+#define SIM_TASKS_H
+
+#include <stdint.h>
+#include "tasks.h"
+
+/* Planificador del host: sustituye a tasks.cpp. Ejecuta pasoTareaX() de
+   cada tarea cuando vence su periodo virtual, siempre de una en una. */
+
+// Corre las tareas durante 'ms' de tiempo virtual
+void simEjecutarMs(uint64_t ms);
+void simEjecutarHastaUs(uint64_t finUs);
+
+uint64_t simPasosTarea(TareaId id);
+uint64_t simPasoMaxUs(TareaId id);       // Paso más largo (tiempo virtual)
+void simReiniciarPasoMax();              // Para medir solo una fase
+uint32_t simDisparosWatchdog();          // Pasos que habrían disparado el TWDT
+
+#endif
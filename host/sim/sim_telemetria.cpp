@@ -0,0 +1,32 @@
+#include "sim_telemetria.h"
+#include "sim_board.h"
+#include <stdio.h>
+
+static FILE* archivo = nullptr;
+static uint64_t registros = 0;
+
+bool simTelemetriaAbrir(const char* ruta) {
+  simTelemetriaCerrar();
+  SimHeapAjeno ajeno;
+  archivo = fopen(ruta, "w");
+  return archivo != nullptr;
+}
+
+void simTelemetriaCerrar() {
+  SimHeapAjeno ajeno;
+  if (archivo) fclose(archivo);
+  archivo = nullptr;
+}
+
+void simTelemetriaRegistrar(const char* canal, const char* a, const char* b) {
+  registros++;
+  if (!archivo) return;
+  SimHeapAjeno ajeno;
+  fprintf(archivo, "%llu\t%s\t%s", (unsigned long long)(simAhoraUs() / 1000), canal, a);
+  if (b) fprintf(archivo, "\t%s", b);
+  fputc('\n', archivo);
+}
+
+uint64_t simTelemetriaRegistros() {
+  return registros;
+}
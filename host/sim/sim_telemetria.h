@@ -0,0 +1,17 @@
+#ifndef SIM_TELEMETRIA_H
+#define SIM_TELEMETRIA_H
+
+#include <stdint.h>
+
+/* Registro de todo lo que el firmware publica (MQTT en el broker simulado
+   y líneas de Influx), una línea por mensaje con el ms virtual:
+     <ms>\tmqtt\t<topic>\t<payload>
+     <ms>\tinflux\t<line protocol>
+   Pensado para comparar con diff la salida de dos versiones del firmware. */
+
+bool simTelemetriaAbrir(const char* ruta);
+void simTelemetriaCerrar();
+void simTelemetriaRegistrar(const char* canal, const char* a, const char* b = nullptr);
+uint64_t simTelemetriaRegistros();
+
+#endif
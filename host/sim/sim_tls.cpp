@@ -0,0 +1,517 @@
+#include "sim_tls.h"
+#include "sim_board.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#ifdef ORION_SIM_TLS_OPENSSL
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#endif
+
+#define TICKET_BYTES 192
+
+// ---------------------------------------------------------
+// LADO SERVIDOR
+// ---------------------------------------------------------
+static SimTls tls;
+static std::map<uint32_t, uint64_t> sesionesServidor;  // id -> emitida (µs virtuales)
+static uint32_t siguienteId = 1;
+static uint32_t completos = 0;
+static uint32_t reanudados = 0;
+
+SimTls& simTls() {
+  return tls;
+}
+
+void simTlsOlvidarSesiones() {
+  SimHeapAjeno ajeno;
+  sesionesServidor.clear();
+}
+
+uint32_t simTlsCompletos() {
+  return completos;
+}
+
+uint32_t simTlsReanudados() {
+  return reanudados;
+}
+
+static bool servidorReanuda(const mbedtls_ssl_session& s) {
+  auto it = sesionesServidor.find(s.id);
+  if (s.id == 0 || it == sesionesServidor.end()) return false;
+  return simAhoraUs() - it->second < (uint64_t)tls.vidaSesionS * 1000000ULL;
+}
+
+static uint32_t servidorEmitir() {
+  SimHeapAjeno ajeno;
+  uint32_t id = siguienteId++;
+  sesionesServidor[id] = simAhoraUs();
+  return id;
+}
+
+// ---------------------------------------------------------
+// SESIONES
+// ---------------------------------------------------------
+void mbedtls_ssl_session_init(mbedtls_ssl_session* s) {
+  memset(s, 0, sizeof(*s));
+}
+
+void mbedtls_ssl_session_free(mbedtls_ssl_session* s) {
+  free(s->ticket);
+#ifdef ORION_SIM_TLS_OPENSSL
+  if (s->real) {
+    SimHeapAjeno ajeno;
+    SSL_SESSION_free((SSL_SESSION*)s->real);
+  }
+#endif
+  memset(s, 0, sizeof(*s));
+}
+
+static int copiarSesion(mbedtls_ssl_session* dst, const mbedtls_ssl_session* src) {
+  mbedtls_ssl_session_free(dst);
+  dst->id = src->id;
+  if (src->ticket) {
+    dst->ticket = (unsigned char*)malloc(src->ticket_len);
+    if (!dst->ticket) return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+    memcpy(dst->ticket, src->ticket, src->ticket_len);
+    dst->ticket_len = src->ticket_len;
+  }
+#ifdef ORION_SIM_TLS_OPENSSL
+  if (src->real) {
+    SSL_SESSION_up_ref((SSL_SESSION*)src->real);
+    dst->real = src->real;
+  }
+#endif
+  return 0;
+}
+
+int mbedtls_ssl_get_session(const mbedtls_ssl_context* ssl, mbedtls_ssl_session* s) {
+  if (ssl->estado != 2 || ssl->actual.id == 0) return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+  return copiarSesion(s, &ssl->actual);
+}
+
+int mbedtls_ssl_set_session(mbedtls_ssl_context* ssl, const mbedtls_ssl_session* s) {
+  return copiarSesion(&ssl->ofrecida, s);
+}
+
+// ---------------------------------------------------------
+// CONFIGURACIÓN
+// ---------------------------------------------------------
+void mbedtls_ssl_config_init(mbedtls_ssl_config* conf) {
+  memset(conf, 0, sizeof(*conf));
+}
+
+void mbedtls_ssl_config_free(mbedtls_ssl_config* conf) {
+  memset(conf, 0, sizeof(*conf));
+}
+
+int mbedtls_ssl_config_defaults(mbedtls_ssl_config* conf, int, int, int) {
+  conf->authmode = MBEDTLS_SSL_VERIFY_REQUIRED;
+  conf->tickets = MBEDTLS_SSL_SESSION_TICKETS_ENABLED;
+  return 0;
+}
+
+void mbedtls_ssl_conf_authmode(mbedtls_ssl_config* conf, int authmode) {
+  conf->authmode = authmode;
+}
+
+void mbedtls_ssl_conf_ca_chain(mbedtls_ssl_config* conf, mbedtls_x509_crt* ca, void*) {
+  conf->ca = ca;
+}
+
+void mbedtls_ssl_conf_rng(mbedtls_ssl_config* conf, int (*f_rng)(void*, unsigned char*, size_t), void* p_rng) {
+  conf->f_rng = f_rng;
+  conf->p_rng = p_rng;
+}
+
+void mbedtls_ssl_conf_verify(mbedtls_ssl_config* conf, int (*f_vrfy)(void*, mbedtls_x509_crt*, int, uint32_t*),
+                             void* p_vrfy) {
+  conf->f_vrfy = f_vrfy;
+  conf->p_vrfy = p_vrfy;
+}
+
+void mbedtls_ssl_conf_session_tickets(mbedtls_ssl_config* conf, int use_tickets) {
+  conf->tickets = use_tickets;
+}
+
+// ---------------------------------------------------------
+// OPENSSL (socket real contra un listener TLS)
+// ---------------------------------------------------------
+#ifdef ORION_SIM_TLS_OPENSSL
+struct TlsReal {
+  SSL_CTX* ctx = nullptr;
+  SSL* ssl = nullptr;
+  BIO* entrada = nullptr;  // Del socket hacia OpenSSL
+  BIO* salida = nullptr;   // De OpenSSL hacia el socket
+  bool eof = false;
+};
+
+static TlsReal* real(const mbedtls_ssl_context* ssl) {
+  return (TlsReal*)ssl->real;
+}
+
+// La CA del firmware, o ORION_SIM_TLS_CA si se prueba con una CA propia
+static bool cargarCa(SSL_CTX* ctx, const mbedtls_x509_crt* ca) {
+  const char* archivo = getenv("ORION_SIM_TLS_CA");
+  if (archivo && archivo[0]) return SSL_CTX_load_verify_locations(ctx, archivo, nullptr) == 1;
+  if (!ca || !ca->raw) return false;
+  BIO* pem = BIO_new_mem_buf(ca->raw, (int)ca->len - 1);
+  X509_STORE* almacen = SSL_CTX_get_cert_store(ctx);
+  int cargados = 0;
+  X509* x;
+  while ((x = PEM_read_bio_X509(pem, nullptr, nullptr, nullptr))) {
+    cargados += X509_STORE_add_cert(almacen, x);
+    X509_free(x);
+  }
+  BIO_free(pem);
+  ERR_clear_error();
+  return cargados > 0;
+}
+
+static int realPreparar(mbedtls_ssl_context* ssl) {
+  TlsReal* r = real(ssl);
+  if (!r->ctx) {
+    r->ctx = SSL_CTX_new(TLS_client_method());
+    // mbedTLS de ESP-IDF negocia TLS 1.2: tickets y ids como en la placa
+    SSL_CTX_set_max_proto_version(r->ctx, TLS1_2_VERSION);
+    SSL_CTX_set_verify(r->ctx, SSL_VERIFY_PEER, nullptr);
+    if (!cargarCa(r->ctx, ssl->conf->ca)) return MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+  }
+  if (r->ssl) SSL_free(r->ssl);
+  r->ssl = SSL_new(r->ctx);
+  r->entrada = BIO_new(BIO_s_mem());
+  r->salida = BIO_new(BIO_s_mem());
+  BIO_set_mem_eof_return(r->entrada, -1);  // Vacío = esperar, no fin de conexión
+  r->eof = false;
+  SSL_set_bio(r->ssl, r->entrada, r->salida);
+  SSL_set_connect_state(r->ssl);
+
+  // El certificado se compara con el host al que de verdad se conectó
+  const char* destino = getenv("ORION_SIM_HOST");
+  if (!destino || !destino[0]) destino = ssl->hostname ? ssl->hostname : "";
+  unsigned char ip[16];
+  X509_VERIFY_PARAM* param = SSL_get0_param(r->ssl);
+  if (inet_pton(AF_INET, destino, ip) == 1) {
+    X509_VERIFY_PARAM_set1_ip_asc(param, destino);
+  } else {
+    SSL_set_tlsext_host_name(r->ssl, destino);
+    X509_VERIFY_PARAM_set1_host(param, destino, 0);
+  }
+  if (ssl->ofrecida.real) SSL_set_session(r->ssl, (SSL_SESSION*)ssl->ofrecida.real);
+  return 0;
+}
+
+// Lo que OpenSSL quiere mandar sale por el BIO del firmware, y lo que
+// llegó por el socket entra a OpenSSL
+static void realBombear(mbedtls_ssl_context* ssl) {
+  TlsReal* r = real(ssl);
+  char buf[2048];
+  int n;
+  while ((n = BIO_read(r->salida, buf, sizeof(buf))) > 0) {
+    for (int hecho = 0; hecho < n;) {
+      int w = ssl->f_send(ssl->p_bio, (const unsigned char*)buf + hecho, n - hecho);
+      if (w <= 0) return;
+      hecho += w;
+    }
+  }
+  for (;;) {
+    n = ssl->f_recv(ssl->p_bio, (unsigned char*)buf, sizeof(buf));
+    if (n == 0) r->eof = true;
+    if (n <= 0) return;
+    BIO_write(r->entrada, buf, n);
+  }
+}
+
+static int realHandshake(mbedtls_ssl_context* ssl) {
+  SimHeapAjeno ajeno;
+  TlsReal* r = real(ssl);
+  if (ssl->estado == 0) {
+    int ret = realPreparar(ssl);
+    if (ret) return ret;
+    ssl->estado = 1;
+  }
+  realBombear(ssl);
+  // SSL_get_error antes de tocar los BIO: escribir en ellos borra la espera
+  int ret = SSL_do_handshake(r->ssl);
+  int error = SSL_get_error(r->ssl, ret);
+  realBombear(ssl);
+  if (ret == 1) {
+    if (SSL_session_reused(r->ssl)) {
+      reanudados++;
+    } else {
+      uint32_t flags = 0;
+      if (ssl->conf->f_vrfy) ssl->conf->f_vrfy(ssl->conf->p_vrfy, ssl->conf->ca, 0, &flags);
+      completos++;
+    }
+    mbedtls_ssl_session_free(&ssl->actual);
+    ssl->actual.real = SSL_get1_session(r->ssl);
+    ssl->actual.id = ssl->actual.real ? 1 : 0;
+    ssl->estado = 2;
+    return 0;
+  }
+  if (error == SSL_ERROR_WANT_READ && !r->eof) {
+    usleep(200);  // El listener responde en tiempo real, no virtual
+    return MBEDTLS_ERR_SSL_WANT_READ;
+  }
+  long verificacion = SSL_get_verify_result(r->ssl);
+  const char* motivo = verificacion != X509_V_OK ? X509_verify_cert_error_string(verificacion)
+                                                 : ERR_reason_error_string(ERR_peek_error());
+  fprintf(stderr, "TLS (OpenSSL): %s\n", motivo ? motivo : "conexion cerrada");
+  ERR_clear_error();
+  ssl->estado = 0;
+  return verificacion != X509_V_OK ? MBEDTLS_ERR_X509_CERT_VERIFY_FAILED : MBEDTLS_ERR_SSL_CONN_EOF;
+}
+
+static int realLeer(mbedtls_ssl_context* ssl, unsigned char* buf, size_t len) {
+  SimHeapAjeno ajeno;
+  TlsReal* r = real(ssl);
+  realBombear(ssl);
+  unsigned char c;
+  // Lectura de 0 bytes: solo procesar el registro pendiente (SSL_pending)
+  int ret = len ? SSL_read(r->ssl, buf, (int)len) : SSL_peek(r->ssl, &c, 1);
+  int error = SSL_get_error(r->ssl, ret);
+  realBombear(ssl);
+  if (ret > 0) return len ? ret : 0;
+  ERR_clear_error();
+  if (error == SSL_ERROR_ZERO_RETURN) return MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY;
+  if (error == SSL_ERROR_WANT_READ && !r->eof) return MBEDTLS_ERR_SSL_WANT_READ;
+  return MBEDTLS_ERR_SSL_CONN_EOF;
+}
+
+static int realEscribir(mbedtls_ssl_context* ssl, const unsigned char* buf, size_t len) {
+  SimHeapAjeno ajeno;
+  TlsReal* r = real(ssl);
+  int ret = SSL_write(r->ssl, buf, (int)len);
+  realBombear(ssl);
+  if (ret > 0) return ret;
+  ERR_clear_error();
+  return MBEDTLS_ERR_SSL_CONN_EOF;
+}
+
+static void realLiberar(mbedtls_ssl_context* ssl) {
+  SimHeapAjeno ajeno;
+  TlsReal* r = real(ssl);
+  if (r->ssl) SSL_free(r->ssl);
+  if (r->ctx) SSL_CTX_free(r->ctx);
+  delete r;
+  ssl->real = nullptr;
+}
+#endif
+
+// ---------------------------------------------------------
+// CONTEXTO
+// ---------------------------------------------------------
+void mbedtls_ssl_init(mbedtls_ssl_context* ssl) {
+  memset(ssl, 0, sizeof(*ssl));
+}
+
+void mbedtls_ssl_free(mbedtls_ssl_context* ssl) {
+#ifdef ORION_SIM_TLS_OPENSSL
+  if (ssl->real) realLiberar(ssl);
+#endif
+  free(ssl->in_buf);
+  free(ssl->out_buf);
+  free(ssl->hostname);
+  free(ssl->transitorio);
+  mbedtls_ssl_session_free(&ssl->ofrecida);
+  mbedtls_ssl_session_free(&ssl->actual);
+  memset(ssl, 0, sizeof(*ssl));
+}
+
+// Como el real: los buffers de registro se reservan aquí y viven con el contexto
+int mbedtls_ssl_setup(mbedtls_ssl_context* ssl, const mbedtls_ssl_config* conf) {
+  ssl->conf = conf;
+  ssl->in_buf = (unsigned char*)malloc(MBEDTLS_SSL_IN_CONTENT_LEN + 333);
+  ssl->out_buf = (unsigned char*)malloc(MBEDTLS_SSL_OUT_CONTENT_LEN + 333);
+  if (!ssl->in_buf || !ssl->out_buf) return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+#ifdef ORION_SIM_TLS_OPENSSL
+  if (getenv("ORION_SIM_RED_REAL")) {
+    SimHeapAjeno ajeno;
+    ssl->real = new TlsReal();
+  }
+#endif
+  return 0;
+}
+
+int mbedtls_ssl_session_reset(mbedtls_ssl_context* ssl) {
+  free(ssl->transitorio);
+  ssl->transitorio = nullptr;
+  mbedtls_ssl_session_free(&ssl->ofrecida);
+  mbedtls_ssl_session_free(&ssl->actual);
+  ssl->estado = 0;
+  ssl->in_len = ssl->in_pos = 0;
+  return 0;
+}
+
+int mbedtls_ssl_set_hostname(mbedtls_ssl_context* ssl, const char* hostname) {
+  free(ssl->hostname);
+  ssl->hostname = strdup(hostname);
+  return ssl->hostname ? 0 : MBEDTLS_ERR_SSL_ALLOC_FAILED;
+}
+
+void mbedtls_ssl_set_bio(mbedtls_ssl_context* ssl, void* p_bio, mbedtls_ssl_send_t* f_send,
+                         mbedtls_ssl_recv_t* f_recv, mbedtls_ssl_recv_timeout_t*) {
+  ssl->p_bio = p_bio;
+  ssl->f_send = f_send;
+  ssl->f_recv = f_recv;
+}
+
+// Devuelve WANT_READ hasta que pasa el costo del handshake en tiempo virtual
+int mbedtls_ssl_handshake(mbedtls_ssl_context* ssl) {
+  if (!ssl->in_buf || !ssl->conf) return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+  if (ssl->estado == 2) return 0;
+#ifdef ORION_SIM_TLS_OPENSSL
+  if (ssl->real) return realHandshake(ssl);
+#endif
+
+  if (ssl->estado == 0) {
+    ssl->reanudando = ssl->conf->tickets && servidorReanuda(ssl->ofrecida);
+    uint32_t ms = ssl->reanudando ? tls.reanudadoMs : tls.completoMs;
+    ssl->transitorio = (unsigned char*)malloc(ssl->reanudando ? tls.heapReanudado : tls.heapCompleto);
+    if (!ssl->transitorio) return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+    ssl->listoUs = simAhoraUs() + (uint64_t)ms * 1000;
+    ssl->estado = 1;
+  }
+  if (simAhoraUs() < ssl->listoUs) return MBEDTLS_ERR_SSL_WANT_READ;
+
+  free(ssl->transitorio);
+  ssl->transitorio = nullptr;
+
+  if (ssl->reanudando) {
+    copiarSesion(&ssl->actual, &ssl->ofrecida);
+    reanudados++;
+  } else {
+    // Certificado del servidor: solo en el handshake completo
+    if (ssl->conf->authmode == MBEDTLS_SSL_VERIFY_REQUIRED && (!ssl->conf->ca || !tls.caValida)) {
+      ssl->estado = 0;
+      return MBEDTLS_ERR_X509_CERT_VERIFY_FAILED;
+    }
+    uint32_t flags = 0;
+    if (ssl->conf->f_vrfy) ssl->conf->f_vrfy(ssl->conf->p_vrfy, ssl->conf->ca, 0, &flags);
+    mbedtls_ssl_session_free(&ssl->actual);
+    ssl->actual.id = servidorEmitir();
+    ssl->actual.ticket = (unsigned char*)malloc(TICKET_BYTES);
+    if (ssl->actual.ticket) {
+      memset(ssl->actual.ticket, 0xA5, TICKET_BYTES);
+      ssl->actual.ticket_len = TICKET_BYTES;
+    }
+    completos++;
+  }
+  ssl->estado = 2;
+  return 0;
+}
+
+// ---------------------------------------------------------
+// DATOS (en claro a través del BIO)
+// ---------------------------------------------------------
+int mbedtls_ssl_read(mbedtls_ssl_context* ssl, unsigned char* buf, size_t len) {
+  if (ssl->estado != 2) return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+#ifdef ORION_SIM_TLS_OPENSSL
+  if (ssl->real) return realLeer(ssl, buf, len);
+#endif
+  if (ssl->in_pos == ssl->in_len) {
+    int n = ssl->f_recv(ssl->p_bio, ssl->in_buf, MBEDTLS_SSL_IN_CONTENT_LEN);
+    if (n < 0) return n;
+    if (n == 0) return MBEDTLS_ERR_SSL_CONN_EOF;
+    ssl->in_len = n;
+    ssl->in_pos = 0;
+  }
+  size_t n = ssl->in_len - ssl->in_pos;
+  if (n > len) n = len;
+  if (n) memcpy(buf, ssl->in_buf + ssl->in_pos, n);
+  ssl->in_pos += n;
+  return (int)n;
+}
+
+int mbedtls_ssl_write(mbedtls_ssl_context* ssl, const unsigned char* buf, size_t len) {
+  if (ssl->estado != 2) return MBEDTLS_ERR_SSL_BAD_INPUT_DATA;
+  if (len > MBEDTLS_SSL_OUT_CONTENT_LEN) len = MBEDTLS_SSL_OUT_CONTENT_LEN;
+#ifdef ORION_SIM_TLS_OPENSSL
+  if (ssl->real) return realEscribir(ssl, buf, len);
+#endif
+  return ssl->f_send(ssl->p_bio, buf, len);
+}
+
+size_t mbedtls_ssl_get_bytes_avail(const mbedtls_ssl_context* ssl) {
+#ifdef ORION_SIM_TLS_OPENSSL
+  if (ssl->real) return real(ssl)->ssl ? SSL_pending(real(ssl)->ssl) : 0;
+#endif
+  return ssl->in_len - ssl->in_pos;
+}
+
+int mbedtls_ssl_close_notify(mbedtls_ssl_context* ssl) {
+#ifdef ORION_SIM_TLS_OPENSSL
+  if (ssl->real && real(ssl)->ssl) {
+    SimHeapAjeno ajeno;
+    SSL_shutdown(real(ssl)->ssl);
+    realBombear(ssl);
+  }
+#endif
+  return 0;
+}
+
+// ---------------------------------------------------------
+// CERTIFICADOS Y AZAR
+// ---------------------------------------------------------
+void mbedtls_x509_crt_init(mbedtls_x509_crt* crt) {
+  memset(crt, 0, sizeof(*crt));
+}
+
+// Acepta cualquier PEM con un certificado; guarda una copia como el real
+int mbedtls_x509_crt_parse(mbedtls_x509_crt* crt, const unsigned char* buf, size_t len) {
+  if (len == 0 || buf[len - 1] != '\0' || !strstr((const char*)buf, "-----BEGIN CERTIFICATE-----")) {
+    return MBEDTLS_ERR_X509_INVALID_FORMAT;
+  }
+  free(crt->raw);
+  crt->raw = (unsigned char*)malloc(len);
+  if (!crt->raw) return MBEDTLS_ERR_SSL_ALLOC_FAILED;
+  memcpy(crt->raw, buf, len);
+  crt->len = len;
+  return 0;
+}
+
+void mbedtls_x509_crt_free(mbedtls_x509_crt* crt) {
+  free(crt->raw);
+  memset(crt, 0, sizeof(*crt));
+}
+
+void mbedtls_entropy_init(mbedtls_entropy_context* ctx) {
+  ctx->fuentes = 1;
+}
+
+void mbedtls_entropy_free(mbedtls_entropy_context* ctx) {
+  ctx->fuentes = 0;
+}
+
+int mbedtls_entropy_func(void*, unsigned char* output, size_t len) {
+  for (size_t i = 0; i < len; i++) output[i] = (unsigned char)rand();
+  return 0;
+}
+
+void mbedtls_ctr_drbg_init(mbedtls_ctr_drbg_context* ctx) {
+  ctx->estado = 0;
+}
+
+void mbedtls_ctr_drbg_free(mbedtls_ctr_drbg_context* ctx) {
+  ctx->estado = 0;
+}
+
+int mbedtls_ctr_drbg_seed(mbedtls_ctr_drbg_context* ctx, int (*f_entropy)(void*, unsigned char*, size_t),
+                          void* p_entropy, const unsigned char*, size_t) {
+  return f_entropy(p_entropy, (unsigned char*)&ctx->estado, sizeof(ctx->estado));
+}
+
+int mbedtls_ctr_drbg_random(void* p_rng, unsigned char* output, size_t output_len) {
+  mbedtls_ctr_drbg_context* ctx = (mbedtls_ctr_drbg_context*)p_rng;
+  for (size_t i = 0; i < output_len; i++) {
+    ctx->estado = ctx->estado * 1664525u + 1013904223u;
+    output[i] = (unsigned char)(ctx->estado >> 24);
+  }
+  return 0;
+}
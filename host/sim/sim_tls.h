@@ -0,0 +1,28 @@
+#ifndef SIM_TLS_H
+#define SIM_TLS_H
+
+#include <stdint.h>
+
+/* =======================
+   TLS SIMULADO
+   =======================
+   Lado servidor del shim de mbedTLS (host/sim/mbedtls): cuánto tarda cada
+   handshake en tiempo virtual, cuánto heap toma mientras dura y qué
+   sesiones recuerda el broker para reanudar. Valores de un ESP32 a
+   240 MHz contra un certificado RSA-2048 con ECDHE P-256. */
+
+struct SimTls {
+  uint32_t completoMs = 1800;       // Verificación de cadena + ECDHE + firma
+  uint32_t reanudadoMs = 120;       // Dos idas y vueltas, solo simétrico
+  uint32_t heapCompleto = 24000;    // Reservas temporales del handshake completo
+  uint32_t heapReanudado = 2000;
+  uint32_t vidaSesionS = 7200;      // Como el session_timeout de OpenSSL/mosquitto
+  bool caValida = true;             // false: el certificado no lo firmó esa CA
+};
+
+SimTls& simTls();
+void simTlsOlvidarSesiones();       // Broker reiniciado: su caché queda vacía
+uint32_t simTlsCompletos();
+uint32_t simTlsReanudados();
+
+#endif
@@ -0,0 +1,43 @@
+#include "sim_ui.h"
+#include "sim_tasks.h"
+#include "Adafruit_SSD1306.h"
+
+extern Adafruit_SSD1306 display;
+
+// El filtro EMA del potenciómetro tarda ~30 pasos de UI en asentarse
+#define SIM_UI_ASENTAR_MS 1000
+#define SIM_UI_PULSO_MS 300
+
+void simUiApuntar(uint8_t total, uint8_t indice) {
+  uint32_t paso = 4096 / total;
+  simFijarAnalogico(SIM_PIN_POT, (uint16_t)(paso * indice + paso / 2));
+  simEjecutarMs(SIM_UI_ASENTAR_MS);
+}
+
+void simUiConfirmar() {
+  simPulsarBoton(SIM_PIN_CONFIRMAR);
+  simEjecutarMs(SIM_UI_PULSO_MS);
+}
+
+void simUiBorrar() {
+  simPulsarBoton(SIM_PIN_BORRAR);
+  simEjecutarMs(SIM_UI_PULSO_MS);
+}
+
+void simUiEnviar() {
+  simPulsarBoton(SIM_PIN_ENVIAR);
+  simEjecutarMs(SIM_UI_PULSO_MS);
+}
+
+void simUiElegir(uint8_t total, uint8_t indice) {
+  simUiApuntar(total, indice);
+  simUiConfirmar();
+}
+
+const char* simUiPantalla() {
+  return display.textoVisible();
+}
+
+bool simUiMuestra(const char* fragmento) {
+  return display.muestra(fragmento);
+}
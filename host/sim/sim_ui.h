@@ -0,0 +1,26 @@
+#ifndef SIM_UI_H
+#define SIM_UI_H
+
+#include <stdint.h>
+
+/* Manos del usuario: potenciómetro y botones de la placa. Avanzan el
+   tiempo con el planificador, así que requieren iniciarTareas(). */
+
+#define SIM_PIN_POT 35
+#define SIM_PIN_CONFIRMAR 32
+#define SIM_PIN_BORRAR 33
+#define SIM_PIN_ENVIAR 25
+
+// Gira el potenciómetro al centro del elemento 'indice' de un menú de 'total'
+void simUiApuntar(uint8_t total, uint8_t indice);
+void simUiConfirmar();
+void simUiBorrar();
+void simUiEnviar();
+// Apuntar + confirmar
+void simUiElegir(uint8_t total, uint8_t indice);
+
+// Texto de la pantalla (última imagen enviada al SSD1306)
+const char* simUiPantalla();
+bool simUiMuestra(const char* fragmento);
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef SIM_GPIO_REG_H
+#define SIM_GPIO_REG_H
+
+// Direcciones del ESP32 (GPIO 0-31)
+#define DR_REG_GPIO_BASE   0x3FF44000
+#define GPIO_OUT_REG       (DR_REG_GPIO_BASE + 0x0004)
+#define GPIO_OUT_W1TS_REG  (DR_REG_GPIO_BASE + 0x0008)
+#define GPIO_OUT_W1TC_REG  (DR_REG_GPIO_BASE + 0x000C)
+#define GPIO_IN_REG        (DR_REG_GPIO_BASE + 0x003C)
+
+#endif
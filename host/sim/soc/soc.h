@@ -0,0 +1,13 @@
+#ifndef SIM_SOC_H
+#define SIM_SOC_H
+
+#include <stdint.h>
+
+// Registros de periféricos: el simulador solo modela los de GPIO (gpio_reg.h)
+void simRegEscribir(uint32_t reg, uint32_t valor);
+uint32_t simRegLeer(uint32_t reg);
+
+#define REG_WRITE(reg, val) simRegEscribir((uint32_t)(reg), (uint32_t)(val))
+#define REG_READ(reg)       simRegLeer((uint32_t)(reg))
+
+#endif
@@ -0,0 +1,191 @@
+#include "sim_tasks.h"
+#include "ui_task.h"
+#include "net_task.h"
+#include "io_task.h"
+#include "bus_i2c.h"
+#include "esp_task_wdt.h"
+#include "metrics.h"
+#include "energia.h"
+
+struct TareaSim {
+  const char* nombre;
+  void (*paso)();
+  uint32_t periodoMs;
+  uint32_t pila;
+  HistogramaId histograma;
+  uint64_t proximoUs;
+  uint64_t pasos;
+  uint64_t pasoMaxUs;
+  uint64_t latidoUs;  // Último esp_task_wdt_reset() de la tarea
+  bool esperando;     // Espera larga de bajo consumo (ulTaskNotifyTake)
+  bool notificado;    // tareaDespertar() sin espera que cortar: la próxima no espera
+};
+
+static TareaSim tareas[TAREA_TOTAL] = {
+  { "ui",  pasoTareaUI,  UI_PERIODO_MS,  TAREA_UI_PILA,  HIST_PASO_UI,  0, 0, 0, 0, false, false },
+  { "red", pasoTareaRed, RED_PERIODO_MS, TAREA_RED_PILA, HIST_PASO_RED, 0, 0, 0, 0, false, false },
+  { "io",  pasoTareaIO,  IO_PERIODO_MS,  TAREA_IO_PILA,  HIST_PASO_IO,  0, 0, 0, 0, false, false },
+  { "i2c", pasoTareaI2C, I2C_PERIODO_MS, TAREA_I2C_PILA, HIST_PASO_I2C, 0, 0, 0, 0, false, false },
+};
+
+static bool tareasIniciadas = false;
+static TareaSim* tareaActual = nullptr;
+static uint32_t wdtTimeoutMs = WDT_TIMEOUT_S * 1000;
+static uint32_t disparosWdt = 0;
+
+// ---------------------------------------------------------
+// API DEL FIRMWARE (tasks.h)
+// ---------------------------------------------------------
+void iniciarTareas() {
+  i2cCederBus();
+  uint64_t ahora = simAhoraUs();
+  for (int i = 0; i < TAREA_TOTAL; i++) {
+    tareas[i].proximoUs = ahora;
+    tareas[i].latidoUs = ahora;
+  }
+  tareasIniciadas = true;
+}
+
+void tareaLatido() {
+  if (tareaActual) tareaActual->latidoUs = simAhoraUs();
+}
+
+// Como xTaskNotifyGive: corta la espera larga o deja la notificación pendiente
+void tareaDespertar(TareaId id) {
+  if (id >= TAREA_TOTAL || !tareasIniciadas) return;
+  TareaSim& t = tareas[id];
+  if (!t.esperando) {
+    t.notificado = true;
+    return;
+  }
+  t.esperando = false;
+  if (t.proximoUs > simAhoraUs()) t.proximoUs = simAhoraUs();
+}
+
+void tareaDespertarDesdeISR(TareaId id) {
+  tareaDespertar(id);
+}
+
+uint32_t tareaPilaLibre(TareaId id) {
+  // La pila del host no se parece a la del ESP32: se informa la asignada
+  if (id >= TAREA_TOTAL) return 0;
+  return tareas[id].pila;
+}
+
+void tareasReportarPilas() {
+  for (int i = 0; i < TAREA_TOTAL; i++) {
+    Serial.printf("%s pasos %llu paso max %llu us\n", tareas[i].nombre,
+                  (unsigned long long)tareas[i].pasos, (unsigned long long)tareas[i].pasoMaxUs);
+  }
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) {
+  return tareaActual ? tareaActual->pila : 0;
+}
+
+esp_err_t esp_task_wdt_init(const esp_task_wdt_config_t* cfg) {
+  if (cfg) wdtTimeoutMs = cfg->timeout_ms;
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reconfigure(const esp_task_wdt_config_t* cfg) {
+  return esp_task_wdt_init(cfg);
+}
+
+esp_err_t esp_task_wdt_add(void*) {
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reset() {
+  tareaLatido();
+  return ESP_OK;
+}
+
+// ---------------------------------------------------------
+// PLANIFICADOR
+// ---------------------------------------------------------
+static void ejecutarPaso(TareaSim* t) {
+  simSaltarA(t->proximoUs);
+
+  uint64_t inicio = simAhoraUs();
+  tareaActual = t;
+  t->latidoUs = inicio;
+  t->paso();
+  tareaActual = nullptr;
+  uint64_t fin = simAhoraUs();
+
+  // Sin latido durante más del timeout: en la placa habría reiniciado
+  if (fin - t->latidoUs > (uint64_t)wdtTimeoutMs * 1000) {
+    disparosWdt++;
+    Serial.printf("WDT: tarea %s sin latido %llu ms\n", t->nombre,
+                  (unsigned long long)((fin - t->latidoUs) / 1000));
+  }
+
+  t->pasos++;
+  metricaLatencia(t->histograma, (uint32_t)(fin - inicio));
+  if (fin - inicio > t->pasoMaxUs) t->pasoMaxUs = fin - inicio;
+
+  // Mismo criterio que cuerpoTarea(): bajo consumo, hasta lo próximo
+  // agendado; si no, un paso atrasado no acumula despertares
+  uint64_t periodoUs = (uint64_t)t->periodoMs * 1000;
+  uint32_t esperaMs = energiaEsperaMs((TareaId)(t - tareas), t->periodoMs);
+  energiaContarPaso((uint32_t)inicio, (uint32_t)fin);
+  if (esperaMs > t->periodoMs) {
+    t->proximoUs = t->notificado ? fin : fin + (uint64_t)esperaMs * 1000;
+    t->esperando = !t->notificado;
+    t->notificado = false;
+  }
+  else if (fin - t->proximoUs >= periodoUs) {
+    metricaContar(CNT_PASOS_ATRASADOS);
+    t->proximoUs = fin + 1000;
+  }
+  else t->proximoUs += periodoUs;
+}
+
+void simEjecutarHastaUs(uint64_t finUs) {
+  if (!tareasIniciadas) {
+    simSaltarA(finUs);
+    return;
+  }
+
+  for (;;) {
+    TareaSim* siguiente = nullptr;
+    for (int i = 0; i < TAREA_TOTAL; i++) {
+      // Empate: gana la de menor índice... salvo IO, que tiene más prioridad
+      if (!siguiente || tareas[i].proximoUs < siguiente->proximoUs ||
+          (tareas[i].proximoUs == siguiente->proximoUs && i == TAREA_IO)) {
+        siguiente = &tareas[i];
+      }
+    }
+    // Un evento anterior (botón, GPS) puede despertar a otra tarea desde su ISR
+    uint64_t evento = simProximoEventoUs();
+    if (evento < siguiente->proximoUs && evento <= finUs) {
+      simSaltarA(evento);
+      continue;
+    }
+    if (siguiente->proximoUs > finUs) break;
+    siguiente->esperando = false;
+    ejecutarPaso(siguiente);
+  }
+  simSaltarA(finUs);
+}
+
+void simEjecutarMs(uint64_t ms) {
+  simEjecutarHastaUs(simAhoraUs() + ms * 1000);
+}
+
+uint64_t simPasosTarea(TareaId id) {
+  return id < TAREA_TOTAL ? tareas[id].pasos : 0;
+}
+
+uint64_t simPasoMaxUs(TareaId id) {
+  return id < TAREA_TOTAL ? tareas[id].pasoMaxUs : 0;
+}
+
+void simReiniciarPasoMax() {
+  for (TareaSim& t : tareas) t.pasoMaxUs = 0;
+}
+
+uint32_t simDisparosWatchdog() {
+  return disparosWdt;
+}
@@ -0,0 +1,31 @@
+#ifndef ARRANQUE_H
+#define ARRANQUE_H
+
+#include <Arduino.h>
+#include "sim_tasks.h"
+#include "sim_ui.h"
+#include "sim_broker_mqtt.h"
+
+void setup();
+
+// Índices del menú principal y de Configuracion (ui_task.cpp)
+#define MENU_TOTAL 5
+#define MENU_LOCAL 0
+#define MENU_CLOUD 1
+#define MENU_HIBRIDO 2
+#define MENU_TEST 3
+#define MENU_CONFIG 4
+
+// Tópicos de la placa simulada: su id sale de la MAC de sim_board.cpp
+#define SIM_ID "246f28a1b2c3"
+#define TOPICO(sufijo) "orion/" SIM_ID "/" sufijo
+
+// Arranque común: broker simulado, Serial en silencio y setup() del sketch
+static inline void arrancarPlaca() {
+  simSilenciarSerial(getenv("ORION_SIM_SERIAL") == nullptr);
+  simBrokerIniciar();
+  simHeapLinea();
+  setup();
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "sim_board.h"
+#include "ESPAsyncWebServer.h"
+#include "WebSerial.h"
+#include "Preferences.h"
+#include "HardwareSerial.h"
+#include "ajustes.h"
+#include "InfluxDbClient.h"
+
+extern HardwareSerial gpsSerialIO;
+
+// sensors/state publicados en 'ms' de virtual
+static size_t publicacionesEn(uint32_t ms) {
+  size_t antes = simBrokerContar(TOPICO("sensors/state"));
+  simEjecutarMs(ms);
+  return simBrokerContar(TOPICO("sensors/state")) - antes;
+}
+
+// Ajustes por consola, HTTP y MQTT sin reflashear: se aplican en caliente,
+// todo o nada, y los que difieren del de compilación sobreviven al reinicio
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_HIBRIDO);
+  simEjecutarMs(15000);
+  COMPROBAR(simBrokerConexiones() == 1);
+  COMPROBAR(ajustes.intervaloMs == 5000);
+  COMPROBAR_ENTRE(publicacionesEn(30000), 5, 7);
+
+  // --- Consola: el intervalo cambia sin reiniciar el modo ---
+  COMPROBAR(contiene(simWebSerialEnviar("cfg set intervalo_ms 10000"), "OK: intervalo_ms = 10000"));
+  simEjecutarMs(10000);
+  COMPROBAR_ENTRE(publicacionesEn(30000), 2, 4);
+  std::string lista = simWebSerialEnviar("cfg");
+  COMPROBAR(contiene(lista, "* intervalo_ms") && contiene(lista, "10000 ms") && contiene(lista, "  diag_ms"));
+
+  // Fuera de rango o incoherente: no cambia nada
+  uint32_t secuencia = ajustesSecuencia();
+  COMPROBAR(contiene(simWebSerialEnviar("cfg set intervalo_ms 10"), "Error: intervalo_ms entre"));
+  COMPROBAR(contiene(simWebSerialEnviar("cfg set ldr_max 200"), "debe ser menor que ldr_max"));
+  COMPROBAR(contiene(simWebSerialEnviar("cfg set gps_baudios 12345"), "Error: gps_baudios"));
+  COMPROBAR(contiene(simWebSerialEnviar("cfg set nada 1"), "Error: no existe 'nada'"));
+  COMPROBAR(ajustesSecuencia() == secuencia);
+  COMPROBAR(ajustes.intervaloMs == 10000 && ajustes.ldrMin == 300);
+
+  // Etiqueta de Influx: sin reconectar, en la siguiente escritura
+  COMPROBAR(contiene(simWebSerialEnviar("cfg set ubicacion a,b"), "Error: ubicacion"));
+  COMPROBAR(contiene(simWebSerialEnviar("cfg set ubicacion invernadero_norte"), "OK"));
+  simEjecutarMs(12000);
+  COMPROBAR(contiene(simInfluxLineas().back(), "dispositivo=" SIM_ID ",ubicacion=invernadero_norte "));
+  COMPROBAR(simBrokerConexiones() == 1);
+
+  // --- HTTP: varios a la vez; uno malo tumba a todos ---
+  SimRespuestaHttp r = simHttp("POST", "/config.json", "intervalo_ms=20000&ldr_max=0");
+  COMPROBAR(r.codigo == 400 && contiene(r.cuerpo, "\"error\":\"Error: ldr_max entre"));
+  COMPROBAR(ajustes.intervaloMs == 10000);
+  r = simHttp("POST", "/config.json", "ldr_min=100&ldr_max=3000&ldr_muestras=8");
+  COMPROBAR(r.codigo == 200 && contiene(r.cuerpo, "\"ldr_min\":100") && contiene(r.cuerpo, "\"ldr_max\":3000"));
+  COMPROBAR(ajustes.ldrMin == 100 && ajustes.ldrMax == 3000 && ajustes.ldrMuestras == 8);
+  COMPROBAR(contiene(simHttp("GET", "/config.json").cuerpo, "\"intervalo_ms\":10000"));
+
+  // --- MQTT retenido: la tarea IO cambia los baudios del GPS ---
+  simBrokerPublicar(TOPICO("config/set"), "{\"gps_baudios\":38400,\"rebote_ms\":500}", true);
+  simEjecutarMs(1000);
+  const SimMensajeMqtt* m = simBrokerUltimo(TOPICO("config/result"));
+  COMPROBAR(m && m->payload == "OK: 2 de 2 ajustes cambiados");
+  COMPROBAR(gpsSerialIO.baudRate() == 38400);
+  COMPROBAR(ajustes.reboteMs == 500);
+  const char* estado = simBrokerRetenido(TOPICO("config/state"));
+  COMPROBAR(estado && contiene(estado, "\"gps_baudios\":38400") && contiene(estado, "\"ldr_muestras\":8"));
+  simBrokerPublicar(TOPICO("config/set"), "[1,2]");
+  simEjecutarMs(500);
+  m = simBrokerUltimo(TOPICO("config/result"));
+  COMPROBAR(m && contiene(m->payload, "Error: se espera un objeto JSON"));
+
+  // --- Broker: otro puerto corta la sesión; el de siempre la recupera ---
+  COMPROBAR(contiene(simWebSerialEnviar("cfg set mqtt_puerto 1884"), "OK"));
+  simEjecutarMs(3000);
+  COMPROBAR(simBrokerClientes() == 0);
+  COMPROBAR(contiene(simWebSerialEnviar("cfg reset mqtt_puerto"), "OK"));
+  simEjecutarMs(10000);
+  COMPROBAR(simBrokerClientes() == 1);
+  COMPROBAR(simBrokerConexiones() == 2);
+
+  // --- Reinicio: solo lo que difiere del de compilación quedó en NVS ---
+  ajustesIniciar();
+  COMPROBAR(ajustes.intervaloMs == 10000 && ajustes.ldrMin == 100 && ajustes.gpsBaudios == 38400);
+  COMPROBAR(ajustes.mqttPuerto == 1883);
+  Preferences prefs;
+  prefs.begin("ajustes", true);
+  COMPROBAR(prefs.isKey("intervalo_ms") && !prefs.isKey("mqtt_puerto") && !prefs.isKey("diag_ms"));
+  prefs.end();
+
+  // Reset de todo: vuelven los de compilación y NVS queda vacía
+  simBrokerPublicar(TOPICO("config/set"), "", true);
+  COMPROBAR(contiene(simWebSerialEnviar("cfg reset"), "OK"));
+  simEjecutarMs(1000);
+  ajustesIniciar();
+  COMPROBAR(ajustes.intervaloMs == 5000 && ajustes.ldrMax == 4095 && ajustes.gpsBaudios == 9600);
+  COMPROBAR(gpsSerialIO.baudRate() == 9600);
+  prefs.begin("ajustes", true);
+  COMPROBAR(!prefs.isKey("intervalo_ms"));
+  prefs.end();
+
+  COMPROBAR(simDisparosWatchdog() == 0);
+  simUiBorrar();
+  return FIN_PRUEBA();
+}
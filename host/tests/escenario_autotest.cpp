@@ -0,0 +1,83 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "WebSerial.h"
+#include "ESPAsyncWebServer.h"
+#include "sim_board.h"
+
+#define TEST_TOTAL 8
+#define TEST_COMPLETO 0
+#define TEST_VOLVER 7
+
+// Autodiagnóstico desde la OLED, WebSerial y MQTT
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+
+  // Un relé encendido antes del test debe quedar encendido después
+  simUiElegir(MENU_TOTAL, MENU_TEST);
+  COMPROBAR(simUiMuestra("Autodiagnostico"));
+  simUiElegir(TEST_TOTAL, TEST_COMPLETO);
+  simEjecutarMs(500);
+  COMPROBAR(simUiMuestra("AUTODIAGNOSTICO"));
+  COMPROBAR(simUiMuestra("Etapa: Relay"));
+
+  // El GPS simulado tiene fix pasados 30 s del arranque
+  simEjecutarMs(45000);
+  COMPROBAR(simUiMuestra("RESULTADO: OK"));
+  COMPROBAR(simUiMuestra("GPS fix 3"));
+  COMPROBAR(simUiMuestra("DHT OK 0/10 err"));
+  for (uint8_t pin : { 26, 27, 14, 12, 13 }) COMPROBAR(simNivelPin(pin) == LOW);
+
+  // Vuelta al menú principal y modo local: reporte por HTTP
+  simUiConfirmar();
+  simUiElegir(TEST_TOTAL, TEST_VOLVER);
+  simUiElegir(MENU_TOTAL, MENU_LOCAL);
+  SimRespuestaHttp r = simHttp("GET", "/selftest.json");
+  COMPROBAR(r.codigo == 200);
+  COMPROBAR(contiene(r.cuerpo, "\"ok\":true"));
+  COMPROBAR(contiene(r.cuerpo, "\"reles\":[{\"ok\":true"));
+  COMPROBAR(contiene(r.cuerpo, "\"ttff_ms\":3"));
+  COMPROBAR(contiene(r.cuerpo, "\"errores\":0"));
+
+  // Solo sensores, con el DHT roto y un relé encendido por el usuario
+  simWebSerialEnviar("relay set 1 on");
+  simEntorno().dhtTasaError = 1.0;
+  COMPROBAR(contiene(simWebSerialEnviar("selftest run sensors"), "iniciado"));
+  COMPROBAR(contiene(simWebSerialEnviar("selftest run"), "en curso"));
+  simEjecutarMs(25000);
+  std::string rep = simWebSerialEnviar("selftest");
+  COMPROBAR(contiene(rep, "\"ok\":false"));
+  COMPROBAR(contiene(rep, "\"errores\":10"));
+  COMPROBAR(contiene(rep, "\"ldr\":{\"ok\":true"));
+  COMPROBAR(!contiene(rep, "\"reles\""));
+  COMPROBAR(simNivelPin(26) == HIGH);
+
+  // Relés desde WebSerial: el relé 1 vuelve a quedar encendido
+  simEntorno().dhtTasaError = 0.0;
+  simWebSerialEnviar("selftest run relays");
+  simEjecutarMs(5000);
+  rep = simWebSerialEnviar("selftest");
+  COMPROBAR(contiene(rep, "\"ok\":true"));
+  COMPROBAR(simNivelPin(26) == HIGH);
+  COMPROBAR(simNivelPin(27) == LOW);
+
+  // Cancelar deja el reporte anterior
+  simWebSerialEnviar("selftest run");
+  simEjecutarMs(1000);
+  simWebSerialEnviar("selftest stop");
+  simEjecutarMs(100);
+  COMPROBAR(simWebSerialEnviar("selftest") == rep);
+
+  // Desde Home Assistant: selftest/set -> selftest/report retenido
+  simUiBorrar();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  simEjecutarMs(5000);
+  simBrokerPublicar(TOPICO("selftest/set"), "RUN");
+  simEjecutarMs(30000);
+  const char* retenido = simBrokerRetenido(TOPICO("selftest/report"));
+  COMPROBAR(retenido && contiene(retenido, "\"gps\":{\"ok\":true"));
+
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
@@ -0,0 +1,69 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "WebSerial.h"
+#include "ESPAsyncWebServer.h"
+#include "LittleFS.h"
+#include "captura.h"
+#include "sim_reproduccion.h"
+#include <stdio.h>
+
+static size_t contarLineas(const std::string& s, const char* inicio) {
+  size_t n = 0;
+  for (size_t p = 0; p < s.size(); p = s.find('\n', p) + 1) {
+    if (s.compare(p, strlen(inicio), inicio) == 0) n++;
+    if (s.find('\n', p) == std::string::npos) break;
+  }
+  return n;
+}
+
+// cap start fs / cap stop en modo local y reproducción de lo capturado
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_LOCAL);
+
+  COMPROBAR(contiene(simWebSerialEnviar("cap start fs"), "Captura"));
+  simEjecutarMs(100);
+  COMPROBAR(contiene(simWebSerialEnviar("cap info"), "LittleFS " CAPTURA_ARCHIVO));
+
+  // Mientras escribe, el archivo no se descarga
+  COMPROBAR(simHttp("GET", CAPTURA_ARCHIVO).codigo == 409);
+
+  // 40 s: entra el fix del GPS (30 s) y ~20 lecturas de DHT
+  simEjecutarMs(40000);
+  simWebSerialEnviar("cap stop");
+  simEjecutarMs(100);
+  COMPROBAR(contiene(simWebSerialEnviar("cap"), "apagada"));
+
+  SimRespuestaHttp r = simHttp("GET", CAPTURA_ARCHIVO);
+  COMPROBAR(r.codigo == 200);
+  COMPROBAR(r.cuerpo.compare(0, 17, "# orion-captura 1") == 0);
+  COMPROBAR(contiene(r.cuerpo, "$GPGGA"));
+  COMPROBAR_ENTRE(contarLineas(r.cuerpo, "D "), 18, 22);
+  COMPROBAR(contarLineas(r.cuerpo, "L ") >= 40);
+  COMPROBAR(contarLineas(r.cuerpo, "G ") >= 40);
+
+  // Temperatura de la primera lectura capturada
+  int tempCapturada = -1;
+  size_t d = r.cuerpo.find("\nD ");
+  COMPROBAR(d != std::string::npos && sscanf(r.cuerpo.c_str() + d, "\nD %*u %d", &tempCapturada) == 1);
+
+  // Reproducción: el entorno cambia pero la placa ve lo grabado
+  simEntorno().tempMedia = 40.0;
+  simEntorno().tempAmplitud = 0.0;
+  COMPROBAR(simReproduccionCargar(simFsRuta(CAPTURA_ARCHIVO).c_str()));
+  simReproduccionIniciar();
+  simEjecutarMs(5000);
+  COMPROBAR(simReproduccionBytesGps() > 0);
+
+  std::string dht = simWebSerialEnviar("sensor dht");
+  char esperado[32];
+  snprintf(esperado, sizeof(esperado), "DHT: %dC", tempCapturada);
+  COMPROBAR(contiene(dht, esperado));
+  COMPROBAR(!contiene(dht, "DHT: 40C"));
+
+  simEjecutarMs(40000);
+  COMPROBAR(simReproduccionTerminada());
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
@@ -0,0 +1,81 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "InfluxDbClient.h"
+#include "sim_red.h"
+#include "WebSerial.h"
+
+// Ciclo de publicación y comandos de Home Assistant
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  simEjecutarMs(12000);
+
+  // Identidad de la MAC: tópicos, Discovery y etiquetas de Influx
+  COMPROBAR(simBrokerConexiones() == 1);
+  COMPROBAR(simBrokerFiltros() == 1);  // orion/<id>/+/set
+  const char* config = simBrokerRetenido("homeassistant/light/orion_" SIM_ID "/relay1/config");
+  COMPROBAR(config && strstr(config, "\"uniq_id\":\"orion_" SIM_ID "_relay1\""));
+  COMPROBAR(config && strstr(config, "\"~\":\"orion/" SIM_ID "\""));
+  COMPROBAR(!simInfluxLineas().empty() && simInfluxLineas().back().find("dispositivo=" SIM_ID) != std::string::npos);
+  COMPROBAR(simBrokerContar(TOPICO("sensors/state")) >= 1);
+  COMPROBAR(simInfluxEscrituras() >= 1);
+  COMPROBAR(simUiMuestra("MQTT: ON"));
+
+  const SimMensajeMqtt* m = simBrokerUltimo(TOPICO("sensors/state"));
+  COMPROBAR(m && m->payload.find("\"temperature\"") != std::string::npos);
+
+  // 5 s entre publicaciones
+  size_t antes = simBrokerContar(TOPICO("sensors/state"));
+  simEjecutarMs(60000);
+  COMPROBAR_ENTRE(simBrokerContar(TOPICO("sensors/state")) - antes, 11, 13);
+
+  // Relé desde Home Assistant: pin y tópico de estado
+  simBrokerPublicar(TOPICO("relay3/set"), "ON");
+  simEjecutarMs(200);
+  COMPROBAR(simNivelPin(14) == HIGH);
+  m = simBrokerUltimo(TOPICO("relay3/state"));
+  COMPROBAR(m && m->payload == "ON");
+
+  // Pulso de cerradura: abre y se cierra sola a los 3 s
+  simBrokerPublicar(TOPICO("lock/set"), "UNLOCK");
+  simEjecutarMs(200);
+  COMPROBAR(simNivelPin(13) == HIGH);
+  simEjecutarMs(3200);
+  COMPROBAR(simNivelPin(13) == LOW);
+  m = simBrokerUltimo(TOPICO("lock/state"));
+  COMPROBAR(m && m->payload == "LOCKED");
+
+  // Caída del broker: reconecta sin bloquear la UI
+  simRedCortar(true);
+  simEjecutarMs(5000);
+  simRedCortar(false);
+  simEjecutarMs(10000);
+  COMPROBAR(simBrokerConexiones() == 2);
+
+  // Borrar sale al menú y cierra la sesión MQTT
+  simUiBorrar();
+  simEjecutarMs(500);
+  COMPROBAR(simBrokerClientes() == 0);
+
+  // Id desde NVS: la siguiente entrada usa los tópicos nuevos
+  simUiElegir(MENU_TOTAL, MENU_LOCAL);
+  COMPROBAR(simWebSerialEnviar("sys id Placa/1").find("Error") != std::string::npos);
+  COMPROBAR(simWebSerialEnviar("sys id invernadero-3").find("orion/invernadero-3/") != std::string::npos);
+  simUiBorrar();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  simEjecutarMs(12000);
+  COMPROBAR(simBrokerRetenido("homeassistant/light/orion_invernadero-3/relay1/config") != nullptr);
+  simBrokerPublicar("orion/invernadero-3/relay4/set", "ON");
+  simBrokerPublicar(TOPICO("relay2/set"), "ON");  // El id viejo ya no escucha
+  simEjecutarMs(200);
+  COMPROBAR(simNivelPin(12) == HIGH);
+  COMPROBAR(simNivelPin(27) == LOW);
+  m = simBrokerUltimo("orion/invernadero-3/relay4/state");
+  COMPROBAR(m && m->payload == "ON");
+  simUiBorrar();
+  simEjecutarMs(500);
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
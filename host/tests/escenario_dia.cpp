@@ -0,0 +1,31 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "InfluxDbClient.h"
+#include "metrics.h"
+
+// Un día completo en modo cloud: ritmo de publicación, heap y watchdog
+int main() {
+  simEntorno().dhtTasaError = 0.02;
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  simEjecutarMs(60000);
+
+  metricasMuestrearSistema();
+  int32_t heapInicial = metricaMedidor(MED_HEAP_LIBRE);
+
+  simEjecutarMs(24ULL * 3600 * 1000);
+
+  metricasMuestrearSistema();
+  size_t publicaciones = simBrokerContar(TOPICO("sensors/state"));
+  COMPROBAR_ENTRE(publicaciones, 17000, 17400);  // 86400 s / 5 s
+  COMPROBAR_ENTRE(simInfluxEscrituras(), 17000, 17400);
+  COMPROBAR(simBrokerConexiones() == 1);
+  COMPROBAR(simDisparosWatchdog() == 0);
+  COMPROBAR(simUartDesbordes(2) == 0);
+  COMPROBAR(metricaContador(CNT_DHT_ERRORES) > 0);
+
+  // Sin fugas: el heap libre no baja más de 4 KB en 24 h
+  COMPROBAR(heapInicial - metricaMedidor(MED_HEAP_LIBRE) < 4096);
+  return FIN_PRUEBA();
+}
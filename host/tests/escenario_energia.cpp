@@ -0,0 +1,147 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "sim_board.h"
+#include "WebSerial.h"
+#include "WiFi.h"
+#include "driver/gpio.h"
+#include "ajustes.h"
+#include "energia.h"
+#include "trayecto.h"
+#include "metrics.h"
+#include <ArduinoJson.h>
+
+#define PIN_GPS_RX 16
+
+static size_t publicacionesEn(uint32_t ms) {
+  size_t antes = simBrokerContar(TOPICO("sensors/state"));
+  simEjecutarMs(ms);
+  return simBrokerContar(TOPICO("sensors/state")) - antes;
+}
+
+// En Cloud no hay consola: los ajustes llegan por config/set
+static bool ajustar(const char* json) {
+  simBrokerPublicar(TOPICO("config/set"), json);
+  simEjecutarMs(ajustes.latenciaMs + 100);
+  const SimMensajeMqtt* m = simBrokerUltimo(TOPICO("config/result"));
+  return m && contiene(m->payload, "OK");
+}
+
+static uint32_t fixesGps() {
+  EstadisticaTrayecto est;
+  trayectoEstadistica(est);
+  return est.recibidos;
+}
+
+// Despierto (‰) y corriente media de los últimos 'ms' de virtual
+static void medir(uint32_t ms, ResumenEnergia& r) {
+  energiaReiniciar();
+  simEjecutarMs(ms);
+  energiaResumen(r);
+}
+
+static double fraccionDespierto(const ResumenEnergia& r) {
+  return (double)(r.ocupadoUs + r.ociosoUs) / (r.ocupadoUs + r.ociosoUs + r.suenoUs);
+}
+
+// Bajo consumo en Cloud: las tareas duermen hasta su próxima ventana, el
+// light sleep apaga la CPU y el broker, los botones y el GPS no lo notan
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  simEjecutarMs(40000);  // Primer fix del GPS a los 30 s
+  COMPROBAR(simBrokerConexiones() == 1);
+
+  // --- Referencia: ticks de 5-20 ms, siempre despierto a 240 MHz ---
+  ResumenEnergia base;
+  medir(60000, base);
+  COMPROBAR(!base.activa && base.suenoUs == 0);
+  COMPROBAR(simPm().mhzMin == 240 && !simPm().suenoLigero);
+  COMPROBAR(base.promedioUa > 25000);
+
+  // --- Bajo consumo ---
+  COMPROBAR(ajustar("{\"bajo_consumo\":1}"));
+  simEjecutarMs(1000);
+  COMPROBAR(energiaActiva());
+  SimPm pm = simPm();
+  COMPROBAR(pm.mhzMax == 240 && pm.mhzMin == 80 && pm.suenoLigero && pm.despertarGpio);
+  COMPROBAR(WiFi.getSleep() == WIFI_PS_MAX_MODEM);
+  COMPROBAR(simPinDespierta(SIM_PIN_CONFIRMAR) && simPinDespierta(SIM_PIN_BORRAR) && simPinDespierta(SIM_PIN_ENVIAR));
+  COMPROBAR(simPinDespierta(PIN_GPS_RX));
+  COMPROBAR(simTipoInterrupcion(SIM_PIN_ENVIAR) == GPIO_INTR_LOW_LEVEL);
+
+  // Misma cadencia de sensores; el GPS sigue llegando a 1 Hz
+  uint32_t fixes = fixesGps();
+  COMPROBAR_ENTRE(publicacionesEn(60000), 11, 13);
+  COMPROBAR_ENTRE(fixesGps() - fixes, 55, 61);
+
+  ResumenEnergia r;
+  medir(60000, r);
+  COMPROBAR(r.activa && r.suenoLigero && r.despertares > 0);
+  COMPROBAR(fraccionDespierto(r) < 0.2);
+  COMPROBAR(r.promedioUa * 4 < base.promedioUa);
+
+  // --- 10 min sin que el broker corte por keepalive ---
+  simEjecutarMs(600000);
+  COMPROBAR(simBrokerExpiradas() == 0);
+  COMPROBAR(simBrokerConexiones() == 1);
+
+  // diag/state con todas las claves: JSON entero, nada descartado
+  const SimMensajeMqtt* diag = simBrokerUltimo(TOPICO("diag/state"));
+  StaticJsonDocument<2048> doc;
+  COMPROBAR(diag && !deserializeJson(doc, diag->payload.c_str()) && doc["energia_ua"].as<uint32_t>() > 0 && doc["energia_ua"].as<uint32_t>() < base.promedioUa);
+  COMPROBAR(metricaContador(CNT_DIAG_DESCARTES) == 0);
+
+  // Orden MQTT: atendida dentro de latencia_ms (la red duerme hasta entonces)
+  simEjecutarMs(1234);
+  simBrokerPublicar(TOPICO("relay2/set"), "ON");
+  uint64_t orden = simAhoraUs();
+  simEjecutarMs(ajustes.latenciaMs + 100);
+  const SimMensajeMqtt* m = simBrokerUltimo(TOPICO("relay2/state"));
+  COMPROBAR(simNivelPin(27) == HIGH);
+  COMPROBAR(m && m->payload == "ON" && m->tUs - orden <= (ajustes.latenciaMs + 50) * 1000ull);
+
+  // Latencia mayor: sube el keepalive y reconecta una vez
+  COMPROBAR(ajustar("{\"latencia_ms\":10000}"));
+  simEjecutarMs(15000);
+  COMPROBAR(simBrokerConexiones() == 2);
+  medir(60000, r);
+  COMPROBAR(fraccionDespierto(r) < 0.2);
+  simEjecutarMs(300000);
+  COMPROBAR(simBrokerExpiradas() == 0 && simBrokerConexiones() == 2);
+
+  // --- Sin tickless idle en el sdkconfig: queda solo DFS ---
+  simPmTicklessIdle(false);
+  COMPROBAR(ajustar("{\"bajo_consumo\":0}"));
+  simEjecutarMs(1000);
+  COMPROBAR(!energiaActiva() && simPm().mhzMin == 240);
+  COMPROBAR(ajustar("{\"bajo_consumo\":1}"));
+  simEjecutarMs(1000);
+  pm = simPm();
+  COMPROBAR(energiaActiva() && !pm.suenoLigero && pm.mhzMin == 80);
+  medir(60000, r);
+  COMPROBAR(r.suenoUs == 0 && r.promedioUa < base.promedioUa);
+  simPmTicklessIdle(true);
+
+  // --- Un botón la despierta: Borrar sale de Cloud y todo vuelve ---
+  simUiBorrar();
+  simEjecutarMs(500);
+  COMPROBAR(simBrokerClientes() == 0);
+  COMPROBAR(!energiaActiva());
+  pm = simPm();
+  COMPROBAR(pm.mhzMin == 240 && pm.cerrojos == 0);
+  COMPROBAR(WiFi.getSleep() != WIFI_PS_MAX_MODEM);
+  COMPROBAR(!simPinDespierta(SIM_PIN_BORRAR) && !simPinDespierta(PIN_GPS_RX));
+  COMPROBAR(simTipoInterrupcion(SIM_PIN_BORRAR) == GPIO_INTR_NEGEDGE);
+
+  // Fuera de Cloud queda en espera; "sys energia" lo dice
+  simUiElegir(MENU_TOTAL, MENU_HIBRIDO);
+  simEjecutarMs(15000);
+  COMPROBAR(!energiaActiva() && simPm().mhzMin == 240);
+  std::string resumen = simWebSerialEnviar("sys energia");
+  COMPROBAR(contiene(resumen, "en espera") && contiene(resumen, "Corriente media estimada"));
+  COMPROBAR(contiene(simWebSerialEnviar("sys energia reset"), "OK"));
+
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
@@ -0,0 +1,89 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "sim_board.h"
+#include "WebSerial.h"
+#include "escenas.h"
+
+// Relés 1-4 y cerradura (io_task.cpp)
+static const uint8_t pines[ESCENA_SALIDAS] = { 26, 27, 14, 12, 13 };
+
+static uint32_t escriturasDigitales() {
+  uint32_t total = 0;
+  for (uint8_t p : pines) total += simEscriturasPin(p);
+  return total;
+}
+
+// Escenas: guardar, aplicar con dos escrituras de registro, un solo estado MQTT y NVS
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_HIBRIDO);
+  simEjecutarMs(12000);
+  COMPROBAR(simBrokerConexiones() == 1);
+
+  COMPROBAR(contiene(simWebSerialEnviar("scene list"), "Sin escenas"));
+  COMPROBAR(contiene(simWebSerialEnviar("scene save noche relay1=on relay2=on relay3=off relay4=off lock=off"),
+                     "OK: escena noche"));
+  COMPROBAR(contiene(simWebSerialEnviar("scene save pasillo relay3=on"), "OK: escena pasillo"));
+
+  // Cinco salidas, dos escrituras (W1TS y W1TC) y ningún digitalWrite()
+  uint32_t registros = simEscriturasRegistroGpio();
+  uint32_t digitales = escriturasDigitales();
+  size_t estados = simBrokerContar(TOPICO("actuators/state"));
+  WebSerial.salida.clear();
+  COMPROBAR(contiene(simWebSerialEnviar("scene run noche"), "OK: escena noche"));
+  simEjecutarMs(100);
+  COMPROBAR(simNivelPin(26) == HIGH && simNivelPin(27) == HIGH);
+  COMPROBAR(simNivelPin(14) == LOW && simNivelPin(12) == LOW && simNivelPin(13) == LOW);
+  COMPROBAR(simEscriturasRegistroGpio() - registros == 2);
+  COMPROBAR(escriturasDigitales() == digitales);
+  COMPROBAR(contiene(WebSerial.salida, "Escena noche aplicada (sesgo"));
+
+  // Un único mensaje consolidado, con la escena y el sesgo medido
+  COMPROBAR(simBrokerContar(TOPICO("actuators/state")) == estados + 1);
+  const char* estado = simBrokerRetenido(TOPICO("actuators/state"));
+  COMPROBAR(estado && contiene(estado, "\"relay1\":\"ON\",\"relay2\":\"ON\",\"relay3\":\"OFF\""));
+  COMPROBAR(contiene(estado, "\"lock\":\"LOCKED\",\"scene\":\"noche\",\"skew_ns\":"));
+  // Los tópicos por salida no quedan atrasados
+  estado = simBrokerRetenido(TOPICO("relay2/state"));
+  COMPROBAR(estado && std::string(estado) == "ON");
+
+  // Desde Home Assistant: solo toca el relé 3, los demás quedan como estaban
+  registros = simEscriturasRegistroGpio();
+  simBrokerPublicar(TOPICO("scenes/set"), "run pasillo");
+  simEjecutarMs(200);
+  COMPROBAR(simNivelPin(14) == HIGH && simNivelPin(26) == HIGH && simNivelPin(12) == LOW);
+  COMPROBAR(simEscriturasRegistroGpio() - registros == 1);
+  const SimMensajeMqtt* m = simBrokerUltimo(TOPICO("scenes/result"));
+  COMPROBAR(m && m->payload == "OK: escena pasillo");
+  estado = simBrokerRetenido(TOPICO("actuators/state"));
+  COMPROBAR(estado && contiene(estado, "\"relay3\":\"ON\"") && contiene(estado, "\"scene\":\"pasillo\",\"skew_ns\":0"));
+
+  // Sin salidas: foto del estado actual
+  COMPROBAR(contiene(simWebSerialEnviar("scene save todo"), "OK: escena todo"));
+  COMPROBAR(contiene(simWebSerialEnviar("scene list"),
+                     "todo         relay1=on relay2=on relay3=on relay4=off lock=off"));
+
+  // Errores
+  COMPROBAR(contiene(simWebSerialEnviar("scene run nada"), "no existe"));
+  COMPROBAR(contiene(simWebSerialEnviar("scene foo todo"), "Error: orden desconocida 'foo'"));
+  COMPROBAR(contiene(simWebSerialEnviar("scene save x relay9=on"), "Error: 'relay9=on'"));
+  COMPROBAR(contiene(simWebSerialEnviar("scene save nombre_demasiado_largo"), "Error: nombre"));
+  simBrokerPublicar(TOPICO("scenes/set"), "run nada");
+  simEjecutarMs(200);
+  m = simBrokerUltimo(TOPICO("scenes/result"));
+  COMPROBAR(m && contiene(m->payload, "no existe"));
+
+  // Sobreviven a un reinicio (NVS)
+  COMPROBAR(contiene(simWebSerialEnviar("scene del pasillo"), "borrada"));
+  escenasIniciar();
+  std::string lista = simWebSerialEnviar("scene list");
+  COMPROBAR(contiene(lista, "noche        relay1=on relay2=on relay3=off relay4=off lock=off"));
+  COMPROBAR(!contiene(lista, "pasillo      relay3=on"));
+  simWebSerialEnviar("scene run noche");
+  simEjecutarMs(100);
+  COMPROBAR(simNivelPin(14) == LOW);
+
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
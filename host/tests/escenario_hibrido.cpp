@@ -0,0 +1,83 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "InfluxDbClient.h"
+#include "sim_ntp.h"
+#include "ESPAsyncWebServer.h"
+#include "WebSerial.h"
+
+// Local y Cloud a la vez, y cambios de modo con Enviar sin reiniciar servicios
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_LOCAL);
+  simEjecutarMs(2000);
+  COMPROBAR(simHttpServidoresActivos() == 1);
+  COMPROBAR(simBrokerConexiones() == 0);
+
+  // Local -> Híbrido: el servidor sigue y se suma MQTT/Influx
+  simUiEnviar();
+  simEjecutarMs(12000);
+  COMPROBAR(simUiMuestra("MODO HIBRIDO"));
+  COMPROBAR(simUiMuestra("MQTT: ON"));
+  COMPROBAR(simHttpServidoresActivos() == 1);
+  COMPROBAR(WebSerial.inicios == 1);
+  COMPROBAR(simBrokerConexiones() == 1);
+  COMPROBAR(simBrokerContar(TOPICO("sensors/state")) >= 1);
+  COMPROBAR(simHttp("GET", "/history.json?campo=temp&rango=1h").codigo == 200);
+
+  // Relé desde la consola: su tópico de estado (retenido) en el mismo paso de red
+  COMPROBAR(contiene(simWebSerialEnviar("relay set 2 on"), "OK: Relay 2 ENCENDIDO"));
+  simEjecutarMs(60);
+  const char* estado = simBrokerRetenido(TOPICO("relay2/state"));
+  COMPROBAR(estado && std::string(estado) == "ON");
+
+  // Relé desde Home Assistant: aviso en la consola
+  WebSerial.salida.clear();
+  simBrokerPublicar(TOPICO("relay3/set"), "ON");
+  simEjecutarMs(200);
+  COMPROBAR(simNivelPin(14) == HIGH);
+  COMPROBAR(contiene(WebSerial.salida, "[Cloud] Relay 3 ENCENDIDO"));
+
+  // Híbrido -> Cloud: MQTT no se corta, el servidor web se cierra
+  simUiEnviar();
+  simEjecutarMs(6000);
+  COMPROBAR(simUiMuestra("== MODO CLOUD =="));
+  COMPROBAR(simHttpServidoresActivos() == 0);
+  COMPROBAR(simBrokerConexiones() == 1);
+  COMPROBAR(simBrokerClientes() == 1);
+
+  // Cloud -> Local -> Híbrido: ni reloj ni Influx se vuelven a preparar
+  simUiEnviar();
+  simEjecutarMs(1000);
+  COMPROBAR(simBrokerClientes() == 0);
+  COMPROBAR(simHttpServidoresActivos() == 1);
+  COMPROBAR(contiene(simWebSerialEnviar("relay set 2 off"), "OK: Relay 2 APAGADO"));
+  simUiEnviar();
+  simEjecutarMs(6000);
+  COMPROBAR(simBrokerConexiones() == 2);
+  COMPROBAR(simNtpArranques() == 1);
+  COMPROBAR(WebSerial.inicios == 1);
+  // El cambio hecho sin sesión se publica al reconectar
+  estado = simBrokerRetenido(TOPICO("relay2/state"));
+  COMPROBAR(estado && std::string(estado) == "OFF");
+
+  // "sys id" en Híbrido: no hay próxima entrada a Cloud, reconecta ya con el nuevo
+  uint32_t conexiones = simBrokerConexiones();
+  COMPROBAR(contiene(simWebSerialEnviar("sys id invernadero-3"), "orion/invernadero-3/"));
+  simEjecutarMs(3000);
+  COMPROBAR(simBrokerConexiones() == conexiones + 1);
+  COMPROBAR(simBrokerRetenido("homeassistant/light/orion_invernadero-3/relay1/config") != nullptr);
+  simBrokerPublicar("orion/invernadero-3/relay4/set", "ON");
+  simEjecutarMs(200);
+  COMPROBAR(simNivelPin(12) == HIGH);
+  simEjecutarMs(6000);
+  COMPROBAR(simInfluxLineas().back().find("dispositivo=invernadero-3") != std::string::npos);
+
+  // Borrar apaga los dos
+  simUiBorrar();
+  simEjecutarMs(500);
+  COMPROBAR(simBrokerClientes() == 0);
+  COMPROBAR(simHttpServidoresActivos() == 0);
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
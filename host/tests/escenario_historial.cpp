@@ -0,0 +1,81 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "Adafruit_SSD1306.h"
+#include "ESPAsyncWebServer.h"
+#include "WebSerial.h"
+#include "historial.h"
+
+static bool hayPixeles(int y0, int y1) {
+  for (int y = y0; y <= y1; y++) {
+    for (int x = 34; x < 128; x++) {
+      if (simPanel()->pixel(x, y)) return true;
+    }
+  }
+  return false;
+}
+
+// Un día y pico en modo local: memoria del historial, consultas y sparklines
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_LOCAL);
+  simEjecutarMs(25ULL * 3600 * 1000);
+  uint32_t ahora = millis() / 1000;
+
+  // 24 h de las seis series en el pool, sin llenarlo
+  EstadisticaSerie temp, lat;
+  historialEstadistica(SERIE_TEMP, temp);
+  historialEstadistica(SERIE_LAT, lat);
+  COMPROBAR(temp.puntos >= 1440);
+  COMPROBAR(ahora - temp.desdeS >= 86400);
+  COMPROBAR(historialBytesUsados() < HISTORIAL_BLOQUES * HISTORIAL_BLOQUE_BYTES);
+  COMPROBAR(temp.bits < temp.puntos * 8);
+  COMPROBAR(lat.bits < lat.puntos * 3);  // Estacionado: tiempo y valor sin cambio
+
+  // Crudos: uno por minuto, exactos
+  PuntoHistorial crudos[16];
+  size_t n = historialLeer(SERIE_TEMP, ahora - 600, crudos, 16);
+  COMPROBAR_ENTRE(n, 9, 10);
+  for (size_t i = 1; i < n; i++) COMPROBAR(crudos[i].s - crudos[i - 1].s == 60);
+  COMPROBAR_ENTRE(crudos[n - 1].v, 195, 285);
+
+  // Ciclo diario del simulador: 24 ± 4 °C
+  TramoHistorial tramos[24];
+  historialConsultar(SERIE_TEMP, 86400, tramos, 24);
+  int32_t minimo = INT32_MAX, maximo = INT32_MIN;
+  for (const TramoHistorial& t : tramos) {
+    COMPROBAR_ENTRE(t.n, 59, 61);
+    minimo = std::min(minimo, t.min);
+    maximo = std::max(maximo, t.max);
+  }
+  COMPROBAR_ENTRE(minimo, 195, 210);
+  COMPROBAR_ENTRE(maximo, 270, 285);
+
+  // Consola WebSerial
+  std::string uso = simWebSerialEnviar("sensor history");
+  COMPROBAR(contiene(uso, "temp: "));
+  COMPROBAR(contiene(uso, "lng: "));
+  COMPROBAR(contiene(simWebSerialEnviar("sensor history hum 6h 6"), "hum, 6 tramos de 3600 s"));
+  COMPROBAR(contiene(simWebSerialEnviar("sensor history foo 6h"), "campo desconocido"));
+  COMPROBAR(contiene(simWebSerialEnviar("sensor history temp xx"), "rango invalido"));
+
+  // JSON
+  SimRespuestaHttp r = simHttp("GET", "/history.json?campo=luz&rango=24h&puntos=24");
+  COMPROBAR(r.codigo == 200);
+  COMPROBAR(contiene(r.cuerpo, "\"campo\":\"luz\""));
+  COMPROBAR(contiene(r.cuerpo, "\"tramo_s\":3600"));
+  COMPROBAR(contiene(r.cuerpo, "\"media\":["));
+  r = simHttp("GET", "/history.json?campo=sats&rango=5m&puntos=0");
+  COMPROBAR(r.codigo == 200);
+  COMPROBAR(contiene(r.cuerpo, ",8]"));
+  COMPROBAR(simHttp("GET", "/history.json?campo=foo").codigo == 400);
+
+  // Sparklines de temperatura, humedad y luz
+  COMPROBAR(simUiMuestra("orion-iot.local"));
+  COMPROBAR(hayPixeles(26, 33));
+  COMPROBAR(hayPixeles(36, 43));
+  COMPROBAR(hayPixeles(46, 53));
+
+  simUiBorrar();
+  return FIN_PRUEBA();
+}
@@ -0,0 +1,107 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "sim_sensores_i2c.h"
+#include "sim_board.h"
+#include "Adafruit_SSD1306.h"
+#include "InfluxDbClient.h"
+#include "WebSerial.h"
+#include "metrics.h"
+#include "bus_i2c.h"
+
+extern Adafruit_SSD1306 display;
+
+// Responde a todo, sin driver que lo reconozca (una EEPROM 24C32, por ejemplo)
+class SimDesconocido : public SimDispositivoI2C {
+public:
+  bool escribir(const uint8_t*, size_t) override { return true; }
+  size_t leer(uint8_t* datos, size_t n) override {
+    memset(datos, 0xFF, n);
+    return n;
+  }
+};
+
+// Bus compartido: escaneo, reloj, lecturas entre trozos de pantalla y errores
+int main() {
+  SimBme280 bme;
+  SimBh1750 bh;
+  simI2cConectar(0x76, &bme);
+  simI2cConectar(0x23, &bh);
+  arrancarPlaca();
+  simEjecutarMs(500);
+
+  // Los tres encontrados: fast mode, 400 kHz (ninguno pasa de ahí)
+  COMPROBAR(i2cReloj() == 400000);
+  COMPROBAR(Wire.getClock() == 400000);
+
+  // Lecturas compensadas dentro de la resolución del sensor
+  simEjecutarMs(3000);
+  LecturaI2C ext;
+  i2cObtenerLectura(ext);
+  COMPROBAR(ext.ambiente && ext.luz);
+  COMPROBAR(fabs(ext.tempC - simTemperatura()) < 0.05);
+  COMPROBAR(fabs(ext.humedad - simHumedad()) < 0.2);
+  COMPROBAR(fabs(ext.presionHpa - 1013.25) < 0.05);
+  COMPROBAR(fabs(ext.lux - 250.0) < 1.0);
+
+  // Menú recorriendo opciones: cada cambio reescribe solo los trozos de la
+  // barra resaltada, y las lecturas se cuelan entre trozos (el tope es el
+  // periodo de la tarea, no un volcado entero de ~25 ms a 400 kHz)
+  metricasReiniciar();
+  uint64_t bytes = simI2cBytes();
+  for (uint8_t i = 0; i < MENU_TOTAL; i++) simUiApuntar(MENU_TOTAL, i);
+  COMPROBAR(memcmp(simPanel()->gddram, display.getBuffer(), I2C_PANTALLA_BYTES) == 0);
+  COMPROBAR(simI2cBytes() - bytes < MENU_TOTAL * I2C_PANTALLA_BYTES / 4);
+  ResumenHistograma lat;
+  metricaResumen(HIST_I2C_SENSOR, lat);
+  COMPROBAR(lat.n >= 8);
+  COMPROBAR(lat.maxUs < (I2C_PERIODO_MS + 2) * 1000);
+
+  // La OLED recibe por trozos lo mismo que dibuja la UI
+  simUiElegir(MENU_TOTAL, MENU_LOCAL);
+  simEjecutarMs(2000);
+  COMPROBAR(memcmp(simPanel()->gddram, display.getBuffer(), I2C_PANTALLA_BYTES) == 0);
+  COMPROBAR(simI2cErroresClock() == 0);
+
+  // Pantalla quieta: solo pasan por el bus las lecturas, no 1 KB por cuadro
+  bytes = simI2cBytes();
+  simEjecutarMs(1000);
+  COMPROBAR(simI2cBytes() - bytes < I2C_PANTALLA_BYTES);
+
+  // Consola
+  COMPROBAR(contiene(simWebSerialEnviar("sensor i2c"), "BH1750: 250.00 lx"));
+  std::string tabla = simWebSerialEnviar("sys i2c");
+  COMPROBAR(contiene(tabla, "I2C 400 kHz"));
+  COMPROBAR(contiene(tabla, "0x3C SSD1306"));
+  COMPROBAR(contiene(tabla, "0x76 BME280"));
+
+  // Módulo desenchufado: errores por dispositivo y la lectura deja de valer
+  simI2cDesconectar(0x23);
+  simEjecutarMs(2500);
+  i2cObtenerLectura(ext);
+  COMPROBAR(!ext.luz && ext.ambiente);
+  COMPROBAR(metricaContador(CNT_I2C_ERRORES) >= 2);
+
+  // Uno nuevo sin driver: el reescaneo lo encuentra y baja el reloj a 100 kHz
+  SimDesconocido eeprom;
+  simI2cConectar(0x50, &eeprom);
+  simWebSerialEnviar("sys i2c scan");
+  simEjecutarMs(200);
+  tabla = simWebSerialEnviar("sys i2c");
+  COMPROBAR(contiene(tabla, "I2C 100 kHz"));
+  COMPROBAR(contiene(tabla, "0x50 ?"));
+  COMPROBAR(!contiene(tabla, "0x23"));
+
+  // Nube: los extras van en el JSON de sensores y en Influx
+  simUiBorrar();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  simEjecutarMs(12000);
+  const SimMensajeMqtt* m = simBrokerUltimo(TOPICO("sensors/state"));
+  COMPROBAR(m && contiene(m->payload, "\"pressure\":1013.2") && !contiene(m->payload, "\"lux\""));
+  COMPROBAR(simBrokerRetenido("homeassistant/sensor/orion_" SIM_ID "/pressure/config") != nullptr);
+  COMPROBAR(!simInfluxLineas().empty() && contiene(simInfluxLineas().back(), "presion_hpa=1013.2"));
+
+  simUiBorrar();
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
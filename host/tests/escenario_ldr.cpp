@@ -0,0 +1,26 @@
+#include "prueba.h"
+#include <Arduino.h>
+#include <LDR_10K.h>
+
+// Librería LDR_10K contra el ADC simulado (sin firmware)
+int main() {
+  simEntorno().ldrRuido = 0;
+  LDR_10K ldr(36, 300, 4095);
+  ldr.begin(12);
+
+  simFijarAnalogico(36, 300);
+  COMPROBAR(ldr.getPercentageLDR() == 0);
+  simFijarAnalogico(36, 4095);
+  COMPROBAR(ldr.getPercentageLDR() == 100);
+  simFijarAnalogico(36, 2197);
+  COMPROBAR_ENTRE(ldr.getPercentageLDR(), 49, 51);
+
+  // Fuera de calibración se satura
+  simFijarAnalogico(36, 100);
+  COMPROBAR(ldr.getPercentageLDR() == 0);
+
+  ldr.setCalibration(1000, 3000);
+  simFijarAnalogico(36, 2000);
+  COMPROBAR_ENTRE(ldr.getPercentageLDR(), 49, 51);
+  return FIN_PRUEBA();
+}
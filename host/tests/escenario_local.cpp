@@ -0,0 +1,39 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "WebSerial.h"
+#include "ESP32Servo.h"
+
+extern Servo servoIO[3];
+
+// procesarComando() vía la consola WebSerial
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_LOCAL);
+  COMPROBAR(simUiMuestra("orion-iot.local"));
+
+  COMPROBAR(contiene(simWebSerialEnviar("relay set 2 on"), "OK: Relay 2 ENCENDIDO"));
+  simEjecutarMs(50);
+  COMPROBAR(simNivelPin(27) == HIGH);
+  COMPROBAR(contiene(simWebSerialEnviar("relay get 2"), "esta ON"));
+  COMPROBAR(contiene(simWebSerialEnviar("relay set 9 on"), "Relay desconocido"));
+
+  COMPROBAR(contiene(simWebSerialEnviar("servo set 2 135"), "Servo 2 -> 135"));
+  simEjecutarMs(50);
+  COMPROBAR(servoIO[1].read() == 135);
+
+  simWebSerialEnviar("lock open");
+  simEjecutarMs(3500);
+  COMPROBAR(contiene(WebSerial.salida, "Cerradura cerrada"));
+
+  simEjecutarMs(3000);  // Primera lectura del DHT
+  std::string todo = simWebSerialEnviar("sensor all");
+  COMPROBAR(contiene(todo, "DHT: "));
+  COMPROBAR(contiene(todo, "LDR: "));
+
+  COMPROBAR(contiene(simWebSerialEnviar("foo"), "Comando no reconocido"));
+
+  simUiBorrar();
+  COMPROBAR(simHttpServidoresActivos() == 0);
+  return FIN_PRUEBA();
+}
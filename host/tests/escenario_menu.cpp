@@ -0,0 +1,38 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "definitions.h"
+
+// Navegación del menú con potenciómetro y botones, como en la placa
+int main() {
+  arrancarPlaca();
+  COMPROBAR(simUiMuestra("Conectado OK"));
+
+  simEjecutarMs(500);
+  simUiApuntar(MENU_TOTAL, MENU_CONFIG);
+  COMPROBAR(simUiMuestra("--> Configuracion"));
+
+  simUiConfirmar();
+  COMPROBAR(simUiMuestra("Estado WiFi: OK"));
+  COMPROBAR(simUiMuestra("IP: 192.168.1.77"));
+
+  // Diagnostico y vuelta a Configuracion
+  simUiElegir(5, 3);
+  COMPROBAR(simUiMuestra("== DIAGNOSTICO =="));
+  simUiBorrar();
+  COMPROBAR(simUiMuestra("Seleccionar WiFi"));
+
+  // Atras
+  simUiElegir(5, 4);
+  COMPROBAR(simUiMuestra("Modo Cloud"));
+
+  // Seleccionar WiFi: el escaneo corre en la tarea de red
+  simUiElegir(MENU_TOTAL, MENU_CONFIG);
+  simUiElegir(5, 2);
+  COMPROBAR(simUiMuestra("Escaneando WiFi..."));
+  simEjecutarMs(3000);
+  COMPROBAR(simUiMuestra("Starlink 2.4"));
+
+  // La UI nunca debe quedarse sin latido
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
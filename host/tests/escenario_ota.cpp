@@ -0,0 +1,224 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "sim_board.h"
+#include "ESPAsyncWebServer.h"
+#include "WebSerial.h"
+#include "sim_ota.h"
+#include "sim_red.h"
+#include "metrics.h"
+#include "ota.h"
+
+#define IMAGEN_BYTES (1024 * 1024)
+#define IROM 0x400D0000u         // Donde el ESP32 mapea el código de la app
+#define ENLACE_BPS 25000         // Enlace de campo: WiFi lejano o módem celular
+
+// Código de verdad (este ejecutable) con pools de literales que apuntan
+// dentro de la imagen cada 64 B, como el IROM de una app de ESP32
+static std::vector<uint8_t> imagenBase() {
+  SimHeapAjeno ajeno;
+  std::vector<uint8_t> v;
+  FILE* f = fopen("/proc/self/exe", "rb");
+  uint8_t buf[65536];
+  size_t n;
+  while (f && v.size() < IMAGEN_BYTES && (n = fread(buf, 1, sizeof(buf), f)) > 0) v.insert(v.end(), buf, buf + n);
+  if (f) fclose(f);
+  while (v.size() < IMAGEN_BYTES) v.push_back((uint8_t)(v.size() * 131));
+  v.resize(IMAGEN_BYTES);
+  uint32_t semilla = 12345;
+  for (size_t i = 64; i + 4 <= v.size(); i += 64) {
+    semilla = semilla * 1103515245u + 12345u;
+    uint32_t p = IROM + (semilla >> 8) % IMAGEN_BYTES;
+    memcpy(&v[i], &p, 4);
+  }
+  v[0] = 0xE9;
+  return v;
+}
+
+// Otra compilación: código nuevo en dos funciones y todo lo que quedó
+// detrás se corre, así que cambian los punteros que lo referencian
+static std::vector<uint8_t> recompilar(const std::vector<uint8_t>& v, uint32_t semilla) {
+  SimHeapAjeno ajeno;
+  const size_t puntos[2] = { 300000, 700000 };
+  const size_t largos[2] = { 600, 200 };
+  std::vector<uint8_t> out(v.begin(), v.begin() + puntos[0]);
+  for (size_t k = 0; k < largos[0]; k++) out.push_back((uint8_t)(v[k * 7 + semilla] ^ 0x5A));
+  out.insert(out.end(), v.begin() + puntos[0], v.begin() + puntos[1]);
+  for (size_t k = 0; k < largos[1]; k++) out.push_back((uint8_t)(v[k * 3 + semilla] + 1));
+  out.insert(out.end(), v.begin() + puntos[1], v.end());
+  for (size_t i = 0; i + 4 <= out.size(); i += 4) {
+    uint32_t p;
+    memcpy(&p, &out[i], 4);
+    if (p < IROM || p >= IROM + IMAGEN_BYTES) continue;
+    uint32_t desplazado = p - IROM;
+    if (desplazado >= puntos[0]) p += largos[0];
+    if (desplazado >= puntos[1]) p += largos[1];
+    memcpy(&out[i], &p, 4);
+  }
+  return out;
+}
+
+// Bootloader y lo que setup() hace por la OTA
+static void arrancar() {
+  simOtaArrancar();
+  otaIniciar();
+  otaRestaurarModos();
+}
+
+// Reinicio sin red al arrancar: MQTT reconecta y la imagen se reporta
+static void reiniciar() {
+  arrancar();
+  simRedCortar(true);
+  simEjecutarMs(100);
+  simRedCortar(false);
+  simEjecutarMs(5000);
+}
+
+static uint64_t pasoMaxOtaUs = 0;
+
+// Orden ota/set y espera a que la imagen quede verificada; ms de virtual
+static uint64_t descargar(const char* ruta, const std::vector<uint8_t>& paquete, const std::vector<uint8_t>& imagen) {
+  simOtaServir(ruta, paquete);
+  std::string orden = std::string("http://imagenes.orion.lan:8070") + ruta + " " + simOtaShaHex(imagen);
+  uint64_t t0 = simAhoraUs();
+  simReiniciarPasoMax();
+  simBrokerPublicar(TOPICO("ota/set"), orden.c_str());
+  for (int i = 0; i < 1200 && otaEstado() != OTA_REINICIANDO && otaEstado() != OTA_FALLIDA; i++) simEjecutarMs(100);
+  pasoMaxOtaUs = std::max(pasoMaxOtaUs, simPasoMaxUs(TAREA_RED));
+  return (simAhoraUs() - t0) / 1000;
+}
+
+// Paquetes comprimidos y delta: por POST /ota en Local y por ota/set en
+// Cloud. Se verifica la firma antes de escribir, el SHA-256 antes de cambiar
+// de partición y una imagen que no se reporta vuelve sola a la anterior
+int main() {
+  std::vector<uint8_t> v1 = imagenBase();
+  std::vector<uint8_t> v2 = recompilar(v1, 11);
+  std::vector<uint8_t> v3 = recompilar(v2, 29);
+  simOtaImagen(v1);
+  simOtaAnchoBanda(ENLACE_BPS);
+
+  std::vector<uint8_t> plana = simOtaPaquete(OTA_PLANA, v2);
+  std::vector<uint8_t> lzss = simOtaPaquete(OTA_LZSS, v1);
+  std::vector<uint8_t> delta = simOtaPaquete(OTA_DELTA, v2, &v1);
+  printf("  paquetes: plana %zu B, lzss %zu B, delta %zu B\n", plana.size(), lzss.size(), delta.size());
+  COMPROBAR(lzss.size() < plana.size() * 3 / 4);
+  COMPROBAR(delta.size() < plana.size() / 20);
+
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_HIBRIDO);
+  simEjecutarMs(15000);
+  COMPROBAR(simBrokerConexiones() == 1);
+
+  // --- Imagen completa sin comprimir por ota/set: v1 -> v2 ---
+  uint64_t msPlana = descargar("/v2.bin.oota", plana, v2);
+  COMPROBAR(otaEstado() == OTA_REINICIANDO);
+  COMPROBAR(strcmp(simOtaArranque(), "app1") == 0);
+  COMPROBAR(simOtaContenido("app1", v2.size()) == v2);
+  simEjecutarMs(OTA_REINICIO_MS + 100);
+  COMPROBAR(simReinicios() == 1);
+  reiniciar();
+  COMPROBAR(strcmp(simOtaCorriendo(), "app1") == 0);
+  const SimMensajeMqtt* estado = simBrokerUltimo(TOPICO("ota/state"));
+  COMPROBAR(estado && contiene(estado->payload, "\"resultado\":\"confirmada\""));
+
+  // --- Comprimida: v2 -> v1 ---
+  uint64_t msLzss = descargar("/v1.oota", lzss, v1);
+  COMPROBAR(otaEstado() == OTA_REINICIANDO);
+  simEjecutarMs(OTA_REINICIO_MS + 100);
+  reiniciar();
+  COMPROBAR(strcmp(simOtaCorriendo(), "app0") == 0);
+  COMPROBAR(simOtaContenido("app0", v1.size()) == v1);
+
+  // --- Delta contra la que corre: v1 -> v2 ---
+  uint64_t msDelta = descargar("/v1-v2.oota", delta, v2);
+  COMPROBAR(otaEstado() == OTA_REINICIANDO);
+  simEjecutarMs(OTA_REINICIO_MS + 100);
+  reiniciar();
+  COMPROBAR(strcmp(simOtaCorriendo(), "app1") == 0);
+  COMPROBAR(simOtaContenido("app1", v2.size()) == v2);
+  printf("  tiempo a %u B/s: plana %llu ms, lzss %llu ms, delta %llu ms\n", ENLACE_BPS,
+         (unsigned long long)msPlana, (unsigned long long)msLzss, (unsigned long long)msDelta);
+  COMPROBAR(msLzss * 4 < msPlana * 3);
+  COMPROBAR(msDelta * 3 < msPlana);
+  COMPROBAR(pasoMaxOtaUs < 500000);
+  COMPROBAR(simDisparosWatchdog() == 0);
+
+  // --- Rechazos: la partición de arranque no se toca ---
+  // El mismo parche ya no aplica: la base es otra
+  descargar("/v1-v2.oota", delta, v2);
+  COMPROBAR(otaEstado() == OTA_FALLIDA);
+  COMPROBAR(contiene(simWebSerialEnviar("sys ota"), "El parche es para otra version"));
+  // SHA-256 fijado por la orden distinto al del paquete
+  simOtaServir("/v1.oota", lzss);
+  simBrokerPublicar(TOPICO("ota/set"), ("http://imagenes.orion.lan:8070/v1.oota " + simOtaShaHex(v3)).c_str());
+  simEjecutarMs(3000);
+  COMPROBAR(otaEstado() == OTA_FALLIDA);
+  COMPROBAR(contiene(simWebSerialEnviar("sys ota"), "SHA-256 distinto al de la orden"));
+  // Paquete armado sin OTA_CLAVE (SHA coherente, firma no): ni por ota/set
+  // ni por POST /ota llega a borrar un sector
+  std::vector<uint8_t> sinFirma = simOtaPaquete(OTA_LZSS, v3);
+  memset(&sinFirma[offsetof(OtaCabecera, firma)], 0, sizeof(OtaCabecera::firma));
+  uint32_t sectores = simOtaSectoresBorrados();
+  simOtaServir("/v3.oota", sinFirma);
+  simBrokerPublicar(TOPICO("ota/set"), ("http://imagenes.orion.lan:8070/v3.oota " + simOtaShaHex(v3)).c_str());
+  simEjecutarMs(3000);
+  COMPROBAR(otaEstado() == OTA_FALLIDA);
+  COMPROBAR(contiene(simWebSerialEnviar("sys ota"), "Firma del paquete invalida"));
+  SimRespuestaHttp r = simHttpSubir("/ota", sinFirma.data(), sinFirma.size(), 500000);
+  COMPROBAR(r.codigo == 400 && otaEstado() == OTA_FALLIDA);
+  COMPROBAR(simOtaSectoresBorrados() == sectores);
+  // Un bit cambiado en la subida local: el SHA de la imagen no cierra
+  std::vector<uint8_t> roto = simOtaPaquete(OTA_LZSS, v3);
+  roto[roto.size() / 2] ^= 0x10;
+  r = simHttpSubir("/ota", roto.data(), roto.size(), 500000);
+  COMPROBAR(r.codigo == 400);
+  COMPROBAR(otaEstado() == OTA_FALLIDA);
+  COMPROBAR(strcmp(simOtaArranque(), "app1") == 0);
+  // Imagen buena pero la flash no deja cambiar el arranque: el reinicio
+  // siguiente no lo cuenta como una vuelta
+  simOtaFallarArranque(true);
+  r = simHttpSubir("/ota", lzss.data(), lzss.size(), 500000);
+  simOtaFallarArranque(false);
+  COMPROBAR(r.codigo == 400);
+  COMPROBAR(contiene(simWebSerialEnviar("sys ota"), "No se pudo cambiar la particion de arranque"));
+  reiniciar();
+  COMPROBAR(strcmp(simOtaCorriendo(), "app1") == 0);
+  COMPROBAR(!contiene(simWebSerialEnviar("sys ota"), "revertida"));
+  COMPROBAR(metricaContador(CNT_OTA_FALLOS) == 6);
+
+  // --- Subida local (LAN) de v3 que nunca se reporta: vuelve a v2 ---
+  std::vector<uint8_t> v3delta = simOtaPaquete(OTA_DELTA, v3, &v2);
+  r = simHttpSubir("/ota", v3delta.data(), v3delta.size(), 500000);
+  COMPROBAR(r.codigo == 200 && contiene(r.cuerpo, "\"estado\":\"reiniciando\""));
+  simEjecutarMs(OTA_REINICIO_MS + 100);
+  simRedCortar(true);
+  arrancar();
+  COMPROBAR(strcmp(simOtaCorriendo(), "app0") == 0);
+  COMPROBAR(simOtaContenido("app0", v3.size()) == v3);
+  COMPROBAR(contiene(simHttp("GET", "/ota.json").cuerpo, "\"a_prueba\":true"));
+  uint32_t reinicios = simReinicios();
+  simEjecutarMs(OTA_CONFIRMAR_MS + 1000);
+  COMPROBAR(simReinicios() == reinicios + 1);
+  COMPROBAR(strcmp(simOtaArranque(), "app1") == 0);
+  arrancar();
+  simRedCortar(false);
+  simEjecutarMs(5000);
+  COMPROBAR(strcmp(simOtaCorriendo(), "app1") == 0);
+  COMPROBAR(contiene(simWebSerialEnviar("sys ota"), "revertida (no se reporto a tiempo)"));
+
+  // --- v3 otra vez, pero se cuelga al arrancar: vuelve al cuarto intento ---
+  r = simHttpSubir("/ota", v3delta.data(), v3delta.size(), 500000);
+  COMPROBAR(r.codigo == 200);
+  simEjecutarMs(OTA_REINICIO_MS + 100);
+  for (int i = 0; i <= OTA_INTENTOS_MAX; i++) {
+    arrancar();
+    COMPROBAR(strcmp(simOtaCorriendo(), "app0") == 0);
+  }
+  COMPROBAR(strcmp(simOtaArranque(), "app1") == 0);
+  arrancar();
+  COMPROBAR(strcmp(simOtaCorriendo(), "app1") == 0);
+  COMPROBAR(contiene(simWebSerialEnviar("sys ota"), "revertida (reinicios)"));
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
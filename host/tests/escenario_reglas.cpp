@@ -0,0 +1,98 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "WebSerial.h"
+#include "metrics.h"
+#include "reglas.h"
+
+// LDR fijo: el porcentaje sale de 300..4095 cuentas
+static void fijarLuz(uint16_t raw) {
+  simEntorno().ldrNoche = raw;
+  simEntorno().ldrDia = raw;
+}
+
+// Reglas locales: retardo, histéresis, franja horaria, NVS, oscilación y MQTT
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_LOCAL);
+  simEjecutarMs(35000);  // Fix GPS: hora UTC disponible
+
+  COMPROBAR(contiene(simWebSerialEnviar("rule list"), "Sin reglas"));
+  COMPROBAR(contiene(simWebSerialEnviar("rule add 1 luz < 20 hyst 5 for 10s then relay 1 on else relay 1 off"),
+                     "OK: regla 1"));
+
+  // Oscuro: el relé espera los 10 s del "for"
+  fijarLuz(400);
+  simEjecutarMs(8000);
+  COMPROBAR(simNivelPin(26) == LOW);
+  simEjecutarMs(4000);
+  COMPROBAR(simNivelPin(26) == HIGH);
+
+  // ~22 %: dentro de la histéresis, sigue encendido
+  fijarLuz(1150);
+  simEjecutarMs(15000);
+  COMPROBAR(simNivelPin(26) == HIGH);
+
+  // Claro: se apaga tras otros 10 s
+  fijarLuz(3800);
+  simEjecutarMs(8000);
+  COMPROBAR(simNivelPin(26) == HIGH);
+  simEjecutarMs(4000);
+  COMPROBAR(simNivelPin(26) == LOW);
+
+  // Errores de compilación con el motivo
+  COMPROBAR(contiene(simWebSerialEnviar("rule add 2 luz <> 3 then relay 1 on"), "comparador desconocido"));
+  COMPROBAR(contiene(simWebSerialEnviar("rule add 2 luz < 3 then"), "Error:"));
+  COMPROBAR(contiene(simWebSerialEnviar("rule del 9"), "no existe"));
+
+  // Forma canónica: paréntesis solo donde hacen falta
+  COMPROBAR(contiene(simWebSerialEnviar("rule add 3 (temp > 30 or hum > 80) and not gps == 1 then servo 2 90"),
+                     "OK: regla 3"));
+  std::string lista = simWebSerialEnviar("rule list");
+  COMPROBAR(contiene(lista, "1 luz < 20 hyst 5 for 10s then relay 1 on else relay 1 off"));
+  COMPROBAR(contiene(lista, "3 (temp > 30 or hum > 80) and not gps == 1 then servo 2 90"));
+
+  // Franja horaria: 08:00 UTC son las 21:00 en UTC+13
+  COMPROBAR(contiene(simWebSerialEnviar("rule add 4 between 20:00 06:00 then lock on else lock off"),
+                     "OK: regla 4"));
+  simEjecutarMs(500);
+  COMPROBAR(simNivelPin(13) == LOW);
+  COMPROBAR(contiene(simWebSerialEnviar("rule tz 13"), "OK: zona UTC+13.0"));
+  simEjecutarMs(500);
+  COMPROBAR(simNivelPin(13) == HIGH);
+
+  // Una regla que se contradice se desactiva sola
+  simWebSerialEnviar("rule add 5 relay2 == 0 then relay 2 on else relay 2 off");
+  simEjecutarMs(1000);
+  COMPROBAR(contiene(simWebSerialEnviar("rule list"), "DESACTIVADA (oscila)"));
+  uint32_t escrituras = simEscriturasPin(27);
+  simEjecutarMs(2000);
+  COMPROBAR(simEscriturasPin(27) == escrituras);
+
+  // Sobreviven a un reinicio (NVS)
+  reglasIniciar();
+  lista = simWebSerialEnviar("rule list");
+  COMPROBAR(contiene(lista, "zona UTC+13.0"));
+  COMPROBAR(contiene(lista, "4 between 20:00 06:00 then lock on else lock off"));
+  COMPROBAR(contiene(lista, "3 (temp > 30 or hum > 80)"));
+  COMPROBAR(contiene(lista, "5 relay2 == 0"));
+
+  // Nube: gestión por MQTT y estado retenido
+  simUiBorrar();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  simEjecutarMs(12000);
+  simBrokerPublicar(TOPICO("rules/set"), "del 5");
+  simEjecutarMs(500);
+  const SimMensajeMqtt* m = simBrokerUltimo(TOPICO("rules/result"));
+  COMPROBAR(m && m->payload == "OK: regla 5 borrada");
+  const char* estado = simBrokerRetenido(TOPICO("rules/state"));
+  COMPROBAR(estado && contiene(estado, "\"id\":1,") && !contiene(estado, "\"id\":5,"));
+
+  ResumenHistograma lat;
+  metricaResumen(HIST_REGLAS, lat);
+  COMPROBAR(lat.n > 0);
+
+  simUiBorrar();
+  return FIN_PRUEBA();
+}
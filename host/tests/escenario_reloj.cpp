@@ -0,0 +1,119 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "InfluxDbClient.h"
+#include "sim_ntp.h"
+#include "WebSerial.h"
+#include "io_task.h"
+#include "reloj.h"
+#include "metrics.h"
+#include "ajustes.h"
+#include "sim_sensores_i2c.h"
+
+// Timestamp (ms) al final de la línea de Influx
+static uint64_t marca(const std::string& linea) {
+  return strtoull(linea.substr(linea.rfind(' ') + 1).c_str(), nullptr, 10);
+}
+
+// Una muestra cada ~5 s (el primer ciclo se atrasa con el handshake), en
+// orden y sin huecos: ni amontonadas a la hora del envío ni repetidas
+static bool espaciadas(const std::vector<std::string>& lineas) {
+  for (size_t i = 1; i < lineas.size(); i++) {
+    uint64_t dt = marca(lineas[i]) - marca(lineas[i - 1]);
+    if (marca(lineas[i]) <= marca(lineas[i - 1]) || dt < 3000 || dt > 8000) {
+      printf("  hueco entre %zu y %zu: %llu ms\n", i - 1, i, (unsigned long long)dt);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Muestras con su hora de adquisición aunque el NTP o Influx lleguen tarde
+int main() {
+  // Con BME280 y BH1750 cada línea lleva también sus campos
+  SimBme280 bme;
+  SimBh1750 bh;
+  simI2cConectar(0x76, &bme);
+  simI2cConectar(0x23, &bh);
+  simNtp().respuestaMs = 20000;
+  simNtp().derivaPpm = 40;
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_HIBRIDO);
+  simEjecutarMs(12000);
+
+  // Sin NTP el modo arranca igual; las muestras esperan en la cola
+  COMPROBAR(simBrokerConexiones() == 1);
+  COMPROBAR(simNtpArranques() == 1 && simNtpSincronizaciones() == 0);
+  COMPROBAR(simInfluxLineas().empty());
+  COMPROBAR(contiene(simWebSerialEnviar("sys reloj"), "Esperando NTP"));
+
+  // Llega la hora: las muestras de antes salen con la hora en que se tomaron
+  simEjecutarMs(18000);
+  COMPROBAR(simNtpSincronizaciones() == 1);
+  const std::vector<std::string>& lineas = simInfluxLineas();
+  COMPROBAR(lineas.size() >= 5);
+  COMPROBAR_ENTRE(marca(lineas[0]), simUtcVerdaderoMs(4000000), simUtcVerdaderoMs(8000000));
+  COMPROBAR(espaciadas(lineas));
+
+  // Influx caído 40 s: el lote posterior conserva los tiempos originales
+  simInfluxFallar(true);
+  simEjecutarMs(40000);
+  size_t antes = lineas.size();
+  simInfluxFallar(false);
+  simEjecutarMs(30000);
+  COMPROBAR(lineas.size() - antes >= 13);
+  COMPROBAR(espaciadas(lineas));
+  COMPROBAR(metricaContador(CNT_INFLUX_DESCARTES) == 0);
+
+  // Segunda sincronización (1 h): corrige 40 ppm x 3600 s y mide la deriva
+  simEjecutarMs(3600000);
+  COMPROBAR(simNtpSincronizaciones() == 2);
+  COMPROBAR_ENTRE(metricaMedidor(MED_RELOJ_DESFASE), -146000, -142000);
+  COMPROBAR_ENTRE(metricaMedidor(MED_RELOJ_DERIVA), 39000, 41000);
+
+  // Con la deriva compensada, la siguiente corrección es casi nula y la hora
+  // de una muestra a media hora de la sincronización sigue en el ms
+  simEjecutarMs(3600000);
+  COMPROBAR(simNtpSincronizaciones() == 3);
+  COMPROBAR_ENTRE(metricaMedidor(MED_RELOJ_DESFASE), -2000, 2000);
+  simEjecutarMs(1800000);
+  LecturaSensores lectura;
+  ioObtenerLectura(lectura);
+  uint64_t utcMs = 0;
+  COMPROBAR(relojUtcMs(lectura.monoUs, utcMs));
+  COMPROBAR_ENTRE((int64_t)(utcMs - simUtcVerdaderoMs(lectura.monoUs)), -2, 2);
+
+  std::string reloj = simWebSerialEnviar("sys reloj");
+  COMPROBAR(contiene(reloj, "NTP: 3 sincronizaciones"));
+  COMPROBAR(contiene(reloj, "Deriva: 4"));
+  simEjecutarMs(11000);
+  const SimMensajeMqtt* diag = simBrokerUltimo(TOPICO("diag/state"));
+  COMPROBAR(diag && contiene(diag->payload, "\"reloj_deriva_ppb\":") && diag->payload.back() == '}');
+
+  // Id y ubicación largos: seis líneas ya no caben en un lote; las que
+  // sobran esperan al siguiente, enteras y sin descartar ninguna
+  COMPROBAR(contiene(simWebSerialEnviar("sys id invernadero-norte-012345"), "ID: invernadero-norte-012345"));
+  std::string ubicacion(AJUSTE_TEXTO_MAX, 'u');
+  COMPROBAR(contiene(simWebSerialEnviar(("cfg set ubicacion " + ubicacion).c_str()), "OK"));
+  simEjecutarMs(6000);
+  simInfluxFallar(true);
+  simEjecutarMs(40000);
+  antes = lineas.size();
+  simInfluxFallar(false);
+  simEjecutarMs(30000);
+  std::vector<std::string> largas(lineas.begin() + antes, lineas.end());
+  COMPROBAR(largas.size() >= 13);
+  COMPROBAR(espaciadas(largas));
+  std::string etiquetas = "estado_sistema,dispositivo=invernadero-norte-012345,ubicacion=" + ubicacion + " ";
+  for (const std::string& l : largas) COMPROBAR(l.rfind(etiquetas, 0) == 0 && marca(l) > 0);
+  COMPROBAR(metricaContador(CNT_INFLUX_DESCARTES) == 0);
+
+  // Influx caído más de lo que cabe en la cola: se pierden las más viejas
+  simInfluxFallar(true);
+  simEjecutarMs(180000);
+  simInfluxFallar(false);
+  simEjecutarMs(30000);
+  COMPROBAR(metricaContador(CNT_INFLUX_DESCARTES) >= 10);
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
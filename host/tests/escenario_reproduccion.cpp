@@ -0,0 +1,54 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "InfluxDbClient.h"
+#include "sim_reproduccion.h"
+
+// Captura fija (datos/fix_perdido.cap, 60 s): fix con 8 satélites que se
+// pierde a los 30 s, ráfaga de errores del DHT entre 20 y 30 s y una luz
+// que parpadea cada segundo. Lo publicado en modo nube debe seguirla.
+int main() {
+  COMPROBAR(simReproduccionCargar(ORION_DATOS "/fix_perdido.cap"));
+  COMPROBAR(simReproduccionDuracionUs() >= 59000000ull);
+  arrancarPlaca();
+  simEjecutarMs(500);
+  // La captura corre antes de entrar: la primera muestra (al conectar) ya es suya
+  simReproduccionIniciar();
+  uint64_t inicio = simAhoraUs();
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+
+  // Cada punto de Influx con el segundo de la captura en que se escribió
+  std::vector<std::pair<uint32_t, std::string>> puntos;
+  while (!simReproduccionTerminada()) {
+    simInfluxLimpiar();
+    simEjecutarMs(250);
+    uint32_t s = (uint32_t)((simAhoraUs() - inicio) / 1000000ull);
+    for (const std::string& l : simInfluxLineas()) puntos.push_back({ s, l });
+  }
+  COMPROBAR_ENTRE(puntos.size(), 9, 13);
+
+  size_t conFix = 0, sinFix = 0, sinDht = 0, dhtMal = 0, luzBaja = 0, luzAlta = 0;
+  for (size_t i = 0; i < puntos.size(); i++) {
+    const auto& p = puntos[i];
+    const std::string& l = p.second;
+    // Un segundo de margen en cada frontera por la latencia de la tarea IO
+    if (p.first >= 2 && p.first < 29 && contiene(l, "satelites=8i")) conFix++;
+    if (p.first >= 32 && contiene(l, "satelites=0i")) sinFix++;
+    if (p.first >= 22 && p.first < 29 && !contiene(l, "temperatura=")) sinDht++;
+    // La primera muestra sale al conectar, antes de la primera lectura del DHT de la captura
+    if (i > 0 && (p.first < 20 || p.first >= 32) && !contiene(l, "temperatura=25i")) dhtMal++;
+    if (contiene(l, "luz_raw=500i")) luzBaja++;
+    if (contiene(l, "luz_raw=3500i")) luzAlta++;
+  }
+  COMPROBAR(conFix >= 3);
+  COMPROBAR(sinFix >= 3);
+  COMPROBAR_ENTRE(sinDht, 1, 2);
+  COMPROBAR(dhtMal == 0);
+  COMPROBAR(luzBaja + luzAlta == puntos.size());
+  COMPROBAR(luzBaja > 0 && luzAlta > 0);
+
+  // Todos los bytes de la captura, sin desbordar la UART
+  COMPROBAR(simReproduccionBytesGps() == 6900);
+  COMPROBAR(simUartDesbordes(2) == 0);
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
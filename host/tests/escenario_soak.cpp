@@ -0,0 +1,124 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "InfluxDbClient.h"
+#include "WebSerial.h"
+#include "sim_red.h"
+#include "metrics.h"
+#include <algorithm>
+#include <vector>
+
+#define SOAK_HORAS 168  // Una semana
+
+// Lo que teclea la consola y manda Home Assistant, uno cada 30 s
+static const char* const comandos[] = {
+  "sensor all", "relay set 2 on", "relay get 2", "relay set 2 off", "servo set 1 135",
+  "sys info", "sys stats", "sensor history temp 6h 8", "track info", "rule list",
+  "scene list", "sys reloj", "sys tls", "foo bar", "lock set off", "help",
+};
+static const char* const mqtt[][2] = {
+  { TOPICO("relay1/set"), "ON" },
+  { TOPICO("relay1/set"), "OFF" },
+  { TOPICO("rules/set"), "add 7 luz < 20 then relay 3 on else relay 3 off" },
+  { TOPICO("rules/set"), "del 7" },
+  { TOPICO("scenes/set"), "save cine relay1=off relay2=on" },
+  { TOPICO("scenes/set"), "run cine" },
+};
+
+// Pendiente (B por hora) de la recta que mejor ajusta la serie
+static double pendiente(const std::vector<int32_t>& serie) {
+  double n = (double)serie.size(), sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (size_t i = 0; i < serie.size(); i++) {
+    sx += i;
+    sy += serie[i];
+    sxx += (double)i * i;
+    sxy += (double)i * serie[i];
+  }
+  return (n * sxy - sx * sy) / (n * sxx - sx * sx);
+}
+
+// Una semana en Híbrido con consola y comandos MQTT constantes y un corte
+// de red al día: pasado el calentamiento el firmware no reserva heap (solo
+// mbedTLS al reconectar, y lo devuelve), y ni el heap libre ni el bloque
+// mayor bajan
+int main() {
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_HIBRIDO);
+
+  // Calentamiento: TLS, NTP, Discovery, primera vuelta de cada comando y
+  // una reconexión (los buffers de vida larga se reservan aquí)
+  for (size_t i = 0; i < sizeof(comandos) / sizeof(comandos[0]); i++) simWebSerialEnviar(comandos[i]);
+  for (size_t i = 0; i < sizeof(mqtt) / sizeof(mqtt[0]); i++) simBrokerPublicar(mqtt[i][0], mqtt[i][1]);
+  simEjecutarMs(600000);
+  simRedCortar(true);
+  simEjecutarMs(30000);
+  simRedCortar(false);
+  simEjecutarMs(600000);
+
+  SimHeapContadores inicio = simHeapContadores();
+  uint64_t pasosInicio = 0;
+  for (int t = 0; t < TAREA_TOTAL; t++) pasosInicio += simPasosTarea((TareaId)t);
+  uint32_t conexionesInicio = simBrokerConexiones();
+  metricasMuestrearSistema();
+  int32_t minimoInicio = metricaMedidor(MED_HEAP_MIN);
+
+  std::vector<int32_t> libre, bloque;
+  {
+    SimHeapAjeno ajeno;  // Las series son de la prueba
+    libre.reserve(SOAK_HORAS);
+    bloque.reserve(SOAK_HORAS);
+  }
+  size_t c = 0, m = 0;
+  uint64_t reservasSinCorte = 0;
+  for (int hora = 0; hora < SOAK_HORAS; hora++) {
+    uint64_t reservasHora = simHeapContadores().reservas;
+    for (int i = 0; i < 120; i++) {
+      simWebSerialEnviar(comandos[c++ % (sizeof(comandos) / sizeof(comandos[0]))]);
+      if (i % 2 == 0) {
+        simBrokerPublicar(mqtt[m][0], mqtt[m][1]);
+        m = (m + 1) % (sizeof(mqtt) / sizeof(mqtt[0]));
+      }
+      simEjecutarMs(30000);
+    }
+    bool corte = hora % 24 == 12;
+    if (corte) {
+      simRedCortar(true);
+      simEjecutarMs(30000);
+      simRedCortar(false);
+      simEjecutarMs(30000);
+    }
+    if (!corte) reservasSinCorte += simHeapContadores().reservas - reservasHora;
+    metricasMuestrearSistema();
+    libre.push_back(metricaMedidor(MED_HEAP_LIBRE));
+    bloque.push_back(metricaMedidor(MED_HEAP_BLOQUE));
+    // El historial del broker y las líneas de Influx son del simulador
+    simBrokerLimpiar();
+    simInfluxLimpiar();
+  }
+
+  SimHeapContadores fin = simHeapContadores();
+  uint64_t pasos = 0;
+  for (int t = 0; t < TAREA_TOTAL; t++) pasos += simPasosTarea((TareaId)t);
+  printf("  %llu pasos, %llu reservas (%llu sin corte), heap libre %ld..%ld, bloque %ld..%ld\n",
+         (unsigned long long)(pasos - pasosInicio), (unsigned long long)(fin.reservas - inicio.reservas),
+         (unsigned long long)reservasSinCorte,
+         (long)*std::min_element(libre.begin(), libre.end()), (long)*std::max_element(libre.begin(), libre.end()),
+         (long)*std::min_element(bloque.begin(), bloque.end()), (long)*std::max_element(bloque.begin(), bloque.end()));
+
+  COMPROBAR(pasos - pasosInicio >= 1000000);
+  COMPROBAR(simBrokerConexiones() - conexionesInicio >= SOAK_HORAS / 24);
+  COMPROBAR(simDisparosWatchdog() == 0);
+
+  // En régimen, ni una reserva: nada que fragmente
+  COMPROBAR(reservasSinCorte == 0);
+  COMPROBAR(fin.vivo == inicio.vivo);
+  COMPROBAR(simHeapSinBloque() == 0);
+  COMPROBAR(metricaContador(CNT_ARENA_DESBORDES) == 0);
+
+  // Ninguna tendencia a la baja, ni un mínimo nuevo
+  COMPROBAR(pendiente(libre) >= 0);
+  COMPROBAR(pendiente(bloque) >= 0);
+  COMPROBAR(*std::min_element(bloque.begin(), bloque.end()) >= bloque.front());
+  COMPROBAR(metricaMedidor(MED_HEAP_MIN) == minimoInicio);
+  return FIN_PRUEBA();
+}
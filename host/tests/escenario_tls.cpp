@@ -0,0 +1,103 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "sim_board.h"
+#include "sim_red.h"
+#include "sim_tls.h"
+#include "mbedtls/ssl.h"
+#include "WebSerial.h"
+#include "metrics.h"
+#include "Preferences.h"
+
+// Corte de red corto: PubSubClient reconecta en el siguiente intento
+static void cortarYReconectar() {
+  simRedCortar(true);
+  simEjecutarMs(1000);
+  simRedCortar(false);
+  simEjecutarMs(6000);
+}
+
+// MQTT sobre TLS: buffers una vez, reanudación de sesión y costo en diag
+int main() {
+  // TLS es opcional (mqtt_tls): guardado de antes, como en una placa ya configurada
+  Preferences prefs;
+  prefs.begin("ajustes", false);
+  prefs.putUInt("mqtt_tls", 1);
+  prefs.putUInt("mqtt_puerto", 8883);
+  prefs.end();
+  simBrokerIniciar(8883);
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_HIBRIDO);
+  simEjecutarMs(12000);
+
+  // Primer enlace: handshake completo con el certificado
+  COMPROBAR(simBrokerConexiones() == 1);
+  COMPROBAR(simTlsCompletos() == 1 && simTlsReanudados() == 0);
+  int32_t heapTls = metricaMedidor(MED_TLS_HEAP);
+  COMPROBAR(heapTls > MBEDTLS_SSL_IN_CONTENT_LEN + MBEDTLS_SSL_OUT_CONTENT_LEN);
+
+  // Reconexión: reanuda la sesión, sin reservar de nuevo los buffers
+  int64_t vivoAntes = simHeapContadores().vivo;
+  simHeapReiniciarPico();
+  cortarYReconectar();
+  COMPROBAR(simBrokerConexiones() == 2);
+  COMPROBAR(simTlsCompletos() == 1 && simTlsReanudados() == 1);
+  COMPROBAR(simHeapContadores().pico - vivoAntes < (int64_t)simTls().heapCompleto / 2);
+
+  ResumenHistograma completo, reanudado;
+  metricaResumen(HIST_TLS_COMPLETO, completo);
+  metricaResumen(HIST_TLS_REANUDADO, reanudado);
+  COMPROBAR(completo.n == 1 && reanudado.n == 1);
+  COMPROBAR(completo.maxUs >= simTls().completoMs * 1000);
+  COMPROBAR(reanudado.maxUs < completo.maxUs / 5);
+
+  // Consola y diagnóstico
+  std::string tls = simWebSerialEnviar("sys tls");
+  COMPROBAR(contiene(tls, "Handshakes: 1 completos, 1 reanudados"));
+  COMPROBAR(contiene(tls, "Sesion guardada: si, enlace abierto"));
+  simEjecutarMs(11000);
+  const SimMensajeMqtt* diag = simBrokerUltimo(TOPICO("diag/state"));
+  COMPROBAR(diag && contiene(diag->payload, "\"tls_heap\":") && contiene(diag->payload, "\"tls_resum_max\":"));
+  COMPROBAR(simBrokerRetenido("homeassistant/sensor/orion_" SIM_ID "/diag_tls_heap/config") != nullptr);
+
+  // Broker reiniciado: no reconoce el ticket y se vuelve al completo
+  simTlsOlvidarSesiones();
+  cortarYReconectar();
+  COMPROBAR(simBrokerConexiones() == 3);
+  COMPROBAR(simTlsCompletos() == 2 && simTlsReanudados() == 1);
+
+  // Certificado que no firmó la CA: no hay sesión MQTT
+  simTls().caValida = false;
+  simTlsOlvidarSesiones();
+  cortarYReconectar();
+  COMPROBAR(simBrokerConexiones() == 3);
+  COMPROBAR(contiene(simWebSerialEnviar("sys tls"), "error -0x2700"));
+  simTls().caValida = true;
+  simEjecutarMs(6000);
+  COMPROBAR(simBrokerConexiones() == 4);
+
+  // Salir y volver a Cloud: el contexto TLS ya está, no se reserva otra vez
+  simUiBorrar();
+  simEjecutarMs(500);
+  COMPROBAR(simBrokerClientes() == 0);
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  simEjecutarMs(6000);
+  COMPROBAR(simBrokerConexiones() == 5);
+  COMPROBAR(simTlsReanudados() == 2);
+  COMPROBAR(metricaMedidor(MED_TLS_HEAP) == heapTls);
+
+  // En claro al 1883 y de vuelta: el broker de siempre, sin handshakes de más
+  uint32_t completos = simTlsCompletos();
+  simBrokerPublicar(TOPICO("config/set"), "{\"mqtt_tls\":0,\"mqtt_puerto\":1883}");
+  simEjecutarMs(3000);
+  COMPROBAR(simBrokerConexiones() == 6 && simBrokerClientes() == 1);
+  COMPROBAR(simTlsCompletos() == completos);
+  simBrokerPublicar(TOPICO("config/set"), "{\"mqtt_tls\":1,\"mqtt_puerto\":8883}");
+  simEjecutarMs(3000);
+  COMPROBAR(simBrokerConexiones() == 7 && simBrokerClientes() == 1);
+  COMPROBAR(simTlsCompletos() == completos + 1);
+
+  simUiBorrar();
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
@@ -0,0 +1,107 @@
+#include "prueba.h"
+#include "arranque.h"
+#include "InfluxDbClient.h"
+#include "sim_board.h"
+#include "trayecto.h"
+#include <math.h>
+#include <vector>
+
+struct Vertice {
+  double lat, lng;
+};
+
+// Polyline (precisión 5) de vuelta a grados
+static std::vector<Vertice> decodificar(const std::string& poly) {
+  std::vector<Vertice> out;
+  int32_t v[2] = { 0, 0 };
+  size_t i = 0;
+  while (i < poly.size()) {
+    for (int d = 0; d < 2; d++) {
+      uint32_t u = 0;
+      int corrimiento = 0, c;
+      do {
+        c = poly[i++] - 63;
+        u |= (uint32_t)(c & 0x1f) << corrimiento;
+        corrimiento += 5;
+      } while (c >= 0x20);
+      v[d] += (u & 1) ? ~(int32_t)(u >> 1) : (int32_t)(u >> 1);
+    }
+    out.push_back({ v[0] * 1e-5, v[1] * 1e-5 });
+  }
+  return out;
+}
+
+static std::string campo(const std::string& json, const char* clave) {
+  std::string k = std::string("\"") + clave + "\":\"";
+  size_t a = json.find(k);
+  if (a == std::string::npos) return "";
+  a += k.size();
+  std::string out;
+  for (size_t i = a; i < json.size() && json[i] != '"'; i++) {
+    if (json[i] == '\\' && i + 1 < json.size()) i++;
+    out += json[i];
+  }
+  return out;
+}
+
+static double metros(double lat1, double lng1, double lat2, double lng2) {
+  double x = (lng2 - lng1) * cos(lat1 * PI / 180) * 111320.0;
+  double y = (lat2 - lat1) * 111320.0;
+  return sqrt(x * x + y * y);
+}
+
+static size_t lineasConPosicion() {
+  size_t n = 0;
+  for (const std::string& l : simInfluxLineas()) n += l.find("latitud=") != std::string::npos;
+  return n;
+}
+
+// Estacionado casi no publica posición; en movimiento, el trayecto
+// conserva las esquinas con muchos menos puntos que fixes
+int main() {
+  simEntorno().gpsRuidoM = 3.0;
+  arrancarPlaca();
+  simEjecutarMs(500);
+  simUiElegir(MENU_TOTAL, MENU_CLOUD);
+  simEjecutarMs(40000);  // Fix a los 30 s
+
+  // 10 min quieto: el primer punto y, como mucho, un latido
+  simInfluxLimpiar();
+  size_t gpsAntes = simBrokerContar(TOPICO("gps/state"));
+  simEjecutarMs(590000);
+  COMPROBAR(simInfluxEscrituras() >= 100);
+  COMPROBAR(lineasConPosicion() <= 1);
+  COMPROBAR(simBrokerContar(TOPICO("gps/state")) - gpsAntes <= 1);
+  COMPROBAR(trayectoTotal() <= 2);
+
+  // 2 min al norte y 2 min al este a 15 m/s
+  double esquinaLat = 0, esquinaLng = 0;
+  uint32_t antes = trayectoTotal();
+  simEntorno().gpsVelocidadMps = 15.0;
+  simEntorno().gpsRumboGrados = 0.0;
+  simEjecutarMs(120000);
+  esquinaLat = simEntorno().gpsLat;
+  esquinaLng = simEntorno().gpsLng;
+  simEntorno().gpsRumboGrados = 90.0;
+  simEjecutarMs(120000);
+  simEntorno().gpsVelocidadMps = 0.0;
+  simEjecutarMs(70000);  // El último lote sale al minuto
+
+  uint32_t guardados = trayectoTotal() - antes;
+  COMPROBAR_ENTRE(guardados, 3, 24);  // 240 fixes
+
+  // Los lotes cubren todos los puntos y alguno cae en la esquina
+  std::vector<Vertice> todos;
+  for (const SimMensajeMqtt& m : simBrokerHistorial()) {
+    if (m.topic != TOPICO("gps/track")) continue;
+    std::vector<Vertice> v = decodificar(campo(m.payload, "poly"));
+    todos.insert(todos.end(), v.begin(), v.end());
+  }
+  COMPROBAR(todos.size() == trayectoTotal());
+  double mejor = 1e9;
+  for (const Vertice& v : todos) mejor = fmin(mejor, metros(v.lat, v.lng, esquinaLat, esquinaLng));
+  COMPROBAR(mejor <= TRAYECTO_TOLERANCIA_M + 2 * 3.0);
+
+  COMPROBAR(simDisparosWatchdog() == 0);
+  return FIN_PRUEBA();
+}
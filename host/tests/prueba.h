@@ -0,0 +1,37 @@
+#ifndef PRUEBA_H
+#define PRUEBA_H
+
+#include <stdio.h>
+#include <string>
+
+/* Aserciones mínimas para los escenarios: no cortan la prueba, solo
+   cuentan fallos. FIN_PRUEBA() devuelve el código de salida de ctest. */
+
+static int fallosPrueba = 0;
+
+#define COMPROBAR(cond)                                                          \
+  do {                                                                           \
+    if (!(cond)) {                                                               \
+      fprintf(stderr, "%s:%d: falla: %s\n", __FILE__, __LINE__, #cond);          \
+      fallosPrueba++;                                                            \
+    }                                                                            \
+  } while (0)
+
+#define COMPROBAR_ENTRE(v, min, max)                                             \
+  do {                                                                           \
+    double _v = (double)(v);                                                     \
+    if (_v < (min) || _v > (max)) {                                              \
+      fprintf(stderr, "%s:%d: falla: %s = %g fuera de [%g, %g]\n", __FILE__,     \
+              __LINE__, #v, _v, (double)(min), (double)(max));                   \
+      fallosPrueba++;                                                            \
+    }                                                                            \
+  } while (0)
+
+#define FIN_PRUEBA() (fallosPrueba ? 1 : 0)
+
+// Respuestas de consola, HTTP y MQTT: basta con que lleven el fragmento
+static inline bool contiene(const std::string& s, const char* fragmento) {
+  return s.find(fragmento) != std::string::npos;
+}
+
+#endif
@@ -0,0 +1,331 @@
+#include "ajustes.h"
+#include <Preferences.h>
+#include <ArduinoJson.h>
+#include <stddef.h>
+
+#define NVS_ESPACIO "ajustes"
+
+Ajustes ajustes;
+
+// Una entrada por AjusteId, en el mismo orden. max == 0: ajuste de texto
+struct DefAjuste {
+  const char* clave;     // También la clave en NVS (hasta 15 caracteres)
+  uint16_t campo;        // offsetof en Ajustes
+  uint32_t defecto;
+  uint32_t min;
+  uint32_t max;
+  const char* unidad;
+  const char* textoDefecto;  // Solo los de texto
+};
+
+#define MQTT_HOST_DEFECTO "130.107.73.33"  // Tu IP Azure
+#define UBICACION_DEFECTO "Azure_Demo"
+
+static const DefAjuste definiciones[AJ_TOTAL] = {
+  { "intervalo_ms", offsetof(Ajustes, intervaloMs), 5000, 1000, 3600000, "ms" },
+  { "diag_ms", offsetof(Ajustes, diagMs), 10000, 2000, 3600000, "ms" },
+  { "mqtt_host", offsetof(Ajustes, mqttHost), 0, 0, 0, "", MQTT_HOST_DEFECTO },
+  { "mqtt_puerto", offsetof(Ajustes, mqttPuerto), 1883, 1, 65535, "" },  // 8883 con mqtt_tls
+  { "mqtt_tls", offsetof(Ajustes, mqttTls), 0, 0, 1, "" },
+  { "mqtt_buffer", offsetof(Ajustes, mqttBuffer), 2048, 1024, 16384, "B" },
+  { "ldr_muestras", offsetof(Ajustes, ldrMuestras), 1, 1, 64, "" },
+  { "ldr_min", offsetof(Ajustes, ldrMin), 300, 0, 4094, "" },
+  { "ldr_max", offsetof(Ajustes, ldrMax), 4095, 1, 4095, "" },
+  { "gps_baudios", offsetof(Ajustes, gpsBaudios), 9600, 4800, 115200, "" },
+  { "rebote_ms", offsetof(Ajustes, reboteMs), 200, 10, 2000, "ms" },
+  { "bajo_consumo", offsetof(Ajustes, bajoConsumo), 0, 0, 1, "" },
+  { "latencia_ms", offsetof(Ajustes, latenciaMs), 2000, 200, 20000, "ms" },  // Bajo el watchdog (30 s)
+  { "ubicacion", offsetof(Ajustes, ubicacion), 0, 0, 0, "", UBICACION_DEFECTO },
+};
+
+static const uint32_t baudiosGps[] = { 4800, 9600, 19200, 38400, 57600, 115200 };
+
+// El mutex ordena a quienes escriben (consola en AsyncTCP, MQTT en la
+// tarea de red), NVS incluido; el spinlock, la copia frente a ajustesTexto()
+static SemaphoreHandle_t mutexAjustes = nullptr;
+static portMUX_TYPE muxAjustes = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t secuencia = 0;
+
+static bool esTexto(const DefAjuste& d) {
+  return d.max == 0;
+}
+
+static uint32_t& entero(Ajustes& a, const DefAjuste& d) {
+  return *(uint32_t*)((uint8_t*)&a + d.campo);
+}
+
+static char* texto(Ajustes& a, const DefAjuste& d) {
+  return (char*)&a + d.campo;
+}
+
+static int buscar(const char* clave) {
+  for (int i = 0; i < AJ_TOTAL; i++) {
+    if (strcasecmp(definiciones[i].clave, clave) == 0) return i;
+  }
+  return -1;
+}
+
+static void porDefecto(Ajustes& a, const DefAjuste& d) {
+  if (esTexto(d)) strlcpy(texto(a, d), d.textoDefecto, AJUSTE_TEXTO_MAX + 1);
+  else entero(a, d) = d.defecto;
+}
+
+static bool esDefecto(Ajustes& a, const DefAjuste& d) {
+  return esTexto(d) ? strcmp(texto(a, d), d.textoDefecto) == 0 : entero(a, d) == d.defecto;
+}
+
+// ---------------------------------------------------------
+// VALIDACIÓN
+// ---------------------------------------------------------
+// Nombre de host o etiqueta de Influx: nada que haya que escapar
+static bool textoValido(const char* valor) {
+  size_t n = strlen(valor);
+  if (n == 0 || n > AJUSTE_TEXTO_MAX) return false;
+  for (size_t i = 0; i < n; i++) {
+    char c = valor[i];
+    if (!isalnum((unsigned char)c) && c != '.' && c != '-' && c != '_') return false;
+  }
+  return true;
+}
+
+// Un valor sobre la copia 'c'; no toca 'ajustes'
+static bool leer(Ajustes& c, const DefAjuste& d, const char* valor, char* resp, size_t cap) {
+  if (esTexto(d)) {
+    if (!textoValido(valor)) {
+      snprintf(resp, cap, "Error: %s de 1 a %d caracteres a-z 0-9 . - _", d.clave, AJUSTE_TEXTO_MAX);
+      return false;
+    }
+    strlcpy(texto(c, d), valor, AJUSTE_TEXTO_MAX + 1);
+    return true;
+  }
+  char* fin = nullptr;
+  unsigned long v = strtoul(valor, &fin, 10);
+  if (!isdigit((unsigned char)valor[0]) || *fin || v < d.min || v > d.max) {
+    snprintf(resp, cap, "Error: %s entre %lu y %lu", d.clave, (unsigned long)d.min, (unsigned long)d.max);
+    return false;
+  }
+  entero(c, d) = (uint32_t)v;
+  return true;
+}
+
+// Lo que depende de más de un ajuste, ya con todos los cambios puestos
+static bool coherente(const Ajustes& c, char* resp, size_t cap) {
+  if (c.ldrMin >= c.ldrMax) {
+    snprintf(resp, cap, "Error: ldr_min (%lu) debe ser menor que ldr_max (%lu)", (unsigned long)c.ldrMin,
+             (unsigned long)c.ldrMax);
+    return false;
+  }
+  for (uint32_t b : baudiosGps) {
+    if (c.gpsBaudios == b) return true;
+  }
+  snprintf(resp, cap, "Error: gps_baudios 4800|9600|19200|38400|57600|115200");
+  return false;
+}
+
+// ---------------------------------------------------------
+// APLICAR Y GUARDAR
+// ---------------------------------------------------------
+// Con el mutex tomado. Solo escribe en NVS las claves que cambiaron
+static uint8_t confirmar(Ajustes& c) {
+  Ajustes antes;
+  portENTER_CRITICAL(&muxAjustes);
+  antes = ajustes;
+  portEXIT_CRITICAL(&muxAjustes);
+
+  uint8_t cambios = 0;
+  Preferences prefs;
+  for (int i = 0; i < AJ_TOTAL; i++) {
+    const DefAjuste& d = definiciones[i];
+    bool igual = esTexto(d) ? strcmp(texto(c, d), texto(antes, d)) == 0 : entero(c, d) == entero(antes, d);
+    if (igual) continue;
+    if (!cambios++) prefs.begin(NVS_ESPACIO, false);
+    if (esDefecto(c, d)) prefs.remove(d.clave);
+    else if (esTexto(d)) prefs.putString(d.clave, texto(c, d));
+    else prefs.putUInt(d.clave, entero(c, d));
+  }
+  if (!cambios) return 0;
+  prefs.end();
+
+  portENTER_CRITICAL(&muxAjustes);
+  ajustes = c;
+  secuencia++;
+  portEXIT_CRITICAL(&muxAjustes);
+  return cambios;
+}
+
+void ajustesIniciar() {
+  if (!mutexAjustes) mutexAjustes = xSemaphoreCreateMutex();
+  Ajustes c;
+  for (const DefAjuste& d : definiciones) porDefecto(c, d);
+
+  // Un valor guardado que ya no vale (otro rango en esta versión) se ignora
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, true);
+  char guardado[AJUSTE_TEXTO_MAX + 1];
+  char resp[80];
+  for (const DefAjuste& d : definiciones) {
+    if (!prefs.isKey(d.clave)) continue;
+    Ajustes prueba = c;
+    if (esTexto(d)) prefs.getString(d.clave, guardado, sizeof(guardado));
+    else snprintf(guardado, sizeof(guardado), "%lu", (unsigned long)prefs.getUInt(d.clave));
+    if (leer(prueba, d, guardado, resp, sizeof(resp)) && coherente(prueba, resp, sizeof(resp))) c = prueba;
+  }
+  prefs.end();
+
+  portENTER_CRITICAL(&muxAjustes);
+  ajustes = c;
+  secuencia++;
+  portEXIT_CRITICAL(&muxAjustes);
+}
+
+uint32_t ajustesSecuencia() {
+  return secuencia;
+}
+
+bool ajustesFijarVarios(const char* const* claves, const char* const* valores, size_t n, char* resp, size_t cap) {
+  xSemaphoreTake(mutexAjustes, portMAX_DELAY);
+  Ajustes c;
+  portENTER_CRITICAL(&muxAjustes);
+  c = ajustes;
+  portEXIT_CRITICAL(&muxAjustes);
+
+  bool ok = n > 0;
+  if (!ok) snprintf(resp, cap, "Error: sin ajustes (cfg para ver las claves)");
+  for (size_t i = 0; i < n && ok; i++) {
+    int id = buscar(claves[i]);
+    if (id < 0) {
+      snprintf(resp, cap, "Error: no existe '%s' (cfg para ver las claves)", claves[i]);
+      ok = false;
+    } else {
+      ok = leer(c, definiciones[id], valores[i], resp, cap);
+    }
+  }
+  if (ok) ok = coherente(c, resp, cap);
+  if (ok) {
+    uint8_t cambios = confirmar(c);
+    if (n == 1) snprintf(resp, cap, "OK: %s = %s%s", claves[0], valores[0], cambios ? "" : " (sin cambios)");
+    else snprintf(resp, cap, "OK: %u de %u ajustes cambiados", cambios, (unsigned)n);
+  }
+  xSemaphoreGive(mutexAjustes);
+  return ok;
+}
+
+bool ajustesFijar(const char* clave, const char* valor, char* resp, size_t cap) {
+  return ajustesFijarVarios(&clave, &valor, 1, resp, cap);
+}
+
+bool ajustesFijarJson(const char* json, char* resp, size_t cap) {
+  StaticJsonDocument<512> doc;
+  if (deserializeJson(doc, json) || !doc.is<JsonObject>()) {
+    snprintf(resp, cap, "Error: se espera un objeto JSON {\"clave\":valor}");
+    return false;
+  }
+  // Los números se pasan a texto: una sola validación para todos los orígenes
+  const char* claves[AJ_TOTAL];
+  const char* valores[AJ_TOTAL];
+  char numeros[AJ_TOTAL][12];
+  size_t n = 0;
+  for (JsonPair par : doc.as<JsonObject>()) {
+    if (n == AJ_TOTAL) {
+      snprintf(resp, cap, "Error: mas de %d ajustes", AJ_TOTAL);
+      return false;
+    }
+    claves[n] = par.key().c_str();
+    if (par.value().is<const char*>()) {
+      valores[n] = par.value().as<const char*>();
+    } else if (par.value().is<uint32_t>()) {
+      snprintf(numeros[n], sizeof(numeros[n]), "%lu", (unsigned long)par.value().as<uint32_t>());
+      valores[n] = numeros[n];
+    } else {
+      valores[n] = "";
+    }
+    n++;
+  }
+  return ajustesFijarVarios(claves, valores, n, resp, cap);
+}
+
+bool ajustesComando(const char* linea, char* resp, size_t cap) {
+  char copia[96];
+  strlcpy(copia, linea, sizeof(copia));
+  char* ctx = nullptr;
+  char* orden = strtok_r(copia, " ", &ctx);
+  char* clave = strtok_r(nullptr, " ", &ctx);
+  char* valor = strtok_r(nullptr, " ", &ctx);
+
+  if (orden && strcasecmp(orden, "set") == 0 && clave && valor) {
+    return ajustesFijar(clave, valor, resp, cap);
+  }
+  if (orden && strcasecmp(orden, "reset") == 0) {
+    // Volver al valor de compilación también pasa por la validación
+    Ajustes defecto;
+    const char* claves[AJ_TOTAL];
+    const char* valores[AJ_TOTAL];
+    char textos[AJ_TOTAL][AJUSTE_TEXTO_MAX + 1];
+    size_t n = 0;
+    for (int i = 0; i < AJ_TOTAL; i++) {
+      const DefAjuste& d = definiciones[i];
+      if (clave && strcasecmp(clave, d.clave) != 0) continue;
+      porDefecto(defecto, d);
+      if (esTexto(d)) strlcpy(textos[n], texto(defecto, d), sizeof(textos[n]));
+      else snprintf(textos[n], sizeof(textos[n]), "%lu", (unsigned long)entero(defecto, d));
+      claves[n] = d.clave;
+      valores[n] = textos[n];
+      n++;
+    }
+    if (clave && !n) {
+      snprintf(resp, cap, "Error: no existe '%s' (cfg para ver las claves)", clave);
+      return false;
+    }
+    return ajustesFijarVarios(claves, valores, n, resp, cap);
+  }
+  snprintf(resp, cap, "Error: cfg | cfg set <clave> <valor> | cfg reset [clave]");
+  return false;
+}
+
+// ---------------------------------------------------------
+// CONSULTA
+// ---------------------------------------------------------
+void ajustesTexto(AjusteId id, char* buf, size_t cap) {
+  if (id >= AJ_TOTAL) {
+    if (cap) buf[0] = '\0';
+    return;
+  }
+  const DefAjuste& d = definiciones[id];
+  portENTER_CRITICAL(&muxAjustes);
+  if (esTexto(d)) strlcpy(buf, texto(ajustes, d), cap);
+  else snprintf(buf, cap, "%lu", (unsigned long)entero(ajustes, d));
+  portEXIT_CRITICAL(&muxAjustes);
+}
+
+size_t ajustesJson(char* buf, size_t cap) {
+  Ajustes a;
+  portENTER_CRITICAL(&muxAjustes);
+  a = ajustes;
+  portEXIT_CRITICAL(&muxAjustes);
+
+  StaticJsonDocument<512> doc;
+  for (const DefAjuste& d : definiciones) {
+    if (esTexto(d)) doc[d.clave] = (const char*)texto(a, d);
+    else doc[d.clave] = entero(a, d);
+  }
+  if (measureJson(doc) >= cap) return 0;
+  return serializeJson(doc, buf, cap);
+}
+
+void ajustesImprimir(Print& out) {
+  Ajustes a;
+  portENTER_CRITICAL(&muxAjustes);
+  a = ajustes;
+  portEXIT_CRITICAL(&muxAjustes);
+
+  out.println("--- AJUSTES (cfg set <clave> <valor>; * = distinto del de compilacion) ---");
+  for (const DefAjuste& d : definiciones) {
+    const char* marca = esDefecto(a, d) ? " " : "*";
+    if (esTexto(d)) {
+      out.printf("%s %-13s %s\n", marca, d.clave, texto(a, d));
+    } else {
+      out.printf("%s %-13s %lu %s (%lu..%lu)\n", marca, d.clave, (unsigned long)entero(a, d), d.unidad,
+                 (unsigned long)d.min, (unsigned long)d.max);
+    }
+  }
+}
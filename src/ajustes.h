@@ -0,0 +1,78 @@
+#ifndef AJUSTES_H
+#define AJUSTES_H
+
+#include <Arduino.h>
+
+/* =======================
+   AJUSTES EN CALIENTE
+   =======================
+   Parámetros de muestreo y publicación que se afinan por sitio sin volver
+   a flashear. Cada uno tiene su valor de compilación, su rango y su clave
+   en NVS (solo se guardan los que difieren del de compilación).
+
+   Se leen como un campo más (ajustes.intervaloMs) desde cualquier tarea.
+   Se cambian por "cfg set <clave> <valor>", POST /config.json y
+   orion/<id>/config/set (retenido, objeto JSON), siempre a través de
+   ajustesFijarVarios(): valida todo, copia de una vez y sube
+   ajustesSecuencia(). Quien tiene que reconfigurar algo (baudios del GPS,
+   broker MQTT) compara la secuencia en su propio paso. */
+
+#define AJUSTE_TEXTO_MAX 63   // Caracteres de un ajuste de texto (sin el terminador)
+#define AJUSTES_JSON_MAX 512  // ajustesJson() con todos los textos al máximo
+
+enum AjusteId : uint8_t {
+  AJ_INTERVALO,      // Lectura y envío de sensores (Cloud)
+  AJ_DIAG,           // Métricas a diag/state
+  AJ_MQTT_HOST,
+  AJ_MQTT_PUERTO,
+  AJ_MQTT_TLS,       // 1: TLS verificado con mqtt_ca.h (el broker necesita un nombre en su certificado)
+  AJ_MQTT_BUFFER,    // PubSubClient: el mensaje más largo (Discovery)
+  AJ_LDR_MUESTRAS,   // Lecturas del ADC promediadas por muestra
+  AJ_LDR_MIN,        // Crudo que es 0 %
+  AJ_LDR_MAX,        // Crudo que es 100 %
+  AJ_GPS_BAUDIOS,
+  AJ_REBOTE,         // Antirrebote de los botones
+  AJ_BAJO_CONSUMO,   // 1: light sleep entre ventanas (Cloud), ver energia.h
+  AJ_LATENCIA,       // Bajo consumo: lo más que tarda en atenderse una orden
+  AJ_UBICACION,      // Etiqueta ubicacion= de InfluxDB
+  AJ_TOTAL
+};
+
+// Enteros de 32 bits alineados: una tarea nunca ve uno a medio escribir
+struct Ajustes {
+  uint32_t intervaloMs;
+  uint32_t diagMs;
+  uint32_t mqttPuerto;
+  uint32_t mqttTls;
+  uint32_t mqttBuffer;
+  uint32_t ldrMuestras;
+  uint32_t ldrMin;
+  uint32_t ldrMax;
+  uint32_t gpsBaudios;
+  uint32_t reboteMs;
+  uint32_t bajoConsumo;
+  uint32_t latenciaMs;
+  char mqttHost[AJUSTE_TEXTO_MAX + 1];   // Se copian con ajustesTexto()
+  char ubicacion[AJUSTE_TEXTO_MAX + 1];
+};
+
+// Solo ajustes.cpp escribe; el resto lee los campos directamente
+extern Ajustes ajustes;
+
+void ajustesIniciar();        // Valores de compilación y NVS (en setup, antes de IO)
+uint32_t ajustesSecuencia();  // Sube con cada cambio aplicado
+
+// Todo o nada: si una clave o un valor no vale, no cambia ninguno.
+// Deja "OK: ..." o el motivo en 'resp'.
+bool ajustesFijarVarios(const char* const* claves, const char* const* valores, size_t n, char* resp, size_t cap);
+bool ajustesFijar(const char* clave, const char* valor, char* resp, size_t cap);
+bool ajustesFijarJson(const char* json, char* resp, size_t cap);   // {"intervalo_ms":10000,...}
+
+// Órdenes de "cfg" (WebSerial): set <clave> <valor> | reset [clave]
+bool ajustesComando(const char* linea, char* resp, size_t cap);
+
+void ajustesTexto(AjusteId id, char* buf, size_t cap);  // Valor actual
+size_t ajustesJson(char* buf, size_t cap);               // 0 si no cabe
+void ajustesImprimir(Print& out);
+
+#endif
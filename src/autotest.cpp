@@ -0,0 +1,446 @@
+#include "autotest.h"
+#include "io_task.h"
+#include <ArduinoJson.h>
+
+#define AUTOTEST_DISPOSITIVO "ESP32_Orion_V1"
+
+#define AT_CONFIRMAR_MS 500   // Orden que IO no confirma en este tiempo: falla
+#define AT_RELE_MS      300   // Tiempo encendido de cada relé
+#define AT_SERVO_MS     600   // Recorrido mecánico entre ángulos
+#define AT_GPS_CADA_MS  5000
+#define AT_GPS_MAX_MS   90000 // Sin fix en este tiempo: falla (arranque en frío ~30 s)
+
+enum PasoAutotest : uint8_t {
+  PASO_INACTIVO,
+  PASO_ACTUADOR_ORDEN,     // Encender el actuador 'indice'
+  PASO_ACTUADOR_ON,        // Esperar confirmación de IO
+  PASO_ACTUADOR_ENCENDIDO,
+  PASO_ACTUADOR_OFF,
+  PASO_SERVOS_ORDEN,       // Los tres al ángulo 'indice'
+  PASO_SERVOS_ESPERA,
+  PASO_SERVOS_RECORRIDO,
+  PASO_SENSORES
+};
+
+static const ActuadorId actuadoresPrueba[5] = { ACT_RELAY_1, ACT_RELAY_2, ACT_RELAY_3, ACT_RELAY_4, ACT_LOCK };
+static const int16_t angulosPrueba[3] = { 0, 90, 180 };
+
+// --- PETICIONES DE OTRAS TAREAS ---
+static volatile uint8_t solicitud = 0;
+static volatile bool cancelar = false;
+
+// --- ESTADO DE LA MÁQUINA (solo tarea UI) ---
+static PasoAutotest paso = PASO_INACTIVO;
+static ResultadoAutotest res;
+static ResultadoAutotest ultimo;     // Última corrida terminada
+static EstadoActuadores previos;     // Para dejar todo como estaba
+static uint8_t indice = 0;           // Actuador o ángulo en curso
+static uint32_t ordenUs = 0;         // micros() al encolar la orden
+static uint32_t aplicadoAntes[ACT_TOTAL];
+static uint8_t pendientes = 0;       // Bits de servos sin confirmar
+static unsigned long desdeMs = 0;
+static uint16_t ultimaDht = 0;
+static uint16_t ultimaLdr = 0;
+static unsigned long ultimaGpsMs = 0;
+static char etapa[20] = "";
+
+// --- REPORTE (cualquier tarea) ---
+static portMUX_TYPE muxReporte = portMUX_INITIALIZER_UNLOCKED;
+static char reporte[AUTOTEST_REPORTE_MAX];
+static size_t reporteLen = 0;
+static volatile uint32_t secuencia = 0;
+
+// ---------------------------------------------------------
+// ÓRDENES A LA TAREA IO
+// ---------------------------------------------------------
+static bool ordenar(ActuadorId act, int16_t valor) {
+  EstadoActuadores e;
+  ioObtenerActuadores(e);
+  aplicadoAntes[act] = e.aplicadoUs[act];
+  ordenUs = micros();
+  desdeMs = millis();
+  return ioEscribir(act, valor, ORIGEN_UI);
+}
+
+// Latencia en us si IO ya aplicó la orden (y en relés el pin releído coincide); -1 si no
+static int32_t confirmado(const EstadoActuadores& e, ActuadorId act, int16_t valor) {
+  if (e.aplicadoUs[act] == aplicadoAntes[act]) return -1;
+  if (act <= ACT_LOCK && ((e.leidos >> act) & 1) != (valor ? 1 : 0)) return -1;
+  return (int32_t)(e.aplicadoUs[act] - ordenUs);
+}
+
+// ---------------------------------------------------------
+// REPORTE JSON
+// ---------------------------------------------------------
+static void actuadorJSON(JsonObject o, const ResultadoActuador& r) {
+  o["ok"] = r.ok;
+  o["on_us"] = r.onUs;
+  o["off_us"] = r.offUs;
+}
+
+static void generarReporte() {
+  // Estático: la pila de la tarea UI no da para el documento
+  static StaticJsonDocument<1536> doc;
+  static char borrador[AUTOTEST_REPORTE_MAX];
+  doc.clear();
+
+  doc["dispositivo"] = AUTOTEST_DISPOSITIVO;
+  doc["ok"] = res.ok;
+  doc["uptime_ms"] = millis();
+  doc["duracion_ms"] = res.duracionMs;
+
+  if (res.fases & AT_RELES) {
+    JsonArray reles = doc.createNestedArray("reles");
+    for (int i = 0; i < 4; i++) actuadorJSON(reles.createNestedObject(), res.reles[i]);
+  }
+  if (res.fases & AT_CERRADURA) actuadorJSON(doc.createNestedObject("cerradura"), res.cerradura);
+
+  if (res.fases & AT_SERVOS) {
+    JsonObject s = doc.createNestedObject("servos");
+    s["ok"] = res.servosOk;
+    JsonArray maxUs = s.createNestedArray("max_us");
+    for (int i = 0; i < 3; i++) maxUs.add(res.servoMaxUs[i]);
+  }
+
+  if (res.fases & AT_DHT) {
+    JsonObject d = doc.createNestedObject("dht");
+    d["ok"] = res.dhtOk;
+    d["lecturas"] = res.dhtLecturas;
+    d["errores"] = res.dhtErrores;
+    d["tasa_error"] = res.dhtLecturas ? (float)res.dhtErrores / res.dhtLecturas : 0.0f;
+    d["min_us"] = res.dhtMinUs;
+    d["media_us"] = res.dhtLecturas ? res.dhtSumaUs / res.dhtLecturas : 0;
+    d["max_us"] = res.dhtMaxUs;
+    if (res.dhtErrores < res.dhtLecturas) {
+      d["temp"] = res.temp;
+      d["hum"] = res.hum;
+    }
+  }
+
+  if (res.fases & AT_LDR) {
+    JsonObject l = doc.createNestedObject("ldr");
+    l["ok"] = res.ldrOk;
+    l["muestras"] = res.ldrMuestras;
+    if (res.ldrMuestras) {
+      float media = (float)res.ldrSuma / res.ldrMuestras;
+      float var = (float)res.ldrSumaCuad / res.ldrMuestras - media * media;
+      l["media"] = (int)(media + 0.5f);
+      l["min"] = res.ldrMin;
+      l["max"] = res.ldrMax;
+      l["desv"] = var > 0 ? sqrtf(var) : 0.0f;
+    }
+  }
+
+  if (res.fases & AT_GPS) {
+    JsonObject g = doc.createNestedObject("gps");
+    g["ok"] = res.gpsOk;
+    g["ttff_ms"] = res.gpsTtffMs;
+    JsonArray sats = g.createNestedArray("sats");
+    for (int i = 0; i < res.gpsMuestras; i++) sats.add(res.gpsSats[i]);
+  }
+
+  size_t n = serializeJson(doc, borrador, sizeof(borrador));
+  portENTER_CRITICAL(&muxReporte);
+  memcpy(reporte, borrador, n + 1);
+  reporteLen = n;
+  secuencia = secuencia + 1;
+  portEXIT_CRITICAL(&muxReporte);
+}
+
+// ---------------------------------------------------------
+// TRANSICIONES
+// ---------------------------------------------------------
+static void restaurar() {
+  for (int i = 0; i < 4; i++) {
+    if ((res.fases & AT_RELES) && previos.relays[i]) ioEscribir((ActuadorId)(ACT_RELAY_1 + i), 1, ORIGEN_UI);
+  }
+  if ((res.fases & AT_CERRADURA) && previos.lockAbierto) ioEscribir(ACT_LOCK, 1, ORIGEN_UI);
+  if (res.fases & AT_SERVOS) {
+    for (int i = 0; i < 3; i++) ioEscribir((ActuadorId)(ACT_SERVO_1 + i), previos.servos[i], ORIGEN_UI);
+  }
+}
+
+static void terminar() {
+  res.ok = true;
+  if (res.fases & AT_RELES) {
+    for (int i = 0; i < 4; i++) res.ok &= res.reles[i].ok;
+  }
+  if (res.fases & AT_CERRADURA) res.ok &= res.cerradura.ok;
+  if (res.fases & AT_SERVOS) res.ok &= res.servosOk;
+
+  // DHT: al menos una lectura válida y no más de 1 de cada 5 con error
+  res.dhtOk = res.dhtLecturas > res.dhtErrores && res.dhtErrores * 5 <= res.dhtLecturas;
+  if (res.fases & AT_DHT) res.ok &= res.dhtOk;
+
+  // LDR: pegado a 0 o a fondo de escala = desconectado o en corto
+  res.ldrOk = res.ldrMuestras > 0 && res.ldrMax > 0 && res.ldrMin < 4095;
+  if (res.fases & AT_LDR) res.ok &= res.ldrOk;
+
+  res.gpsOk = res.gpsTtffMs != 0;
+  if (res.fases & AT_GPS) res.ok &= res.gpsOk;
+
+  res.duracionMs = millis() - res.inicioMs;
+  restaurar();
+  ultimo = res;
+  generarReporte();
+  paso = PASO_INACTIVO;
+  etapa[0] = '\0';
+}
+
+// Siguiente fase habilitada a partir de 'desde'
+static void avanzar(PasoAutotest desde) {
+  if (desde <= PASO_ACTUADOR_ORDEN) {
+    // Relés y/o cerradura, desde 'indice'
+    for (; indice < 5; indice++) {
+      bool esLock = actuadoresPrueba[indice] == ACT_LOCK;
+      if (res.fases & (esLock ? AT_CERRADURA : AT_RELES)) {
+        paso = PASO_ACTUADOR_ORDEN;
+        return;
+      }
+    }
+  }
+  if (desde <= PASO_SERVOS_ORDEN && (res.fases & AT_SERVOS)) {
+    indice = 0;
+    paso = PASO_SERVOS_ORDEN;
+    return;
+  }
+  if (res.fases & (AT_DHT | AT_LDR | AT_GPS)) {
+    LecturaSensores l;
+    ioObtenerLectura(l);
+    ultimaDht = l.dhtLecturas;
+    ultimaLdr = l.ldrLecturas;
+    ultimaGpsMs = millis() - AT_GPS_CADA_MS;  // Primera muestra ya
+    strlcpy(etapa, "Sensores", sizeof(etapa));
+    paso = PASO_SENSORES;
+    return;
+  }
+  terminar();
+}
+
+static void iniciar(uint8_t fases) {
+  memset(&res, 0, sizeof(res));
+  res.fases = fases & AT_COMPLETO;
+  res.inicioMs = millis();
+  res.dhtMinUs = UINT32_MAX;
+  res.ldrMin = UINT16_MAX;
+  res.servosOk = true;
+  ioObtenerActuadores(previos);
+  indice = 0;
+  avanzar(PASO_ACTUADOR_ORDEN);
+}
+
+// ---------------------------------------------------------
+// PASOS
+// ---------------------------------------------------------
+static ResultadoActuador& resultadoDe(uint8_t i) {
+  return actuadoresPrueba[i] == ACT_LOCK ? res.cerradura : res.reles[i];
+}
+
+static void pasoActuador(const EstadoActuadores& e) {
+  ActuadorId act = actuadoresPrueba[indice];
+  ResultadoActuador& r = resultadoDe(indice);
+  unsigned long now = millis();
+
+  switch (paso) {
+    case PASO_ACTUADOR_ORDEN:
+      if (act == ACT_LOCK) strlcpy(etapa, "Cerradura", sizeof(etapa));
+      else snprintf(etapa, sizeof(etapa), "Relay %d", indice + 1);
+      if (ordenar(act, 1)) paso = PASO_ACTUADOR_ON;  // Cola llena: se reintenta
+      break;
+
+    case PASO_ACTUADOR_ON: {
+      int32_t us = confirmado(e, act, 1);
+      if (us < 0 && now - desdeMs <= AT_CONFIRMAR_MS) return;
+      r.ok = us >= 0;
+      if (r.ok) r.onUs = (uint32_t)us;
+      desdeMs = now;
+      paso = PASO_ACTUADOR_ENCENDIDO;
+      break;
+    }
+    case PASO_ACTUADOR_ENCENDIDO:
+      if (now - desdeMs >= AT_RELE_MS && ordenar(act, 0)) paso = PASO_ACTUADOR_OFF;
+      break;
+
+    case PASO_ACTUADOR_OFF: {
+      int32_t us = confirmado(e, act, 0);
+      if (us < 0 && now - desdeMs <= AT_CONFIRMAR_MS) return;
+      if (us >= 0) r.offUs = (uint32_t)us;
+      else r.ok = false;
+      indice++;
+      avanzar(PASO_ACTUADOR_ORDEN);
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+static void pasoServos(const EstadoActuadores& e) {
+  unsigned long now = millis();
+
+  switch (paso) {
+    case PASO_SERVOS_ORDEN:
+      // Los tres a la vez; cada uno se confirma por separado
+      snprintf(etapa, sizeof(etapa), "Servos %d", angulosPrueba[indice]);
+      for (int i = 0; i < 3; i++) aplicadoAntes[ACT_SERVO_1 + i] = e.aplicadoUs[ACT_SERVO_1 + i];
+      ordenUs = micros();
+      desdeMs = now;
+      pendientes = 0;
+      for (int i = 0; i < 3; i++) {
+        if (ioEscribir((ActuadorId)(ACT_SERVO_1 + i), angulosPrueba[indice], ORIGEN_UI)) pendientes |= (1 << i);
+        else res.servosOk = false;
+      }
+      paso = PASO_SERVOS_ESPERA;
+      break;
+
+    case PASO_SERVOS_ESPERA:
+      for (int i = 0; i < 3; i++) {
+        if (!(pendientes & (1 << i))) continue;
+        int32_t us = confirmado(e, (ActuadorId)(ACT_SERVO_1 + i), angulosPrueba[indice]);
+        if (us < 0) continue;
+        if ((uint32_t)us > res.servoMaxUs[i]) res.servoMaxUs[i] = (uint32_t)us;
+        pendientes &= ~(1 << i);
+      }
+      if (pendientes && now - desdeMs <= AT_CONFIRMAR_MS) return;
+      if (pendientes) res.servosOk = false;
+      desdeMs = now;
+      paso = PASO_SERVOS_RECORRIDO;
+      break;
+
+    case PASO_SERVOS_RECORRIDO:
+      // Dejar que el servo llegue antes del siguiente ángulo
+      if (now - desdeMs < AT_SERVO_MS) return;
+      if (++indice < 3) paso = PASO_SERVOS_ORDEN;
+      else avanzar(PASO_SENSORES);
+      break;
+
+    default:
+      break;
+  }
+}
+
+static void pasoSensores() {
+  LecturaSensores l;
+  ioObtenerLectura(l);
+  unsigned long now = millis();
+
+  if (l.dhtLecturas != ultimaDht && res.dhtLecturas < AUTOTEST_DHT_LECTURAS) {
+    ultimaDht = l.dhtLecturas;
+    res.dhtLecturas++;
+    if (l.dhtStatus != 0) {
+      res.dhtErrores++;
+    } else {
+      res.temp = l.temp;
+      res.hum = l.hum;
+    }
+    res.dhtSumaUs += l.dhtUs;
+    if (l.dhtUs < res.dhtMinUs) res.dhtMinUs = l.dhtUs;
+    if (l.dhtUs > res.dhtMaxUs) res.dhtMaxUs = l.dhtUs;
+  }
+
+  if (l.ldrLecturas != ultimaLdr && res.ldrMuestras < AUTOTEST_LDR_MUESTRAS) {
+    ultimaLdr = l.ldrLecturas;
+    uint16_t raw = (uint16_t)l.luxRaw;
+    res.ldrMuestras++;
+    res.ldrSuma += raw;
+    res.ldrSumaCuad += (uint64_t)raw * raw;
+    if (raw < res.ldrMin) res.ldrMin = raw;
+    if (raw > res.ldrMax) res.ldrMax = raw;
+  }
+
+  if (now - ultimaGpsMs >= AT_GPS_CADA_MS && res.gpsMuestras < AUTOTEST_GPS_MUESTRAS) {
+    ultimaGpsMs = now;
+    res.gpsSats[res.gpsMuestras++] = l.satsValido ? (uint8_t)min(l.sats, (uint32_t)255) : 0;
+  }
+  res.gpsTtffMs = l.gpsFixMs;
+
+  bool dhtListo = !(res.fases & AT_DHT) || res.dhtLecturas >= AUTOTEST_DHT_LECTURAS;
+  bool ldrListo = !(res.fases & AT_LDR) || res.ldrMuestras >= AUTOTEST_LDR_MUESTRAS;
+  // Con fix, tres muestras de satélites bastan para ver si se sostiene
+  bool gpsListo = !(res.fases & AT_GPS) || (res.gpsTtffMs && res.gpsMuestras >= 3) ||
+                  now - res.inicioMs >= AT_GPS_MAX_MS;
+  if (dhtListo && ldrListo && gpsListo) terminar();
+}
+
+// ---------------------------------------------------------
+// API
+// ---------------------------------------------------------
+bool autotestSolicitar(uint8_t fases) {
+  if (paso != PASO_INACTIVO || solicitud) return false;
+  cancelar = false;
+  solicitud = fases ? fases : AT_COMPLETO;
+  return true;
+}
+
+void autotestCancelar() {
+  cancelar = true;
+}
+
+void autotestPaso() {
+  if (cancelar) {
+    cancelar = false;
+    solicitud = 0;
+    if (paso != PASO_INACTIVO) {
+      // Sin reporte: queda el de la corrida anterior
+      restaurar();
+      paso = PASO_INACTIVO;
+      pendientes = 0;
+      etapa[0] = '\0';
+    }
+    return;
+  }
+  if (paso == PASO_INACTIVO) {
+    if (!solicitud) return;
+    uint8_t fases = solicitud;
+    solicitud = 0;
+    iniciar(fases);
+    return;
+  }
+
+  EstadoActuadores e;
+  ioObtenerActuadores(e);
+  switch (paso) {
+    case PASO_ACTUADOR_ORDEN:
+    case PASO_ACTUADOR_ON:
+    case PASO_ACTUADOR_ENCENDIDO:
+    case PASO_ACTUADOR_OFF:
+      pasoActuador(e);
+      break;
+    case PASO_SERVOS_ORDEN:
+    case PASO_SERVOS_ESPERA:
+    case PASO_SERVOS_RECORRIDO:
+      pasoServos(e);
+      break;
+    case PASO_SENSORES:
+      pasoSensores();
+      break;
+    default:
+      break;
+  }
+}
+
+bool autotestEnCurso() {
+  return paso != PASO_INACTIVO || solicitud;
+}
+
+const char* autotestEtapa() {
+  return etapa;
+}
+
+const ResultadoAutotest& autotestResultado() {
+  return paso != PASO_INACTIVO ? res : ultimo;
+}
+
+size_t autotestReporte(char* buf, size_t cap) {
+  if (!cap) return 0;
+  portENTER_CRITICAL(&muxReporte);
+  size_t n = min(reporteLen, cap - 1);
+  memcpy(buf, reporte, n);
+  portEXIT_CRITICAL(&muxReporte);
+  buf[n] = '\0';
+  return n;
+}
+
+uint32_t autotestSecuencia() {
+  return secuencia;
+}
@@ -0,0 +1,93 @@
+#ifndef AUTOTEST_H
+#define AUTOTEST_H
+
+#include <Arduino.h>
+
+/* =======================
+   AUTODIAGNÓSTICO
+   =======================
+   Máquina de estados sin bloqueos que revisa la placa antes de
+   instalarla: latencia orden -> lectura del pin de cada relé y de la
+   cerradura, tiempo de aplicación de los servos, tiempo de respuesta y
+   tasa de error del DHT, ruido del LDR y arranque del GPS.
+
+   Corre en la tarea UI (autotestPaso() en cada paso) y solo usa la API
+   de io_task: las mediciones finas las toma la tarea IO con micros().
+   Se puede pedir desde cualquier tarea; el reporte JSON queda para la
+   OLED, /selftest.json y orion/selftest/report. */
+
+// Fases (máscara)
+#define AT_RELES      0x01
+#define AT_CERRADURA  0x02
+#define AT_SERVOS     0x04
+#define AT_DHT        0x08
+#define AT_LDR        0x10
+#define AT_GPS        0x20
+#define AT_COMPLETO   0x3F
+
+#define AUTOTEST_DHT_LECTURAS 10
+#define AUTOTEST_LDR_MUESTRAS 20
+#define AUTOTEST_GPS_MUESTRAS 18   // Satélites cada 5 s
+#define AUTOTEST_REPORTE_MAX  1024
+
+// Latencia de la orden hasta que IO la aplica (relés: y la lee del pin)
+struct ResultadoActuador {
+  bool ok;
+  uint32_t onUs;
+  uint32_t offUs;
+};
+
+struct ResultadoAutotest {
+  uint8_t fases;
+  bool ok;
+  uint32_t inicioMs;
+  uint32_t duracionMs;
+
+  ResultadoActuador reles[4];
+  ResultadoActuador cerradura;
+
+  bool servosOk;
+  uint32_t servoMaxUs[3];
+
+  bool dhtOk;
+  uint8_t dhtLecturas;
+  uint8_t dhtErrores;
+  uint32_t dhtMinUs;
+  uint32_t dhtMaxUs;
+  uint32_t dhtSumaUs;
+  int temp;
+  int hum;
+
+  bool ldrOk;
+  uint8_t ldrMuestras;
+  uint16_t ldrMin;
+  uint16_t ldrMax;
+  uint32_t ldrSuma;
+  uint64_t ldrSumaCuad;
+
+  bool gpsOk;
+  uint32_t gpsTtffMs;     // Desde el arranque (0 = sin fix)
+  uint8_t gpsMuestras;
+  uint8_t gpsSats[AUTOTEST_GPS_MUESTRAS];
+};
+
+// Pide una corrida (cualquier tarea). false si ya hay una en curso.
+bool autotestSolicitar(uint8_t fases);
+void autotestCancelar();
+
+// Un paso de la máquina. Solo desde la tarea UI.
+void autotestPaso();
+
+bool autotestEnCurso();
+const char* autotestEtapa();
+
+// Parcial durante una corrida; si no, el de la última terminada. Solo tarea UI.
+const ResultadoAutotest& autotestResultado();
+
+// Último reporte terminado, para cualquier tarea. 0 si aún no hay.
+size_t autotestReporte(char* buf, size_t cap);
+
+// Sube con cada reporte nuevo (para publicarlo una sola vez)
+uint32_t autotestSecuencia();
+
+#endif
@@ -0,0 +1,295 @@
+#include "bus_i2c.h"
+#include "metrics.h"
+#include "tasks.h"
+#include <Wire.h>
+
+#define COLA_I2C_LEN   4
+#define I2C_RELOJ_MAX  400000    // Fast mode: tope aunque un driver acepte más
+
+// --- DISPOSITIVOS (los toca solo quien tiene el bus) ---
+static DispositivoI2C dispositivos[I2C_DISPOSITIVOS_MAX];
+static uint8_t totalDispositivos = 0;
+static DispositivoI2C* pantalla = nullptr;
+static uint32_t reloj = I2C_RELOJ_BASE;
+static uint32_t siguienteLecturaMs = 0;  // La más próxima de todos los sensores
+static bool busCedido = false;
+static QueueHandle_t colaI2C;
+
+// --- PANTALLA ---
+static portMUX_TYPE muxI2C = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t marco[I2C_PANTALLA_BYTES];    // Último framebuffer de la UI (muxI2C)
+static volatile bool marcoNuevo = false;
+static uint8_t enviado[I2C_PANTALLA_BYTES];  // Lo que ya tiene la GDDRAM
+static bool enviadoValido = false;           // false hasta la primera pasada completa
+static bool pasadaEnCurso = false;
+static uint16_t cursor = 0;                  // Próximo trozo de la pasada
+
+// --- LECTURAS ---
+static LecturaI2C lectura;       // Publicada (muxI2C)
+static LecturaI2C lecturaTarea;  // La que llenan los drivers
+
+// ---------------------------------------------------------
+// TRANSACCIONES (para los drivers)
+// ---------------------------------------------------------
+static bool registrar(DispositivoI2C& d, uint32_t t0, bool ok) {
+  uint32_t us = micros() - t0;
+  d.transacciones++;
+  d.ultimaUs = us;
+  d.sumaUs += us;
+  if (us > d.maxUs) d.maxUs = us;
+  if (!ok) {
+    d.errores++;
+    metricaContar(CNT_I2C_ERRORES);
+  }
+  return ok;
+}
+
+bool i2cEscribir(DispositivoI2C& d, const uint8_t* datos, size_t n) {
+  uint32_t t0 = micros();
+  Wire.beginTransmission(d.dir);
+  Wire.write(datos, n);
+  return registrar(d, t0, Wire.endTransmission() == 0);
+}
+
+bool i2cEscribirRegistro(DispositivoI2C& d, uint8_t reg, uint8_t valor) {
+  uint8_t datos[2] = { reg, valor };
+  return i2cEscribir(d, datos, sizeof(datos));
+}
+
+bool i2cLeerRegistros(DispositivoI2C& d, uint8_t reg, uint8_t* out, size_t n) {
+  uint32_t t0 = micros();
+  Wire.beginTransmission(d.dir);
+  Wire.write(reg);
+  // Repeated start: nadie se mete entre el registro y la lectura
+  bool ok = Wire.endTransmission(false) == 0 && Wire.requestFrom(d.dir, n, true) == n;
+  if (ok) {
+    for (size_t i = 0; i < n; i++) out[i] = Wire.read();
+  }
+  return registrar(d, t0, ok);
+}
+
+bool i2cLeer(DispositivoI2C& d, uint8_t* out, size_t n) {
+  uint32_t t0 = micros();
+  bool ok = Wire.requestFrom(d.dir, n, true) == n;
+  if (ok) {
+    for (size_t i = 0; i < n; i++) out[i] = Wire.read();
+  }
+  return registrar(d, t0, ok);
+}
+
+// ---------------------------------------------------------
+// ESCANEO
+// ---------------------------------------------------------
+// El primer driver de esa dirección que confirma el chip se lo queda
+static const DriverI2C* buscarDriver(DispositivoI2C& d) {
+  for (uint8_t i = 0; i < driversI2CTotal; i++) {
+    const DriverI2C* drv = driversI2C[i];
+    if (drv->direcciones[0] != d.dir && drv->direcciones[1] != d.dir) continue;
+    d.driver = drv;
+    if (!drv->iniciar || drv->iniciar(d)) return drv;
+    memset(d.privado, 0, sizeof(d.privado));
+  }
+  return nullptr;
+}
+
+static void escanear() {
+  Wire.setClock(I2C_RELOJ_BASE);
+  totalDispositivos = 0;
+  pantalla = nullptr;
+  uint32_t relojNuevo = I2C_RELOJ_MAX;
+  uint32_t ahora = millis();
+
+  for (uint8_t dir = 0x08; dir < 0x78 && totalDispositivos < I2C_DISPOSITIVOS_MAX; dir++) {
+    Wire.beginTransmission(dir);
+    if (Wire.endTransmission() != 0) continue;
+
+    DispositivoI2C& d = dispositivos[totalDispositivos++];
+    memset(&d, 0, sizeof(d));
+    d.dir = dir;
+    d.driver = buscarDriver(d);
+
+    uint32_t max = d.driver ? d.driver->relojMax : I2C_RELOJ_BASE;
+    if (max < relojNuevo) relojNuevo = max;
+    if (d.driver && d.driver->periodoMs) d.proximoMs = ahora + d.driver->periodoMs;
+    if (d.driver && !d.driver->leer && !pantalla) pantalla = &d;
+  }
+
+  reloj = relojNuevo;
+  Wire.setClock(reloj);
+  siguienteLecturaMs = ahora;
+
+  Serial.print("I2C:");
+  for (uint8_t i = 0; i < totalDispositivos; i++) {
+    Serial.printf(" 0x%02X %s", dispositivos[i].dir,
+                  dispositivos[i].driver ? dispositivos[i].driver->nombre : "?");
+  }
+  Serial.printf(" -> %lu kHz\n", (unsigned long)(reloj / 1000));
+}
+
+// ---------------------------------------------------------
+// SENSORES
+// ---------------------------------------------------------
+static void atenderSensores() {
+  uint32_t ahora = millis();
+  if ((int32_t)(ahora - siguienteLecturaMs) < 0) return;
+
+  uint32_t proxima = ahora + 60000;
+  bool leido = false;
+  for (uint8_t i = 0; i < totalDispositivos; i++) {
+    DispositivoI2C& d = dispositivos[i];
+    if (!d.driver || !d.driver->leer) continue;
+
+    if ((int32_t)(ahora - d.proximoMs) >= 0) {
+      uint32_t t0 = micros();
+      if (d.driver->leer(d, lecturaTarea)) lecturaTarea.tMs = ahora;
+      leido = true;
+      // Desde que venció hasta que terminó: incluye la espera detrás de la pantalla
+      metricaLatencia(HIST_I2C_SENSOR, (ahora - d.proximoMs) * 1000 + (micros() - t0));
+
+      d.proximoMs += d.driver->periodoMs;
+      if ((int32_t)(ahora - d.proximoMs) >= 0) d.proximoMs = ahora + d.driver->periodoMs;
+    }
+    if ((int32_t)(d.proximoMs - proxima) < 0) proxima = d.proximoMs;
+  }
+  siguienteLecturaMs = proxima;
+
+  if (leido) {
+    portENTER_CRITICAL(&muxI2C);
+    lectura = lecturaTarea;
+    portEXIT_CRITICAL(&muxI2C);
+  }
+}
+
+// ---------------------------------------------------------
+// PANTALLA
+// ---------------------------------------------------------
+static bool mandarTrozo(uint16_t desde, const uint8_t* datos) {
+  uint8_t pag = desde / 128;
+  uint8_t col = desde % 128;
+  const uint8_t ventana[] = { 0x00, 0x21, col, (uint8_t)(col + I2C_TROZO - 1), 0x22, pag, pag };
+  if (!i2cEscribir(*pantalla, ventana, sizeof(ventana))) return false;
+  return i2cEscribir(*pantalla, datos, I2C_TROZO + 1);
+}
+
+// Recorre el marco trozo a trozo y manda los que no coinciden con la GDDRAM.
+// Una pasada puede quedar a medias y seguir en el próximo paso.
+static void volcarPantalla(uint32_t presupuestoUs) {
+  if (!pantalla) {
+    marcoNuevo = false;
+    return;
+  }
+
+  uint32_t t0 = micros();
+  while (pasadaEnCurso || marcoNuevo) {
+    if (!pasadaEnCurso) {
+      // Lo que llegue desde aquí lo ve esta pasada o dispara la siguiente
+      marcoNuevo = false;
+      pasadaEnCurso = true;
+      cursor = 0;
+    }
+
+    atenderSensores();
+
+    uint8_t trozo[I2C_TROZO + 1];
+    trozo[0] = 0x40;  // Co = 0, D/C = 1: datos de GDDRAM
+    portENTER_CRITICAL(&muxI2C);
+    memcpy(trozo + 1, marco + cursor, I2C_TROZO);
+    portEXIT_CRITICAL(&muxI2C);
+
+    if (!enviadoValido || memcmp(trozo + 1, enviado + cursor, I2C_TROZO) != 0) {
+      if (mandarTrozo(cursor, trozo)) {
+        memcpy(enviado + cursor, trozo + 1, I2C_TROZO);
+      } else {
+        enviado[cursor] = ~trozo[1];  // Difiere: se reintenta en otra pasada
+        marcoNuevo = true;
+      }
+    }
+
+    cursor += I2C_TROZO;
+    if (cursor >= I2C_PANTALLA_BYTES) {
+      pasadaEnCurso = false;
+      enviadoValido = true;
+    }
+    if (micros() - t0 >= presupuestoUs) break;
+  }
+}
+
+// ---------------------------------------------------------
+// API PUBLICA
+// ---------------------------------------------------------
+void iniciarI2C() {
+  colaI2C = xQueueCreate(COLA_I2C_LEN, sizeof(PeticionI2C));
+  escanear();
+}
+
+void i2cCederBus() {
+  busCedido = true;
+  // Los delay() del arranque no cuentan como lecturas atrasadas
+  uint32_t ahora = millis();
+  for (uint8_t i = 0; i < totalDispositivos; i++) {
+    const DriverI2C* drv = dispositivos[i].driver;
+    if (drv && drv->periodoMs) dispositivos[i].proximoMs = ahora + drv->periodoMs;
+  }
+  siguienteLecturaMs = ahora;
+}
+
+void pasoTareaI2C() {
+  PeticionI2C pet;
+  while (xQueueReceive(colaI2C, &pet, 0) == pdTRUE) {
+    if (pet == I2C_ESCANEAR) escanear();
+  }
+
+  atenderSensores();
+  volcarPantalla(I2C_PRESUPUESTO_US);
+}
+
+void i2cPantalla(Adafruit_SSD1306& p) {
+  portENTER_CRITICAL(&muxI2C);
+  memcpy(marco, p.getBuffer(), I2C_PANTALLA_BYTES);
+  marcoNuevo = true;
+  portEXIT_CRITICAL(&muxI2C);
+
+  // Splash y mensajes de setup: todavía no hay tarea que lo mande
+  if (!busCedido) volcarPantalla(UINT32_MAX);
+  else tareaDespertar(TAREA_I2C);
+}
+
+bool i2cSolicitar(PeticionI2C pet) {
+  if (xQueueSend(colaI2C, &pet, 0) == pdTRUE) {
+    tareaDespertar(TAREA_I2C);
+    return true;
+  }
+  metricaContar(CNT_COLA_LLENA);
+  return false;
+}
+
+uint32_t i2cMsHastaProximo() {
+  if (pasadaEnCurso || marcoNuevo) return 0;
+  int32_t falta = (int32_t)(siguienteLecturaMs - millis());
+  return falta > 0 ? (uint32_t)falta : 0;
+}
+
+void i2cObtenerLectura(LecturaI2C& out) {
+  portENTER_CRITICAL(&muxI2C);
+  out = lectura;
+  portEXIT_CRITICAL(&muxI2C);
+}
+
+uint32_t i2cReloj() {
+  return reloj;
+}
+
+void i2cImprimir(Print& out) {
+  // Contadores leídos sin lock: pueden ir un paso atrasados
+  out.printf("--- I2C %lu kHz ---\n", (unsigned long)(reloj / 1000));
+  out.println("dir  driver      tx   err  media    max (us)");
+  for (uint8_t i = 0; i < totalDispositivos; i++) {
+    const DispositivoI2C& d = dispositivos[i];
+    const DriverI2C* drv = d.driver;
+    uint32_t media = d.transacciones ? (uint32_t)(d.sumaUs / d.transacciones) : 0;
+    out.printf("0x%02X %-8s %6lu %5lu %6lu %6lu\n", d.dir, drv ? drv->nombre : "?",
+               (unsigned long)d.transacciones, (unsigned long)d.errores, (unsigned long)media,
+               (unsigned long)d.maxUs);
+  }
+  if (totalDispositivos == 0) out.println("Sin dispositivos");
+}
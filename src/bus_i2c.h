@@ -0,0 +1,103 @@
+#ifndef BUS_I2C_H
+#define BUS_I2C_H
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+
+/* =======================
+   BUS I2C (GPIO 21/22)
+   =======================
+   La OLED y la cabecera "Extensiones I2C" comparten bus. Desde
+   iniciarTareas() solo la tarea I2C toca Wire; el resto le pide cosas:
+   la UI deja el framebuffer con i2cPantalla() y los sensores los leen
+   sus drivers cuando vence su periodo.
+
+   La pantalla se manda en trozos de I2C_TROZO bytes, y solo los que
+   cambiaron desde el último volcado. Antes de cada trozo se atienden las
+   lecturas vencidas, así un volcado de 1 KB no retrasa a un sensor más
+   que lo que dura un trozo (~0.9 ms a 400 kHz).
+
+   Al arrancar se escanea el bus: cada dirección que responde se ofrece a
+   los drivers de driversI2C y el reloj sube a lo que acepten todos los
+   dispositivos encontrados (400 kHz como mucho: fast mode). */
+
+#define I2C_PIN_SDA          21
+#define I2C_PIN_SCL          22
+#define I2C_PERIODO_MS       5
+#define I2C_RELOJ_BASE       100000   // Escaneo y dispositivos sin driver
+#define I2C_TROZO            32       // Bytes de GDDRAM por transacción
+#define I2C_PRESUPUESTO_US   4000     // Bus para la pantalla en cada paso
+#define I2C_DISPOSITIVOS_MAX 8
+#define I2C_PANTALLA_BYTES   (128 * 64 / 8)
+
+// Lo que aportan los sensores de expansión (cada grupo con su bandera)
+struct LecturaI2C {
+  uint32_t tMs;        // millis() de la última lectura buena
+  bool ambiente;       // BME280 (BMP280: sin humedad)
+  float tempC;
+  float humedad;       // NAN en un BMP280
+  float presionHpa;
+  bool luz;            // BH1750
+  float lux;
+};
+
+struct DispositivoI2C;
+
+// Para sumar un chip basta con escribir sus funciones y agregarlo a
+// driversI2C (drivers_i2c.cpp)
+struct DriverI2C {
+  const char* nombre;
+  uint8_t direcciones[2];   // Donde puede responder (0 = sin segunda)
+  uint32_t relojMax;        // Hz
+  uint32_t periodoMs;       // Entre lecturas (0 = no se lee: la pantalla)
+  // Confirma que es ese chip y lo configura. nullptr = basta el ACK.
+  bool (*iniciar)(DispositivoI2C& d);
+  // Llena su parte de 'out'; false si la transacción falló
+  bool (*leer)(DispositivoI2C& d, LecturaI2C& out);
+};
+
+struct DispositivoI2C {
+  uint8_t dir;
+  const DriverI2C* driver;  // nullptr: responde pero no se reconoce
+  uint32_t proximoMs;       // Siguiente lectura
+  uint32_t transacciones;
+  uint32_t errores;
+  uint32_t ultimaUs;
+  uint32_t maxUs;
+  uint64_t sumaUs;
+  uint8_t privado[40];      // Calibración u otro estado del driver
+};
+
+extern const DriverI2C* const driversI2C[];
+extern const uint8_t driversI2CTotal;
+
+// Escanea y arranca los drivers. En iniciarUI(), con la OLED ya iniciada.
+void iniciarI2C();
+// Desde aquí la pantalla la vuelca la tarea I2C (lo llama iniciarTareas)
+void i2cCederBus();
+// Un paso de la tarea I2C: peticiones, lecturas vencidas y trozos de pantalla
+void pasoTareaI2C();
+
+// UI: copia el framebuffer (antes de i2cCederBus() se vuelca en el momento)
+void i2cPantalla(Adafruit_SSD1306& pantalla);
+
+// --- Para drivers (solo desde la tarea I2C) ---
+// Cuentan la transacción, su duración y los errores del dispositivo
+bool i2cEscribir(DispositivoI2C& d, const uint8_t* datos, size_t n);
+bool i2cEscribirRegistro(DispositivoI2C& d, uint8_t reg, uint8_t valor);
+bool i2cLeerRegistros(DispositivoI2C& d, uint8_t reg, uint8_t* out, size_t n);
+bool i2cLeer(DispositivoI2C& d, uint8_t* out, size_t n);
+
+// --- Desde cualquier tarea ---
+enum PeticionI2C : uint8_t {
+  I2C_ESCANEAR   // Vuelve a buscar dispositivos (p. ej. tras conectar uno)
+};
+bool i2cSolicitar(PeticionI2C pet);
+// Bajo consumo: ms hasta la próxima lectura (0 si hay pantalla por mandar)
+uint32_t i2cMsHastaProximo();
+void i2cObtenerLectura(LecturaI2C& out);
+uint32_t i2cReloj();
+// Dispositivos, driver y latencia/errores de cada uno (sys i2c)
+void i2cImprimir(Print& out);
+
+#endif
@@ -0,0 +1,129 @@
+#include "captura.h"
+#include <LittleFS.h>
+
+#define CAPTURA_BUFFER 1024
+#define CAPTURA_VACIAR_MS 1000
+
+static DestinoCaptura destino = CAPTURA_NINGUNA;
+static File archivo;
+static char buffer[CAPTURA_BUFFER];
+static size_t usados = 0;
+static uint32_t escritos = 0;
+static uint32_t inicioMs = 0;
+static uint32_t ultimoVaciado = 0;
+
+// ---------------------------------------------------------
+// SALIDA
+// ---------------------------------------------------------
+static void vaciar() {
+  if (!usados) return;
+  if (destino == CAPTURA_FS) {
+    archivo.write((const uint8_t*)buffer, usados);
+  } else if (destino == CAPTURA_SERIAL) {
+    Serial.write((const uint8_t*)buffer, usados);
+  }
+  escritos += usados;
+  usados = 0;
+  ultimoVaciado = millis();
+
+  if (escritos >= CAPTURA_MAX_BYTES) {
+    Serial.println("Captura: limite alcanzado");
+    capturaDetener();
+  }
+}
+
+// Reserva espacio para una línea completa; nunca se parte entre vaciados.
+// nullptr si al vaciar se llegó al límite y la captura se cerró.
+static char* linea(size_t max) {
+  if (usados + max > CAPTURA_BUFFER) vaciar();
+  return destino == CAPTURA_NINGUNA ? nullptr : buffer + usados;
+}
+
+// Abre la línea con "[CAP:]<tipo> <ms> " y devuelve cuánto ocupó
+static size_t cabecera(char* p, size_t cap, char tipo) {
+  const char* prefijo = (destino == CAPTURA_SERIAL) ? "CAP:" : "";
+  return snprintf(p, cap, "%s%c %lu ", prefijo, tipo, (unsigned long)(millis() - inicioMs));
+}
+
+// ---------------------------------------------------------
+// API
+// ---------------------------------------------------------
+bool capturaIniciar(DestinoCaptura nuevo) {
+  capturaDetener();
+  if (nuevo == CAPTURA_FS) {
+    if (!LittleFS.begin(true)) return false;
+    archivo = LittleFS.open(CAPTURA_ARCHIVO, "w");
+    if (!archivo) return false;
+  } else if (nuevo != CAPTURA_SERIAL) {
+    return false;
+  }
+
+  destino = nuevo;
+  usados = 0;
+  escritos = 0;
+  inicioMs = millis();
+  ultimoVaciado = inicioMs;
+
+  char* p = linea(32);
+  usados += snprintf(p, 32, "%s# orion-captura 1\n", destino == CAPTURA_SERIAL ? "CAP:" : "");
+  return true;
+}
+
+void capturaDetener() {
+  if (destino == CAPTURA_NINGUNA) return;
+  DestinoCaptura cerrando = destino;
+  vaciar();
+  destino = CAPTURA_NINGUNA;
+  if (cerrando == CAPTURA_FS) archivo.close();
+}
+
+DestinoCaptura capturaDestino() {
+  return destino;
+}
+
+void capturaGps(const uint8_t* datos, size_t n) {
+  if (destino == CAPTURA_NINGUNA || !n) return;
+  // Peor caso: cada byte como \xHH
+  char* p = linea(24 + 4 * n);
+  if (!p) return;
+  size_t k = cabecera(p, 24, 'G');
+  for (size_t i = 0; i < n; i++) {
+    uint8_t c = datos[i];
+    if (c == '\r') { p[k++] = '\\'; p[k++] = 'r'; }
+    else if (c == '\n') { p[k++] = '\\'; p[k++] = 'n'; }
+    else if (c == '\\') { p[k++] = '\\'; p[k++] = '\\'; }
+    else if (c < 0x20 || c > 0x7e) k += snprintf(p + k, 5, "\\x%02X", c);
+    else p[k++] = (char)c;
+  }
+  p[k++] = '\n';
+  usados += k;
+}
+
+void capturaDht(int temp, int hum, int estado) {
+  if (destino == CAPTURA_NINGUNA) return;
+  char* p = linea(64);
+  if (!p) return;
+  size_t k = cabecera(p, 64, 'D');
+  usados += k + snprintf(p + k, 64 - k, "%d %d %d\n", temp, hum, estado);
+}
+
+void capturaLdr(int raw) {
+  if (destino == CAPTURA_NINGUNA) return;
+  char* p = linea(48);
+  if (!p) return;
+  size_t k = cabecera(p, 48, 'L');
+  usados += k + snprintf(p + k, 48 - k, "%d\n", raw);
+}
+
+void capturaPaso() {
+  if (destino != CAPTURA_NINGUNA && millis() - ultimoVaciado >= CAPTURA_VACIAR_MS) vaciar();
+}
+
+void capturaInfo(Print& out) {
+  static const char* nombres[] = { "apagada", "LittleFS " CAPTURA_ARCHIVO, "Serial (CAP:)" };
+  out.print("Captura: "); out.println(nombres[destino]);
+  if (destino == CAPTURA_NINGUNA) return;
+  out.print("Bytes: "); out.print(escritos + usados);
+  out.print(" / "); out.println(CAPTURA_MAX_BYTES);
+  out.print("Duracion: "); out.print((millis() - inicioMs) / 1000); out.println(" s");
+}
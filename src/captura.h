@@ -0,0 +1,45 @@
+#ifndef CAPTURA_H
+#define CAPTURA_H
+
+#include <Arduino.h>
+
+/* =======================
+   CAPTURA DE SENSORES
+   =======================
+   Registra lo que ve la tarea IO para reproducirlo después en el
+   simulador de host (host/sim/sim_reproduccion): bytes crudos de la UART
+   del GPS y cada lectura de DHT y LDR, con millis() relativos al inicio.
+
+   Formato (una línea por registro, texto):
+     # orion-captura 1
+     G <ms> <bytes>          bytes del GPS; \r \n \\ y no imprimibles como \xHH
+     D <ms> <temp> <hum> <estado>
+     L <ms> <raw>
+
+   En modo serial cada línea sale por Serial con el prefijo "CAP:" para
+   separarla del log. Solo la tarea IO llama a estas funciones. */
+
+enum DestinoCaptura : uint8_t {
+  CAPTURA_NINGUNA,
+  CAPTURA_FS,       // LittleFS, CAPTURA_ARCHIVO
+  CAPTURA_SERIAL
+};
+
+#define CAPTURA_ARCHIVO "/captura.log"
+#define CAPTURA_MAX_BYTES (512UL * 1024UL)  // Se detiene sola al llegar (~10 min de GPS)
+
+bool capturaIniciar(DestinoCaptura destino);
+void capturaDetener();
+DestinoCaptura capturaDestino();
+
+void capturaGps(const uint8_t* datos, size_t n);
+void capturaDht(int temp, int hum, int estado);
+void capturaLdr(int raw);
+
+// Vacía el buffer si toca (cada segundo o al llenarse). Una vez por paso de IO.
+void capturaPaso();
+
+// Destino, bytes escritos y duración
+void capturaInfo(Print& out);
+
+#endif
@@ -0,0 +1,241 @@
+#include "cliente_tls.h"
+#include "metrics.h"
+
+ClienteTLS clienteTLS;
+
+// ---------------------------------------------------------
+// TRANSPORTE (el TCP lo sigue haciendo WiFiClient)
+// ---------------------------------------------------------
+int ClienteTLS::enviarTcp(void* ctx, const unsigned char* buf, size_t len) {
+  WiFiClient& tcp = ((ClienteTLS*)ctx)->tcp;
+  if (!tcp.connected()) return MBEDTLS_ERR_SSL_CONN_EOF;
+  size_t n = tcp.write(buf, len);
+  return n > 0 ? (int)n : MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+// Nunca bloquea: sin bytes, mbedTLS devuelve WANT_READ a quien lo llamó
+int ClienteTLS::recibirTcp(void* ctx, unsigned char* buf, size_t len) {
+  WiFiClient& tcp = ((ClienteTLS*)ctx)->tcp;
+  int disponibles = tcp.available();
+  if (disponibles <= 0) return tcp.connected() ? MBEDTLS_ERR_SSL_WANT_READ : 0;
+  return tcp.read(buf, min(len, (size_t)disponibles));
+}
+
+// Solo se llama si el servidor mandó su certificado: un handshake reanudado no lo hace
+int ClienteTLS::alVerificar(void* ctx, mbedtls_x509_crt*, int, uint32_t*) {
+  ((ClienteTLS*)ctx)->verificado = true;
+  return 0;
+}
+
+// ---------------------------------------------------------
+// INICIO (una vez)
+// ---------------------------------------------------------
+bool ClienteTLS::iniciar(const char* caPem, const char* servidor) {
+  if (listo) return true;
+  uint32_t heapAntes = ESP.getFreeHeap();
+
+  mbedtls_ssl_init(&ssl);
+  mbedtls_ssl_config_init(&conf);
+  mbedtls_x509_crt_init(&ca);
+  mbedtls_ctr_drbg_init(&drbg);
+  mbedtls_entropy_init(&entropia);
+  mbedtls_ssl_session_init(&sesion);
+
+  const char* pers = "orion-mqtt";
+  int ret = mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropia, (const unsigned char*)pers, strlen(pers));
+  // El largo incluye el '\0': así mbedTLS lo reconoce como PEM
+  if (ret == 0) ret = mbedtls_x509_crt_parse(&ca, (const unsigned char*)caPem, strlen(caPem) + 1);
+  if (ret == 0) {
+    ret = mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                      MBEDTLS_SSL_PRESET_DEFAULT);
+  }
+  if (ret == 0) {
+    mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_ca_chain(&conf, &ca, nullptr);
+    mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+    mbedtls_ssl_conf_verify(&conf, alVerificar, this);
+    mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+    // Aquí se reservan los buffers de entrada y salida, para toda la vida del contexto
+    ret = mbedtls_ssl_setup(&ssl, &conf);
+  }
+  if (ret == 0) ret = mbedtls_ssl_set_hostname(&ssl, servidor);
+  if (ret != 0) {
+    ultimoError = ret;
+    Serial.printf("TLS: no se pudo preparar (-0x%04X)\n", (unsigned)-ret);
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_config_free(&conf);
+    mbedtls_x509_crt_free(&ca);
+    mbedtls_ctr_drbg_free(&drbg);
+    mbedtls_entropy_free(&entropia);
+    return false;
+  }
+  mbedtls_ssl_set_bio(&ssl, this, enviarTcp, recibirTcp, nullptr);
+
+  heapBuffers = heapAntes - ESP.getFreeHeap();
+  metricaFijar(MED_TLS_HEAP, (int32_t)heapBuffers);
+  listo = true;
+  return true;
+}
+
+// ---------------------------------------------------------
+// CONEXIÓN
+// ---------------------------------------------------------
+int ClienteTLS::handshake() {
+  uint32_t t0 = micros();
+  mbedtls_ssl_session_reset(&ssl);
+  if (tieneSesion) mbedtls_ssl_set_session(&ssl, &sesion);
+  verificado = false;
+
+  int ret;
+  uint32_t inicioMs = millis();
+  while ((ret = mbedtls_ssl_handshake(&ssl)) != 0) {
+    if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) break;
+    if (millis() - inicioMs > TLS_HANDSHAKE_MAX_MS) {
+      ret = MBEDTLS_ERR_SSL_TIMEOUT;
+      break;
+    }
+    delay(1);
+  }
+  ultimoUs = micros() - t0;
+  ultimoError = ret;
+  if (ret != 0) {
+    Serial.printf("TLS: handshake fallido (-0x%04X)\n", (unsigned)-ret);
+    return 0;
+  }
+
+  if (verificado) completos++;
+  else reanudados++;
+  metricaLatencia(verificado ? HIST_TLS_COMPLETO : HIST_TLS_REANUDADO, ultimoUs);
+
+  // El broker pudo emitir un ticket nuevo: se guarda para la próxima
+  mbedtls_ssl_session_free(&sesion);
+  mbedtls_ssl_session_init(&sesion);
+  tieneSesion = mbedtls_ssl_get_session(&ssl, &sesion) == 0;
+  abierto = true;
+  return 1;
+}
+
+int ClienteTLS::connect(IPAddress ip, uint16_t port) {
+  if (!listo) return 0;
+  stop();
+  if (!tcp.connect(ip, port)) return 0;
+  if (handshake()) return 1;
+  tcp.stop();
+  return 0;
+}
+
+int ClienteTLS::connect(const char* host, uint16_t port) {
+  if (!listo) return 0;
+  stop();
+  if (!tcp.connect(host, port)) return 0;
+  if (handshake()) return 1;
+  tcp.stop();
+  return 0;
+}
+
+void ClienteTLS::stop() {
+  if (abierto) {
+    mbedtls_ssl_close_notify(&ssl);  // Cortesía: si no sale, el broker cierra igual
+    abierto = false;
+  }
+  byteEspiado = -1;
+  tcp.stop();
+}
+
+bool ClienteTLS::fijarServidor(const char* servidor) {
+  olvidarSesion();
+  if (!listo) return false;
+  int ret = mbedtls_ssl_set_hostname(&ssl, servidor);
+  if (ret != 0) ultimoError = ret;
+  return ret == 0;
+}
+
+void ClienteTLS::olvidarSesion() {
+  mbedtls_ssl_session_free(&sesion);
+  mbedtls_ssl_session_init(&sesion);
+  tieneSesion = false;
+}
+
+// ---------------------------------------------------------
+// DATOS
+// ---------------------------------------------------------
+size_t ClienteTLS::write(const uint8_t* buf, size_t size) {
+  if (!abierto) return 0;
+  size_t enviados = 0;
+  uint32_t inicioMs = millis();
+  while (enviados < size) {
+    int ret = mbedtls_ssl_write(&ssl, buf + enviados, size - enviados);
+    if (ret > 0) {
+      enviados += ret;
+    } else if (ret != MBEDTLS_ERR_SSL_WANT_WRITE && ret != MBEDTLS_ERR_SSL_WANT_READ) {
+      stop();
+      break;
+    } else if (millis() - inicioMs > TLS_HANDSHAKE_MAX_MS) {
+      break;
+    } else {
+      delay(1);
+    }
+  }
+  return enviados;
+}
+
+int ClienteTLS::available() {
+  if (!abierto) return 0;
+  int n = (int)mbedtls_ssl_get_bytes_avail(&ssl);
+  // Lectura de 0 bytes: descifra el registro que haya en el socket
+  if (n == 0 && tcp.available() > 0) {
+    int ret = mbedtls_ssl_read(&ssl, nullptr, 0);
+    if (ret == MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY || ret == MBEDTLS_ERR_SSL_CONN_EOF) {
+      stop();
+      return 0;
+    }
+    n = (int)mbedtls_ssl_get_bytes_avail(&ssl);
+  }
+  return n + (byteEspiado >= 0 ? 1 : 0);
+}
+
+int ClienteTLS::read(uint8_t* buf, size_t size) {
+  if (!abierto || size == 0) return -1;
+  size_t copiados = 0;
+  if (byteEspiado >= 0) {
+    buf[copiados++] = (uint8_t)byteEspiado;
+    byteEspiado = -1;
+    if (copiados == size || mbedtls_ssl_get_bytes_avail(&ssl) == 0) return copiados;
+  }
+  int ret = mbedtls_ssl_read(&ssl, buf + copiados, size - copiados);
+  if (ret > 0) return copiados + ret;
+  if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) stop();
+  return copiados ? (int)copiados : -1;
+}
+
+int ClienteTLS::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int ClienteTLS::peek() {
+  if (byteEspiado < 0 && available() > 0) byteEspiado = read();
+  return byteEspiado;
+}
+
+uint8_t ClienteTLS::connected() {
+  if (!abierto) return 0;
+  return tcp.connected() || available() > 0;
+}
+
+// ---------------------------------------------------------
+// CONSOLA
+// ---------------------------------------------------------
+void ClienteTLS::imprimir(Print& out) {
+  out.println("--- TLS MQTT ---");
+  if (!listo) {
+    out.println("Sin preparar (se prepara al entrar en Cloud)");
+    if (ultimoError) out.printf("Error -0x%04X\n", (unsigned)-ultimoError);
+    return;
+  }
+  out.printf("Contexto y buffers: %lu B de heap\n", (unsigned long)heapBuffers);
+  out.printf("Handshakes: %lu completos, %lu reanudados\n", (unsigned long)completos, (unsigned long)reanudados);
+  out.printf("Ultimo: %lu ms", (unsigned long)(ultimoUs / 1000));
+  if (ultimoError) out.printf(", error -0x%04X", (unsigned)-ultimoError);
+  out.printf("\nSesion guardada: %s, enlace %s\n", tieneSesion ? "si" : "no", abierto ? "abierto" : "cerrado");
+}
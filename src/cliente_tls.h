@@ -0,0 +1,78 @@
+#ifndef CLIENTE_TLS_H
+#define CLIENTE_TLS_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/ctr_drbg.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/x509_crt.h>
+
+/* =======================
+   CLIENTE TLS (MQTT)
+   =======================
+   Client de Arduino sobre mbedTLS para PubSubClient. Contexto, CA y
+   buffers de registro se reservan una sola vez (iniciar()); cada connect()
+   reutiliza el contexto con mbedtls_ssl_session_reset() y ofrece la sesión
+   del enlace anterior (ticket o id). Si el broker la acepta, el handshake
+   salta certificado y ECDHE: décimas de segundo en vez de segundos, y sin
+   reservas grandes que fragmenten el heap. */
+
+#define TLS_HANDSHAKE_MAX_MS 10000
+
+class ClienteTLS : public Client {
+public:
+  // Una vez por arranque: false si la CA no se pudo leer o no hubo memoria
+  bool iniciar(const char* caPem, const char* servidor);
+  bool iniciado() const { return listo; }
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t size) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+  using Print::write;
+
+  void olvidarSesion();  // El próximo connect() hace el handshake completo
+  // Otro broker (mqtt_host): nombre a verificar en su certificado; su sesión no sirve
+  bool fijarServidor(const char* servidor);
+  void imprimir(Print& out);
+
+private:
+  WiFiClient tcp;
+  mbedtls_ssl_context ssl;
+  mbedtls_ssl_config conf;
+  mbedtls_x509_crt ca;
+  mbedtls_ctr_drbg_context drbg;
+  mbedtls_entropy_context entropia;
+  mbedtls_ssl_session sesion;
+
+  bool listo = false;
+  bool abierto = false;
+  bool tieneSesion = false;
+  bool verificado = false;  // El handshake en curso revisó el certificado
+  int byteEspiado = -1;     // peek()
+
+  // Para "sys tls"
+  uint32_t heapBuffers = 0;
+  uint32_t completos = 0;
+  uint32_t reanudados = 0;
+  uint32_t ultimoUs = 0;
+  int ultimoError = 0;
+
+  int handshake();
+  static int enviarTcp(void* ctx, const unsigned char* buf, size_t len);
+  static int recibirTcp(void* ctx, unsigned char* buf, size_t len);
+  static int alVerificar(void* ctx, mbedtls_x509_crt* crt, int profundidad, uint32_t* flags);
+};
+
+extern ClienteTLS clienteTLS;
+
+#endif
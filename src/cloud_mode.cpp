@@ -1,5 +1,19 @@
 #include "cloud_mode.h"
-#include "definitions.h"
+#include "io_task.h"
+#include "net_task.h"
+#include "metrics.h"
+#include "autotest.h"
+#include "reglas.h"
+#include "escenas.h"
+#include "identidad.h"
+#include "bus_i2c.h"
+#include "cliente_tls.h"
+#include "mqtt_ca.h"
+#include "reloj.h"
+#include "texto.h"
+#include "ota.h"
+#include "ajustes.h"
+#include "energia.h"
 #include <WiFi.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
@@ -8,26 +22,14 @@
 #include <InfluxDbClient.h>
 #include <InfluxDbCloud.h>
 
-// Hardware Libraries
-#include <DHT11.h>
-#include <LDR_10K.h>
-#include <TinyGPS++.h>
-#include <ESP32Servo.h>
-
-// --- DEFINICIÓN DE HARDWARE ---
-#define PIN_RELAY_1 26
-#define PIN_RELAY_2 27
-#define PIN_RELAY_3 14
-#define PIN_RELAY_4 12
-#define PIN_LOCK    13
-#define PIN_DHT     23
-#define PIN_LDR     34
-#define PIN_GPS_RX  16
-#define PIN_GPS_TX  17
-
 // --- CONFIGURACIÓN MQTT (Home Assistant) ---
-const char* mqtt_server = "130.107.73.33"; // Tu IP Azure
-const int mqtt_port = 1883;
+// Broker, puerto y transporte son mqtt_host, mqtt_puerto y mqtt_tls en
+// ajustes.h (en claro al 1883 por defecto; con mqtt_tls, TLS verificado con
+// MQTT_CA_PEM, mqtt_ca.h). Aquí, la copia que usa PubSubClient
+char servidorMqtt[AJUSTE_TEXTO_MAX + 1] = "";
+uint16_t puertoMqtt = 0;
+Client* transporteMqtt = nullptr;  // &clienteTLS o &clientePlano
+uint16_t keepAliveMqtt = 0;  // s; crece con latencia_ms (bajo consumo)
 const char* mqtt_user = ""; 
 const char* mqtt_pass = ""; 
 
@@ -39,147 +41,533 @@ const char* mqtt_pass = "";
 #define TZ_INFO "CST6CDT,M4.1.0,M10.5.0" // Hora CDMX para timestamps correctos
 
 // --- OBJETOS DE RED ---
-WiFiClient espClient;
-PubSubClient client(espClient);
+WiFiClient clientePlano;
+PubSubClient client;
 InfluxDBClient clientInflux(INFLUXDB_URL, INFLUXDB_ORG, INFLUXDB_BUCKET, INFLUXDB_TOKEN);
 
-// Punto de datos Influx
-Point sensorData("estado_sistema"); // "Measurement" en Influx
-
-Adafruit_SSD1306* cloudDisplay;
-
-// --- OBJETOS DE HARDWARE ---
-DHT11 dhtCloud(PIN_DHT);
-LDR_10K ldrCloud(PIN_LDR);
-TinyGPSPlus gpsCloud;
-HardwareSerial gpsSerialCloud(2);
-
 // --- VARIABLES ---
-unsigned long lastMsg = 0;
-const long interval = 5000; // Leer y enviar cada 5s
-unsigned long lockTimer = 0;
-bool lockOpen = false;
+char topicoBase[IDENTIDAD_MAX + 8];  // "orion/<id>", fijo mientras dura el modo
+char idRed[IDENTIDAD_MAX + 1];  // Copia de la tarea de red (identidadCopiar)
+uint32_t identidadAplicada = 0;
+char medicionInflux[IDENTIDAD_MAX + AJUSTE_TEXTO_MAX + 40];  // Measurement y etiquetas (armarMedicion)
+unsigned long lastMsg = 0;       // Leer y enviar cada ajustes.intervaloMs
+unsigned long lastReconnect = 0;
+const long reconnectInterval = 2000; // Espera entre intentos sin bloquear la tarea
+unsigned long lastDiag = 0;      // Métricas a orion/diag/state cada ajustes.diagMs
+bool influxOK = false;
+bool influxValidado = false;      // Una vez por arranque: volver a Cloud (o pasar a Híbrido) solo reconecta MQTT
+uint32_t autotestPublicado = 0;  // Secuencia del último reporte enviado
+uint32_t reglasPublicadas = 0;   // reglasSecuencia() del último estado enviado
+uint32_t gpsEnviado = 0;         // trayectoTotal() en el último envío de posición
+uint32_t trayectoPublicado = 0;  // Siguiente punto del trayecto por publicar
+uint32_t otaPublicada = 0;       // otaSecuencia() del último estado enviado
+uint32_t ajustesAplicados = 0;   // ajustesSecuencia() ya aplicada al cliente MQTT
+uint32_t ajustesPublicados = 0;  // ajustesSecuencia() del último config/state
+unsigned long lastTrack = 0;
+const long trackInterval = 60000; // Lote de trayecto como mucho cada minuto
+
+// --- MUESTRAS PARA INFLUX ---
+// Esperan la primera hora NTP o a que Influx responda, y se escriben con la
+// hora en que se tomaron: un reintento no las corre en el tiempo, y si un
+// lote sí había llegado, el mismo timestamp sobrescribe en vez de duplicar
+#define INFLUX_PENDIENTES 24   // 2 minutos de muestras a 5 s
+#define INFLUX_LOTE 6          // Líneas por petición HTTP
+#define INFLUX_LINEA_MAX 256   // Una muestra con GPS e I2C ocupa ~220 B (~350 con id y ubicación largos)
+
+// Textos de la tarea de red: el comando MQTT en curso, Discovery y el lote
+// de Influx. Se vacía al terminar cada callback y cada pasada del bucle
+#define CLOUD_ARENA_BYTES (INFLUX_LOTE * INFLUX_LINEA_MAX + 512)
+static ArenaFija<CLOUD_ARENA_BYTES> arenaRed;
+
+struct MuestraInflux {
+  LecturaSensores lectura;
+  LecturaI2C ext;
+  PuntoTrayecto gps;
+  bool conGps;
+};
+MuestraInflux pendientes[INFLUX_PENDIENTES];
+uint8_t pendienteInicio = 0;
+uint8_t pendientesN = 0;
 
 // --- DECLARACIÓN DE FUNCIONES ---
 void callback(char* topic, byte* payload, unsigned int length);
+static void atenderComando(const char* sufijo, const char* msg);
 void reconnect();
 void publishDiscovery();
 void leerYPublicarSensores(); // Esta función ahora enviará a MQTT y a Influx
+void publicarDiagnostico();
+void publicarAutotest();
+void publicarTrayecto();
+void publicarReglas();
+void publicarActuadores();
+void publicarOta();
+void publicarAjustes();
+void encolarMuestra(const MuestraInflux& muestra);
+void escribirPendientes();
+bool publicar(const char* topic, const char* payload, bool retained = false);
+bool publicarEn(const char* sufijo, const char* payload, bool retained = false);
 
 // ---------------------------------------------------------
 // LÓGICA DE CONTROL (CALLBACK MQTT)
 // ---------------------------------------------------------
 void callback(char* topic, byte* payload, unsigned int length) {
-  String msg;
-  for (int i = 0; i < length; i++) msg += (char)payload[i];
-  String strTopic = String(topic);
+  size_t marca = arenaRed.marca();
+  const char* msg = arenaRed.copiar((const char*)payload, length);
 
   Serial.print("MQTT CMD ["); Serial.print(topic); Serial.print("]: "); Serial.println(msg);
 
-  if (strTopic.endsWith("relay1/set")) {
-    digitalWrite(PIN_RELAY_1, (msg == "ON") ? HIGH : LOW);
-    client.publish("orion/relay1/state", msg.c_str());
+  // Solo llega orion/<id>/+/set: se compara lo que sigue a la base
+  size_t largoBase = strlen(topicoBase);
+  if (strncmp(topic, topicoBase, largoBase) == 0 && topic[largoBase] == '/') {
+    atenderComando(topic + largoBase + 1, msg);
   }
-  else if (strTopic.endsWith("relay2/set")) {
-    digitalWrite(PIN_RELAY_2, (msg == "ON") ? HIGH : LOW);
-    client.publish("orion/relay2/state", msg.c_str());
+  arenaRed.volver(marca);
+}
+
+// 'sufijo': lo que sigue a orion/<id>/
+static void atenderComando(const char* sufijo, const char* msg) {
+  // El estado se publica cuando IO confirma el cambio (cloudPublicarActuador)
+  if (strcmp(sufijo, "relay1/set") == 0) {
+    ioEscribir(ACT_RELAY_1, strcmp(msg, "ON") == 0 ? 1 : 0, ORIGEN_CLOUD);
+  }
+  else if (strcmp(sufijo, "relay2/set") == 0) {
+    ioEscribir(ACT_RELAY_2, strcmp(msg, "ON") == 0 ? 1 : 0, ORIGEN_CLOUD);
   }
-  else if (strTopic.endsWith("relay3/set")) {
-    digitalWrite(PIN_RELAY_3, (msg == "ON") ? HIGH : LOW);
-    client.publish("orion/relay3/state", msg.c_str());
+  else if (strcmp(sufijo, "relay3/set") == 0) {
+    ioEscribir(ACT_RELAY_3, strcmp(msg, "ON") == 0 ? 1 : 0, ORIGEN_CLOUD);
   }
-  else if (strTopic.endsWith("relay4/set")) {
-    digitalWrite(PIN_RELAY_4, (msg == "ON") ? HIGH : LOW);
-    client.publish("orion/relay4/state", msg.c_str());
+  else if (strcmp(sufijo, "relay4/set") == 0) {
+    ioEscribir(ACT_RELAY_4, strcmp(msg, "ON") == 0 ? 1 : 0, ORIGEN_CLOUD);
   }
-  else if (strTopic.endsWith("lock/set")) {
-    if (msg == "UNLOCK") {
-      digitalWrite(PIN_LOCK, HIGH);
-      client.publish("orion/lock/state", "UNLOCKED");
-      lockOpen = true;
-      lockTimer = millis();
+  else if (strcmp(sufijo, "lock/set") == 0) {
+    if (strcmp(msg, "UNLOCK") == 0) {
+      ComandoIO cmd = { CMD_IO_PULSO_LOCK, ACT_LOCK, ORIGEN_CLOUD, 3000 };
+      ioEnviarComando(cmd);
     } else {
-      digitalWrite(PIN_LOCK, LOW);
-      client.publish("orion/lock/state", "LOCKED");
+      ioEscribir(ACT_LOCK, 0, ORIGEN_CLOUD);
     }
   }
+  else if (strcmp(sufijo, "selftest/set") == 0) {
+    // El reporte sale por orion/<id>/selftest/report al terminar
+    if (strcmp(msg, "STOP") == 0) autotestCancelar();
+    else autotestSolicitar(AT_COMPLETO);
+  }
+  else if (strcmp(sufijo, "rules/set") == 0) {
+    // Mismas órdenes que "rule" en WebSerial; la lista sale por rules/state
+    char resp[128];
+    reglasComando(msg, resp, sizeof(resp));
+    publicarEn("rules/result", resp);
+  }
+  else if (strcmp(sufijo, "scenes/set") == 0) {
+    // Mismas órdenes que "scene" en WebSerial; el cambio sale por actuators/state
+    char resp[96];
+    escenasComando(msg, ORIGEN_CLOUD, resp, sizeof(resp));
+    publicarEn("scenes/result", resp);
+  }
+  else if (strcmp(sufijo, "ota/set") == 0) {
+    // "<url http> <sha256 hex>": la descarga la hace otaPaso(); el avance sale por ota/state
+    const char* url = arenaRed.palabra(msg, ' ', 0);
+    const char* sha = arenaRed.palabra(msg, ' ', 1);
+    if (!otaDescargar(url, sha)) publicarEn("ota/result", "Rechazada: ocupada, URL o SHA-256 invalidos");
+  }
+  else if (strcmp(sufijo, "config/set") == 0) {
+    // Retenido: la placa toma los ajustes del sitio cada vez que se suscribe.
+    // Lo aplicado sale por config/state
+    char resp[96];
+    ajustesFijarJson(msg, resp, sizeof(resp));
+    publicarEn("config/result", resp);
+  }
+}
+
+// Todas las publicaciones pasan por aquí para medir latencia y fallos
+bool publicar(const char* topic, const char* payload, bool retained) {
+  uint32_t t0 = micros();
+  bool ok = client.publish(topic, payload, retained);
+  metricaLatencia(HIST_MQTT_PUBLICAR, micros() - t0);
+  metricaContar(ok ? CNT_MQTT_PUBLICADOS : CNT_MQTT_FALLOS);
+  return ok;
+}
+
+// Tópico relativo a orion/<id>/
+bool publicarEn(const char* sufijo, const char* payload, bool retained) {
+  char topic[64];
+  snprintf(topic, sizeof(topic), "%s/%s", topicoBase, sufijo);
+  return publicar(topic, payload, retained);
 }
 
 // ---------------------------------------------------------
-// INICIO DEL MODO CLOUD
+// ESTADO DE ACTUADORES (eventos de la tarea IO)
 // ---------------------------------------------------------
-void iniciarModoCloud(Adafruit_SSD1306* displayPtr) {
-  cloudDisplay = displayPtr;
-
-  // 1. Hardware Init
-  pinMode(PIN_RELAY_1, OUTPUT); digitalWrite(PIN_RELAY_1, LOW);
-  pinMode(PIN_RELAY_2, OUTPUT); digitalWrite(PIN_RELAY_2, LOW);
-  pinMode(PIN_RELAY_3, OUTPUT); digitalWrite(PIN_RELAY_3, LOW);
-  pinMode(PIN_RELAY_4, OUTPUT); digitalWrite(PIN_RELAY_4, LOW);
-  pinMode(PIN_LOCK, OUTPUT);    digitalWrite(PIN_LOCK, LOW);
-  
-  ldrCloud.begin(12);
-  gpsSerialCloud.begin(9600, SERIAL_8N1, PIN_GPS_RX, PIN_GPS_TX);
-
-  // 2. Sincronización de Tiempo (NECESARIO PARA INFLUX)
-  cloudDisplay->clearDisplay();
-  cloudDisplay->setCursor(0,0);
-  cloudDisplay->println("Sincronizando reloj...");
-  cloudDisplay->display();
-  
-  timeSync(TZ_INFO, "pool.ntp.org", "time.nis.gov");
+// Retenidos: Home Assistant ve el estado real aunque cambie con la sesión cerrada
+static void publicarSalida(ActuadorId actuador, bool on) {
+  if (actuador <= ACT_RELAY_4) {
+    char sufijo[16];
+    snprintf(sufijo, sizeof(sufijo), "relay%d/state", actuador - ACT_RELAY_1 + 1);
+    publicarEn(sufijo, on ? "ON" : "OFF", true);
+  } else if (actuador == ACT_LOCK) {
+    publicarEn("lock/state", on ? "UNLOCKED" : "LOCKED", true);
+  }
+}
 
-  // 3. Validación InfluxDB
-  cloudDisplay->println("Check InfluxDB...");
-  cloudDisplay->display();
-  
-  if (clientInflux.validateConnection()) {
-    Serial.print("InfluxDB OK: "); Serial.println(clientInflux.getServerUrl());
-  } else {
-    Serial.print("InfluxDB Error: "); Serial.println(clientInflux.getLastErrorMessage());
-    cloudDisplay->println("Err Influx!");
-    cloudDisplay->display();
-    delay(1000);
+size_t cloudJsonActuadores(const EstadoActuadores& act, char* buf, size_t cap) {
+  static const char* const campos[4] = { "relay1", "relay2", "relay3", "relay4" };
+  StaticJsonDocument<256> doc;
+  for (uint8_t i = 0; i < 4; i++) doc[campos[i]] = act.relays[i] ? "ON" : "OFF";
+  doc["lock"] = act.lockAbierto ? "UNLOCKED" : "LOCKED";
+  doc["scene"] = act.escena;
+  doc["skew_ns"] = act.escenaSesgoNs;
+  return serializeJson(doc, buf, cap);
+}
+
+// Relés y cerradura en un solo mensaje: una escena se ve como un único cambio
+static void publicarEstadoActuadores() {
+  EstadoActuadores estado;
+  ioObtenerActuadores(estado);
+  char buf[160];
+  cloudJsonActuadores(estado, buf, sizeof(buf));
+  publicarEn("actuators/state", buf, true);
+}
+
+void cloudPublicarActuador(const EventoActuador& evt) {
+  if (!client.connected()) return;
+
+  if (evt.actuador == ACT_ESCENA) {
+    publicarEstadoActuadores();
+    // Los tópicos por salida siguen al día para quien solo escucha esos
+    Escena e;
+    if (!escenaObtener((uint8_t)evt.valor, e)) return;
+    for (uint8_t s = 0; s < ESCENA_SALIDAS; s++) {
+      if (e.mascara & (1 << s)) publicarSalida((ActuadorId)s, (e.valores >> s) & 1);
+    }
+  } else if (evt.actuador <= ACT_LOCK) {
+    publicarSalida(evt.actuador, evt.valor);
+    publicarEstadoActuadores();
   }
+}
+
+// Al conectar: lo que pudo cambiar desde la consola o las reglas sin sesión
+void publicarActuadores() {
+  EstadoActuadores estado;
+  ioObtenerActuadores(estado);
+  for (uint8_t i = 0; i < 4; i++) publicarSalida((ActuadorId)(ACT_RELAY_1 + i), estado.relays[i]);
+  publicarSalida(ACT_LOCK, estado.lockAbierto);
+  publicarEstadoActuadores();
+}
+
+// ---------------------------------------------------------
+// AJUSTES EN CALIENTE
+// ---------------------------------------------------------
+// Measurement y etiquetas: cambian con el id o con el ajuste ubicacion
+static void armarMedicion() {
+  char ubicacion[AJUSTE_TEXTO_MAX + 1];
+  ajustesTexto(AJ_UBICACION, ubicacion, sizeof(ubicacion));
+  snprintf(medicionInflux, sizeof(medicionInflux), "estado_sistema,dispositivo=%s,ubicacion=%s", idRed, ubicacion);
+}
+
+// TLS: contexto y buffers una vez por arranque (las reconexiones reanudan
+// la sesión). 'renovar': otro nombre que verificar en el certificado
+static void prepararTls(bool renovar) {
+  if (!clienteTLS.iniciado()) {
+    redEnviarEventoUI(EVT_CLOUD_PROGRESO, 0, "Preparando TLS...");
+    if (!clienteTLS.iniciar(MQTT_CA_PEM, servidorMqtt)) redEnviarEventoUI(EVT_CLOUD_PROGRESO, 0, "Err TLS!");
+  } else if (renovar) {
+    clienteTLS.fijarServidor(servidorMqtt);
+  }
+}
+
+// Broker, transporte, keepalive y buffer de los ajustes. Otro broker o
+// transporte cierra la sesión: se reconecta en el mismo paso
+static void aplicarAjustesMqtt() {
+  ajustesAplicados = ajustesSecuencia();
+  char host[AJUSTE_TEXTO_MAX + 1];
+  ajustesTexto(AJ_MQTT_HOST, host, sizeof(host));
+  bool otroHost = strcmp(host, servidorMqtt) != 0;
+  Client* transporte = ajustes.mqttTls ? (Client*)&clienteTLS : (Client*)&clientePlano;
+  if (otroHost || ajustes.mqttPuerto != puertoMqtt || transporte != transporteMqtt) {
+    // El DISCONNECT sale por el transporte de la sesión abierta
+    if (client.connected()) {
+      client.disconnect();
+      lastReconnect = 0;
+    }
+    bool otroTransporte = transporte != transporteMqtt;
+    strlcpy(servidorMqtt, host, sizeof(servidorMqtt));
+    puertoMqtt = (uint16_t)ajustes.mqttPuerto;
+    transporteMqtt = transporte;
+    client.setClient(*transporte);
+    client.setServer(servidorMqtt, puertoMqtt);
+    if (ajustes.mqttTls) prepararTls(otroHost || otroTransporte);
+  }
+  // En bajo consumo la tarea de red puede dormir latencia_ms entre dos
+  // client.loop(), y el broker corta a 1.5 keepalive sin paquetes. Vale
+  // desde el próximo CONNECT: si cambia, se reconecta.
+  uint16_t keepAlive = max((uint32_t)MQTT_KEEPALIVE, (2 * ajustes.latenciaMs + 999) / 1000);
+  if (keepAlive != keepAliveMqtt) {
+    keepAliveMqtt = keepAlive;
+    client.setKeepAlive(keepAliveMqtt);
+    if (client.connected()) {
+      client.disconnect();
+      lastReconnect = 0;
+    }
+  }
+  // PubSubClient rehace su buffer solo si cambia el tamaño
+  if (client.getBufferSize() != ajustes.mqttBuffer) client.setBufferSize((uint16_t)ajustes.mqttBuffer);
+  armarMedicion();
+}
+
+// Tópicos y etiquetas de Influx del id vigente. Un "sys id" llega desde
+// la consola: con sesión abierta se reconecta para suscribirse, anunciarse
+// y publicar con el nuevo (también en Híbrido, que no vuelve a entrar)
+static void aplicarIdentidad() {
+  identidadAplicada = identidadSecuencia();
+  identidadCopiar(idRed, sizeof(idRed));
+  snprintf(topicoBase, sizeof(topicoBase), "orion/%s", idRed);
+  armarMedicion();
+  if (client.connected()) {
+    client.disconnect();
+    lastReconnect = 0;
+  }
+}
+
+// ---------------------------------------------------------
+// INICIO DEL MODO CLOUD
+// ---------------------------------------------------------
+void iniciarModoCloud() {
+  // 1. NTP en segundo plano (una vez por arranque): las muestras llevan su
+  //    hora monotónica y se convierten a UTC al escribirlas en Influx
+  relojIniciar(TZ_INFO, "pool.ntp.org", "time.nis.gov");
+
+  // 2. Validación InfluxDB (se repite solo si falló)
+  if (!influxValidado) {
+    redEnviarEventoUI(EVT_CLOUD_PROGRESO, 0, "Check InfluxDB...");
+    clientInflux.setWriteOptions(WriteOptions().writePrecision(WritePrecision::MS));
+
+    if (clientInflux.validateConnection()) {
+      influxValidado = true;
+      Serial.print("InfluxDB OK: "); Serial.println(clientInflux.getServerUrl());
+    } else {
+      Serial.print("InfluxDB Error: "); Serial.println(clientInflux.getLastErrorMessage());
+      redEnviarEventoUI(EVT_CLOUD_PROGRESO, 0, "Err Influx!");
+    }
+  }
+
+  // 3. Broker, transporte y buffer (grande: Discovery JSON). Un TLS que
+  //    falló al prepararse se reintenta en cada entrada
+  aplicarAjustesMqtt();
+  if (ajustes.mqttTls) prepararTls(false);
 
   // 4. MQTT Init
-  client.setServer(mqtt_server, mqtt_port);
+  aplicarIdentidad();
   client.setCallback(callback);
-  client.setBufferSize(2048); // Buffer grande para Discovery JSON
+  client.setSocketTimeout(5); // Acota lo que connect() puede retener la tarea de red
+  lastReconnect = 0;
+}
 
-  // Etiquetas globales para Influx
-  sensorData.addTag("dispositivo", "ESP32_Orion_V1");
-  sensorData.addTag("ubicacion", "Azure_Demo");
+void detenerModoCloud() {
+  client.disconnect();
+}
+
+static uint32_t msHasta(unsigned long cuando, unsigned long now) {
+  long falta = (long)(cuando - now);
+  return falta > 0 ? (uint32_t)falta : 0;
+}
+
+uint32_t cloudMsHastaVentana() {
+  unsigned long now = millis();
+  if (!client.connected()) return msHasta(lastReconnect + reconnectInterval, now);
+  // Mismos criterios (">") que loopModoCloud()
+  uint32_t ms = min(msHasta(lastMsg + ajustes.intervaloMs + 1, now), msHasta(lastDiag + ajustes.diagMs + 1, now));
+  if (trayectoTotal() != trayectoPublicado) ms = min(ms, msHasta(lastTrack + trackInterval + 1, now));
+  return ms;
 }
 
 // ---------------------------------------------------------
 // LOOP PRINCIPAL
 // ---------------------------------------------------------
 void loopModoCloud() {
-  // 1. Alimentar GPS (Siempre, lo más rápido posible)
-  while (gpsSerialCloud.available() > 0) {
-    gpsCloud.encode(gpsSerialCloud.read());
-  }
-
-  // 2. Verificar MQTT
+  // 1. Verificar MQTT (el GPS y la cerradura los atiende la tarea IO)
+  if (ajustesSecuencia() != ajustesAplicados) aplicarAjustesMqtt();
+  if (identidadSecuencia() != identidadAplicada) aplicarIdentidad();
   if (!client.connected()) {
     reconnect();
   }
   client.loop();
 
-  // 3. Temporizador Cerradura
-  if (lockOpen && (millis() - lockTimer > 3000)) {
-    digitalWrite(PIN_LOCK, LOW);
-    client.publish("orion/lock/state", "LOCKED");
-    lockOpen = false;
-  }
-
-  // 4. Lectura y Envío de Sensores (Cada 5 seg)
+  // 2. Envío de Sensores (cada intervalo_ms)
   unsigned long now = millis();
-  if (now - lastMsg > interval) {
+  if (now - lastMsg > ajustes.intervaloMs) {
     lastMsg = now;
+    uint32_t t0 = micros();
     leerYPublicarSensores();
+    metricaLatencia(HIST_SENSORES, micros() - t0);
+  }
+
+  // 3. Diagnóstico (retenido, cada diag_ms)
+  if (client.connected() && now - lastDiag > ajustes.diagMs) {
+    lastDiag = now;
+    publicarDiagnostico();
+  }
+
+  // 4. Trayecto simplificado: por lotes, antes si se acumula medio lote
+  uint32_t pendientes = trayectoTotal() - trayectoPublicado;
+  if (client.connected() && pendientes &&
+      (pendientes >= TRAYECTO_LOTE_MAX / 2 || now - lastTrack > trackInterval)) {
+    lastTrack = now;
+    publicarTrayecto();
   }
+
+  // 5. Reporte de autodiagnóstico nuevo (retenido)
+  if (client.connected() && autotestSecuencia() != autotestPublicado) {
+    publicarAutotest();
+  }
+
+  // 6. Reglas locales: tabla y estado (retenido) cuando cambian o disparan
+  if (client.connected() && reglasSecuencia() != reglasPublicadas) {
+    publicarReglas();
+  }
+
+  // 7. Estado de la OTA (retenido) cuando avanza de fase o termina
+  if (client.connected() && otaSecuencia() != otaPublicada) {
+    publicarOta();
+  }
+
+  // 8. Ajustes vigentes (retenido) cuando cambian, vengan de donde vengan
+  if (client.connected() && ajustesSecuencia() != ajustesPublicados) {
+    publicarAjustes();
+  }
+
+  arenaRed.reiniciar();
+}
+
+void publicarDiagnostico() {
+  // Fuera de la pila de la tarea de red (solo ella publica)
+  static char buffer[METRICAS_JSON_MAX];
+  if (!metricasJSON(buffer, sizeof(buffer))) {
+    metricaContar(CNT_DIAG_DESCARTES);
+    return;
+  }
+  publicarEn("diag/state", buffer, true);
+}
+
+void publicarReglas() {
+  static char lista[2048];
+  uint32_t secuencia = reglasSecuencia();
+  if (reglasJson(lista, sizeof(lista)) && !publicarEn("rules/state", lista, true)) return;
+  reglasPublicadas = secuencia;
+}
+
+void publicarOta() {
+  char estado[320];
+  uint32_t secuencia = otaSecuencia();
+  otaJson(estado, sizeof(estado));
+  if (publicarEn("ota/state", estado, true)) otaPublicada = secuencia;
+}
+
+void publicarAjustes() {
+  char estado[AJUSTES_JSON_MAX];
+  uint32_t secuencia = ajustesSecuencia();
+  if (ajustesJson(estado, sizeof(estado)) && publicarEn("config/state", estado, true)) ajustesPublicados = secuencia;
+}
+
+void publicarAutotest() {
+  static char reporte[AUTOTEST_REPORTE_MAX];
+  uint32_t secuencia = autotestSecuencia();
+  if (autotestReporte(reporte, sizeof(reporte)) && !publicarEn("selftest/report", reporte, true)) return;
+  autotestPublicado = secuencia;
+}
+
+void publicarTrayecto() {
+  PuntoTrayecto lote[TRAYECTO_LOTE_MAX];
+  uint32_t desde = trayectoPublicado;
+  size_t n = trayectoLote(&desde, lote, TRAYECTO_LOTE_MAX);
+  if (!n) return;
+
+  char buffer[768];
+  if (!cloudJsonTrayecto(lote, n, desde - n, buffer, sizeof(buffer))) return;
+  if (publicarEn("gps/track", buffer)) trayectoPublicado = desde;
+}
+
+// ---------------------------------------------------------
+// PAYLOADS
+// ---------------------------------------------------------
+size_t cloudJsonSensores(const LecturaSensores& lectura, char* buf, size_t cap, const LecturaI2C* ext) {
+  StaticJsonDocument<300> doc;
+  doc["temperature"] = lectura.temp;
+  doc["humidity"] = lectura.hum;
+  doc["illuminance"] = lectura.lux;
+  // Sensores de expansión: solo los que respondieron en la última lectura
+  if (ext && ext->ambiente) {
+    doc["temp_ext"] = ext->tempC;
+    if (!isnan(ext->humedad)) doc["hum_ext"] = ext->humedad;
+    doc["pressure"] = ext->presionHpa;
+  }
+  if (ext && ext->luz) doc["lux"] = ext->lux;
+  return serializeJson(doc, buf, cap);
+}
+
+size_t cloudJsonGps(const PuntoTrayecto& punto, char* buf, size_t cap) {
+  StaticJsonDocument<200> gpsDoc;
+  gpsDoc["latitude"] = punto.lat * 1e-5;
+  gpsDoc["longitude"] = punto.lng * 1e-5;
+  gpsDoc["gps_accuracy"] = 10;
+  return serializeJson(gpsDoc, buf, cap);
+}
+
+size_t cloudJsonTrayecto(const PuntoTrayecto* puntos, size_t n, uint32_t desde, char* buf, size_t cap) {
+  char poly[8 * TRAYECTO_LOTE_MAX + 16];
+  char tiempos[4 * TRAYECTO_LOTE_MAX + 8];
+  if (!trayectoPolyline(puntos, n, poly, sizeof(poly))) return 0;
+  if (!trayectoPolylineTiempos(puntos, n, tiempos, sizeof(tiempos))) return 0;
+
+  EstadisticaTrayecto est;
+  trayectoEstadistica(est);
+
+  // t0_ms y ahora_ms son millis(): el receptor ancla t0 con su propia hora
+  StaticJsonDocument<256> doc;
+  doc["desde"] = desde;
+  doc["n"] = n;
+  doc["t0_ms"] = puntos[0].ms;
+  doc["ahora_ms"] = millis();
+  doc["tol_m"] = est.toleranciaM;
+  doc["poly"] = (const char*)poly;
+  doc["dt"] = (const char*)tiempos;
+  return serializeJson(doc, buf, cap);
+}
+
+// Agrega a buf[usado..]; si no cabe, 'usado' queda en 'cap'
+static void agregarLinea(char* buf, size_t cap, size_t& usado, const char* fmt, ...) {
+  if (usado >= cap) return;
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(buf + usado, cap - usado, fmt, args);
+  va_end(args);
+  usado = (n < 0 || (size_t)n >= cap - usado) ? cap : usado + n;
+}
+
+// Line protocol de Influx, como lo arma Point de la librería (sin String)
+size_t cloudLineaInflux(const LecturaSensores& lectura, const PuntoTrayecto* gps, const LecturaI2C* ext,
+                        uint64_t utcMs, char* buf, size_t cap) {
+  size_t usado = 0;
+  agregarLinea(buf, cap, usado, "%s ", medicionInflux);
+
+  // Solo enviar datos DHT si la lectura fue válida
+  if (lectura.dhtStatus == 0) agregarLinea(buf, cap, usado, "temperatura=%di,humedad=%di,", lectura.temp, lectura.hum);
+  agregarLinea(buf, cap, usado, "luz_porcentaje=%di,luz_raw=%di", lectura.lux, lectura.luxRaw);
+
+  // Posición solo cuando el trayecto guardó un punto nuevo; estacionado no se repite
+  if (gps) {
+    agregarLinea(buf, cap, usado, ",latitud=%.5f,longitud=%.5f,altitud=%di", gps->lat * 1e-5, gps->lng * 1e-5,
+                 (int)gps->alt);
+  }
+  if (lectura.satsValido) agregarLinea(buf, cap, usado, ",satelites=%di", (int)lectura.sats);
+
+  if (ext && ext->ambiente) {
+    agregarLinea(buf, cap, usado, ",temp_ext=%.2f", ext->tempC);
+    if (!isnan(ext->humedad)) agregarLinea(buf, cap, usado, ",hum_ext=%.2f", ext->humedad);
+    agregarLinea(buf, cap, usado, ",presion_hpa=%.2f", ext->presionHpa);
+  }
+  if (ext && ext->luz) agregarLinea(buf, cap, usado, ",lux=%.2f", ext->lux);
+  agregarLinea(buf, cap, usado, " %llu", (unsigned long long)utcMs);
+  return usado < cap ? usado : 0;
 }
 
 // ---------------------------------------------------------
@@ -187,123 +575,180 @@ void loopModoCloud() {
 // ---------------------------------------------------------
 void leerYPublicarSensores() {
   
-  // --- A. LEER SENSORES ---
-  int temp = 0, hum = 0;
-  int dhtStatus = dhtCloud.readTemperatureHumidity(temp, hum);
-  int lux = ldrCloud.getPercentageLDR();
-  int luxRaw = ldrCloud.getAnalogLDR();
+  // --- A. LEER SENSORES (última muestra de la tarea IO) ---
+  LecturaSensores lectura;
+  ioObtenerLectura(lectura);
+  LecturaI2C ext;
+  i2cObtenerLectura(ext);
 
   // --- B. ENVIAR A MQTT (JSON para Home Assistant) ---
-  StaticJsonDocument<300> doc;
-  doc["temperature"] = temp;
-  doc["humidity"] = hum;
-  doc["illuminance"] = lux;
-
-  if (gpsCloud.location.isValid()) {
-    StaticJsonDocument<200> gpsDoc;
-    gpsDoc["latitude"] = gpsCloud.location.lat();
-    gpsDoc["longitude"] = gpsCloud.location.lng();
-    gpsDoc["gps_accuracy"] = 10;
+  // Posición: el último punto del trayecto, solo si es nuevo (retenido)
+  PuntoTrayecto gps = {};
+  uint32_t totalTrayecto = trayectoTotal();
+  bool gpsNuevo = totalTrayecto != gpsEnviado && trayectoUltimo(gps);
+  if (gpsNuevo) {
     char gpsBuffer[200];
-    serializeJson(gpsDoc, gpsBuffer);
-    client.publish("orion/gps/state", gpsBuffer);
+    cloudJsonGps(gps, gpsBuffer, sizeof(gpsBuffer));
+    publicarEn("gps/state", gpsBuffer, true);
   }
 
   char jsonBuffer[300];
-  serializeJson(doc, jsonBuffer);
-  client.publish("orion/sensors/state", jsonBuffer);
+  cloudJsonSensores(lectura, jsonBuffer, sizeof(jsonBuffer), &ext);
+  publicarEn("sensors/state", jsonBuffer);
+
+  // --- C. ENVIAR A INFLUXDB (la muestra espera en la cola si no se puede) ---
+  MuestraInflux muestra = { lectura, ext, gps, gpsNuevo };
+  encolarMuestra(muestra);
+  if (gpsNuevo) gpsEnviado = totalTrayecto;
+  escribirPendientes();
+
+  // --- D. AVISAR A LA UI (la pantalla la dibuja la tarea UI) ---
+  int16_t estado = (client.connected() ? 1 : 0) | (influxOK ? 2 : 0);
+  redEnviarEventoUI(EVT_CLOUD_ESTADO, estado);
+}
 
-  // --- C. ENVIAR A INFLUXDB ---
-  sensorData.clearFields(); // Limpiar punto anterior
-  
-  // Solo enviar datos DHT si la lectura fue válida
-  if (dhtStatus == 0) {
-    sensorData.addField("temperatura", temp);
-    sensorData.addField("humedad", hum);
+void encolarMuestra(const MuestraInflux& muestra) {
+  if (pendientesN == INFLUX_PENDIENTES) {
+    pendienteInicio = (pendienteInicio + 1) % INFLUX_PENDIENTES;  // Se pierde la más vieja
+    pendientesN--;
+    metricaContar(CNT_INFLUX_DESCARTES);
+  }
+  MuestraInflux& m = pendientes[(pendienteInicio + pendientesN) % INFLUX_PENDIENTES];
+  m = muestra;
+  if (!m.lectura.monoUs) m.lectura.monoUs = relojMonoUs();  // IO aún no adquirió nada
+  pendientesN++;
+}
+
+// Un lote por ciclo: las muestras de antes del NTP salen con su hora real
+void escribirPendientes() {
+  if (!pendientesN) return;
+  if (!relojSincronizado()) {
+    Serial.printf("Influx: %u muestras esperando hora NTP\n", pendientesN);
+    return;
   }
-  sensorData.addField("luz_porcentaje", lux);
-  sensorData.addField("luz_raw", luxRaw);
 
-  // Datos GPS si válidos
-  if (gpsCloud.location.isValid()) {
-    sensorData.addField("latitud", gpsCloud.location.lat());
-    sensorData.addField("longitud", gpsCloud.location.lng());
-    sensorData.addField("altitud", gpsCloud.altitude.meters());
-    sensorData.addField("satelites", (int)gpsCloud.satellites.value());
+  // El lote sale de la arena: 1.5 KB que no ocupan la pila de la tarea de red
+  const size_t cap = INFLUX_LOTE * INFLUX_LINEA_MAX;
+  char* lote = arenaRed.reservar(cap);
+  if (!lote) return;
+  size_t usado = 0;
+  uint8_t n = 0;
+  while (n < pendientesN && n < INFLUX_LOTE) {
+    const MuestraInflux& m = pendientes[(pendienteInicio + n) % INFLUX_PENDIENTES];
+    uint64_t utcMs = 0;
+    relojUtcMs(m.lectura.monoUs, utcMs);
+    // Cada línea se arma detrás de su separador y solo entra si cupo entera
+    size_t sep = n ? 1 : 0;
+    size_t largo = cloudLineaInflux(m.lectura, m.conGps ? &m.gps : nullptr, &m.ext, utcMs, lote + usado + sep,
+                                    cap - usado - sep);
+    if (largo) {
+      if (sep) lote[usado] = '\n';
+      usado += sep + largo;
+      n++;
+      continue;
+    }
+    lote[usado] = '\0';
+    if (n) break;  // Lote lleno: el resto sale en el próximo
+    // No cabe ni sola: se descarta en vez de mandarla cortada
+    pendienteInicio = (pendienteInicio + 1) % INFLUX_PENDIENTES;
+    pendientesN--;
+    metricaContar(CNT_INFLUX_DESCARTES);
   }
+  if (!n) return;
 
-  // Escribir en BDD
   Serial.println("Enviando a InfluxDB...");
-  if (!clientInflux.writePoint(sensorData)) {
-    Serial.print("Fallo escritura Influx: ");
-    Serial.println(clientInflux.getLastErrorMessage());
-  } else {
-    Serial.println("InfluxDB Write OK");
-  }
-
-  // --- D. ACTUALIZAR PANTALLA OLED ---
-  cloudDisplay->clearDisplay();
-  cloudDisplay->setCursor(0, 0);
-  cloudDisplay->println("== MODO CLOUD ==");
-  cloudDisplay->print("MQTT: "); cloudDisplay->println(client.connected() ? "ON" : "OFF");
-  cloudDisplay->print("Influx: "); cloudDisplay->println("Enviado");
-  
-  cloudDisplay->print("T:"); cloudDisplay->print(temp); 
-  cloudDisplay->print(" H:"); cloudDisplay->println(hum);
-  
-  if(gpsCloud.location.isValid()) {
-    cloudDisplay->print("GPS: OK Sats:"); cloudDisplay->println(gpsCloud.satellites.value());
-  } else {
-    cloudDisplay->println("GPS: Buscando...");
+  uint32_t t0 = micros();
+  influxOK = clientInflux.writeRecord(lote);
+  metricaLatencia(HIST_INFLUX_ESCRIBIR, micros() - t0);
+  metricaContar(influxOK ? CNT_INFLUX_OK : CNT_INFLUX_FALLOS);
+  if (!influxOK) {
+    // getLastErrorMessage() devuelve una String: basta el código HTTP
+    Serial.printf("Fallo escritura Influx: HTTP %d\n", clientInflux.getLastStatusCode());
+    return;
   }
-  
-  cloudDisplay->display();
+  Serial.printf("InfluxDB Write OK (%u muestras)\n", n);
+  pendienteInicio = (pendienteInicio + n) % INFLUX_PENDIENTES;
+  pendientesN -= n;
 }
 
 // ---------------------------------------------------------
 // RECONEXIÓN Y DISCOVERY (Sin Cambios Mayores)
 // ---------------------------------------------------------
-void sendDiscovery(const char* component, const char* name, const char* unique_id, const char* device_class, bool isSensor, int relayNum = 0) {
-    // (Pega aquí la misma función sendDiscovery que te di en el código anterior)
-    // Para ahorrar espacio en esta respuesta no la repito, pero ES NECESARIA.
-    // Si la necesitas completa de nuevo, dímelo.
+// Los tópicos usan la base "~" de Discovery (orion/<id>) y los ids llevan
+// el de la placa: dos placas en el mismo Home Assistant no se mezclan
+size_t cloudJsonDiscovery(const char* component, const char* name, const char* unique_id, const char* device_class, bool isSensor, int relayNum, char* buf, size_t cap) {
+    // Los textos quedan en la arena hasta serializar (ArduinoJson guarda el puntero)
+    size_t marca = arenaRed.marca();
+    const char* id = idRed;
     StaticJsonDocument<600> doc;
-    String topic_config = "homeassistant/" + String(component) + "/orion/" + String(unique_id) + "/config";
+    doc["~"] = topicoBase;
     doc["name"] = name;
-    doc["uniq_id"] = unique_id;
+    doc["uniq_id"] = arenaRed.formatear("orion_%s_%s", id, unique_id);
     JsonObject dev = doc.createNestedObject("dev");
-    dev["ids"] = "orion_esp32_v1";
-    dev["name"] = "Orion IoT System";
+    dev["ids"] = arenaRed.formatear("orion_%s", id);
+    dev["name"] = arenaRed.formatear("Orion %s", id);
     dev["mdl"] = "ESP32 Custom";
     dev["mf"] = "Ing. Jesus Gonzalez";
 
     if (!isSensor) {
-      if (String(component) == "light") {
-        String rNum = String(relayNum);
-        doc["cmd_t"] = "orion/relay" + rNum + "/set";
-        doc["stat_t"] = "orion/relay" + rNum + "/state";
+      if (strcmp(component, "light") == 0) {
+        doc["cmd_t"] = arenaRed.formatear("~/relay%d/set", relayNum);
+        doc["stat_t"] = arenaRed.formatear("~/relay%d/state", relayNum);
         doc["pl_on"] = "ON"; doc["pl_off"] = "OFF";
-      } else if (String(component) == "lock") {
-        doc["cmd_t"] = "orion/lock/set";
-        doc["stat_t"] = "orion/lock/state";
+      } else if (strcmp(component, "lock") == 0) {
+        doc["cmd_t"] = "~/lock/set";
+        doc["stat_t"] = "~/lock/state";
         doc["pl_lock"] = "LOCK"; doc["pl_unlk"] = "UNLOCK";
       }
     } else {
-      if (String(component) == "device_tracker") {
-         doc["stat_t"] = "orion/gps/state";
-         doc["json_attr_t"] = "orion/gps/state";
+      if (strcmp(component, "device_tracker") == 0) {
+         doc["stat_t"] = "~/gps/state";
+         doc["json_attr_t"] = "~/gps/state";
       } else {
-         doc["stat_t"] = "orion/sensors/state";
-         doc["val_tpl"] = "{{ value_json." + String(unique_id) + " }}";
+         doc["stat_t"] = "~/sensors/state";
+         doc["val_tpl"] = arenaRed.formatear("{{ value_json.%s }}", unique_id);
          if (device_class[0] != '\0') doc["dev_cla"] = device_class;
-         if (String(device_class) == "temperature") doc["unit_of_meas"] = "°C";
-         if (String(device_class) == "humidity") doc["unit_of_meas"] = "%";
-         if (String(device_class) == "illuminance") doc["unit_of_meas"] = "%";
+         if (strcmp(device_class, "temperature") == 0) doc["unit_of_meas"] = "°C";
+         if (strcmp(device_class, "humidity") == 0) doc["unit_of_meas"] = "%";
+         if (strcmp(device_class, "illuminance") == 0) doc["unit_of_meas"] = strcmp(unique_id, "lux") == 0 ? "lx" : "%";
+         if (strcmp(device_class, "pressure") == 0) doc["unit_of_meas"] = "hPa";
       }
     }
+    size_t n = serializeJson(doc, buf, cap);
+    arenaRed.volver(marca);
+    return n;
+}
+
+void sendDiscovery(const char* component, const char* name, const char* unique_id, const char* device_class, bool isSensor, int relayNum = 0) {
+    char topic_config[IDENTIDAD_MAX + 80];
+    snprintf(topic_config, sizeof(topic_config), "homeassistant/%s/orion_%s/%s/config", component, idRed, unique_id);
+    char buffer[600];
+    cloudJsonDiscovery(component, name, unique_id, device_class, isSensor, relayNum, buffer, sizeof(buffer));
+    publicar(topic_config, buffer, true);
+}
+
+// Sensores de diagnóstico: leen su campo de orion/<id>/diag/state
+void sendDiscoveryDiag(const char* name, const char* campo, const char* unidad) {
+    size_t marca = arenaRed.marca();
+    StaticJsonDocument<600> doc;
+    const char* dispositivo = arenaRed.formatear("orion_%s", idRed);
+    char topic_config[IDENTIDAD_MAX + 80];
+    snprintf(topic_config, sizeof(topic_config), "homeassistant/sensor/%s/diag_%s/config", dispositivo, campo);
+    doc["~"] = topicoBase;
+    doc["name"] = name;
+    doc["uniq_id"] = arenaRed.formatear("%s_diag_%s", dispositivo, campo);
+    JsonObject dev = doc.createNestedObject("dev");
+    dev["ids"] = dispositivo;
+    doc["stat_t"] = "~/diag/state";
+    doc["val_tpl"] = arenaRed.formatear("{{ value_json.%s }}", campo);
+    doc["unit_of_meas"] = unidad;
+    doc["ent_cat"] = "diagnostic";
+    doc["stat_cla"] = "measurement";
+
     char buffer[600];
     serializeJson(doc, buffer);
-    client.publish(topic_config.c_str(), buffer, true);
+    publicar(topic_config, buffer, true);
+    arenaRed.volver(marca);
 }
 
 void publishDiscovery() {
@@ -316,25 +761,57 @@ void publishDiscovery() {
   sendDiscovery("sensor", "Temperatura", "temperature", "temperature", true);
   sendDiscovery("sensor", "Humedad", "humidity", "humidity", true);
   sendDiscovery("sensor", "Luminosidad", "illuminance", "illuminance", true);
+  // Expansiones I2C encontradas al arrancar (o en el último "sys i2c scan")
+  LecturaI2C ext;
+  i2cObtenerLectura(ext);
+  if (ext.ambiente) {
+    sendDiscovery("sensor", "Temperatura Ext", "temp_ext", "temperature", true);
+    if (!isnan(ext.humedad)) sendDiscovery("sensor", "Humedad Ext", "hum_ext", "humidity", true);
+    sendDiscovery("sensor", "Presion", "pressure", "pressure", true);
+  }
+  if (ext.luz) sendDiscovery("sensor", "Iluminancia", "lux", "illuminance", true);
   sendDiscovery("device_tracker", "Orion GPS", "gps_tracker", "", true);
+  sendDiscoveryDiag("Heap libre", "heap", "B");
+  sendDiscoveryDiag("Heap bloque mayor", "heap_blk", "B");
+  sendDiscoveryDiag("Pila libre red", "pila_red", "B");
+  sendDiscoveryDiag("Latencia sensores p95", "sensores_p95", "us");
+  sendDiscoveryDiag("Latencia MQTT p95", "mqtt_pub_p95", "us");
+  sendDiscoveryDiag("Latencia Influx p95", "influx_p95", "us");
+  sendDiscoveryDiag("Paso red max", "paso_red_max", "us");
+  sendDiscoveryDiag("Handshake TLS max", "tls_full_max", "us");
+  sendDiscoveryDiag("Handshake TLS reanudado max", "tls_resum_max", "us");
+  sendDiscoveryDiag("Heap TLS", "tls_heap", "B");
+  sendDiscoveryDiag("Deriva reloj", "reloj_deriva_ppb", "ppb");
+  sendDiscoveryDiag("Corriente media estimada", "energia_ua", "uA");
 }
 
 void reconnect() {
   if (!client.connected()) {
+    // Sin delay(): se reintenta en el siguiente paso pasado reconnectInterval
+    unsigned long now = millis();
+    if (lastReconnect != 0 && now - lastReconnect < reconnectInterval) return;
+    lastReconnect = now;
+
     Serial.print("Reconectando MQTT...");
-    String clientId = "ESP32Orion-" + String(random(0xffff), HEX);
-    if (client.connect(clientId.c_str(), mqtt_user, mqtt_pass)) {
+    // Id de cliente estable: si la placa reaparece, el broker cierra la sesión vieja
+    char clientId[IDENTIDAD_MAX + 8];
+    snprintf(clientId, sizeof(clientId), "orion-%s", idRed);
+    uint32_t t0 = micros();
+    bool ok = client.connect(clientId, mqtt_user, mqtt_pass);
+    metricaLatencia(HIST_MQTT_CONECTAR, micros() - t0);
+    if (ok) {
       Serial.println("Conectado");
-      client.subscribe("orion/relay1/set");
-      client.subscribe("orion/relay2/set");
-      client.subscribe("orion/relay3/set");
-      client.subscribe("orion/relay4/set");
-      client.subscribe("orion/lock/set");
+      metricaContar(CNT_MQTT_RECONEXIONES);
+      otaConfirmar();  // Una imagen a prueba que llega al broker se queda
+      // Un solo filtro para relés, cerradura, autodiagnóstico, reglas, OTA y ajustes
+      char filtro[IDENTIDAD_MAX + 16];
+      snprintf(filtro, sizeof(filtro), "%s/+/set", topicoBase);
+      client.subscribe(filtro);
       publishDiscovery();
+      publicarActuadores();
     } else {
       Serial.print("failed, rc=");
-      Serial.print(client.state());
-      delay(2000);
+      Serial.println(client.state());
     }
   }
-}
\ No newline at end of file
+}
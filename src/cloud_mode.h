@@ -2,12 +2,42 @@
 #define CLOUD_MODE_H
 
 #include <Arduino.h>
-#include <Adafruit_SSD1306.h>
+#include "messages.h"
+#include "trayecto.h"
 
-// Inicializa la conexión MQTT y manda las configuraciones a Home Assistant
-void iniciarModoCloud(Adafruit_SSD1306* displayPtr);
+struct LecturaI2C;
+
+// Inicializa la conexión MQTT y manda las configuraciones a Home Assistant.
+// Corre en la tarea de red; el progreso se informa a la UI con EVT_CLOUD_PROGRESO.
+void iniciarModoCloud();
 
 // Bucle principal: mantiene la conexión y publica datos de sensores
 void loopModoCloud();
 
-#endif
\ No newline at end of file
+// Cierra la sesión MQTT al salir del modo
+void detenerModoCloud();
+
+// Bajo consumo: ms hasta lo próximo que loopModoCloud() tiene agendado
+// (sensores, diagnóstico, trayecto o reintento de conexión)
+uint32_t cloudMsHastaVentana();
+
+// Publica en el tópico de estado un cambio confirmado por la tarea IO
+void cloudPublicarActuador(const EventoActuador& evt);
+
+// Payloads de cada ciclo y de Discovery, sin publicar (los usa host/bench).
+// Devuelven los bytes escritos en buf.
+// 'ext': sensores del bus I2C (se agregan los que respondieron), o nullptr
+size_t cloudJsonSensores(const LecturaSensores& lectura, char* buf, size_t cap, const LecturaI2C* ext = nullptr);
+size_t cloudJsonGps(const PuntoTrayecto& punto, char* buf, size_t cap);
+size_t cloudJsonActuadores(const EstadoActuadores& act, char* buf, size_t cap);  // actuators/state
+size_t cloudJsonDiscovery(const char* component, const char* name, const char* unique_id,
+                          const char* device_class, bool isSensor, int relayNum, char* buf, size_t cap);
+// Línea de Influx con la hora 'utcMs'; 0 si no cabe en cap.
+// 'gps': último punto del trayecto si es nuevo desde la escritura anterior, o nullptr
+size_t cloudLineaInflux(const LecturaSensores& lectura, const PuntoTrayecto* gps, const LecturaI2C* ext,
+                        uint64_t utcMs, char* buf, size_t cap);
+
+// Lote polyline para orion/gps/track con los puntos [desde, desde + n)
+size_t cloudJsonTrayecto(const PuntoTrayecto* puntos, size_t n, uint32_t desde, char* buf, size_t cap);
+
+#endif
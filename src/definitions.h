@@ -11,7 +11,9 @@ enum UIState {
   UI_WIFI_PASSWORD,
   UI_LOCAL_MODE,
   UI_CLOUD_MODE,
-  UI_TEST_MODE
+  UI_HYBRID_MODE,
+  UI_TEST_MODE,
+  UI_DIAGNOSTICO
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "bus_i2c.h"
+
+/* =======================
+   DRIVERS I2C
+   =======================
+   Cada driver confirma su chip en iniciar() y deja en privado[] lo que
+   necesite (calibración). leer() corre en la tarea I2C: una sola ráfaga
+   por lectura, así el bus queda libre para la pantalla. */
+
+// ---------------------------------------------------------
+// SSD1306: la inicia Adafruit; aquí solo fija el reloj y recibe trozos.
+// La hoja de datos llega a fast mode (400 kHz); más rápido funciona en
+// unos módulos y en otros corrompe la imagen.
+// ---------------------------------------------------------
+static const DriverI2C driverSSD1306 = {
+  "SSD1306", { 0x3C, 0x3D }, 400000, 0, nullptr, nullptr
+};
+
+// ---------------------------------------------------------
+// BME280 / BMP280 (Bosch): temperatura, presión y humedad
+// ---------------------------------------------------------
+#define BME_REG_ID        0xD0
+#define BME_REG_CALIB_TP  0x88   // 24 bytes: T1..T3, P1..P9
+#define BME_REG_CALIB_H1  0xA1
+#define BME_REG_CALIB_H2  0xE1   // 7 bytes: H2..H6
+#define BME_REG_CTRL_HUM  0xF2
+#define BME_REG_CTRL_MEAS 0xF4
+#define BME_REG_CONFIG    0xF5
+#define BME_REG_DATOS     0xF7   // 8 bytes: P, T, H
+
+#define BME_ID_BME280 0x60
+#define BME_ID_BMP280 0x58
+
+struct CalibracionBME {
+  uint16_t T1; int16_t T2, T3;
+  uint16_t P1; int16_t P2, P3, P4, P5, P6, P7, P8, P9;
+  uint8_t H1, H3; int16_t H2, H4, H5; int8_t H6;
+  bool humedad;  // false en un BMP280
+};
+static_assert(sizeof(CalibracionBME) <= sizeof(DispositivoI2C::privado), "calibracion BME280");
+
+static uint16_t le16(const uint8_t* b) {
+  return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+static bool bmeIniciar(DispositivoI2C& d) {
+  uint8_t id;
+  if (!i2cLeerRegistros(d, BME_REG_ID, &id, 1)) return false;
+  if (id != BME_ID_BME280 && id != BME_ID_BMP280) return false;
+
+  CalibracionBME& c = *(CalibracionBME*)d.privado;
+  uint8_t tp[24];
+  if (!i2cLeerRegistros(d, BME_REG_CALIB_TP, tp, sizeof(tp))) return false;
+  c.T1 = le16(tp);      c.T2 = le16(tp + 2);  c.T3 = le16(tp + 4);
+  c.P1 = le16(tp + 6);  c.P2 = le16(tp + 8);  c.P3 = le16(tp + 10);
+  c.P4 = le16(tp + 12); c.P5 = le16(tp + 14); c.P6 = le16(tp + 16);
+  c.P7 = le16(tp + 18); c.P8 = le16(tp + 20); c.P9 = le16(tp + 22);
+
+  c.humedad = id == BME_ID_BME280;
+  if (c.humedad) {
+    uint8_t h[7];
+    if (!i2cLeerRegistros(d, BME_REG_CALIB_H1, &c.H1, 1)) return false;
+    if (!i2cLeerRegistros(d, BME_REG_CALIB_H2, h, sizeof(h))) return false;
+    c.H2 = le16(h);
+    c.H3 = h[2];
+    c.H4 = (int16_t)((int8_t)h[3] * 16 | (h[4] & 0x0F));
+    c.H5 = (int16_t)((int8_t)h[5] * 16 | (h[4] >> 4));
+    c.H6 = (int8_t)h[6];
+    // ctrl_hum solo se aplica al escribir después ctrl_meas
+    if (!i2cEscribirRegistro(d, BME_REG_CTRL_HUM, 0x01)) return false;  // Humedad x1
+  }
+  // Normal, standby 1 s, sin filtro; temperatura y presión x1
+  return i2cEscribirRegistro(d, BME_REG_CONFIG, 0xA0) && i2cEscribirRegistro(d, BME_REG_CTRL_MEAS, 0x27);
+}
+
+// Compensación entera de la hoja de datos (BME280 §4.2.3)
+static int32_t bmeTemperatura(const CalibracionBME& c, int32_t adc, int32_t& tFine) {
+  int32_t v1 = ((((adc >> 3) - ((int32_t)c.T1 << 1))) * c.T2) >> 11;
+  int32_t v2 = (((((adc >> 4) - (int32_t)c.T1) * ((adc >> 4) - (int32_t)c.T1)) >> 12) * c.T3) >> 14;
+  tFine = v1 + v2;
+  return (tFine * 5 + 128) >> 8;  // 0.01 °C
+}
+
+static uint32_t bmePresion(const CalibracionBME& c, int32_t adc, int32_t tFine) {
+  int64_t v1 = (int64_t)tFine - 128000;
+  int64_t v2 = v1 * v1 * c.P6;
+  v2 += (v1 * c.P5) << 17;
+  v2 += (int64_t)c.P4 << 35;
+  v1 = ((v1 * v1 * c.P3) >> 8) + ((v1 * c.P2) << 12);
+  v1 = ((((int64_t)1) << 47) + v1) * c.P1 >> 33;
+  if (v1 == 0) return 0;
+  int64_t p = 1048576 - adc;
+  p = (((p << 31) - v2) * 3125) / v1;
+  v1 = ((int64_t)c.P9 * (p >> 13) * (p >> 13)) >> 25;
+  v2 = ((int64_t)c.P8 * p) >> 19;
+  p = ((p + v1 + v2) >> 8) + ((int64_t)c.P7 << 4);
+  return (uint32_t)p;  // Pa en Q24.8
+}
+
+static uint32_t bmeHumedad(const CalibracionBME& c, int32_t adc, int32_t tFine) {
+  int32_t v = tFine - 76800;
+  v = (((((adc << 14) - ((int32_t)c.H4 << 20) - (c.H5 * v)) + 16384) >> 15) *
+       (((((((v * c.H6) >> 10) * (((v * (int32_t)c.H3) >> 11) + 32768)) >> 10) + 2097152) * c.H2 + 8192) >> 14));
+  v -= (((((v >> 15) * (v >> 15)) >> 7) * (int32_t)c.H1) >> 4);
+  if (v < 0) v = 0;
+  if (v > 419430400) v = 419430400;
+  return (uint32_t)(v >> 12);  // %RH en Q22.10
+}
+
+static bool bmeLeer(DispositivoI2C& d, LecturaI2C& out) {
+  const CalibracionBME& c = *(const CalibracionBME*)d.privado;
+  uint8_t b[8];
+  out.ambiente = i2cLeerRegistros(d, BME_REG_DATOS, b, c.humedad ? 8 : 6);
+  if (!out.ambiente) return false;
+
+  int32_t adcP = ((int32_t)b[0] << 12) | ((int32_t)b[1] << 4) | (b[2] >> 4);
+  int32_t adcT = ((int32_t)b[3] << 12) | ((int32_t)b[4] << 4) | (b[5] >> 4);
+  int32_t tFine;
+  out.tempC = bmeTemperatura(c, adcT, tFine) / 100.0f;
+  out.presionHpa = bmePresion(c, adcP, tFine) / 25600.0f;
+  out.humedad = c.humedad ? bmeHumedad(c, ((int32_t)b[6] << 8) | b[7], tFine) / 1024.0f : NAN;
+  return true;
+}
+
+static const DriverI2C driverBME280 = {
+  "BME280", { 0x76, 0x77 }, 400000, 1000, bmeIniciar, bmeLeer
+};
+
+// ---------------------------------------------------------
+// BH1750: iluminancia en lux
+// ---------------------------------------------------------
+#define BH1750_ENCENDER  0x01
+#define BH1750_CONTINUO  0x10   // Alta resolución (1 lx), 120 ms por medida
+
+static bool bhIniciar(DispositivoI2C& d) {
+  // Sin registro de id: basta con que acepte los dos comandos
+  uint8_t c = BH1750_ENCENDER;
+  if (!i2cEscribir(d, &c, 1)) return false;
+  c = BH1750_CONTINUO;
+  return i2cEscribir(d, &c, 1);
+}
+
+static bool bhLeer(DispositivoI2C& d, LecturaI2C& out) {
+  uint8_t b[2];
+  out.luz = i2cLeer(d, b, sizeof(b));
+  if (!out.luz) return false;
+  out.lux = ((b[0] << 8) | b[1]) / 1.2f;
+  return true;
+}
+
+static const DriverI2C driverBH1750 = {
+  "BH1750", { 0x23, 0x5C }, 400000, 1000, bhIniciar, bhLeer
+};
+
+// ---------------------------------------------------------
+// REGISTRO
+// ---------------------------------------------------------
+const DriverI2C* const driversI2C[] = { &driverSSD1306, &driverBME280, &driverBH1750 };
+const uint8_t driversI2CTotal = sizeof(driversI2C) / sizeof(driversI2C[0]);
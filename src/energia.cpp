@@ -0,0 +1,353 @@
+#include "energia.h"
+#include "ajustes.h"
+#include "net_task.h"
+#include "cloud_mode.h"
+#include "io_task.h"
+#include "bus_i2c.h"
+#include "ota.h"
+#include "autotest.h"
+#include "captura.h"
+#include "metrics.h"
+#include <WiFi.h>
+#include <esp_pm.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+#define ENERGIA_BOTONES_MAX 4
+#define ENERGIA_RAFAGA_PERIODO_MAX_MS 3000  // Más espaciadas no se prevén
+
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+typedef esp_pm_config_t ConfigPm;
+#else
+typedef esp_pm_config_esp32_t ConfigPm;
+#endif
+
+// --- ESTADO (lo cambia solo la tarea de red) ---
+static volatile bool activa = false;
+static bool dfs = false;          // esp_pm aceptó bajar la frecuencia
+static bool suenoLigero = false;  // ...y el light sleep automático
+
+// --- BOTONES ---
+static uint8_t botones[ENERGIA_BOTONES_MAX];
+static uint8_t totalBotones = 0;
+static volatile bool botonApagado[ENERGIA_BOTONES_MAX];  // Por su ISR, hasta que se suelte
+
+// --- GPS ---
+// 'rafaga' lo pone la ISR (interrupción encendida) o la tarea IO tras
+// apagarla; lo quita la tarea IO antes de volver a encenderla
+static int8_t pinUart = -1;
+static esp_pm_lock_handle_t cerrojoUart = nullptr;
+static volatile bool rafaga = false;
+static volatile uint32_t uartUltimoMs = 0;  // Último byte leído o inicio de la ráfaga
+static bool rafagaLeida = false;
+static uint32_t inicioLecturaMs = 0;
+static uint32_t finRafagaMs = 0;
+static uint32_t proximaRafagaMs = 0;  // 0: sin prever
+
+// --- CICLO DE TRABAJO (muxEnergia) ---
+static portMUX_TYPE muxEnergia = portMUX_INITIALIZER_UNLOCKED;
+static bool hayPasos = false;
+static uint32_t finPasosUs = 0;     // Fin del último paso de cualquier tarea
+static bool huecoDormible = false;  // Cómo se pasa el hueco que empieza en finPasosUs
+static bool huecoDfs = false;
+static uint64_t ocupadoUs = 0;
+static uint64_t ocioso240Us = 0;
+static uint64_t ocioso80Us = 0;
+static uint64_t suenoUs = 0;
+static uint32_t despertares = 0;
+
+// ---------------------------------------------------------
+// ENTRADA Y SALIDA
+// ---------------------------------------------------------
+static void IRAM_ATTR isrUart() {
+  // De nivel: saltaría mientras dure el bit en bajo
+  gpio_intr_disable((gpio_num_t)pinUart);
+  if (!rafaga) {
+    rafaga = true;
+    esp_pm_lock_acquire(cerrojoUart);
+  }
+  uartUltimoMs = millis();
+  tareaDespertarDesdeISR(TAREA_IO);
+}
+
+static bool corresponde() {
+  OtaEstado ota = otaEstado();
+  return ajustes.bajoConsumo && redModosActivos() == MODO_CLOUD && WiFi.isConnected() &&
+         (ota == OTA_INACTIVA || ota == OTA_FALLIDA) && !autotestEnCurso() &&
+         capturaDestino() == CAPTURA_NINGUNA;
+}
+
+static bool configurarPm(int mhzMin, bool sueno) {
+  ConfigPm cfg = {};
+  cfg.max_freq_mhz = ENERGIA_MHZ_MAX;
+  cfg.min_freq_mhz = mhzMin;
+  cfg.light_sleep_enable = sueno;
+  return esp_pm_configure(&cfg) == ESP_OK;
+}
+
+static void entrar() {
+  // Sin CONFIG_FREERTOS_USE_TICKLESS_IDLE no hay light sleep: queda DFS
+  suenoLigero = configurarPm(ENERGIA_MHZ_MIN, true);
+  dfs = suenoLigero || configurarPm(ENERGIA_MHZ_MIN, false);
+  WiFi.setSleep(WIFI_PS_MAX_MODEM);
+
+  // Antes que los pines: con la interrupción en nivel, la ISR debe apagarla
+  activa = true;
+  for (uint8_t i = 0; i < totalBotones; i++) {
+    botonApagado[i] = false;
+    gpio_wakeup_enable((gpio_num_t)botones[i], GPIO_INTR_LOW_LEVEL);
+  }
+  if (pinUart >= 0) {
+    rafaga = false;
+    proximaRafagaMs = 0;
+    attachInterrupt(pinUart, isrUart, FALLING);
+    gpio_wakeup_enable((gpio_num_t)pinUart, GPIO_INTR_LOW_LEVEL);
+  }
+  esp_sleep_enable_gpio_wakeup();
+
+  Serial.printf("Bajo consumo: %s, latencia %lu ms\n",
+                suenoLigero ? "light sleep" : dfs ? "solo DFS (sin tickless idle)" : "sin esp_pm",
+                (unsigned long)ajustes.latenciaMs);
+}
+
+static void salir() {
+  for (uint8_t i = 0; i < totalBotones; i++) {
+    gpio_num_t pin = (gpio_num_t)botones[i];
+    gpio_wakeup_disable(pin);
+    gpio_set_intr_type(pin, GPIO_INTR_NEGEDGE);  // El FALLING de la UI
+    gpio_intr_enable(pin);
+    botonApagado[i] = false;
+  }
+  if (pinUart >= 0) {
+    gpio_wakeup_disable((gpio_num_t)pinUart);
+    detachInterrupt(pinUart);
+    if (rafaga) esp_pm_lock_release(cerrojoUart);
+    rafaga = false;
+  }
+  configurarPm(ENERGIA_MHZ_MAX, false);
+  WiFi.setSleep(true);
+  activa = false;
+  dfs = suenoLigero = false;
+
+  // Las que esperan algo lejano vuelven ya a su periodo
+  for (uint8_t i = 0; i < TAREA_TOTAL; i++) tareaDespertar((TareaId)i);
+  Serial.println("Bajo consumo: fuera");
+}
+
+// ---------------------------------------------------------
+// ESPERAS
+// ---------------------------------------------------------
+// Vuelve a armar los botones ya soltados; true si alguno sigue pulsado
+static bool botonesPulsados() {
+  bool pulsado = false;
+  for (uint8_t i = 0; i < totalBotones; i++) {
+    if (!botonApagado[i]) continue;
+    if (digitalRead(botones[i]) == LOW) {
+      pulsado = true;
+      continue;
+    }
+    botonApagado[i] = false;
+    gpio_intr_enable((gpio_num_t)botones[i]);
+  }
+  return pulsado;
+}
+
+// UART callada: suelta el cerrojo, aprende el ritmo del GPS y rearma RX
+static bool rafagaTerminada(uint32_t ahora) {
+  if (ahora - uartUltimoMs < ENERGIA_RAFAGA_MS) return false;
+  if (rafagaLeida) {
+    uint32_t fin = uartUltimoMs;
+    uint32_t periodo = fin - finRafagaMs;
+    uint32_t duracion = fin - inicioLecturaMs;
+    bool previsible = finRafagaMs && periodo <= ENERGIA_RAFAGA_PERIODO_MAX_MS &&
+                      periodo > duracion + ENERGIA_RAFAGA_ANTES_MS;
+    // El primer byte que llega dormido se pierde: la siguiente se espera despierto
+    proximaRafagaMs = previsible ? fin + periodo - duracion - ENERGIA_RAFAGA_ANTES_MS : 0;
+    finRafagaMs = fin;
+  }
+  rafagaLeida = false;
+  rafaga = false;
+  esp_pm_lock_release(cerrojoUart);
+  gpio_intr_enable((gpio_num_t)pinUart);
+  return true;
+}
+
+static void adelantarRafaga(uint32_t ahora) {
+  gpio_intr_disable((gpio_num_t)pinUart);
+  proximaRafagaMs = 0;
+  uartUltimoMs = ahora;
+  rafaga = true;
+  esp_pm_lock_acquire(cerrojoUart);
+}
+
+uint32_t energiaEsperaMs(TareaId id, uint32_t periodoMs) {
+  if (!activa) return periodoMs;
+  uint32_t ahora = millis();
+  uint32_t ms;
+  uint32_t tope = ENERGIA_ESPERA_MAX_MS;
+  switch (id) {
+    case TAREA_RED:
+      ms = cloudMsHastaVentana();
+      tope = ajustes.latenciaMs;
+      break;
+    case TAREA_IO:
+      // La UART recibe: se vacía al ritmo de siempre
+      if (rafaga && !rafagaTerminada(ahora)) return periodoMs;
+      ms = ioMsHastaProximo();
+      if (proximaRafagaMs) {
+        int32_t falta = (int32_t)(proximaRafagaMs - ahora);
+        if (falta <= 0) {
+          adelantarRafaga(ahora);
+          return periodoMs;
+        }
+        ms = min(ms, (uint32_t)falta);
+      }
+      break;
+    case TAREA_I2C:
+      ms = i2cMsHastaProximo();
+      break;
+    default:
+      if (botonesPulsados()) return periodoMs;
+      ms = ENERGIA_ESPERA_MAX_MS;
+      break;
+  }
+  return max(periodoMs, min(ms, tope));
+}
+
+void IRAM_ATTR energiaBotonISR(uint8_t pin) {
+  if (!activa) return;
+  for (uint8_t i = 0; i < totalBotones; i++) {
+    if (botones[i] != pin) continue;
+    gpio_intr_disable((gpio_num_t)pin);
+    botonApagado[i] = true;
+  }
+  tareaDespertarDesdeISR(TAREA_UI);
+}
+
+void energiaUartLeida() {
+  uint32_t ahora = millis();
+  if (rafaga && !rafagaLeida) {
+    rafagaLeida = true;
+    inicioLecturaMs = ahora;
+  }
+  uartUltimoMs = ahora;
+}
+
+// ---------------------------------------------------------
+// CICLO DE TRABAJO
+// ---------------------------------------------------------
+// Con muxEnergia tomado
+static void contarHueco(uint32_t us) {
+  if (huecoDormible && us >= ENERGIA_SUENO_MIN_US) {
+    suenoUs += us - ENERGIA_DESPERTAR_US;
+    ocioso80Us += ENERGIA_DESPERTAR_US;
+    despertares++;
+  } else if (huecoDfs) {
+    ocioso80Us += us;
+  } else {
+    ocioso240Us += us;
+  }
+}
+
+void energiaContarPaso(uint32_t inicioUs, uint32_t finUs) {
+  portENTER_CRITICAL(&muxEnergia);
+  if (!hayPasos) {
+    hayPasos = true;
+    finPasosUs = inicioUs;
+  }
+  int32_t hueco = (int32_t)(inicioUs - finPasosUs);
+  if (hueco > 0) {
+    contarHueco((uint32_t)hueco);
+    finPasosUs = inicioUs;
+  }
+  // Pasos solapados (dos cores): solo lo que pasa del último fin
+  int32_t nuevo = (int32_t)(finUs - finPasosUs);
+  if (nuevo > 0) {
+    ocupadoUs += (uint32_t)nuevo;
+    finPasosUs = finUs;
+  }
+  huecoDormible = activa && suenoLigero && !rafaga;
+  huecoDfs = activa && dfs;
+  portEXIT_CRITICAL(&muxEnergia);
+}
+
+static uint32_t promedioUa(const ResumenEnergia& r, uint64_t o240, uint64_t o80) {
+  uint64_t total = r.ocupadoUs + r.ociosoUs + r.suenoUs;
+  if (!total) return 0;
+  double carga = (double)r.ocupadoUs * ENERGIA_UA_ACTIVO + (double)o240 * ENERGIA_UA_OCIOSO_240 +
+                 (double)o80 * ENERGIA_UA_OCIOSO_80 + (double)r.suenoUs * ENERGIA_UA_SUENO;
+  return (uint32_t)(carga / total);
+}
+
+// ---------------------------------------------------------
+// API PUBLICA
+// ---------------------------------------------------------
+void energiaIniciar() {
+  if (!cerrojoUart) esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "gps", &cerrojoUart);
+}
+
+void energiaBoton(uint8_t pin) {
+  if (totalBotones < ENERGIA_BOTONES_MAX) botones[totalBotones++] = pin;
+}
+
+void energiaUart(uint8_t pinRx) {
+  pinUart = (int8_t)pinRx;
+}
+
+void energiaPaso() {
+  bool quiere = corresponde();
+  if (quiere && !activa) entrar();
+  else if (!quiere && activa) salir();
+
+  ResumenEnergia r;
+  energiaResumen(r);
+  uint64_t total = r.ocupadoUs + r.ociosoUs + r.suenoUs;
+  metricaFijar(MED_ENERGIA_DESPIERTO, total ? (int32_t)((r.ocupadoUs + r.ociosoUs) * 1000 / total) : 1000);
+  metricaFijar(MED_ENERGIA_UA, (int32_t)r.promedioUa);
+}
+
+bool energiaActiva() {
+  return activa;
+}
+
+void energiaResumen(ResumenEnergia& out) {
+  portENTER_CRITICAL(&muxEnergia);
+  out.ocupadoUs = ocupadoUs;
+  out.ociosoUs = ocioso240Us + ocioso80Us;
+  out.suenoUs = suenoUs;
+  out.despertares = despertares;
+  uint64_t o240 = ocioso240Us, o80 = ocioso80Us;
+  portEXIT_CRITICAL(&muxEnergia);
+  out.activa = activa;
+  out.suenoLigero = suenoLigero;
+  out.promedioUa = promedioUa(out, o240, o80);
+}
+
+void energiaReiniciar() {
+  portENTER_CRITICAL(&muxEnergia);
+  hayPasos = false;
+  ocupadoUs = ocioso240Us = ocioso80Us = suenoUs = 0;
+  despertares = 0;
+  portEXIT_CRITICAL(&muxEnergia);
+}
+
+void energiaImprimir(Print& out) {
+  ResumenEnergia r;
+  energiaResumen(r);
+  uint64_t total = r.ocupadoUs + r.ociosoUs + r.suenoUs;
+  double s = total / 1e6;
+  double pct = total ? 100.0 / total : 0;
+
+  out.println("--- ENERGIA ---");
+  if (!r.activa) out.println(ajustes.bajoConsumo ? "Bajo consumo: en espera (solo en Cloud, sin OTA/autotest/captura)"
+                                                 : "Bajo consumo: apagado (cfg set bajo_consumo 1)");
+  else out.printf("Bajo consumo: %s\n", r.suenoLigero ? "light sleep + DFS 80-240 MHz + modem sleep"
+                                                       : "DFS 80-240 MHz + modem sleep (sin light sleep)");
+  out.printf("Latencia max: %lu ms\n", (unsigned long)ajustes.latenciaMs);
+  out.printf("Medido: %.1f s\n", s);
+  out.printf("Despierto: %.1f s (%.1f %%), ejecutando %.1f s\n", (r.ocupadoUs + r.ociosoUs) / 1e6,
+             (r.ocupadoUs + r.ociosoUs) * pct, r.ocupadoUs / 1e6);
+  out.printf("Dormido: %.1f s (%.1f %%), %lu despertares\n", r.suenoUs / 1e6, r.suenoUs * pct,
+             (unsigned long)r.despertares);
+  out.printf("Corriente media estimada: %.2f mA (solo el ESP32)\n", r.promedioUa / 1000.0);
+}
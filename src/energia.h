@@ -0,0 +1,83 @@
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include <Arduino.h>
+#include "tasks.h"
+
+/* =======================
+   BAJO CONSUMO
+   =======================
+   Con bajo_consumo = 1 y solo el modo Cloud activo (sin OTA, autotest ni
+   captura en curso) las tareas dejan de despertar cada 5-20 ms: cada una
+   duerme hasta lo próximo que tiene agendado (ventana de sensores o de
+   diagnóstico, lectura del DHT/LDR, sensor I2C) y el light sleep
+   automático de esp_pm apaga la CPU mientras ninguna tiene trabajo. La
+   frecuencia baja a 80 MHz sola (DFS) y el WiFi queda asociado en modem
+   sleep; el broker no nota nada.
+
+   Despiertan antes:
+     - un botón (nivel bajo en el pin: la ISR de la UI apaga su
+       interrupción hasta que se suelta)
+     - una ráfaga del GPS (nivel bajo en RX; hasta que la UART se calla
+       se toma un cerrojo que impide el light sleep para no perder bytes)
+     - una cola de otra tarea (tareaDespertar)
+   La tarea de red no duerme más de latencia_ms: es lo más que tarda una
+   orden MQTT en atenderse y fija el keepalive (2 latencias, 15 s mínimo).
+
+   Para el ciclo de trabajo se suman los pasos de todas las tareas (CPU
+   ejecutando) y cada hueco entre pasos se cuenta como sueño (si
+   había light sleep y duró lo bastante para entrar) u ocioso a la
+   frecuencia del momento. La corriente media sale de esos tiempos y de
+   las corrientes típicas de la hoja de datos del ESP32 (solo el módulo:
+   sin OLED, sensores ni relés). */
+
+#define ENERGIA_MHZ_MAX        240
+#define ENERGIA_MHZ_MIN        80
+#define ENERGIA_ESPERA_MAX_MS  1000   // UI, IO e I2C sin nada agendado antes
+#define ENERGIA_RAFAGA_MS      40     // UART del GPS callada: terminó la ráfaga
+#define ENERGIA_RAFAGA_ANTES_MS 20    // Se despierta antes de la próxima ráfaga prevista
+#define ENERGIA_SUENO_MIN_US   3000   // Hueco más corto en que entra el light sleep (3 ticks)
+#define ENERGIA_DESPERTAR_US   500    // Entrar y salir del light sleep (se cuenta ocioso)
+
+// Corriente típica del módulo (µA)
+#define ENERGIA_UA_ACTIVO      50000  // 240 MHz ejecutando, radio en modem sleep
+#define ENERGIA_UA_OCIOSO_240  30000
+#define ENERGIA_UA_OCIOSO_80   20000
+#define ENERGIA_UA_SUENO       800    // Light sleep con el WiFi asociado (promedio con beacons)
+
+struct ResumenEnergia {
+  bool activa;         // Bajo consumo en uso ahora
+  bool suenoLigero;    // esp_pm aceptó el light sleep (si no, solo DFS)
+  uint64_t ocupadoUs;  // Algún paso ejecutándose
+  uint64_t ociosoUs;   // Despierto sin pasos (idle de FreeRTOS)
+  uint64_t suenoUs;    // En light sleep
+  uint32_t despertares;
+  uint32_t promedioUa; // Corriente media estimada
+};
+
+// En setup(), antes de iniciarTareas()
+void energiaIniciar();
+// Pines que despiertan: botones (UI, ISR propia) y RX del GPS (IO)
+void energiaBoton(uint8_t pin);
+void energiaUart(uint8_t pinRx);
+
+// Tarea de red, en cada paso: entra o sale según ajustes y modos
+void energiaPaso();
+bool energiaActiva();
+
+// cuerpoTarea(): lo que puede dormir la tarea tras su paso (>= periodoMs)
+uint32_t energiaEsperaMs(TareaId id, uint32_t periodoMs);
+// cuerpoTarea(): un paso de cualquier tarea, en micros()
+void energiaContarPaso(uint32_t inicioUs, uint32_t finUs);
+
+// Desde las ISR de los botones (cualquiera sea el resultado del antirrebote)
+void energiaBotonISR(uint8_t pin);
+// IO: leyó bytes del GPS
+void energiaUartLeida();
+
+void energiaResumen(ResumenEnergia& out);
+void energiaReiniciar();
+// "sys energia": modo, latencia, tiempos y corriente media
+void energiaImprimir(Print& out);
+
+#endif
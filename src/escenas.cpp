@@ -0,0 +1,203 @@
+#include "escenas.h"
+#include "io_task.h"
+#include <Preferences.h>
+
+#define NVS_ESPACIO "escenas"
+#define NVS_CLAVE   "tabla"   // Toda la tabla en un blob: una escritura por cambio
+
+static const char* nombresSalida[ESCENA_SALIDAS] = { "relay1", "relay2", "relay3", "relay4", "lock" };
+
+// La escribe la tarea de red (órdenes); IO solo copia una escena al aplicarla
+static portMUX_TYPE muxEscenas = portMUX_INITIALIZER_UNLOCKED;
+static Escena tabla[ESCENAS_MAX];
+
+static void guardar() {
+  Escena copia[ESCENAS_MAX];
+  portENTER_CRITICAL(&muxEscenas);
+  memcpy(copia, tabla, sizeof(copia));
+  portEXIT_CRITICAL(&muxEscenas);
+
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, false);
+  prefs.putBytes(NVS_CLAVE, copia, sizeof(copia));
+  prefs.end();
+}
+
+void escenasIniciar() {
+  memset(tabla, 0, sizeof(tabla));
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, true);
+  // Otro tamaño = otro formato: se arranca sin escenas
+  if (prefs.getBytesLength(NVS_CLAVE) == sizeof(tabla)) prefs.getBytes(NVS_CLAVE, tabla, sizeof(tabla));
+  prefs.end();
+  for (uint8_t i = 0; i < ESCENAS_MAX; i++) tabla[i].nombre[ESCENA_NOMBRE_MAX] = '\0';
+}
+
+bool escenaObtener(uint8_t indice, Escena& out) {
+  if (indice >= ESCENAS_MAX) return false;
+  portENTER_CRITICAL(&muxEscenas);
+  out = tabla[indice];
+  portEXIT_CRITICAL(&muxEscenas);
+  return out.nombre[0] != '\0';
+}
+
+int escenaBuscar(const char* nombre) {
+  int encontrada = -1;
+  portENTER_CRITICAL(&muxEscenas);
+  for (int i = 0; i < ESCENAS_MAX && encontrada < 0; i++) {
+    if (tabla[i].nombre[0] && strcasecmp(tabla[i].nombre, nombre) == 0) encontrada = i;
+  }
+  portEXIT_CRITICAL(&muxEscenas);
+  return encontrada;
+}
+
+// ---------------------------------------------------------
+// ÓRDENES
+// ---------------------------------------------------------
+// "relay2=on" -> bit 1 en mascara (y en valores si es on)
+static bool leerSalida(const char* palabra, Escena& e) {
+  const char* igual = strchr(palabra, '=');
+  if (!igual) return false;
+  size_t largo = igual - palabra;
+  for (uint8_t s = 0; s < ESCENA_SALIDAS; s++) {
+    if (strlen(nombresSalida[s]) != largo || strncasecmp(palabra, nombresSalida[s], largo) != 0) continue;
+    const char* v = igual + 1;
+    bool on = strcasecmp(v, "on") == 0 || strcmp(v, "1") == 0;
+    if (!on && strcasecmp(v, "off") != 0 && strcmp(v, "0") != 0) return false;
+    e.mascara |= (1 << s);
+    if (on) e.valores |= (1 << s);
+    else e.valores &= ~(1 << s);
+    return true;
+  }
+  return false;
+}
+
+static bool nombreValido(const char* nombre) {
+  size_t n = strlen(nombre);
+  if (n == 0 || n > ESCENA_NOMBRE_MAX) return false;
+  for (size_t i = 0; i < n; i++) {
+    if (!isalnum((unsigned char)nombre[i]) && nombre[i] != '_' && nombre[i] != '-') return false;
+  }
+  return true;
+}
+
+static bool guardarEscena(char* resto, char* resp, size_t cap) {
+  char* ctx = nullptr;
+  char* nombre = strtok_r(resto, " ", &ctx);
+  if (!nombre || !nombreValido(nombre)) {
+    snprintf(resp, cap, "Error: nombre de 1 a %d caracteres a-z 0-9 _ -", ESCENA_NOMBRE_MAX);
+    return false;
+  }
+
+  Escena e = {};
+  strlcpy(e.nombre, nombre, sizeof(e.nombre));
+  for (char* p = strtok_r(nullptr, " ", &ctx); p; p = strtok_r(nullptr, " ", &ctx)) {
+    if (!leerSalida(p, e)) {
+      snprintf(resp, cap, "Error: '%s' (use relay1..relay4|lock=on|off)", p);
+      return false;
+    }
+  }
+  // Sin salidas: foto de las cinco como están ahora
+  if (!e.mascara) {
+    EstadoActuadores act;
+    ioObtenerActuadores(act);
+    e.mascara = (1 << ESCENA_SALIDAS) - 1;
+    for (uint8_t r = 0; r < 4; r++) {
+      if (act.relays[r]) e.valores |= (1 << r);
+    }
+    if (act.lockAbierto) e.valores |= (1 << ACT_LOCK);
+  }
+
+  int libre = -1;
+  portENTER_CRITICAL(&muxEscenas);
+  for (int i = 0; i < ESCENAS_MAX; i++) {
+    if (tabla[i].nombre[0] && strcasecmp(tabla[i].nombre, e.nombre) == 0) {
+      libre = i;
+      break;
+    }
+    if (!tabla[i].nombre[0] && libre < 0) libre = i;
+  }
+  if (libre >= 0) tabla[libre] = e;
+  portEXIT_CRITICAL(&muxEscenas);
+
+  if (libre < 0) {
+    snprintf(resp, cap, "Error: maximo %d escenas", ESCENAS_MAX);
+    return false;
+  }
+  guardar();
+  snprintf(resp, cap, "OK: escena %s", e.nombre);
+  return true;
+}
+
+bool escenasComando(const char* linea, OrigenComando origen, char* resp, size_t cap) {
+  char copia[96];
+  strlcpy(copia, linea, sizeof(copia));
+  char* ctx = nullptr;
+  char* orden = strtok_r(copia, " ", &ctx);
+  char* resto = ctx;
+
+  if (!orden) {
+    snprintf(resp, cap, "Error: save|run|del|clear");
+    return false;
+  }
+  if (strcasecmp(orden, "save") == 0) return guardarEscena(resto ? resto : (char*)"", resp, cap);
+
+  if (strcasecmp(orden, "clear") == 0) {
+    portENTER_CRITICAL(&muxEscenas);
+    memset(tabla, 0, sizeof(tabla));
+    portEXIT_CRITICAL(&muxEscenas);
+    guardar();
+    snprintf(resp, cap, "OK: escenas borradas");
+    return true;
+  }
+
+  if (strcasecmp(orden, "run") != 0 && strcasecmp(orden, "del") != 0) {
+    snprintf(resp, cap, "Error: orden desconocida '%s'", orden);
+    return false;
+  }
+
+  char* nombre = strtok_r(nullptr, " ", &ctx);
+  int i = nombre ? escenaBuscar(nombre) : -1;
+  Escena e;
+  if (i < 0 || !escenaObtener(i, e)) {
+    snprintf(resp, cap, "Error: escena '%s' no existe", nombre ? nombre : "");
+    return false;
+  }
+
+  if (strcasecmp(orden, "run") == 0) {
+    ComandoIO cmd = { CMD_IO_ESCENA, ACT_TOTAL, origen, (int16_t)i };
+    if (!ioEnviarComando(cmd)) {
+      snprintf(resp, cap, "Error: cola IO llena");
+      return false;
+    }
+    snprintf(resp, cap, "OK: escena %s", e.nombre);
+    return true;
+  }
+  portENTER_CRITICAL(&muxEscenas);
+  tabla[i].nombre[0] = '\0';
+  portEXIT_CRITICAL(&muxEscenas);
+  guardar();
+  snprintf(resp, cap, "OK: escena %s borrada", e.nombre);
+  return true;
+}
+
+void escenasImprimir(Print& out) {
+  EstadoActuadores act;
+  ioObtenerActuadores(act);
+  out.println("--- ESCENAS ---");
+  bool alguna = false;
+  for (uint8_t i = 0; i < ESCENAS_MAX; i++) {
+    Escena e;
+    if (!escenaObtener(i, e)) continue;
+    alguna = true;
+    out.printf("%-12s", e.nombre);
+    for (uint8_t s = 0; s < ESCENA_SALIDAS; s++) {
+      if (e.mascara & (1 << s)) out.printf(" %s=%s", nombresSalida[s], (e.valores & (1 << s)) ? "on" : "off");
+    }
+    out.println();
+  }
+  if (!alguna) out.println("Sin escenas");
+  if (act.escena[0]) {
+    out.printf("Ultima: %s, sesgo entre salidas %lu ns\n", act.escena, (unsigned long)act.escenaSesgoNs);
+  }
+}
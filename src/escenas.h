@@ -0,0 +1,42 @@
+#ifndef ESCENAS_H
+#define ESCENAS_H
+
+#include <Arduino.h>
+#include "messages.h"
+
+/* =======================
+   ESCENAS
+   =======================
+   Un estado de relés y cerradura con nombre ("noche": 1 y 2 encendidos,
+   3 y 4 apagados, cerradura cerrada). La tarea IO la aplica con dos
+   escrituras de registro (GPIO_OUT_W1TS y GPIO_OUT_W1TC): todas las
+   salidas cambian en el mismo ciclo de bus y no de a una por mensaje.
+
+     save <nombre> [relay1=on relay3=off lock=on ...]   (sin salidas: las actuales)
+     run <nombre> | del <nombre> | clear
+
+   Cada escena indica qué salidas toca (mascara) y cómo las deja
+   (valores); las demás quedan como estén. Bit 0..3: relés, bit 4: cerradura. */
+
+#define ESCENAS_MAX        8
+#define ESCENA_SALIDAS     5     // Relés 1-4 y cerradura (ActuadorId 0..4)
+
+struct Escena {
+  char nombre[ESCENA_NOMBRE_MAX + 1];  // "" = hueco libre
+  uint8_t mascara;
+  uint8_t valores;
+};
+
+void escenasIniciar();   // Carga de NVS (en iniciarIO)
+
+// Copia de la escena 'indice'; false si el hueco está libre
+bool escenaObtener(uint8_t indice, Escena& out);
+int escenaBuscar(const char* nombre);   // Índice o -1
+
+// Órdenes de "scene" (WebSerial) y orion/<id>/scenes/set (MQTT).
+// "run" encola la escena en IO. Deja la respuesta en 'resp'.
+bool escenasComando(const char* linea, OrigenComando origen, char* resp, size_t cap);
+
+void escenasImprimir(Print& out);
+
+#endif
@@ -0,0 +1,423 @@
+#include "historial.h"
+
+#define PERIODO_S (HISTORIAL_PERIODO_MS / 1000)
+#define BLOQUE_BITS (HISTORIAL_BLOQUE_BYTES * 8)
+
+struct Bloque {
+  uint8_t serie;      // SERIE_TOTAL = libre
+  uint16_t n;
+  uint16_t bits;
+  uint32_t s0;        // Primer punto, entero
+  int32_t v0;
+  uint8_t datos[HISTORIAL_BLOQUE_BYTES];
+};
+
+// Bloque abierto de cada serie y estado del codificador
+struct Escritor {
+  int8_t bloque;      // -1 = ninguno
+  uint32_t s;
+  int32_t delta;
+  int32_t v;
+};
+
+// Media del minuto en curso (solo tarea IO)
+struct Acumulador {
+  int64_t suma;
+  uint16_t n;
+};
+
+static const char* const NOMBRES[SERIE_TOTAL] = { "temp", "hum", "luz", "sats", "lat", "lng" };
+static const int32_t ESCALAS[SERIE_TOTAL] = { 10, 10, 10, 1, 100000, 100000 };
+
+// Anchos tras los prefijos '10', '110', '1110' y '1111'
+static const uint8_t ANCHOS_TIEMPO[4] = { 7, 9, 12, 32 };
+static const uint8_t ANCHOS_VALOR[4] = { 4, 8, 16, 32 };
+
+// --- POOL (protegido por mutex) ---
+static SemaphoreHandle_t mutexHistorial = nullptr;
+static Bloque pool[HISTORIAL_BLOQUES];
+static Escritor escritores[SERIE_TOTAL];
+static volatile uint32_t secuencia = 0;
+
+// --- MINUTO EN CURSO (solo tarea IO) ---
+static Acumulador acumuladores[SERIE_TOTAL];
+static uint32_t inicioMinutoMs = 0;
+
+// ---------------------------------------------------------
+// BITS
+// ---------------------------------------------------------
+static void escribirBits(uint8_t* datos, uint16_t& pos, uint32_t valor, uint8_t n) {
+  while (n--) {
+    if ((valor >> n) & 1) datos[pos >> 3] |= 0x80 >> (pos & 7);
+    else datos[pos >> 3] &= ~(0x80 >> (pos & 7));
+    pos++;
+  }
+}
+
+static uint32_t leerBits(const uint8_t* datos, uint16_t& pos, uint8_t n) {
+  uint32_t valor = 0;
+  while (n--) {
+    valor = (valor << 1) | ((datos[pos >> 3] >> (7 - (pos & 7))) & 1);
+    pos++;
+  }
+  return valor;
+}
+
+static uint32_t zigzag(int32_t v) {
+  return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t desZigzag(uint32_t u) {
+  return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+// '0' si es cero; si no, el prefijo más corto cuyo ancho lo admite
+static uint8_t bitsCodigo(int32_t v, const uint8_t anchos[4]) {
+  if (v == 0) return 1;
+  uint32_t u = zigzag(v);
+  for (uint8_t i = 0; i < 3; i++) {
+    if (u < (1UL << anchos[i])) return i + 2 + anchos[i];
+  }
+  return 4 + anchos[3];
+}
+
+static void escribirCodigo(uint8_t* datos, uint16_t& pos, int32_t v, const uint8_t anchos[4]) {
+  if (v == 0) {
+    escribirBits(datos, pos, 0, 1);
+    return;
+  }
+  uint32_t u = zigzag(v);
+  uint8_t i = 0;
+  while (i < 3 && u >= (1UL << anchos[i])) i++;
+  // i unos y un cero de cierre; el último prefijo ('1111') no lleva cero
+  escribirBits(datos, pos, 1, 1);
+  for (uint8_t k = 0; k < i; k++) escribirBits(datos, pos, 1, 1);
+  if (i < 3) escribirBits(datos, pos, 0, 1);
+  escribirBits(datos, pos, u, anchos[i]);
+}
+
+static int32_t leerCodigo(const uint8_t* datos, uint16_t& pos, const uint8_t anchos[4]) {
+  if (!leerBits(datos, pos, 1)) return 0;
+  uint8_t i = 0;
+  while (i < 3 && leerBits(datos, pos, 1)) i++;
+  return desZigzag(leerBits(datos, pos, anchos[i]));
+}
+
+// ---------------------------------------------------------
+// ESCRITURA
+// ---------------------------------------------------------
+static bool esAbierto(int8_t b) {
+  for (uint8_t s = 0; s < SERIE_TOTAL; s++) {
+    if (escritores[s].bloque == b) return true;
+  }
+  return false;
+}
+
+// Uno libre o, si no queda, el cerrado más antiguo de cualquier serie
+static int8_t bloqueNuevo() {
+  int8_t elegido = -1;
+  for (int8_t b = 0; b < HISTORIAL_BLOQUES; b++) {
+    if (pool[b].serie == SERIE_TOTAL) return b;
+    if (esAbierto(b)) continue;
+    if (elegido < 0 || (int32_t)(pool[b].s0 - pool[elegido].s0) < 0) elegido = b;
+  }
+  return elegido;
+}
+
+static void agregar(SerieId serie, uint32_t s, int32_t v) {
+  Escritor& e = escritores[serie];
+
+  if (e.bloque >= 0) {
+    Bloque& b = pool[e.bloque];
+    int32_t delta = (int32_t)(s - e.s);
+    int32_t dod = delta - e.delta;
+    int32_t dv = v - e.v;
+    if (b.bits + bitsCodigo(dod, ANCHOS_TIEMPO) + bitsCodigo(dv, ANCHOS_VALOR) <= BLOQUE_BITS) {
+      escribirCodigo(b.datos, b.bits, dod, ANCHOS_TIEMPO);
+      escribirCodigo(b.datos, b.bits, dv, ANCHOS_VALOR);
+      b.n++;
+      e.s = s;
+      e.delta = delta;
+      e.v = v;
+      return;
+    }
+  }
+
+  e.bloque = -1;  // El lleno deja de estar abierto y puede reciclarse
+  int8_t nuevo = bloqueNuevo();
+  Bloque& b = pool[nuevo];
+  b.serie = serie;
+  b.n = 1;
+  b.bits = 0;
+  b.s0 = s;
+  b.v0 = v;
+  e.bloque = nuevo;
+  e.s = s;
+  e.delta = PERIODO_S;  // Un minuto puntual cuesta 1 bit desde el segundo punto
+  e.v = v;
+}
+
+void historialIniciar() {
+  if (!mutexHistorial) mutexHistorial = xSemaphoreCreateMutex();
+  for (uint8_t b = 0; b < HISTORIAL_BLOQUES; b++) pool[b].serie = SERIE_TOTAL;
+  for (uint8_t s = 0; s < SERIE_TOTAL; s++) {
+    escritores[s].bloque = -1;
+    acumuladores[s] = { 0, 0 };
+  }
+  inicioMinutoMs = millis();
+  secuencia = 0;
+}
+
+void historialMuestra(SerieId serie, int32_t valor) {
+  if (serie >= SERIE_TOTAL) return;
+  acumuladores[serie].suma += valor;
+  acumuladores[serie].n++;
+}
+
+void historialPaso(uint32_t ahoraMs) {
+  if (ahoraMs - inicioMinutoMs < HISTORIAL_PERIODO_MS) return;
+
+  // Una consulta larga tiene el mutex: se reintenta en el siguiente paso
+  // con la misma marca de tiempo
+  if (xSemaphoreTake(mutexHistorial, 0) != pdTRUE) return;
+
+  inicioMinutoMs += HISTORIAL_PERIODO_MS;
+  if (ahoraMs - inicioMinutoMs >= HISTORIAL_PERIODO_MS) inicioMinutoMs = ahoraMs;  // IO detenido
+  uint32_t s = inicioMinutoMs / 1000;
+
+  for (uint8_t i = 0; i < SERIE_TOTAL; i++) {
+    Acumulador& a = acumuladores[i];
+    if (!a.n) continue;  // Sin lecturas válidas: queda un hueco en el tiempo
+    int64_t media = a.suma >= 0 ? (a.suma + a.n / 2) / a.n : (a.suma - a.n / 2) / a.n;
+    agregar((SerieId)i, s, (int32_t)media);
+    a = { 0, 0 };
+  }
+  secuencia++;
+  xSemaphoreGive(mutexHistorial);
+}
+
+// ---------------------------------------------------------
+// LECTURA
+// ---------------------------------------------------------
+// Recorre los puntos de la serie en orden de tiempo. Con el mutex tomado.
+template <typename F>
+static void recorrer(SerieId serie, uint32_t desdeS, F visitar) {
+  int8_t orden[HISTORIAL_BLOQUES];
+  uint8_t n = 0;
+  for (int8_t b = 0; b < HISTORIAL_BLOQUES; b++) {
+    if (pool[b].serie != serie) continue;
+    uint8_t i = n++;
+    while (i > 0 && (int32_t)(pool[orden[i - 1]].s0 - pool[b].s0) > 0) {
+      orden[i] = orden[i - 1];
+      i--;
+    }
+    orden[i] = b;
+  }
+
+  for (uint8_t k = 0; k < n; k++) {
+    const Bloque& b = pool[orden[k]];
+    // Si el siguiente ya empieza antes de 'desde', este queda entero fuera
+    if (k + 1 < n && (int32_t)(pool[orden[k + 1]].s0 - desdeS) <= 0) continue;
+
+    uint32_t s = b.s0;
+    int32_t v = b.v0;
+    int32_t delta = PERIODO_S;
+    uint16_t pos = 0;
+    for (uint16_t i = 0; i < b.n; i++) {
+      if (i > 0) {
+        delta += leerCodigo(b.datos, pos, ANCHOS_TIEMPO);
+        s += delta;
+        v += leerCodigo(b.datos, pos, ANCHOS_VALOR);
+      }
+      if ((int32_t)(s - desdeS) >= 0) visitar(s, v);
+    }
+  }
+}
+
+const char* historialNombre(SerieId serie) {
+  return serie < SERIE_TOTAL ? NOMBRES[serie] : "";
+}
+
+int32_t historialEscala(SerieId serie) {
+  return serie < SERIE_TOTAL ? ESCALAS[serie] : 1;
+}
+
+SerieId historialSerie(const char* nombre) {
+  for (uint8_t i = 0; i < SERIE_TOTAL; i++) {
+    if (strcasecmp(nombre, NOMBRES[i]) == 0) return (SerieId)i;
+  }
+  return SERIE_TOTAL;
+}
+
+uint32_t historialRango(const char* texto) {
+  char* fin;
+  unsigned long n = strtoul(texto, &fin, 10);
+  if (fin == texto) return 0;
+  switch (tolower(*fin)) {
+    case 's': return n;
+    case 'm': return n * 60;
+    case 'h': return n * 3600;
+    case 'd': return n * 86400;
+    default: return *fin ? 0 : n;
+  }
+}
+
+size_t historialLeer(SerieId serie, uint32_t desdeS, PuntoHistorial* out, size_t max) {
+  if (serie >= SERIE_TOTAL || !max) return 0;
+  size_t n = 0;
+  xSemaphoreTake(mutexHistorial, portMAX_DELAY);
+  recorrer(serie, desdeS, [&](uint32_t s, int32_t v) {
+    if (n < max) out[n++] = { s, v };
+  });
+  xSemaphoreGive(mutexHistorial);
+  return n;
+}
+
+void historialConsultar(SerieId serie, uint32_t rangoS, TramoHistorial* out, size_t tramos) {
+  for (size_t i = 0; i < tramos; i++) out[i] = { 0, 0, 0, 0 };
+  if (serie >= SERIE_TOTAL || !tramos || !rangoS) return;
+
+  // Tramos de (inicio, ahora]; los puntos llegan ordenados, así que basta
+  // un acumulador para el tramo en curso
+  uint32_t ahora = millis() / 1000;
+  int64_t inicio = (int64_t)ahora - rangoS;
+  uint32_t desde = inicio < 0 ? 0 : (uint32_t)inicio + 1;
+  size_t actual = tramos;
+  int64_t suma = 0;
+
+  xSemaphoreTake(mutexHistorial, portMAX_DELAY);
+  recorrer(serie, desde, [&](uint32_t s, int32_t v) {
+    uint64_t i = (uint64_t)(s - inicio - 1) * tramos / rangoS;
+    if (i >= tramos) return;
+    if (i != actual) {
+      if (actual < tramos) out[actual].media = (int32_t)(suma / out[actual].n);
+      actual = i;
+      suma = 0;
+      out[i].min = out[i].max = v;
+    }
+    TramoHistorial& t = out[i];
+    t.min = min(t.min, v);
+    t.max = max(t.max, v);
+    t.n++;
+    suma += v;
+  });
+  xSemaphoreGive(mutexHistorial);
+  if (actual < tramos) out[actual].media = (int32_t)(suma / out[actual].n);
+}
+
+// ---------------------------------------------------------
+// SALIDA
+// ---------------------------------------------------------
+static void imprimirValor(Print& out, SerieId serie, int32_t v) {
+  int32_t escala = ESCALAS[serie];
+  uint8_t decimales = escala >= 100000 ? 5 : escala >= 10 ? 1 : 0;
+  out.print((double)v / escala, decimales);
+}
+
+void historialImprimir(Print& out, SerieId serie, uint32_t rangoS, size_t tramos) {
+  if (serie >= SERIE_TOTAL) {
+    uint32_t ahora = millis() / 1000;
+    out.printf("Historial: %lu de %u bytes\n", (unsigned long)historialBytesUsados(), (unsigned)sizeof(pool));
+    for (uint8_t i = 0; i < SERIE_TOTAL; i++) {
+      EstadisticaSerie est;
+      historialEstadistica((SerieId)i, est);
+      if (!est.puntos) {
+        out.printf("%s: sin datos\n", NOMBRES[i]);
+        continue;
+      }
+      out.printf("%s: %lu puntos desde hace %lu min, %.1f bits/punto (%u bloques)\n", NOMBRES[i],
+                 (unsigned long)est.puntos, (unsigned long)((ahora - est.desdeS) / 60),
+                 (double)est.bits / est.puntos, est.bloques);
+    }
+    return;
+  }
+
+  static TramoHistorial buf[HISTORIAL_TRAMOS_MAX];
+  tramos = constrain(tramos, (size_t)1, (size_t)HISTORIAL_TRAMOS_MAX);
+  historialConsultar(serie, rangoS, buf, tramos);
+  uint32_t paso = rangoS / tramos;
+  out.printf("%s, %lu tramos de %lu s (min / media / max):\n", NOMBRES[serie], (unsigned long)tramos, (unsigned long)paso);
+  for (size_t i = 0; i < tramos; i++) {
+    out.printf("hace %lu min: ", (unsigned long)((rangoS - i * paso) / 60));
+    if (!buf[i].n) {
+      out.println("-");
+      continue;
+    }
+    imprimirValor(out, serie, buf[i].min);
+    out.print(" / ");
+    imprimirValor(out, serie, buf[i].media);
+    out.print(" / ");
+    imprimirValor(out, serie, buf[i].max);
+    out.println();
+  }
+}
+
+void historialJson(Print& out, SerieId serie, uint32_t rangoS, size_t tramos) {
+  uint32_t ahora = millis() / 1000;
+  out.printf("{\"campo\":\"%s\",\"escala\":%ld,\"rango_s\":%lu,\"ahora_s\":%lu", NOMBRES[serie],
+             (long)ESCALAS[serie], (unsigned long)rangoS, (unsigned long)ahora);
+
+  // Crudos: se escriben al decodificar, sin copia intermedia
+  if (!tramos) {
+    uint32_t desde = ahora > rangoS ? ahora - rangoS + 1 : 0;
+    bool primero = true;
+    out.print(",\"puntos\":[");
+    xSemaphoreTake(mutexHistorial, portMAX_DELAY);
+    recorrer(serie, desde, [&](uint32_t s, int32_t v) {
+      out.printf("%s[%lu,%ld]", primero ? "" : ",", (unsigned long)(ahora - s), (long)v);
+      primero = false;
+    });
+    xSemaphoreGive(mutexHistorial);
+    out.print("]}");
+    return;
+  }
+
+  static TramoHistorial buf[HISTORIAL_TRAMOS_MAX];
+  tramos = min(tramos, (size_t)HISTORIAL_TRAMOS_MAX);
+  historialConsultar(serie, rangoS, buf, tramos);
+  out.printf(",\"tramo_s\":%lu", (unsigned long)(rangoS / tramos));
+
+  static const char* const CAMPOS[4] = { "min", "media", "max", "n" };
+  for (uint8_t c = 0; c < 4; c++) {
+    out.printf(",\"%s\":[", CAMPOS[c]);
+    for (size_t i = 0; i < tramos; i++) {
+      if (i) out.print(',');
+      const TramoHistorial& t = buf[i];
+      if (c == 3) out.print(t.n);
+      else if (!t.n) out.print("null");
+      else out.print(c == 0 ? t.min : c == 1 ? t.media : t.max);
+    }
+    out.print(']');
+  }
+  out.print('}');
+}
+
+void historialEstadistica(SerieId serie, EstadisticaSerie& out) {
+  out = { 0, 0, 0, 0 };
+  bool primero = true;
+  xSemaphoreTake(mutexHistorial, portMAX_DELAY);
+  for (uint8_t b = 0; b < HISTORIAL_BLOQUES; b++) {
+    if (pool[b].serie != serie) continue;
+    out.puntos += pool[b].n;
+    out.bits += pool[b].bits;
+    out.bloques++;
+    if (primero || (int32_t)(pool[b].s0 - out.desdeS) < 0) out.desdeS = pool[b].s0;
+    primero = false;
+  }
+  xSemaphoreGive(mutexHistorial);
+}
+
+uint32_t historialBytesUsados() {
+  uint32_t bytes = 0;
+  xSemaphoreTake(mutexHistorial, portMAX_DELAY);
+  for (uint8_t b = 0; b < HISTORIAL_BLOQUES; b++) {
+    // Cabecera + flujo ocupado
+    if (pool[b].serie != SERIE_TOTAL) bytes += sizeof(Bloque) - HISTORIAL_BLOQUE_BYTES + (pool[b].bits + 7) / 8;
+  }
+  xSemaphoreGive(mutexHistorial);
+  return bytes;
+}
+
+uint32_t historialSecuencia() {
+  return secuencia;
+}
@@ -0,0 +1,92 @@
+#ifndef HISTORIAL_H
+#define HISTORIAL_H
+
+#include <Arduino.h>
+
+/* =======================
+   HISTORIAL DE SENSORES
+   =======================
+   Serie temporal comprimida en RAM, un punto por minuto y serie. Cada
+   bloque guarda el primer punto entero y el resto en un flujo de bits
+   estilo Gorilla: delta-de-delta del tiempo (un minuto puntual = 1 bit)
+   y delta del valor en zigzag con prefijos de longitud variable (sin
+   cambio = 1 bit). Los valores son enteros escalados, así que el XOR
+   de Gorilla (pensado para double) no aporta nada sobre el delta.
+
+   Los bloques salen de un pool común: cuando se llena se recicla el
+   bloque cerrado más antiguo de cualquier serie, de modo que todas
+   conservan más o menos la misma ventana. Un día de temperatura con
+   ruido de ±0.2 °C ocupa ~1.3 KB; una serie quieta, ~400 B.
+
+   historialMuestra()/historialPaso() solo desde la tarea IO; las
+   consultas, desde cualquier tarea (mutex: decodifican fuera de IO). */
+
+#define HISTORIAL_PERIODO_MS   60000   // Un punto por minuto
+#define HISTORIAL_BLOQUE_BYTES 128     // Flujo de bits por bloque
+#define HISTORIAL_BLOQUES      56      // Pool común (~7 KB)
+#define HISTORIAL_TRAMOS_MAX   120     // Por consulta reducida
+
+enum SerieId : uint8_t {
+  SERIE_TEMP,   // °C x10
+  SERIE_HUM,    // % x10
+  SERIE_LUZ,    // % x10
+  SERIE_SATS,
+  SERIE_LAT,    // 1e-5 grados
+  SERIE_LNG,
+  SERIE_TOTAL
+};
+
+// Punto decodificado: segundos desde el arranque y valor escalado
+struct PuntoHistorial {
+  uint32_t s;
+  int32_t v;
+};
+
+// Un tramo de una consulta reducida (n = 0: sin datos en el tramo)
+struct TramoHistorial {
+  int32_t min;
+  int32_t max;
+  int32_t media;
+  uint16_t n;
+};
+
+struct EstadisticaSerie {
+  uint32_t puntos;     // Puntos que conserva
+  uint32_t bits;       // Bits que ocupan
+  uint8_t bloques;
+  uint32_t desdeS;     // Punto más antiguo (s desde el arranque)
+};
+
+void historialIniciar();
+
+// Acumula una muestra del minuto en curso (se guarda la media)
+void historialMuestra(SerieId serie, int32_t valor);
+// Cierra el minuto cuando toca
+void historialPaso(uint32_t ahoraMs);
+
+// Nombre corto ("temp", "hum", "luz", "sats", "lat", "lng") y escala del valor
+const char* historialNombre(SerieId serie);
+int32_t historialEscala(SerieId serie);
+SerieId historialSerie(const char* nombre);   // SERIE_TOTAL si no existe
+
+// "90s", "30m", "6h", "1d" -> segundos (0 si no se entiende)
+uint32_t historialRango(const char* texto);
+
+// Puntos crudos con s >= desdeS, del más antiguo al más nuevo
+size_t historialLeer(SerieId serie, uint32_t desdeS, PuntoHistorial* out, size_t max);
+
+// Los últimos 'rangoS' segundos en 'tramos' partes iguales (la última acaba ahora)
+void historialConsultar(SerieId serie, uint32_t rangoS, TramoHistorial* out, size_t tramos);
+
+// Consola: SERIE_TOTAL imprime el uso de cada serie; si no, la consulta por tramos
+void historialImprimir(Print& out, SerieId serie, uint32_t rangoS, size_t tramos);
+// /history.json: min/media/max por tramo, o los puntos crudos con tramos = 0
+void historialJson(Print& out, SerieId serie, uint32_t rangoS, size_t tramos);
+
+void historialEstadistica(SerieId serie, EstadisticaSerie& out);
+uint32_t historialBytesUsados();
+
+// Sube con cada minuto cerrado (para redibujar)
+uint32_t historialSecuencia();
+
+#endif
@@ -0,0 +1,75 @@
+#include "identidad.h"
+#include <Preferences.h>
+
+#define NVS_ESPACIO "orion"
+
+// Se escribe en setup o desde la consola ("sys id", AsyncTCP) mientras la
+// tarea de red lo copia: el spinlock cubre el id a medio escribir
+static char id[IDENTIDAD_MAX + 1];
+static bool deFabrica = true;
+static portMUX_TYPE muxIdentidad = portMUX_INITIALIZER_UNLOCKED;
+static volatile uint32_t secuencia = 0;
+
+// Bytes de la MAC en el orden en que se imprimen (el byte 0 es el menos significativo)
+static void idDeMac(char* buf) {
+  uint64_t mac = ESP.getEfuseMac();
+  for (int i = 0; i < 6; i++) {
+    snprintf(buf + i * 2, 3, "%02x", (unsigned)((mac >> (8 * i)) & 0xFF));
+  }
+}
+
+static bool valido(const char* texto) {
+  size_t n = strlen(texto);
+  if (n == 0 || n > IDENTIDAD_MAX) return false;
+  for (size_t i = 0; i < n; i++) {
+    char c = texto[i];
+    if (!((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '-')) return false;
+  }
+  return true;
+}
+
+void identidadIniciar() {
+  char guardado[IDENTIDAD_MAX + 1] = "";
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, true);
+  prefs.getString("id", guardado, sizeof(guardado));
+  prefs.end();
+
+  deFabrica = !valido(guardado);
+  if (deFabrica) idDeMac(id);
+  else strlcpy(id, guardado, sizeof(id));
+}
+
+void identidadCopiar(char* buf, size_t cap) {
+  portENTER_CRITICAL(&muxIdentidad);
+  strlcpy(buf, id, cap);
+  portEXIT_CRITICAL(&muxIdentidad);
+}
+
+uint32_t identidadSecuencia() {
+  return secuencia;
+}
+
+bool identidadDeFabrica() {
+  return deFabrica;
+}
+
+bool identidadFijar(const char* nuevo) {
+  if (nuevo[0] && !valido(nuevo)) return false;
+
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, false);
+  if (nuevo[0]) prefs.putString("id", nuevo);
+  else prefs.remove("id");
+  prefs.end();
+
+  char copia[IDENTIDAD_MAX + 1];
+  if (nuevo[0]) strlcpy(copia, nuevo, sizeof(copia));
+  else idDeMac(copia);
+  portENTER_CRITICAL(&muxIdentidad);
+  strlcpy(id, copia, sizeof(id));
+  deFabrica = !nuevo[0];
+  secuencia++;
+  portEXIT_CRITICAL(&muxIdentidad);
+  return true;
+}
@@ -0,0 +1,33 @@
+#ifndef IDENTIDAD_H
+#define IDENTIDAD_H
+
+#include <Arduino.h>
+
+/* =======================
+   IDENTIDAD DE LA PLACA
+   =======================
+   Nombre único con el que la placa aparece en el broker, en Home
+   Assistant y en InfluxDB. Por defecto son los 12 dígitos hex de la MAC
+   de fábrica (eFuse); "sys id <nombre>" lo cambia y queda en NVS.
+
+   Todos los tópicos cuelgan de "orion/<id>/", así cientos de placas
+   comparten broker sin pisarse y cada una se suscribe con un solo
+   filtro: "orion/<id>/+/set".
+
+   identidadFijar() (consola, contexto AsyncTCP) cambia el id y sube
+   identidadSecuencia(); la tarea de red lo compara en su paso y, con
+   sesión abierta, reconecta con los tópicos nuevos (también en Híbrido,
+   donde no hay una próxima entrada a Cloud). */
+
+#define IDENTIDAD_MAX 24   // Caracteres del id (sin el terminador)
+
+void identidadIniciar();     // Lee NVS o la MAC (en setup, antes de las tareas)
+void identidadCopiar(char* buf, size_t cap);  // Id vigente (desde cualquier tarea)
+uint32_t identidadSecuencia();                // Sube con cada identidadFijar()
+
+// [a-z0-9_-], hasta IDENTIDAD_MAX. "" vuelve al id de la MAC.
+// false si no es válido (no toca nada).
+bool identidadFijar(const char* id);
+bool identidadDeFabrica();   // true si el id sale de la MAC
+
+#endif
@@ -0,0 +1,390 @@
+#include "io_task.h"
+#include "metrics.h"
+#include "captura.h"
+#include "trayecto.h"
+#include "historial.h"
+#include "reglas.h"
+#include "escenas.h"
+#include "reloj.h"
+#include "ajustes.h"
+#include "energia.h"
+#include "tasks.h"
+#include <Arduino.h>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+
+// Hardware Libraries
+#include <DHT11.h>
+#include <LDR_10K.h>
+#include <TinyGPS++.h>
+#include <ESP32Servo.h>
+
+// --- DEFINICIÓN DE HARDWARE ---
+// Única tarea que toca relés, cerradura, servos y sensores.
+#define PIN_RELAY_1 26
+#define PIN_RELAY_2 27
+#define PIN_RELAY_3 14
+#define PIN_RELAY_4 12
+#define PIN_LOCK    13
+
+#define PIN_DHT     23
+#define PIN_LDR     34
+#define PIN_GPS_RX  16
+#define PIN_GPS_TX  17
+
+#define PIN_SERVO_1 15
+#define PIN_SERVO_2 2
+#define PIN_SERVO_3 4
+
+// --- MUESTREO ---
+#define IO_PERIODO_DHT_MS 2000  // El DHT11 no admite menos de ~1s entre lecturas
+#define IO_PERIODO_LDR_MS 500
+#define GPS_RX_BUFFER     1024  // Margen para pasos lentos (DHT) a 9600 baudios (gps_baudios)
+
+// --- OBJETOS DE HARDWARE ---
+DHT11 dhtIO(PIN_DHT);
+LDR_10K ldrIO(PIN_LDR);
+TinyGPSPlus gpsIO;
+HardwareSerial gpsSerialIO(2);
+
+Servo servoIO[3];
+
+static const uint8_t pinesRelay[4] = { PIN_RELAY_1, PIN_RELAY_2, PIN_RELAY_3, PIN_RELAY_4 };
+static const uint8_t pinesServo[3] = { PIN_SERVO_1, PIN_SERVO_2, PIN_SERVO_3 };
+
+// --- COLAS ---
+static QueueHandle_t colaComandosIO;
+static QueueHandle_t colaEventosActuador;
+
+// --- ESTADO COMPARTIDO (protegido por spinlock) ---
+static portMUX_TYPE muxEstadoIO = portMUX_INITIALIZER_UNLOCKED;
+static LecturaSensores lecturaActual;
+static EstadoActuadores actuadoresActual;
+
+// --- TEMPORIZADORES ---
+static unsigned long ultimoDHT = 0;
+static unsigned long ultimoLDR = 0;
+static unsigned long lockCierreMs = 0;
+static bool lockPulsoActivo = false;
+static OrigenComando lockPulsoOrigen = ORIGEN_IO;
+static uint32_t ultimoFixTrayecto = 0;  // hhmmsscc del último fix dado al trayecto
+static uint32_t ajustesAplicados = 0;   // ajustesSecuencia() ya aplicada al LDR y al GPS
+
+// ---------------------------------------------------------
+// AUXILIARES
+// ---------------------------------------------------------
+static void publicarEvento(ActuadorId actuador, int16_t valor, OrigenComando origen) {
+  EventoActuador evt = { actuador, origen, valor };
+  // Si la red va atrasada se pierde el evento, nunca se bloquea el IO
+  if (xQueueSend(colaEventosActuador, &evt, 0) != pdTRUE) metricaContar(CNT_COLA_LLENA);
+  else tareaDespertar(TAREA_RED);
+}
+
+static void aplicarActuador(ActuadorId actuador, int16_t valor, OrigenComando origen) {
+  if (actuador >= ACT_TOTAL) return;
+
+  // OUTPUT incluye la entrada en el ESP32: digitalRead() relee el pin
+  int leido = -1;
+  if (actuador <= ACT_RELAY_4) {
+    uint8_t pin = pinesRelay[actuador - ACT_RELAY_1];
+    digitalWrite(pin, valor ? HIGH : LOW);
+    leido = digitalRead(pin);
+  } else if (actuador == ACT_LOCK) {
+    digitalWrite(PIN_LOCK, valor ? HIGH : LOW);
+    leido = digitalRead(PIN_LOCK);
+  } else {
+    servoIO[actuador - ACT_SERVO_1].write(valor);
+  }
+  uint32_t aplicado = micros();
+
+  portENTER_CRITICAL(&muxEstadoIO);
+  if (actuador <= ACT_RELAY_4) {
+    actuadoresActual.relays[actuador - ACT_RELAY_1] = (valor != 0);
+  } else if (actuador == ACT_LOCK) {
+    actuadoresActual.lockAbierto = (valor != 0);
+  } else {
+    actuadoresActual.servos[actuador - ACT_SERVO_1] = (uint8_t)valor;
+  }
+  if (leido == HIGH) actuadoresActual.leidos |= (1 << actuador);
+  else if (leido == LOW) actuadoresActual.leidos &= ~(1 << actuador);
+  actuadoresActual.aplicadoUs[actuador] = aplicado;
+  portEXIT_CRITICAL(&muxEstadoIO);
+
+  reglasDato((CampoRegla)(CAMPO_RELAY1 + actuador), valor);
+
+  publicarEvento(actuador, valor, origen);
+}
+
+// Toda la escena en dos escrituras de registro: W1TS sube y W1TC baja solo
+// los bits de su máscara (todos los pines están por debajo de 32)
+static void aplicarEscena(uint8_t indice, OrigenComando origen) {
+  Escena e;
+  if (!escenaObtener(indice, e)) return;
+
+  uint32_t subir = 0, bajar = 0;
+  for (uint8_t s = 0; s < ESCENA_SALIDAS; s++) {
+    if (!(e.mascara & (1 << s))) continue;
+    uint32_t bit = 1UL << (s < 4 ? pinesRelay[s] : PIN_LOCK);
+    if (e.valores & (1 << s)) subir |= bit;
+    else bajar |= bit;
+  }
+  if (e.mascara & (1 << ACT_LOCK)) lockPulsoActivo = false;  // Igual que una orden manual
+
+  uint32_t c0 = ESP.getCycleCount();
+  if (subir) REG_WRITE(GPIO_OUT_W1TS_REG, subir);
+  if (bajar) REG_WRITE(GPIO_OUT_W1TC_REG, bajar);
+  uint32_t c1 = ESP.getCycleCount();
+  uint32_t niveles = REG_READ(GPIO_IN_REG);
+  uint32_t aplicado = micros();
+  // Con una sola escritura todas cambian juntas
+  uint32_t sesgoNs = (subir && bajar) ? (c1 - c0) * 1000 / ESP.getCpuFreqMHz() : 0;
+
+  portENTER_CRITICAL(&muxEstadoIO);
+  for (uint8_t s = 0; s < ESCENA_SALIDAS; s++) {
+    if (!(e.mascara & (1 << s))) continue;
+    bool on = e.valores & (1 << s);
+    if (s < 4) actuadoresActual.relays[s] = on;
+    else actuadoresActual.lockAbierto = on;
+    if (niveles & (1UL << (s < 4 ? pinesRelay[s] : PIN_LOCK))) actuadoresActual.leidos |= (1 << s);
+    else actuadoresActual.leidos &= ~(1 << s);
+    actuadoresActual.aplicadoUs[s] = aplicado;
+  }
+  strlcpy(actuadoresActual.escena, e.nombre, sizeof(actuadoresActual.escena));
+  actuadoresActual.escenaSesgoNs = sesgoNs;
+  portEXIT_CRITICAL(&muxEstadoIO);
+
+  for (uint8_t s = 0; s < ESCENA_SALIDAS; s++) {
+    if (e.mascara & (1 << s)) reglasDato((CampoRegla)(CAMPO_RELAY1 + s), (e.valores >> s) & 1);
+  }
+  // Un solo evento: la red publica el estado consolidado
+  publicarEvento(ACT_ESCENA, indice, origen);
+}
+
+static void ejecutarComando(const ComandoIO& cmd) {
+  switch (cmd.tipo) {
+    case CMD_IO_ESCRIBIR: {
+      int16_t valor = cmd.valor;
+      if (cmd.actuador >= ACT_SERVO_1) valor = constrain(valor, 0, 180);
+      if (cmd.actuador == ACT_LOCK) lockPulsoActivo = false;  // Manual anula el pulso
+      aplicarActuador(cmd.actuador, valor, cmd.origen);
+      break;
+    }
+    case CMD_IO_PULSO_LOCK:
+      aplicarActuador(ACT_LOCK, 1, cmd.origen);
+      lockPulsoActivo = true;
+      lockPulsoOrigen = cmd.origen;
+      lockCierreMs = millis() + (uint16_t)cmd.valor;
+      break;
+    case CMD_IO_CAPTURA:
+      if (cmd.valor == CAPTURA_NINGUNA) capturaDetener();
+      else if (!capturaIniciar((DestinoCaptura)cmd.valor)) Serial.println("Captura: no se pudo iniciar");
+      break;
+    case CMD_IO_ESCENA:
+      aplicarEscena((uint8_t)cmd.valor, cmd.origen);
+      break;
+  }
+}
+
+// LDR y UART del GPS con los ajustes actuales ("cfg set" desde otra tarea)
+static void aplicarAjustes() {
+  ajustesAplicados = ajustesSecuencia();
+  ldrIO.setSmoothing((uint8_t)ajustes.ldrMuestras);
+  ldrIO.setCalibration((int)ajustes.ldrMin, (int)ajustes.ldrMax);
+  if (gpsSerialIO.baudRate() != ajustes.gpsBaudios) gpsSerialIO.updateBaudRate(ajustes.gpsBaudios);
+}
+
+static void leerGPS() {
+  // Por bloques: la captura registra cada bloque tal como llegó
+  uint8_t bloque[64];
+  int disponibles;
+  while ((disponibles = gpsSerialIO.available()) > 0) {
+    size_t n = gpsSerialIO.read(bloque, min(disponibles, (int)sizeof(bloque)));
+    capturaGps(bloque, n);
+    for (size_t i = 0; i < n; i++) gpsIO.encode(bloque[i]);
+    energiaUartLeida();
+  }
+
+  if (!gpsIO.location.isUpdated() && !gpsIO.satellites.isUpdated()) return;
+
+  // GGA y RMC traen el mismo fix: al trayecto, una vez por segundo
+  bool fixNuevo = gpsIO.location.isValid() && gpsIO.location.isUpdated() && gpsIO.time.value() != ultimoFixTrayecto;
+  if (fixNuevo) ultimoFixTrayecto = gpsIO.time.value();
+  bool satsNuevos = gpsIO.satellites.isUpdated() && gpsIO.satellites.isValid();
+
+  portENTER_CRITICAL(&muxEstadoIO);
+  lecturaActual.gpsValido = gpsIO.location.isValid();
+  if (lecturaActual.gpsValido) {
+    lecturaActual.lat = gpsIO.location.lat();
+    lecturaActual.lng = gpsIO.location.lng();
+    lecturaActual.alt = gpsIO.altitude.meters();
+  }
+  lecturaActual.satsValido = gpsIO.satellites.isValid();
+  lecturaActual.sats = gpsIO.satellites.value();
+  if (lecturaActual.gpsValido && !lecturaActual.gpsFixMs) lecturaActual.gpsFixMs = millis();
+  double lat = lecturaActual.lat, lng = lecturaActual.lng, alt = lecturaActual.alt;
+  portEXIT_CRITICAL(&muxEstadoIO);
+
+  reglasDato(CAMPO_GPS, gpsIO.location.isValid());
+  if (gpsIO.time.isValid()) reglasDato(CAMPO_HORA, gpsIO.time.hour() * 60 + gpsIO.time.minute());
+  if (satsNuevos) {
+    historialMuestra(SERIE_SATS, gpsIO.satellites.value());
+    reglasDato(CAMPO_SATS, gpsIO.satellites.value());
+  }
+  if (fixNuevo) {
+    trayectoAgregar(lat, lng, alt, millis());
+    historialMuestra(SERIE_LAT, lround(lat * 1e5));
+    historialMuestra(SERIE_LNG, lround(lng * 1e5));
+  }
+}
+
+static void leerSensores(unsigned long now) {
+  if (now - ultimoDHT >= IO_PERIODO_DHT_MS) {
+    ultimoDHT = now;
+    int temp = 0, hum = 0;
+    uint32_t t0 = micros();
+    int res = dhtIO.readTemperatureHumidity(temp, hum);
+    uint32_t duracion = micros() - t0;
+    if (res != 0) metricaContar(CNT_DHT_ERRORES);
+    capturaDht(temp, hum, res);
+    if (res == 0) {
+      historialMuestra(SERIE_TEMP, temp * 10);
+      historialMuestra(SERIE_HUM, hum * 10);
+      reglasDato(CAMPO_TEMP, temp);
+      reglasDato(CAMPO_HUM, hum);
+    }
+
+    portENTER_CRITICAL(&muxEstadoIO);
+    lecturaActual.dhtStatus = res;
+    lecturaActual.dhtUs = duracion;
+    lecturaActual.dhtLecturas++;
+    if (res == 0) {
+      lecturaActual.temp = temp;
+      lecturaActual.hum = hum;
+    }
+    lecturaActual.tMs = now;
+    lecturaActual.monoUs = relojMonoUs();
+    portEXIT_CRITICAL(&muxEstadoIO);
+  }
+
+  if (now - ultimoLDR >= IO_PERIODO_LDR_MS) {
+    ultimoLDR = now;
+    int raw = ldrIO.getAnalogLDR();
+    int pct = ldrIO.getPercentageLDR();
+    capturaLdr(raw);
+    historialMuestra(SERIE_LUZ, pct * 10);
+    reglasDato(CAMPO_LUZ, pct);
+
+    portENTER_CRITICAL(&muxEstadoIO);
+    lecturaActual.luxRaw = raw;
+    lecturaActual.lux = pct;
+    lecturaActual.ldrLecturas++;
+    lecturaActual.tMs = now;
+    lecturaActual.monoUs = relojMonoUs();
+    portEXIT_CRITICAL(&muxEstadoIO);
+  }
+}
+
+// ---------------------------------------------------------
+// API PUBLICA
+// ---------------------------------------------------------
+void iniciarIO() {
+  colaComandosIO = xQueueCreate(COLA_COMANDOS_IO_LEN, sizeof(ComandoIO));
+  colaEventosActuador = xQueueCreate(COLA_EVENTOS_RED_LEN, sizeof(EventoActuador));
+
+  for (int i = 0; i < 4; i++) {
+    pinMode(pinesRelay[i], OUTPUT);
+    digitalWrite(pinesRelay[i], LOW);
+  }
+  pinMode(PIN_LOCK, OUTPUT);
+  digitalWrite(PIN_LOCK, LOW);
+
+  for (int i = 0; i < 3; i++) {
+    servoIO[i].attach(pinesServo[i]);
+  }
+
+  ldrIO.begin(12);
+  dhtIO.setDelay(0);  // El espaciado lo marca IO_PERIODO_DHT_MS, no un delay() interno
+
+  gpsSerialIO.setRxBufferSize(GPS_RX_BUFFER);
+  gpsSerialIO.begin(ajustes.gpsBaudios, SERIAL_8N1, PIN_GPS_RX, PIN_GPS_TX);
+  energiaUart(PIN_GPS_RX);
+  aplicarAjustes();
+
+  memset(&lecturaActual, 0, sizeof(lecturaActual));
+  memset(&actuadoresActual, 0, sizeof(actuadoresActual));
+  lecturaActual.dhtStatus = -1;  // Sin lectura todavía
+  historialIniciar();
+  reglasIniciar();
+  escenasIniciar();
+  // Relés y cerradura arrancan apagados; los servos, sin posición conocida
+  for (uint8_t a = ACT_RELAY_1; a <= ACT_LOCK; a++) reglasDato((CampoRegla)(CAMPO_RELAY1 + a - ACT_RELAY_1), 0);
+}
+
+void pasoTareaIO() {
+  // 1. GPS primero: la UART se llena a ~1 byte/ms (con los baudios de los ajustes)
+  if (ajustesSecuencia() != ajustesAplicados) aplicarAjustes();
+  leerGPS();
+
+  // 2. Órdenes pendientes (UI, WebSerial, MQTT)
+  ComandoIO cmd;
+  while (xQueueReceive(colaComandosIO, &cmd, 0) == pdTRUE) {
+    ejecutarComando(cmd);
+  }
+
+  // 3. Temporizador de la cerradura
+  unsigned long now = millis();
+  if (lockPulsoActivo && (long)(now - lockCierreMs) >= 0) {
+    lockPulsoActivo = false;
+    aplicarActuador(ACT_LOCK, 0, lockPulsoOrigen);
+  }
+
+  // 4. Muestreo periódico
+  leerSensores(now);
+  historialPaso(now);
+  capturaPaso();
+
+  // 5. Reglas locales afectadas por lo que cambió en este paso
+  reglasPaso(now, ejecutarComando);
+}
+
+bool ioEnviarComando(const ComandoIO& cmd) {
+  if (xQueueSend(colaComandosIO, &cmd, 0) == pdTRUE) {
+    tareaDespertar(TAREA_IO);
+    return true;
+  }
+  metricaContar(CNT_COLA_LLENA);
+  return false;
+}
+
+bool ioEscribir(ActuadorId actuador, int16_t valor, OrigenComando origen) {
+  ComandoIO cmd = { CMD_IO_ESCRIBIR, actuador, origen, valor };
+  return ioEnviarComando(cmd);
+}
+
+void ioObtenerLectura(LecturaSensores& out) {
+  portENTER_CRITICAL(&muxEstadoIO);
+  out = lecturaActual;
+  portEXIT_CRITICAL(&muxEstadoIO);
+}
+
+void ioObtenerActuadores(EstadoActuadores& out) {
+  portENTER_CRITICAL(&muxEstadoIO);
+  out = actuadoresActual;
+  portEXIT_CRITICAL(&muxEstadoIO);
+}
+
+bool ioRecibirEventoActuador(EventoActuador& evt) {
+  return xQueueReceive(colaEventosActuador, &evt, 0) == pdTRUE;
+}
+
+static uint32_t msHasta(unsigned long cuando, unsigned long now) {
+  long falta = (long)(cuando - now);
+  return falta > 0 ? (uint32_t)falta : 0;
+}
+
+uint32_t ioMsHastaProximo() {
+  unsigned long now = millis();
+  uint32_t ms = min(msHasta(ultimoDHT + IO_PERIODO_DHT_MS, now), msHasta(ultimoLDR + IO_PERIODO_LDR_MS, now));
+  if (lockPulsoActivo) ms = min(ms, msHasta(lockCierreMs, now));
+  return ms;
+}
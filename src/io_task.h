@@ -0,0 +1,31 @@
+#ifndef IO_TASK_H
+#define IO_TASK_H
+
+#include "messages.h"
+
+// Periodo del paso de la tarea IO (alimenta GPS y atiende comandos)
+#define IO_PERIODO_MS 10
+
+// Configura pines, sensores, servos y la UART del GPS. Crea la cola de comandos.
+void iniciarIO();
+
+// Un paso de la tarea IO: GPS, comandos pendientes, temporizadores y muestreo
+void pasoTareaIO();
+
+// Encola una orden para los actuadores (no bloquea). false si la cola está llena.
+bool ioEnviarComando(const ComandoIO& cmd);
+
+// Atajo para CMD_IO_ESCRIBIR
+bool ioEscribir(ActuadorId actuador, int16_t valor, OrigenComando origen);
+
+// Copia consistente del último estado (se puede llamar desde cualquier tarea)
+void ioObtenerLectura(LecturaSensores& out);
+void ioObtenerActuadores(EstadoActuadores& out);
+
+// Eventos de cambio de actuador (IO -> Red). Solo los consume la tarea de red.
+bool ioRecibirEventoActuador(EventoActuador& evt);
+
+// Bajo consumo: ms hasta la próxima lectura del DHT/LDR o el cierre de la cerradura
+uint32_t ioMsHastaProximo();
+
+#endif
@@ -4,88 +4,88 @@
 #include <ESPAsyncWebServer.h>
 #include <WebSerial.h>
 #include <ESPmDNS.h>
-#include <DHT11.h>
-#include <LDR_10K.h>
-#include <ESP32Servo.h>
-#include <TinyGPS++.h>
-
-// HARDWARE
-// ---------------------------------------------------------
-#define PIN_RELAY_1 26
-#define PIN_RELAY_2 27
-#define PIN_RELAY_3 14
-#define PIN_RELAY_4 12
-#define PIN_LOCK 13
-
-#define PIN_LDR 34
-#define PIN_DHT 23
-#define PIN_GPS_RX 16
-#define PIN_GPS_TX 17
-
-#define PIN_SERVO_1 15
-#define PIN_SERVO_2 2
-#define PIN_SERVO_3 4
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+#include "io_task.h"
+#include "metrics.h"
+#include "captura.h"
+#include "autotest.h"
+#include "trayecto.h"
+#include "historial.h"
+#include "reglas.h"
+#include "escenas.h"
+#include "identidad.h"
+#include "bus_i2c.h"
+#include "cliente_tls.h"
+#include "reloj.h"
+#include "texto.h"
+#include "ota.h"
+#include "ajustes.h"
+#include "energia.h"
 
 // ---------------------------------------------------------
 AsyncWebServer server(80);
 
-// Sensores
-DHT11 dht11(PIN_DHT);
-LDR_10K ldr(PIN_LDR);
-
-// GPS
-TinyGPSPlus gps;
-HardwareSerial gpsSerial(2);
-
-// Servos
-Servo servo1;
-Servo servo2;
-Servo servo3;
+// Los sensores y actuadores viven en la tarea IO: aquí solo se
+// encolan órdenes y se consulta la última lectura.
 
 // ---------------------------------------------------------
 bool servidorActivo = false;
 
 // ---------------------------------------------------------
-// COMANDOS (idénticos a tu implementación)
+// COMANDOS
 // ---------------------------------------------------------
-String getValue(String data, char separator, int index) {
-  int found = 0;
-  int strIndex[] = { 0, -1 };
-  int maxIndex = data.length() - 1;
-
-  for (int i = 0; i <= maxIndex && found <= index; i++) {
-    if (data.charAt(i) == separator || i == maxIndex) {
-      found++;
-      strIndex[0] = strIndex[1] + 1;
-      strIndex[1] = (i == maxIndex) ? i + 1 : i;
-    }
-  }
-  return found > index ? data.substring(strIndex[0], strIndex[1]) : "";
+// Las palabras del comando y las respuestas salen de aquí (corre en el
+// contexto de AsyncTCP); se vacía al terminar cada comando
+#define LOCAL_ARENA_BYTES 512
+static ArenaFija<LOCAL_ARENA_BYTES> arenaConsola;
+
+static bool es(const char* a, const char* b) {
+  return strcmp(a, b) == 0;
+}
+
+// Una línea de respuesta (Print::printf reserva heap pasados 64 B)
+static void responder(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+static void responder(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  const char* linea = arenaConsola.vformatear(fmt, args);
+  va_end(args);
+  WebSerial.println(linea);
 }
 
-void procesarComando(String cmd) {
-  cmd.trim();
-  String categoria = getValue(cmd, ' ', 0);
-  String accion = getValue(cmd, ' ', 1);
-  String objetivo = getValue(cmd, ' ', 2);
-  String valor = getValue(cmd, ' ', 3);
+void procesarComando(const char* entrada) {
+  size_t marca = arenaConsola.marca();
+
+  // Sin espacios a los lados: la primera palabra es siempre la categoría
+  while (isspace((unsigned char)*entrada)) entrada++;
+  size_t largo = strlen(entrada);
+  while (largo && isspace((unsigned char)entrada[largo - 1])) largo--;
+  const char* cmd = arenaConsola.copiar(entrada, largo);
+
+  const char* categoria = arenaConsola.palabra(cmd, ' ', 0);
+  const char* accion = arenaConsola.palabra(cmd, ' ', 1);
+  const char* objetivo = arenaConsola.palabra(cmd, ' ', 2);
+  const char* valor = arenaConsola.palabra(cmd, ' ', 3);
 
   // --- RELAYS ---
-  if (categoria == "relay") {
-    int pin = -1;
-    if (objetivo == "1") pin = PIN_RELAY_1;
-    else if (objetivo == "2") pin = PIN_RELAY_2;
-    else if (objetivo == "3") pin = PIN_RELAY_3;
-    else if (objetivo == "4") pin = PIN_RELAY_4;
-
-    if (pin != -1) {
-      if (accion == "set") {
-        bool estado = (valor == "on");
-        digitalWrite(pin, estado ? HIGH : LOW);
-        WebSerial.println("OK: Relay " + objetivo + (estado ? " ENCENDIDO" : " APAGADO"));
-      } else if (accion == "get") {
-        int estado = digitalRead(pin);
-        WebSerial.println("Info: Relay " + objetivo + " esta " + (estado ? "ON" : "OFF"));
+  if (es(categoria, "relay")) {
+    int relay = -1;
+    if (es(objetivo, "1")) relay = ACT_RELAY_1;
+    else if (es(objetivo, "2")) relay = ACT_RELAY_2;
+    else if (es(objetivo, "3")) relay = ACT_RELAY_3;
+    else if (es(objetivo, "4")) relay = ACT_RELAY_4;
+
+    if (relay != -1) {
+      if (es(accion, "set")) {
+        bool estado = es(valor, "on");
+        ioEscribir((ActuadorId)relay, estado ? 1 : 0, ORIGEN_LOCAL);
+        responder("OK: Relay %s %s", objetivo, estado ? "ENCENDIDO" : "APAGADO");
+      } else if (es(accion, "get")) {
+        EstadoActuadores act;
+        ioObtenerActuadores(act);
+        bool estado = act.relays[relay - ACT_RELAY_1];
+        responder("Info: Relay %s esta %s", objetivo, estado ? "ON" : "OFF");
       }
     } else {
       WebSerial.println("Error: Relay desconocido (use 1-4)");
@@ -93,36 +93,35 @@ void procesarComando(String cmd) {
   }
 
   // --- LOCK ---
-  else if (categoria == "lock") {
-    if (accion == "open") {
+  else if (es(categoria, "lock")) {
+    if (es(accion, "open")) {
       WebSerial.println("Abriendo cerradura por 3s...");
-      digitalWrite(PIN_LOCK, HIGH);
-      delay(3000);  // Bloqueante breve intencional por seguridad
-      digitalWrite(PIN_LOCK, LOW);
-      WebSerial.println("Cerradura cerrada.");
-    } else if (accion == "set") {
-      bool estado = (objetivo == "on");
-      digitalWrite(PIN_LOCK, estado ? HIGH : LOW);
-      WebSerial.println("OK: Cerradura " + String(estado ? "ACTIVADA" : "DESACTIVADA"));
+      // La tarea IO la cierra sola; el aviso llega por localNotificarActuador()
+      ComandoIO cmd = { CMD_IO_PULSO_LOCK, ACT_LOCK, ORIGEN_LOCAL, 3000 };
+      ioEnviarComando(cmd);
+    } else if (es(accion, "set")) {
+      bool estado = es(objetivo, "on");
+      ioEscribir(ACT_LOCK, estado ? 1 : 0, ORIGEN_LOCAL);
+      responder("OK: Cerradura %s", estado ? "ACTIVADA" : "DESACTIVADA");
     }
   }
 
   // --- SERVOS ---
-  else if (categoria == "servo") {
-    if (accion == "set") {
-      int angulo = valor.toInt();
+  else if (es(categoria, "servo")) {
+    if (es(accion, "set")) {
+      int angulo = atoi(valor);
       if (angulo < 0) angulo = 0;
       if (angulo > 180) angulo = 180;
 
-      if (objetivo == "1") {
-        servo1.write(angulo);
-        WebSerial.println("Servo 1 -> " + String(angulo));
-      } else if (objetivo == "2") {
-        servo2.write(angulo);
-        WebSerial.println("Servo 2 -> " + String(angulo));
-      } else if (objetivo == "3") {
-        servo3.write(angulo);
-        WebSerial.println("Servo 3 -> " + String(angulo));
+      if (es(objetivo, "1")) {
+        ioEscribir(ACT_SERVO_1, angulo, ORIGEN_LOCAL);
+        responder("Servo 1 -> %d", angulo);
+      } else if (es(objetivo, "2")) {
+        ioEscribir(ACT_SERVO_2, angulo, ORIGEN_LOCAL);
+        responder("Servo 2 -> %d", angulo);
+      } else if (es(objetivo, "3")) {
+        ioEscribir(ACT_SERVO_3, angulo, ORIGEN_LOCAL);
+        responder("Servo 3 -> %d", angulo);
       } else {
         WebSerial.println("Error: Servo desconocido (use 1-3)");
       }
@@ -130,46 +129,199 @@ void procesarComando(String cmd) {
   }
 
   // --- COMANDOS DE SENSORES ---
-  else if (categoria == "sensor") {
-    if (accion == "dht") {
-      int temp = 0, hum = 0;
-      int res = dht11.readTemperatureHumidity(temp, hum);
-      if (res == 0) WebSerial.println("DHT: " + String(temp) + "C, " + String(hum) + "%");
-      else WebSerial.println("DHT Error: " + String(res));
-    } else if (accion == "ldr") {
-      int raw = ldr.getAnalogLDR();
-      int pct = ldr.getPercentageLDR();
-      WebSerial.println("LDR: " + String(pct) + "% (Raw: " + String(raw) + ")");
-    } else if (accion == "gps") {
-      if (gps.location.isValid()) {
-        String gpsData = "GPS: Lat=" + String(gps.location.lat(), 6) + " Lon=" + String(gps.location.lng(), 6) + " Alt=" + String(gps.altitude.meters(), 2) + " Sats=" + String(gps.satellites.value());
-        WebSerial.println(gpsData);
+  else if (es(categoria, "sensor")) {
+    LecturaSensores lectura;
+    ioObtenerLectura(lectura);
+
+    if (es(accion, "dht")) {
+      if (lectura.dhtStatus == 0) responder("DHT: %dC, %d%%", lectura.temp, lectura.hum);
+      else responder("DHT Error: %d", lectura.dhtStatus);
+    } else if (es(accion, "ldr")) {
+      responder("LDR: %d%% (Raw: %d)", lectura.lux, lectura.luxRaw);
+    } else if (es(accion, "gps")) {
+      if (lectura.gpsValido) {
+        responder("GPS: Lat=%.6f Lon=%.6f Alt=%.2f Sats=%lu", lectura.lat, lectura.lng, lectura.alt,
+                  (unsigned long)lectura.sats);
       } else {
         WebSerial.println("GPS: Buscando satelites... (Asegurate de estar al aire libre)");
       }
-    } else if (accion == "all") {
+    } else if (es(accion, "history")) {
+      // sensor history <campo> <rango> [tramos]; sin campo, el uso de memoria
+      SerieId serie = historialSerie(objetivo);
+      uint32_t rango = valor[0] ? historialRango(valor) : 3600;
+      const char* tramos = arenaConsola.palabra(cmd, ' ', 4);
+      if (objetivo[0] && serie == SERIE_TOTAL) {
+        WebSerial.println("Error: campo desconocido (temp, hum, luz, sats, lat, lng)");
+      } else if (!rango) {
+        WebSerial.println("Error: rango invalido (ej. 30m, 6h, 24h)");
+      } else {
+        historialImprimir(WebSerial, serie, rango, tramos[0] ? atoi(tramos) : 12);
+      }
+    } else if (es(accion, "i2c")) {
+      LecturaI2C ext;
+      i2cObtenerLectura(ext);
+      if (ext.ambiente) responder("BME280: %.2fC, %.2f%%, %.2f hPa", ext.tempC, ext.humedad, ext.presionHpa);
+      if (ext.luz) responder("BH1750: %.2f lx", ext.lux);
+      if (!ext.ambiente && !ext.luz) WebSerial.println("I2C: sin sensores (sys i2c)");
+    } else if (es(accion, "all")) {
       // Recursividad simple para imprimir todo
       procesarComando("sensor dht");
       procesarComando("sensor ldr");
       procesarComando("sensor gps");
+      procesarComando("sensor i2c");
     }
   }
 
   // --- COMANDOS DE SISTEMA ---
-  else if (categoria == "sys") {
-    if (accion == "info") {
+  else if (es(categoria, "sys")) {
+    if (es(accion, "info")) {
+      IPAddress ip = WiFi.localIP();
+      char id[IDENTIDAD_MAX + 1];
+      identidadCopiar(id, sizeof(id));
       WebSerial.println("--- SYSTEM INFO ---");
-      WebSerial.println("IP: " + WiFi.localIP().toString());
-      WebSerial.println("RSSI: " + String(WiFi.RSSI()) + " dBm");
-      WebSerial.println("Uptime: " + String(millis() / 1000) + " s");
-    } else if (accion == "reset") {
+      responder("ID: %s%s", id, identidadDeFabrica() ? " (MAC)" : " (NVS)");
+      responder("IP: %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+      responder("RSSI: %d dBm", (int)WiFi.RSSI());
+      responder("Uptime: %lu s", (unsigned long)(millis() / 1000));
+    } else if (es(accion, "stats")) {
+      if (es(objetivo, "reset")) {
+        metricasReiniciar();
+        WebSerial.println("OK: Metricas a cero");
+      } else {
+        metricasMuestrearSistema();
+        metricasImprimir(WebSerial);
+      }
+    } else if (es(accion, "id")) {
+      // La tarea de red lo toma en su próximo paso (en Híbrido reconecta con él)
+      if (objetivo[0] && !identidadFijar(es(objetivo, "mac") ? "" : objetivo)) {
+        responder("Error: id de 1 a %d caracteres a-z 0-9 _ -", IDENTIDAD_MAX);
+      } else {
+        char id[IDENTIDAD_MAX + 1];
+        identidadCopiar(id, sizeof(id));
+        responder("ID: %s (topicos orion/%s/...)", id, id);
+      }
+    } else if (es(accion, "i2c")) {
+      // El escaneo lo hace la tarea I2C entre dos trozos de pantalla
+      if (es(objetivo, "scan")) {
+        WebSerial.println(i2cSolicitar(I2C_ESCANEAR) ? "Escaneando bus I2C..." : "Error: cola I2C llena");
+      } else {
+        i2cImprimir(WebSerial);
+      }
+    } else if (es(accion, "tls")) {
+      if (!ajustes.mqttTls) WebSerial.println("MQTT en claro (cfg set mqtt_tls 1 y mqtt_puerto 8883 para TLS)");
+      clienteTLS.imprimir(WebSerial);
+    } else if (es(accion, "reloj")) {
+      relojImprimir(WebSerial);
+    } else if (es(accion, "ota")) {
+      otaImprimir(WebSerial);
+    } else if (es(accion, "energia")) {
+      if (es(objetivo, "reset")) {
+        energiaReiniciar();
+        WebSerial.println("OK: Ciclo de trabajo a cero");
+      } else {
+        energiaImprimir(WebSerial);
+      }
+    } else if (es(accion, "reset")) {
       WebSerial.println("Reiniciando...");
       delay(500);
       ESP.restart();
     }
   }
 
-  else if (categoria == "help" || categoria == "?") {
+  // --- CAPTURA (la ejecuta la tarea IO) ---
+  else if (es(categoria, "cap")) {
+    if (es(accion, "start")) {
+      DestinoCaptura destino = es(objetivo, "serial") ? CAPTURA_SERIAL : CAPTURA_FS;
+      ComandoIO cmd = { CMD_IO_CAPTURA, ACT_TOTAL, ORIGEN_LOCAL, destino };
+      ioEnviarComando(cmd);
+      WebSerial.println(destino == CAPTURA_FS ? "Capturando en " CAPTURA_ARCHIVO " (descarga: /captura.log)"
+                                              : "Capturando por Serial (lineas CAP:)");
+    } else if (es(accion, "stop")) {
+      ComandoIO cmd = { CMD_IO_CAPTURA, ACT_TOTAL, ORIGEN_LOCAL, CAPTURA_NINGUNA };
+      ioEnviarComando(cmd);
+      WebSerial.println("Captura detenida");
+    } else {
+      capturaInfo(WebSerial);
+    }
+  }
+
+  // --- TRAYECTO GPS ---
+  else if (es(categoria, "track")) {
+    if (es(accion, "tol") && objetivo[0]) {
+      trayectoFijarTolerancia(atof(objetivo));
+      responder("OK: Tolerancia %s m", objetivo);
+    } else if (es(accion, "clear")) {
+      trayectoReiniciar();
+      WebSerial.println("OK: Trayecto borrado");
+    } else {
+      EstadisticaTrayecto est;
+      trayectoEstadistica(est);
+      responder("Trayecto: %lu puntos de %lu fixes (%lu por latido), tolerancia %.1f m", (unsigned long)est.guardados,
+                (unsigned long)est.recibidos, (unsigned long)est.latidos, est.toleranciaM);
+      PuntoTrayecto p;
+      if (trayectoUltimo(p)) {
+        responder("Ultimo: %.5f, %.5f hace %lu s", p.lat * 1e-5, p.lng * 1e-5, (unsigned long)((millis() - p.ms) / 1000));
+      }
+    }
+  }
+
+  // --- REGLAS LOCALES (las evalúa la tarea IO) ---
+  else if (es(categoria, "rule")) {
+    if (!accion[0] || es(accion, "list")) {
+      reglasImprimir(WebSerial);
+    } else {
+      char resp[128];
+      reglasComando(cmd + strlen(categoria), resp, sizeof(resp));
+      WebSerial.println(resp);
+    }
+  }
+
+  // --- ESCENAS (las aplica la tarea IO de una vez) ---
+  else if (es(categoria, "scene")) {
+    if (!accion[0] || es(accion, "list")) {
+      escenasImprimir(WebSerial);
+    } else {
+      char resp[96];
+      escenasComando(cmd + strlen(categoria), ORIGEN_LOCAL, resp, sizeof(resp));
+      WebSerial.println(resp);
+    }
+  }
+
+  // --- AJUSTES EN CALIENTE (quedan en NVS) ---
+  else if (es(categoria, "cfg")) {
+    if (!accion[0] || es(accion, "list")) {
+      ajustesImprimir(WebSerial);
+    } else {
+      char resp[96];
+      ajustesComando(cmd + strlen(categoria), resp, sizeof(resp));
+      WebSerial.println(resp);
+    }
+  }
+
+  // --- AUTODIAGNÓSTICO (lo corre la tarea UI) ---
+  else if (es(categoria, "selftest")) {
+    if (es(accion, "run")) {
+      uint8_t fases = AT_COMPLETO;
+      if (es(objetivo, "relays")) fases = AT_RELES;
+      else if (es(objetivo, "lock")) fases = AT_CERRADURA;
+      else if (es(objetivo, "servos")) fases = AT_SERVOS;
+      else if (es(objetivo, "sensors")) fases = AT_DHT | AT_LDR;
+      else if (es(objetivo, "gps")) fases = AT_GPS;
+      if (autotestSolicitar(fases)) WebSerial.println("Autodiagnostico iniciado (reporte: /selftest.json)");
+      else WebSerial.println("Error: ya hay un autodiagnostico en curso");
+    } else if (es(accion, "stop")) {
+      autotestCancelar();
+      WebSerial.println("Autodiagnostico cancelado");
+    } else if (autotestEnCurso()) {
+      WebSerial.println("Autodiagnostico en curso...");
+    } else {
+      static char reporte[AUTOTEST_REPORTE_MAX];
+      if (autotestReporte(reporte, sizeof(reporte))) WebSerial.println(reporte);
+      else WebSerial.println("Sin reporte: selftest run");
+    }
+  }
+
+  else if (es(categoria, "help") || es(categoria, "?")) {
     WebSerial.println("--- COMANDOS ---");
     WebSerial.println("ACTUADORES: ");
     WebSerial.println("apagar/encender --> relay set <1-4> on/off");
@@ -183,20 +335,38 @@ void procesarComando(String cmd) {
     WebSerial.println("Leer GPS --> sensor GPS");
     WebSerial.println("Leer DHT --> sensor dht");
     WebSerial.println("Leer luz --> sensor ldr");
+    WebSerial.println("Expansiones I2C --> sensor i2c");
+    WebSerial.println("Historial --> sensor history [temp|hum|luz|sats|lat|lng] [30m|6h|24h] [tramos]");
+    WebSerial.println("Trayecto GPS --> track info | track tol <m> | track clear");
+    WebSerial.println("Reglas --> rule add <id> luz < 20 hyst 5 for 10s then relay 1 on else relay 1 off");
+    WebSerial.println("           rule list | rule del|on|off <id> | rule clear | rule tz <horas>");
+    WebSerial.println("Escenas --> scene save <nombre> [relay1=on relay2=off lock=off ...]");
+    WebSerial.println("           scene run|del <nombre> | scene list | scene clear");
+    WebSerial.println("Ajustes --> cfg | cfg set <clave> <valor> | cfg reset [clave]");
     WebSerial.println("Sistema: ");
     WebSerial.println("Info Hardware --> sys info");
+    WebSerial.println("Metricas --> sys stats [reset]");
+    WebSerial.println("Captura --> cap start fs/serial | cap stop | cap info");
+    WebSerial.println("Autodiagnostico --> selftest run [relays|lock|servos|sensors|gps] | selftest stop | selftest");
+    WebSerial.println("Id MQTT --> sys id [nombre|mac]");
+    WebSerial.println("Bus I2C --> sys i2c [scan]");
+    WebSerial.println("TLS MQTT --> sys tls");
+    WebSerial.println("Reloj NTP --> sys reloj");
+    WebSerial.println("Actualizacion --> sys ota (paquete .oota: POST /ota)");
+    WebSerial.println("Bajo consumo --> sys energia [reset] (cfg set bajo_consumo 1)");
     WebSerial.println("Reiniciar --> sys reset");
   }
 
   else {
     WebSerial.println("Comando no reconocido. Prueba: 'help' o '?'");
   }
+
+  arenaConsola.volver(marca);
 }
 
 void recvMsg(uint8_t* data, size_t len) {
-  String cmd;
-  for (size_t i = 0; i < len; i++) cmd += char(data[i]);
-  procesarComando(cmd);
+  procesarComando(arenaConsola.copiar((const char*)data, len));
+  arenaConsola.reiniciar();
   delay(10);  // cede tiempo al scheduler (clave)
 }
 
@@ -207,30 +377,98 @@ bool iniciarServidorLocal() {
 
   if (!WiFi.isConnected()) return false;
 
-  // Pines
-  pinMode(PIN_RELAY_1, OUTPUT);
-  pinMode(PIN_RELAY_2, OUTPUT);
-  pinMode(PIN_RELAY_3, OUTPUT);
-  pinMode(PIN_RELAY_4, OUTPUT);
-  pinMode(PIN_LOCK, OUTPUT);
-
-  servo1.attach(PIN_SERVO_1);
-  servo2.attach(PIN_SERVO_2);
-  servo3.attach(PIN_SERVO_3);
-
-  ldr.begin(12);
-  gpsSerial.begin(9600, SERIAL_8N1, PIN_GPS_RX, PIN_GPS_TX);
-  delay(1000);
+  // Pines, servos, LDR y GPS ya los configuró iniciarIO()
 
   if (MDNS.begin("orion-iot")) {
     Serial.println("mDNS iniciado");
   }
 
-  WebSerial.begin(&server);
-  WebSerial.onMessage(recvMsg);
+  // WebSerial y las descargas de la última captura (no mientras se está
+  // escribiendo), del último autodiagnóstico y del historial.
+  // Las rutas sobreviven a server.end(): se registran una sola vez y
+  // volver al modo (o pasar a Híbrido) solo reabre el puerto.
+  static bool rutasRegistradas = false;
+  if (!rutasRegistradas) {
+    rutasRegistradas = true;
+    WebSerial.begin(&server);
+    WebSerial.onMessage(recvMsg);
+    server.on("/captura.log", HTTP_GET, [](AsyncWebServerRequest* request) {
+      if (capturaDestino() == CAPTURA_FS) {
+        request->send(409, "text/plain", "Captura en curso: cap stop");
+      } else if (!LittleFS.begin() || !LittleFS.exists(CAPTURA_ARCHIVO)) {
+        request->send(404, "text/plain", "Sin captura");
+      } else {
+        request->send(LittleFS, CAPTURA_ARCHIVO, "text/plain", true);
+      }
+    });
+    server.on("/selftest.json", HTTP_GET, [](AsyncWebServerRequest* request) {
+      static char reporte[AUTOTEST_REPORTE_MAX];
+      if (autotestReporte(reporte, sizeof(reporte))) {
+        request->send(200, "application/json", reporte);
+      } else {
+        request->send(404, "text/plain", autotestEnCurso() ? "Autodiagnostico en curso" : "Sin reporte");
+      }
+    });
+    // /history.json?campo=temp&rango=6h&puntos=60 (puntos=0: crudos)
+    server.on("/history.json", HTTP_GET, [](AsyncWebServerRequest* request) {
+      SerieId serie = request->hasParam("campo") ? historialSerie(request->getParam("campo")->value().c_str()) : SERIE_TEMP;
+      uint32_t rango = request->hasParam("rango") ? historialRango(request->getParam("rango")->value().c_str()) : 86400;
+      long puntos = request->hasParam("puntos") ? request->getParam("puntos")->value().toInt() : 60;
+      if (serie == SERIE_TOTAL || !rango || puntos < 0) {
+        request->send(400, "text/plain", "campo: temp|hum|luz|sats|lat|lng, rango: 30m|6h|24h, puntos >= 0");
+        return;
+      }
+      AsyncResponseStream* respuesta = request->beginResponseStream("application/json");
+      historialJson(*respuesta, serie, rango, puntos);
+      request->send(respuesta);
+    });
+    // Paquete .oota (ota.h) como archivo de formulario: cada trozo se
+    // descomprime y se escribe al llegar. El reinicio lo hace otaPaso()
+    server.on("/ota", HTTP_POST, [](AsyncWebServerRequest* request) {
+      static char estado[320];
+      otaJson(estado, sizeof(estado));
+      request->send(otaEstado() == OTA_REINICIANDO ? 200 : 400, "application/json", estado);
+    }, [](AsyncWebServerRequest* request, const String& archivo, size_t indice, uint8_t* datos, size_t largo, bool final) {
+      static bool propia = false;  // Esta subida tiene la sesión (no una descarga de Cloud)
+      if (indice == 0) propia = otaComenzar(OTA_ORIGEN_LOCAL);
+      if (!propia) return;
+      if (largo && !otaEscribir(datos, largo)) propia = false;
+      if (final && propia) otaTerminar();
+    });
+    // Ajustes: GET los vigentes; POST clave=valor (todos o ninguno)
+    server.on("/config.json", HTTP_ANY, [](AsyncWebServerRequest* request) {
+      static char cuerpo[AJUSTES_JSON_MAX];
+      if (request->method() == HTTP_POST) {
+        const char* claves[AJ_TOTAL];
+        const char* valores[AJ_TOTAL];
+        size_t n = 0;
+        for (size_t i = 0; i < request->params() && n < AJ_TOTAL; i++) {
+          const AsyncWebParameter* p = request->getParam(i);
+          claves[n] = p->name().c_str();
+          valores[n++] = p->value().c_str();
+        }
+        char resp[96];
+        if (!ajustesFijarVarios(claves, valores, n, resp, sizeof(resp))) {
+          StaticJsonDocument<160> error;
+          error["error"] = (const char*)resp;
+          serializeJson(error, cuerpo, sizeof(cuerpo));
+          request->send(400, "application/json", cuerpo);
+          return;
+        }
+      }
+      ajustesJson(cuerpo, sizeof(cuerpo));
+      request->send(200, "application/json", cuerpo);
+    });
+    server.on("/ota.json", HTTP_GET, [](AsyncWebServerRequest* request) {
+      static char estado[320];
+      otaJson(estado, sizeof(estado));
+      request->send(200, "application/json", estado);
+    });
+  }
   server.begin();
 
   servidorActivo = true;
+  otaConfirmar();  // En modo Local, reportarse es volver a servir la consola
   return true;
 }
 
@@ -243,7 +481,30 @@ void detenerServidorLocal() {
 }
 
 void loopServidorLocal() {
-  while (gpsSerial.available() > 0) {
-    gps.encode(gpsSerial.read());
+  // El GPS lo alimenta la tarea IO; aquí no queda trabajo periódico por ahora
+}
+
+void localNotificarActuador(const EventoActuador& evt) {
+  // Cierre automático tras "lock open"
+  if (evt.actuador == ACT_LOCK && evt.origen == ORIGEN_LOCAL && evt.valor == 0) {
+    WebSerial.println("Cerradura cerrada.");
+  }
+
+  // Escenas: el sesgo se conoce recién cuando IO la aplicó, sea quien sea el origen
+  if (evt.actuador == ACT_ESCENA) {
+    EstadoActuadores act;
+    ioObtenerActuadores(act);
+    WebSerial.printf("Escena %s aplicada (sesgo %lu ns)\n", act.escena, (unsigned long)act.escenaSesgoNs);
+    return;
+  }
+
+  // Cambios que no pidió la consola (Home Assistant en Híbrido, reglas)
+  if (evt.origen == ORIGEN_LOCAL || evt.origen == ORIGEN_IO) return;
+  // Corre en la tarea de red: no toca la arena de la consola
+  const char* quien = evt.origen == ORIGEN_CLOUD ? "Cloud" : evt.origen == ORIGEN_REGLA ? "Regla" : "UI";
+  if (evt.actuador <= ACT_RELAY_4) {
+    WebSerial.printf("[%s] Relay %d %s\n", quien, evt.actuador - ACT_RELAY_1 + 1, evt.valor ? "ENCENDIDO" : "APAGADO");
+  } else if (evt.actuador == ACT_LOCK) {
+    WebSerial.printf("[%s] Cerradura %s\n", quien, evt.valor ? "abierta" : "cerrada");
   }
 }
@@ -2,14 +2,21 @@
 #define LOCAL_SERVER_H
 
 #include <WiFi.h>
+#include "messages.h"
 
-// Inicializa todo el sistema local (MDNS + WebSerial + HW)
+// Inicializa todo el sistema local (MDNS + WebSerial)
 bool iniciarServidorLocal();
 
 // Apaga el servidor local (limpio)
 void detenerServidorLocal();
 
-// Loop de mantenimiento (GPS, tareas no bloqueantes)
+// Loop de mantenimiento (tareas no bloqueantes, corre en la tarea de red)
 void loopServidorLocal();
 
+// Intérprete de comandos de la consola WebSerial (sin heap: texto.h)
+void procesarComando(const char* cmd);
+
+// Avisos por WebSerial de cambios confirmados por la tarea IO
+void localNotificarActuador(const EventoActuador& evt);
+
 #endif
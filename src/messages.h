@@ -0,0 +1,148 @@
+#ifndef MESSAGES_H
+#define MESSAGES_H
+
+#include <Arduino.h>
+
+/* =======================
+   MENSAJES ENTRE TAREAS
+   =======================
+   Las tres tareas (UI, Red, IO) no comparten hardware: se comunican
+   solo con estos tipos a través de colas acotadas de FreeRTOS. */
+
+// Longitudes de cola (mensajes, no bytes)
+#define COLA_COMANDOS_IO_LEN   8
+#define COLA_EVENTOS_RED_LEN  16
+#define COLA_PETICIONES_RED_LEN 4
+#define COLA_EVENTOS_UI_LEN    8
+
+#define ESCENA_NOMBRE_MAX     12   // Nombre de escena (escenas.h), sin el '\0'
+
+/* =======================
+   ACTUADORES
+   ======================= */
+enum ActuadorId : uint8_t {
+  ACT_RELAY_1,
+  ACT_RELAY_2,
+  ACT_RELAY_3,
+  ACT_RELAY_4,
+  ACT_LOCK,
+  ACT_SERVO_1,
+  ACT_SERVO_2,
+  ACT_SERVO_3,
+  ACT_TOTAL,
+  ACT_ESCENA = ACT_TOTAL  // Solo en EventoActuador: se aplicó una escena (valor: índice)
+};
+
+// Quién originó la orden (para no hacer eco al mismo canal)
+enum OrigenComando : uint8_t {
+  ORIGEN_UI,
+  ORIGEN_LOCAL,
+  ORIGEN_CLOUD,
+  ORIGEN_IO,
+  ORIGEN_REGLA   // Motor de reglas local (reglas.h)
+};
+
+/* =======================
+   UI / RED  -->  IO
+   ======================= */
+enum TipoComandoIO : uint8_t {
+  CMD_IO_ESCRIBIR,   // relay/lock: 0/1, servo: angulo
+  CMD_IO_PULSO_LOCK, // abre la cerradura 'valor' ms y la cierra sola
+  CMD_IO_CAPTURA,    // valor: DestinoCaptura (0 = detener)
+  CMD_IO_ESCENA      // valor: índice en la tabla de escenas (escenas.h)
+};
+
+struct ComandoIO {
+  TipoComandoIO tipo;
+  ActuadorId actuador;
+  OrigenComando origen;
+  int16_t valor;
+};
+
+// Última lectura de sensores (copia completa, se entrega por valor)
+struct LecturaSensores {
+  uint32_t tMs;        // millis() de la última adquisición
+  uint64_t monoUs;     // La misma, en el reloj de muestras (reloj.h): de ahí sale su hora UTC
+  int temp;
+  int hum;
+  int dhtStatus;       // 0 = lectura valida
+  uint32_t dhtUs;      // Lo que tardó la última lectura del DHT
+  uint16_t dhtLecturas; // Lecturas intentadas desde el arranque
+  uint16_t ldrLecturas;
+  int lux;
+  int luxRaw;
+  bool gpsValido;
+  double lat;
+  double lng;
+  double alt;
+  bool satsValido;
+  uint32_t sats;
+  uint32_t gpsFixMs;   // millis() del primer fix (0 = aún sin fix)
+};
+
+struct EstadoActuadores {
+  bool relays[4];
+  bool lockAbierto;
+  uint8_t servos[3];
+  uint8_t leidos;                  // Bit por relé/cerradura: nivel releído del pin
+  uint32_t aplicadoUs[ACT_TOTAL];  // micros() en que IO aplicó la última orden
+  char escena[ESCENA_NOMBRE_MAX + 1];  // Última escena aplicada ("" = ninguna)
+  uint32_t escenaSesgoNs;              // Entre la primera y la última salida que cambió
+};
+
+/* =======================
+   IO  -->  RED
+   ======================= */
+struct EventoActuador {
+  ActuadorId actuador;
+  OrigenComando origen;
+  int16_t valor;
+};
+
+/* =======================
+   UI  -->  RED
+   ======================= */
+enum TipoPeticionRed : uint8_t {
+  RED_CONECTAR_WIFI,
+  RED_ESCANEAR_WIFI,
+  RED_FIJAR_MODOS     // modos: máscara ModoRed; la red solo toca lo que cambia
+};
+
+// Servicios de red que pueden correr a la vez (Híbrido = los dos)
+enum ModoRed : uint8_t {
+  MODO_NINGUNO = 0,
+  MODO_LOCAL   = 1,   // WebSerial + HTTP
+  MODO_CLOUD   = 2,   // MQTT + Influx
+  MODO_HIBRIDO = MODO_LOCAL | MODO_CLOUD
+};
+
+#define SSID_MAX_LEN 32
+#define PASS_MAX_LEN 16
+
+struct PeticionRed {
+  TipoPeticionRed tipo;
+  uint8_t modos;
+  char ssid[SSID_MAX_LEN + 1];
+  char pass[PASS_MAX_LEN + 1];
+};
+
+/* =======================
+   RED  -->  UI
+   ======================= */
+enum TipoEventoUI : uint8_t {
+  EVT_WIFI_RESULTADO,   // valor: 1 conectado, 0 fallo
+  EVT_ESCANEO_LISTO,    // valor: redes encontradas
+  EVT_LOCAL_RESULTADO,  // valor: 1 servidor activo, 0 fallo
+  EVT_CLOUD_PROGRESO,   // texto: paso de arranque
+  EVT_CLOUD_ESTADO      // valor: bit0 MQTT, bit1 Influx OK
+};
+
+#define EVT_TEXTO_LEN 24
+
+struct EventoUI {
+  TipoEventoUI tipo;
+  int16_t valor;
+  char texto[EVT_TEXTO_LEN];
+};
+
+#endif
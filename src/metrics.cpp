@@ -0,0 +1,154 @@
+#include "metrics.h"
+#include "tasks.h"
+#include <WiFi.h>
+#include <ArduinoJson.h>
+#include <esp_heap_caps.h>
+
+struct Histograma {
+  uint32_t cubetas[METRICA_CUBETAS];
+  uint32_t n;
+  uint32_t maxUs;
+  uint64_t sumaUs;
+};
+
+static uint32_t contadores[CNT_TOTAL];
+static int32_t medidores[MED_TOTAL];
+static Histograma histogramas[HIST_TOTAL];
+
+static const char* nombresContador[CNT_TOTAL] = {
+  "mqtt_pub", "mqtt_fallos", "mqtt_reconex", "influx_ok", "influx_fallos", "dht_err", "cola_llena", "pasos_tarde",
+  "i2c_err", "influx_desc", "arena_desb", "ota_fallos", "diag_desc"
+};
+
+static const char* nombresMedidor[MED_TOTAL] = {
+  "heap", "heap_min", "heap_blk", "pila_ui", "pila_red", "pila_io", "pila_i2c", "rssi", "tls_heap",
+  "reloj_desfase_us", "reloj_deriva_ppb", "energia_despierto_pm", "energia_ua"
+};
+
+static const char* nombresHistograma[HIST_TOTAL] = {
+  "paso_ui", "paso_red", "paso_io", "paso_i2c", "sensores", "mqtt_pub", "influx", "mqtt_con", "reglas",
+  "i2c_sensor", "tls_full", "tls_resum"
+};
+
+// ---------------------------------------------------------
+// REGISTRO
+// ---------------------------------------------------------
+void metricaContar(ContadorId id, uint32_t n) {
+  __atomic_fetch_add(&contadores[id], n, __ATOMIC_RELAXED);
+}
+
+void metricaFijar(MedidorId id, int32_t valor) {
+  medidores[id] = valor;
+}
+
+void metricaLatencia(HistogramaId id, uint32_t us) {
+  Histograma& h = histogramas[id];
+  uint32_t i = 32 - __builtin_clz(us | 1);
+  if (i >= METRICA_CUBETAS) i = METRICA_CUBETAS - 1;
+  h.cubetas[i]++;
+  h.n++;
+  h.sumaUs += us;
+  if (us > h.maxUs) h.maxUs = us;
+}
+
+// ---------------------------------------------------------
+// LECTURA
+// ---------------------------------------------------------
+uint32_t metricaContador(ContadorId id) {
+  return contadores[id];
+}
+
+int32_t metricaMedidor(MedidorId id) {
+  return medidores[id];
+}
+
+const char* metricaNombre(HistogramaId id) {
+  return nombresHistograma[id];
+}
+
+static uint32_t percentil(const Histograma& h, uint32_t n, uint32_t pct) {
+  uint32_t objetivo = (n * pct + 99) / 100;
+  uint32_t acumulado = 0;
+  for (uint8_t i = 0; i < METRICA_CUBETAS; i++) {
+    acumulado += h.cubetas[i];
+    if (acumulado >= objetivo) {
+      uint32_t limite = (i == 0) ? 1 : (1UL << i) - 1;
+      return limite < h.maxUs ? limite : h.maxUs;
+    }
+  }
+  return h.maxUs;
+}
+
+void metricaResumen(HistogramaId id, ResumenHistograma& out) {
+  // Copia primero: la tarea dueña puede seguir escribiendo
+  Histograma h = histogramas[id];
+  out.n = h.n;
+  out.maxUs = h.maxUs;
+  out.mediaUs = h.n ? (uint32_t)(h.sumaUs / h.n) : 0;
+  out.p50Us = h.n ? percentil(h, h.n, 50) : 0;
+  out.p95Us = h.n ? percentil(h, h.n, 95) : 0;
+}
+
+void metricasMuestrearSistema() {
+  medidores[MED_HEAP_LIBRE] = (int32_t)ESP.getFreeHeap();
+  medidores[MED_HEAP_MIN] = (int32_t)ESP.getMinFreeHeap();
+  medidores[MED_HEAP_BLOQUE] = (int32_t)heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+  medidores[MED_PILA_UI] = (int32_t)tareaPilaLibre(TAREA_UI);
+  medidores[MED_PILA_RED] = (int32_t)tareaPilaLibre(TAREA_RED);
+  medidores[MED_PILA_IO] = (int32_t)tareaPilaLibre(TAREA_IO);
+  medidores[MED_PILA_I2C] = (int32_t)tareaPilaLibre(TAREA_I2C);
+  medidores[MED_WIFI_RSSI] = WiFi.isConnected() ? WiFi.RSSI() : 0;
+}
+
+void metricasReiniciar() {
+  memset(contadores, 0, sizeof(contadores));
+  memset(histogramas, 0, sizeof(histogramas));
+}
+
+// ---------------------------------------------------------
+// SALIDA
+// ---------------------------------------------------------
+size_t metricasJSON(char* buf, size_t cap) {
+  StaticJsonDocument<2048> doc;
+  doc["uptime"] = millis() / 1000;
+  for (uint8_t i = 0; i < MED_TOTAL; i++) doc[nombresMedidor[i]] = medidores[i];
+  for (uint8_t i = 0; i < CNT_TOTAL; i++) doc[nombresContador[i]] = contadores[i];
+
+  // Por histograma: "<nombre>_p95" y "<nombre>_max" en µs. Claves
+  // armadas una vez: ArduinoJson guarda el puntero de un const char*
+  static char claves[HIST_TOTAL][2][24];
+  if (!claves[0][0][0]) {
+    for (uint8_t i = 0; i < HIST_TOTAL; i++) {
+      snprintf(claves[i][0], sizeof(claves[i][0]), "%s_p95", nombresHistograma[i]);
+      snprintf(claves[i][1], sizeof(claves[i][1]), "%s_max", nombresHistograma[i]);
+    }
+  }
+  for (uint8_t i = 0; i < HIST_TOTAL; i++) {
+    ResumenHistograma r;
+    metricaResumen((HistogramaId)i, r);
+    doc[(const char*)claves[i][0]] = r.p95Us;
+    doc[(const char*)claves[i][1]] = r.maxUs;
+  }
+  // serializeJson() corta sin avisar: mejor no publicar que publicar JSON roto
+  if (doc.overflowed() || measureJson(doc) >= cap) return 0;
+  return serializeJson(doc, buf, cap);
+}
+
+void metricasImprimir(Print& out) {
+  out.println("--- STATS ---");
+  // Casts: uint32_t/int32_t son long en el core 3.x
+  out.printf("Heap libre %ld B (min %ld, bloque %ld)\n", (long)medidores[MED_HEAP_LIBRE],
+             (long)medidores[MED_HEAP_MIN], (long)medidores[MED_HEAP_BLOQUE]);
+  out.printf("Pila libre ui %ld red %ld io %ld i2c %ld B\n", (long)medidores[MED_PILA_UI],
+             (long)medidores[MED_PILA_RED], (long)medidores[MED_PILA_IO], (long)medidores[MED_PILA_I2C]);
+  out.println("Latencia (us)   n    p50    p95    max");
+  for (uint8_t i = 0; i < HIST_TOTAL; i++) {
+    ResumenHistograma r;
+    metricaResumen((HistogramaId)i, r);
+    out.printf("%-10s %6lu %6lu %6lu %6lu\n", nombresHistograma[i], (unsigned long)r.n, (unsigned long)r.p50Us,
+               (unsigned long)r.p95Us, (unsigned long)r.maxUs);
+  }
+  for (uint8_t i = 0; i < CNT_TOTAL; i++) {
+    out.printf("%s: %lu\n", nombresContador[i], (unsigned long)contadores[i]);
+  }
+}
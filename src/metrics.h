@@ -0,0 +1,100 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+/* =======================
+   MÉTRICAS DE RENDIMIENTO
+   =======================
+   Registro fijo (sin heap) de contadores, medidores e histogramas de
+   latencia. Registrar una muestra es un incremento y un clz: se puede
+   llamar en cualquier paso de tarea. Cada histograma tiene un único
+   escritor (la tarea que mide); los contadores son atómicos. */
+
+enum ContadorId : uint8_t {
+  CNT_MQTT_PUBLICADOS,
+  CNT_MQTT_FALLOS,       // publish() rechazado (desconectado o buffer chico)
+  CNT_MQTT_RECONEXIONES,
+  CNT_INFLUX_OK,
+  CNT_INFLUX_FALLOS,
+  CNT_DHT_ERRORES,
+  CNT_COLA_LLENA,        // Mensajes descartados entre tareas
+  CNT_PASOS_ATRASADOS,   // Pasos que superaron el periodo de su tarea
+  CNT_I2C_ERRORES,       // NACK o lectura corta en el bus I2C
+  CNT_INFLUX_DESCARTES,  // Muestras perdidas con la cola de Influx llena
+  CNT_ARENA_DESBORDES,   // Textos cortados por no caber en su arena (texto.h)
+  CNT_OTA_FALLOS,        // Actualizaciones abortadas o revertidas
+  CNT_DIAG_DESCARTES,    // diag/state sin publicar por no caber en METRICAS_JSON_MAX
+  CNT_TOTAL
+};
+
+enum MedidorId : uint8_t {
+  MED_HEAP_LIBRE,
+  MED_HEAP_MIN,
+  MED_HEAP_BLOQUE,       // Bloque libre más grande (fragmentación)
+  MED_PILA_UI,
+  MED_PILA_RED,
+  MED_PILA_IO,
+  MED_PILA_I2C,
+  MED_WIFI_RSSI,
+  MED_TLS_HEAP,          // Contexto y buffers TLS reservados al entrar en Cloud
+  MED_RELOJ_DESFASE,     // µs que el NTP corrigió al reloj de muestras en la última sincronización
+  MED_RELOJ_DERIVA,      // ppb del cristal medidos entre sincronizaciones
+  MED_ENERGIA_DESPIERTO, // ‰ del tiempo fuera de light sleep (energia.h)
+  MED_ENERGIA_UA,        // Corriente media estimada del ESP32 (µA)
+  MED_TOTAL
+};
+
+enum HistogramaId : uint8_t {
+  HIST_PASO_UI,
+  HIST_PASO_RED,
+  HIST_PASO_IO,
+  HIST_PASO_I2C,
+  HIST_SENSORES,         // leerYPublicarSensores() completo
+  HIST_MQTT_PUBLICAR,
+  HIST_INFLUX_ESCRIBIR,
+  HIST_MQTT_CONECTAR,
+  HIST_REGLAS,           // Pasada de reglasPaso() que evaluó algo
+  HIST_I2C_SENSOR,       // Lectura I2C: desde que vence hasta que termina
+  HIST_TLS_COMPLETO,     // Handshake TLS con certificado (sin sesión que reanudar)
+  HIST_TLS_REANUDADO,    // Handshake TLS abreviado con ticket o id de sesión
+  HIST_TOTAL
+};
+
+// Cubetas log2 en µs: la i cubre [2^(i-1), 2^i). La última acumula el resto (> ~4 s).
+#define METRICA_CUBETAS 24
+
+struct ResumenHistograma {
+  uint32_t n;
+  uint32_t mediaUs;
+  uint32_t p50Us;        // Límite superior de la cubeta (aproximado)
+  uint32_t p95Us;
+  uint32_t maxUs;
+};
+
+// --- Registro (camino caliente) ---
+void metricaContar(ContadorId id, uint32_t n = 1);
+void metricaFijar(MedidorId id, int32_t valor);
+void metricaLatencia(HistogramaId id, uint32_t us);
+
+// --- Lectura ---
+uint32_t metricaContador(ContadorId id);
+int32_t metricaMedidor(MedidorId id);
+void metricaResumen(HistogramaId id, ResumenHistograma& out);
+const char* metricaNombre(HistogramaId id);
+
+// Actualiza heap, pilas y RSSI. La llama la tarea de red cada segundo.
+void metricasMuestrearSistema();
+
+// Pone a cero contadores e histogramas (los medidores se recalculan solos)
+void metricasReiniciar();
+
+// JSON compacto para orion/diag/state. Devuelve la longitud escrita, o 0
+// si no cabe entero (nunca deja un JSON cortado).
+#define METRICAS_JSON_MAX 1536
+size_t metricasJSON(char* buf, size_t cap);
+
+// Tabla legible (WebSerial 'sys stats' o Serial)
+void metricasImprimir(Print& out);
+
+#endif
@@ -0,0 +1,205 @@
+#include "net_task.h"
+#include "io_task.h"
+#include "cloud_mode.h"
+#include "local_server.h"
+#include "metrics.h"
+#include "ota.h"
+#include "energia.h"
+#include "tasks.h"
+#include <WiFi.h>
+
+// --- COLAS ---
+static QueueHandle_t colaPeticionesRed;
+static QueueHandle_t colaEventosUI;
+
+// --- ESTADO ---
+static uint8_t modosActivos = MODO_NINGUNO;  // Máscara ModoRed
+static bool escaneando = false;
+static unsigned long ultimoMuestreo = 0;
+
+#define RED_MUESTREO_MS 1000
+
+static char ssidEscaneo[MAX_NETWORKS][SSID_MAX_LEN + 1];
+
+// ---------------------------------------------------------
+// WIFI
+// ---------------------------------------------------------
+bool conectarWiFi(const char* ssid, const char* pass, uint32_t timeoutMs) {
+
+  Serial.print("Conectando a ");
+  Serial.println(ssid);
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin(ssid, pass);
+
+  uint32_t t0 = millis();
+  while (!WiFi.isConnected() && (millis() - t0 < timeoutMs)) {
+    delay(100);
+  }
+
+  if (WiFi.isConnected()) {
+    Serial.println("WiFi conectado");
+    Serial.print("IP: ");
+    Serial.println(WiFi.localIP());
+    return true;
+  }
+
+  Serial.println("Fallo conexion WiFi");
+  WiFi.disconnect(true);
+  return false;
+}
+
+// Escaneo asíncrono: se lanza aquí y se recoge en revisarEscaneo()
+static void lanzarEscaneo() {
+  if (escaneando) return;
+  WiFi.scanNetworks(true);
+  escaneando = true;
+}
+
+static void revisarEscaneo() {
+  if (!escaneando) return;
+
+  int n = WiFi.scanComplete();
+  if (n == WIFI_SCAN_RUNNING) return;
+
+  escaneando = false;
+  if (n < 0) n = 0;  // WIFI_SCAN_FAILED
+  n = min(n, MAX_NETWORKS);
+
+  for (int i = 0; i < n; i++) {
+    strlcpy(ssidEscaneo[i], WiFi.SSID(i).c_str(), sizeof(ssidEscaneo[i]));
+  }
+  WiFi.scanDelete();
+
+  redEnviarEventoUI(EVT_ESCANEO_LISTO, n);
+}
+
+// ---------------------------------------------------------
+// MODOS
+// ---------------------------------------------------------
+// Solo se arranca o detiene el servicio que cambia: pasar de Local a
+// Híbrido no toca el servidor web y de Híbrido a Cloud no corta MQTT
+static void fijarModos(uint8_t modos) {
+  uint8_t apagar = modosActivos & ~modos;
+  uint8_t encender = modos & ~modosActivos;
+
+  if (apagar & MODO_LOCAL) detenerServidorLocal();
+  if (apagar & MODO_CLOUD) detenerModoCloud();
+
+  if (encender & MODO_LOCAL) {
+    bool ok = iniciarServidorLocal();
+    if (!ok) modos &= ~MODO_LOCAL;
+    redEnviarEventoUI(EVT_LOCAL_RESULTADO, ok ? 1 : 0);
+  }
+  if (encender & MODO_CLOUD) iniciarModoCloud();
+
+  modosActivos = modos;
+}
+
+// ---------------------------------------------------------
+// PETICIONES DE LA UI
+// ---------------------------------------------------------
+static void atenderPeticion(const PeticionRed& pet) {
+  switch (pet.tipo) {
+    case RED_CONECTAR_WIFI: {
+      bool ok = conectarWiFi(pet.ssid, pet.pass);
+      redEnviarEventoUI(EVT_WIFI_RESULTADO, ok ? 1 : 0);
+      break;
+    }
+    case RED_ESCANEAR_WIFI:
+      lanzarEscaneo();
+      break;
+
+    case RED_FIJAR_MODOS:
+      fijarModos(pet.modos);
+      break;
+  }
+}
+
+// ---------------------------------------------------------
+// API PUBLICA
+// ---------------------------------------------------------
+void iniciarRed() {
+  colaPeticionesRed = xQueueCreate(COLA_PETICIONES_RED_LEN, sizeof(PeticionRed));
+  colaEventosUI = xQueueCreate(COLA_EVENTOS_UI_LEN, sizeof(EventoUI));
+}
+
+void pasoTareaRed() {
+  // 1. Peticiones de la UI (pueden bloquear: WiFi.begin, validar Influx...)
+  PeticionRed pet;
+  while (xQueueReceive(colaPeticionesRed, &pet, 0) == pdTRUE) {
+    atenderPeticion(pet);
+  }
+
+  revisarEscaneo();
+
+  // 2. Cambios de actuadores hechos por IO -> tópicos de estado / WebSerial
+  // (en Híbrido, un relé movido desde la consola sale también por MQTT)
+  EventoActuador evt;
+  while (ioRecibirEventoActuador(evt)) {
+    if (modosActivos & MODO_CLOUD) cloudPublicarActuador(evt);
+    if (modosActivos & MODO_LOCAL) localNotificarActuador(evt);
+  }
+
+  // 3. Modos activos
+  if (modosActivos & MODO_CLOUD) loopModoCloud();
+  if (modosActivos & MODO_LOCAL) loopServidorLocal();
+
+  // 4. OTA: descarga en curso, plazo de la imagen a prueba, reinicio
+  otaPaso();
+
+  // 5. Heap, pilas y RSSI para las métricas
+  unsigned long now = millis();
+  if (now - ultimoMuestreo >= RED_MUESTREO_MS) {
+    ultimoMuestreo = now;
+    metricasMuestrearSistema();
+  }
+
+  // 6. Bajo consumo: entra o sale según ajustes, modo y lo que esté en curso
+  energiaPaso();
+}
+
+bool redEnviarPeticion(const PeticionRed& pet) {
+  if (xQueueSend(colaPeticionesRed, &pet, 0) != pdTRUE) return false;
+  tareaDespertar(TAREA_RED);
+  return true;
+}
+
+bool redEnviarPeticion(TipoPeticionRed tipo) {
+  PeticionRed pet = {};
+  pet.tipo = tipo;
+  return redEnviarPeticion(pet);
+}
+
+bool redFijarModos(uint8_t modos) {
+  PeticionRed pet = {};
+  pet.tipo = RED_FIJAR_MODOS;
+  pet.modos = modos;
+  return redEnviarPeticion(pet);
+}
+
+uint8_t redModosActivos() {
+  return modosActivos;
+}
+
+bool redEnviarEventoUI(TipoEventoUI tipo, int16_t valor, const char* texto) {
+  EventoUI evt = {};
+  evt.tipo = tipo;
+  evt.valor = valor;
+  if (texto) strlcpy(evt.texto, texto, sizeof(evt.texto));
+  if (xQueueSend(colaEventosUI, &evt, 0) == pdTRUE) {
+    tareaDespertar(TAREA_UI);
+    return true;
+  }
+  metricaContar(CNT_COLA_LLENA);
+  return false;
+}
+
+bool redRecibirEventoUI(EventoUI& evt) {
+  return xQueueReceive(colaEventosUI, &evt, 0) == pdTRUE;
+}
+
+const char* redSsidEscaneado(int i) {
+  if (i < 0 || i >= MAX_NETWORKS) return "";
+  return ssidEscaneo[i];
+}
@@ -0,0 +1,34 @@
+#ifndef NET_TASK_H
+#define NET_TASK_H
+
+#include "messages.h"
+
+// Periodo del paso de la tarea de red (MQTT keep-alive, peticiones de UI)
+#define RED_PERIODO_MS 20
+
+#define MAX_NETWORKS 10
+
+// Conexión WiFi bloqueante. Solo desde setup() o desde la tarea de red.
+bool conectarWiFi(const char* ssid, const char* pass, uint32_t timeoutMs = 10000);
+
+// Crea las colas de red. Llamar antes de iniciarTareas().
+void iniciarRed();
+
+// Un paso de la tarea de red: peticiones de la UI, eventos de IO y modos activos
+void pasoTareaRed();
+
+// UI -> Red (no bloquea). false si la cola está llena.
+bool redEnviarPeticion(const PeticionRed& pet);
+bool redEnviarPeticion(TipoPeticionRed tipo);
+// Servicios que deben quedar corriendo (máscara ModoRed; MODO_NINGUNO los para)
+bool redFijarModos(uint8_t modos);
+uint8_t redModosActivos();
+
+// Red -> UI. Solo los consume la tarea UI.
+bool redEnviarEventoUI(TipoEventoUI tipo, int16_t valor, const char* texto = nullptr);
+bool redRecibirEventoUI(EventoUI& evt);
+
+// Resultado del último escaneo. Válido tras EVT_ESCANEO_LISTO y hasta el siguiente escaneo.
+const char* redSsidEscaneado(int i);
+
+#endif
@@ -0,0 +1,722 @@
+#include "ota.h"
+#include "net_task.h"
+#include "metrics.h"
+#include <WiFi.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <mbedtls/sha256.h>
+
+#define NVS_ESPACIO "ota"
+
+// Cómo terminó la última actualización (NVS "resultado")
+enum OtaResultado : uint8_t {
+  RES_NINGUNO,
+  RES_CONFIRMADA,
+  RES_SIN_REPORTE,   // Vencido OTA_CONFIRMAR_MS
+  RES_REINICIOS,     // OTA_INTENTOS_MAX arranques sin reportarse
+  RES_NO_ARRANCO     // El bootloader volvió solo a la anterior
+};
+static const char* const textosResultado[] = {
+  "ninguna", "confirmada", "revertida (no se reporto a tiempo)", "revertida (reinicios)", "revertida (no arranco)"
+};
+static const char* const textosEstado[] = { "inactiva", "descargando", "escribiendo", "reiniciando", "fallida" };
+static const char* const textosTipo[] = { "plana", "lzss", "delta" };
+
+// El estado lo cambian AsyncTCP (POST /ota) y la tarea de red; los datos
+// de la sesión, solo quien la tomó
+static portMUX_TYPE muxOta = portMUX_INITIALIZER_UNLOCKED;
+static volatile OtaEstado estado = OTA_INACTIVA;
+static OtaOrigen origen = OTA_ORIGEN_LOCAL;
+static uint32_t secuencia = 0;
+static const char* error = "";
+static bool reiniciar = false;
+static unsigned long reinicioEn = 0;
+// otaEscribir()/otaTerminar() no toman muxOta mientras escriben (la flash
+// tarda): 'dentro' lo marca y la tarea de red no corta la sesión debajo;
+// 'cortando' es su corte en curso, que ya no deja entrar a nadie
+static bool dentro = false;
+static bool cortando = false;
+
+// --- Sesión ---
+static OtaCabecera cab;
+static size_t cabLeidos = 0;
+static bool shaFijado = false;
+static uint8_t shaFijo[32];
+static const esp_partition_t* destino = nullptr;
+static const esp_partition_t* base = nullptr;
+static esp_ota_handle_t manejador = 0;
+static bool abierta = false;
+static mbedtls_sha256_context sha;
+static uint32_t recibidos = 0;   // Bytes del paquete
+static uint32_t escritos = 0;    // Bytes de la imagen
+static uint32_t inicioMs = 0;
+static unsigned long ultimoDatoMs = 0;
+static uint8_t bloque[OTA_BLOQUE_BYTES];
+static size_t bloqueN = 0;
+
+// --- LZSS ---
+enum FaseLz : uint8_t { LZ_BANDERA, LZ_LITERAL, LZ_INDICE, LZ_LARGO };
+static uint8_t ventana[1 << OTA_VENTANA_MAX_BITS];
+static uint16_t ventanaPos = 0;
+static uint16_t mascara = 0;
+static FaseLz faseLz = LZ_BANDERA;
+static uint8_t faltan = 0;
+static uint16_t acumulado = 0;
+static uint16_t indice = 0;
+
+// --- Parche ---
+enum FaseDelta : uint8_t { D_ORDEN, D_SALTO, D_LARGO, D_DATOS };
+static FaseDelta faseDelta = D_ORDEN;
+static uint8_t orden = 0;
+static uint32_t varint = 0;
+static uint8_t varintBits = 0;
+static uint32_t deltaResta = 0;
+static uint32_t baseCursor = 0;
+static uint8_t baseBuf[OTA_BASE_BYTES];
+static uint32_t baseBufInicio = 0;
+static uint16_t baseBufN = 0;
+
+// --- Descarga (tarea de red) ---
+enum FaseHttp : uint8_t { HTTP_CONECTAR, HTTP_CABECERAS, HTTP_CUERPO };
+static WiFiClient http;
+static char url[OTA_URL_MAX];
+static char servidor[64];
+static uint16_t puerto = 80;
+static const char* ruta = "/";
+static uint8_t shaDescarga[32];
+static FaseHttp faseHttp = HTTP_CONECTAR;
+static char linea[64];
+static uint8_t lineaN = 0;
+static bool primeraLinea = true;
+static uint8_t red[128];
+
+// --- Arranque a prueba ---
+static bool aPrueba = false;
+static unsigned long plazoMs = 0;
+static char previa[17] = "";
+static uint8_t modosPrevios = 0;
+
+// --- Última actualización escrita (para ota/state y la consola) ---
+static OtaTipo ultimoTipo = OTA_PLANA;
+static uint32_t ultimoPaquete = 0;
+static uint32_t ultimaImagen = 0;
+static uint32_t ultimoMs = 0;
+static OtaResultado resultado = RES_NINGUNO;
+
+// ---------------------------------------------------------
+// ESCRITURA EN LA PARTICIÓN
+// ---------------------------------------------------------
+static bool fallar(const char* motivo) {
+  otaAbortar(motivo);
+  return false;
+}
+
+static bool volcar() {
+  if (!bloqueN) return true;
+  mbedtls_sha256_update(&sha, bloque, bloqueN);
+  if (esp_ota_write(manejador, bloque, bloqueN) != ESP_OK) return fallar("Error escribiendo flash");
+  bloqueN = 0;
+  return true;
+}
+
+static bool emitir(uint8_t b) {
+  if (escritos >= cab.largo) return fallar("Imagen mas larga que la cabecera");
+  bloque[bloqueN++] = b;
+  escritos++;
+  return bloqueN < sizeof(bloque) || volcar();
+}
+
+// ---------------------------------------------------------
+// PARCHE (bytes ya descomprimidos)
+// ---------------------------------------------------------
+static bool leerBase(uint8_t& b) {
+  if (baseCursor >= cab.largoBase) return fallar("Parche fuera de la imagen base");
+  if (baseCursor < baseBufInicio || baseCursor - baseBufInicio >= baseBufN) {
+    baseBufInicio = baseCursor;
+    baseBufN = (uint16_t)min((uint32_t)OTA_BASE_BYTES, cab.largoBase - baseCursor);
+    if (esp_partition_read(base, baseBufInicio, baseBuf, baseBufN) != ESP_OK) return fallar("Error leyendo la base");
+  }
+  b = baseBuf[baseCursor++ - baseBufInicio];
+  return true;
+}
+
+static bool deltaByte(uint8_t b) {
+  if (faseDelta == D_ORDEN) {
+    if (b > OTA_DELTA_DIFF) return fallar("Orden de parche desconocida");
+    orden = b;
+    varint = 0;
+    varintBits = 0;
+    faseDelta = b == OTA_DELTA_DIFF ? D_SALTO : D_LARGO;
+    return true;
+  }
+  if (faseDelta == D_DATOS) {
+    if (orden == OTA_DELTA_DIFF) {
+      uint8_t o;
+      if (!leerBase(o)) return false;
+      b += o;
+    }
+    if (--deltaResta == 0) faseDelta = D_ORDEN;
+    return emitir(b);
+  }
+
+  // Varint: 7 bits por byte, el alto indica que sigue
+  if (varintBits > 28) return fallar("Parche corrupto");
+  varint |= (uint32_t)(b & 0x7F) << varintBits;
+  varintBits += 7;
+  if (b & 0x80) return true;
+  if (faseDelta == D_SALTO) {
+    // Zigzag; un salto fuera de la base lo detecta leerBase()
+    baseCursor += (uint32_t)((int32_t)(varint >> 1) ^ -(int32_t)(varint & 1));
+    varint = 0;
+    varintBits = 0;
+    faseDelta = D_LARGO;
+    return true;
+  }
+  deltaResta = varint;
+  faseDelta = deltaResta ? D_DATOS : D_ORDEN;
+  return true;
+}
+
+// ---------------------------------------------------------
+// LZSS
+// ---------------------------------------------------------
+static bool salida(uint8_t b) {
+  ventana[ventanaPos++ & mascara] = b;
+  return cab.tipo == OTA_DELTA ? deltaByte(b) : emitir(b);
+}
+
+static bool lzBit(uint8_t bit) {
+  if (faseLz == LZ_BANDERA) {
+    faseLz = bit ? LZ_LITERAL : LZ_INDICE;
+    faltan = bit ? 8 : cab.ventanaBits;
+    acumulado = 0;
+    return true;
+  }
+  acumulado = acumulado << 1 | bit;
+  if (--faltan) return true;
+
+  if (faseLz == LZ_LITERAL) {
+    faseLz = LZ_BANDERA;
+    return salida((uint8_t)acumulado);
+  }
+  if (faseLz == LZ_INDICE) {
+    indice = acumulado;
+    faseLz = LZ_LARGO;
+    faltan = cab.largoBits;
+    acumulado = 0;
+    return true;
+  }
+  // Referencia: puede solaparse con lo que va copiando (repeticiones)
+  faseLz = LZ_BANDERA;
+  uint16_t desde = ventanaPos - indice - 1;
+  for (uint16_t i = 0; i < acumulado + OTA_LZ_MIN; i++) {
+    if (!salida(ventana[(desde + i) & mascara])) return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------
+// FIRMA (HMAC-SHA256, RFC 2104)
+// ---------------------------------------------------------
+static_assert(sizeof(OTA_CLAVE) - 1 <= 64, "OTA_CLAVE tiene que caber en un bloque de SHA-256");
+
+void otaFirmar(const OtaCabecera& cabecera, uint8_t firma[32]) {
+  uint8_t pad[64] = {};
+  memcpy(pad, OTA_CLAVE, sizeof(OTA_CLAVE) - 1);
+  for (uint8_t& b : pad) b ^= 0x36;
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts(&ctx, 0);
+  mbedtls_sha256_update(&ctx, pad, sizeof(pad));
+  mbedtls_sha256_update(&ctx, (const uint8_t*)&cabecera, offsetof(OtaCabecera, firma));
+  uint8_t interno[32];
+  mbedtls_sha256_finish(&ctx, interno);
+
+  for (uint8_t& b : pad) b ^= 0x36 ^ 0x5C;
+  mbedtls_sha256_starts(&ctx, 0);
+  mbedtls_sha256_update(&ctx, pad, sizeof(pad));
+  mbedtls_sha256_update(&ctx, interno, sizeof(interno));
+  mbedtls_sha256_finish(&ctx, firma);
+  mbedtls_sha256_free(&ctx);
+}
+
+// Sin cortar en el primer byte distinto: el tiempo no dice cuántos acertó
+static bool firmaValida() {
+  uint8_t calculada[32];
+  otaFirmar(cab, calculada);
+  uint8_t diferencia = 0;
+  for (size_t i = 0; i < sizeof(calculada); i++) diferencia |= calculada[i] ^ cab.firma[i];
+  return diferencia == 0;
+}
+
+// ---------------------------------------------------------
+// SESIÓN
+// ---------------------------------------------------------
+static void cambiarEstado(OtaEstado nuevo) {
+  estado = nuevo;
+  secuencia++;
+}
+
+// La base tiene que ser exactamente la imagen contra la que se hizo el parche
+static bool baseCoincide() {
+  if (!base || cab.largoBase == 0 || cab.largoBase > base->size) return false;
+  mbedtls_sha256_context shaBase;
+  mbedtls_sha256_init(&shaBase);
+  mbedtls_sha256_starts(&shaBase, 0);
+  for (uint32_t pos = 0; pos < cab.largoBase; pos += sizeof(baseBuf)) {
+    uint32_t n = min((uint32_t)sizeof(baseBuf), cab.largoBase - pos);
+    if (esp_partition_read(base, pos, baseBuf, n) != ESP_OK) {
+      mbedtls_sha256_free(&shaBase);
+      return false;
+    }
+    mbedtls_sha256_update(&shaBase, baseBuf, n);
+  }
+  uint8_t calculado[32];
+  mbedtls_sha256_finish(&shaBase, calculado);
+  mbedtls_sha256_free(&shaBase);
+  baseBufN = 0;
+  return memcmp(calculado, cab.shaBase, sizeof(calculado)) == 0;
+}
+
+// Con la cabecera completa: validar y abrir la partición inactiva
+static bool abrir() {
+  if (memcmp(cab.magia, OTA_MAGIA, 4) != 0 || cab.version != OTA_VERSION) return fallar("No es un paquete OTA");
+  if (!firmaValida()) return fallar("Firma del paquete invalida");
+  if (cab.tipo > OTA_DELTA || cab.ventanaBits < 8 || cab.ventanaBits > OTA_VENTANA_MAX_BITS ||
+      cab.largoBits < 3 || cab.largoBits > 8) {
+    return fallar("Cabecera OTA invalida");
+  }
+  if (shaFijado && memcmp(cab.sha, shaFijo, sizeof(shaFijo)) != 0) return fallar("SHA-256 distinto al de la orden");
+
+  destino = esp_ota_get_next_update_partition(nullptr);
+  if (!destino || cab.largo == 0 || cab.largo > destino->size) return fallar("La imagen no cabe");
+  if (cab.tipo == OTA_DELTA) {
+    base = esp_ota_get_running_partition();
+    if (!baseCoincide()) return fallar("El parche es para otra version");
+  }
+  // Borrado sector a sector según se escribe: ningún paso borra la partición entera
+  if (esp_ota_begin(destino, OTA_WITH_SEQUENTIAL_WRITES, &manejador) != ESP_OK) return fallar("esp_ota_begin");
+  abierta = true;
+
+  mbedtls_sha256_init(&sha);
+  mbedtls_sha256_starts(&sha, 0);
+  mascara = (1 << cab.ventanaBits) - 1;
+  memset(ventana, 0, sizeof(ventana));
+  ventanaPos = 0;
+  faseLz = LZ_BANDERA;
+  faseDelta = D_ORDEN;
+  baseCursor = 0;
+  baseBufInicio = 0;
+  baseBufN = 0;
+  Serial.printf("OTA: %s de %lu B hacia %s\n", textosTipo[cab.tipo], (unsigned long)cab.largo, destino->label);
+  return true;
+}
+
+// Sin tomar la sesión (ya la tiene quien llama)
+static void empezar(const uint8_t* shaEsperado) {
+  cabLeidos = 0;
+  recibidos = 0;
+  escritos = 0;
+  bloqueN = 0;
+  abierta = false;
+  shaFijado = shaEsperado != nullptr;
+  if (shaFijado) memcpy(shaFijo, shaEsperado, sizeof(shaFijo));
+  error = "";
+  inicioMs = millis();
+  ultimoDatoMs = inicioMs;
+  cortando = false;
+  cambiarEstado(OTA_ESCRIBIENDO);
+}
+
+static bool tomar(OtaOrigen quien, OtaEstado nuevo) {
+  portENTER_CRITICAL(&muxOta);
+  bool libre = estado == OTA_INACTIVA || estado == OTA_FALLIDA;
+  if (libre) {
+    estado = nuevo;
+    origen = quien;
+  }
+  portEXIT_CRITICAL(&muxOta);
+  return libre;
+}
+
+bool otaComenzar(OtaOrigen quien, const uint8_t* shaEsperado) {
+  if (!tomar(quien, OTA_ESCRIBIENDO)) return false;
+  empezar(shaEsperado);
+  return true;
+}
+
+static bool entrar() {
+  portENTER_CRITICAL(&muxOta);
+  bool puede = estado == OTA_ESCRIBIENDO && !cortando;
+  if (puede) dentro = true;
+  portEXIT_CRITICAL(&muxOta);
+  return puede;
+}
+
+static void salir() {
+  portENTER_CRITICAL(&muxOta);
+  dentro = false;
+  portEXIT_CRITICAL(&muxOta);
+}
+
+static bool escribir(const uint8_t* datos, size_t n) {
+  recibidos += n;
+  ultimoDatoMs = millis();
+  while (n && cabLeidos < sizeof(cab)) {
+    ((uint8_t*)&cab)[cabLeidos++] = *datos++;
+    n--;
+    if (cabLeidos == sizeof(cab) && !abrir()) return false;
+  }
+  for (size_t i = 0; i < n; i++) {
+    if (cab.tipo == OTA_PLANA) {
+      if (!emitir(datos[i])) return false;
+      continue;
+    }
+    for (int8_t b = 7; b >= 0; b--) {
+      if (!lzBit((datos[i] >> b) & 1)) return false;
+    }
+  }
+  return true;
+}
+
+bool otaEscribir(const uint8_t* datos, size_t n) {
+  if (!entrar()) return false;
+  bool ok = escribir(datos, n);
+  salir();
+  return ok;
+}
+
+static bool terminar() {
+  if (cabLeidos < sizeof(cab) || escritos != cab.largo) return fallar("Imagen incompleta");
+  if (!volcar()) return false;
+
+  uint8_t calculado[32];
+  mbedtls_sha256_finish(&sha, calculado);
+  mbedtls_sha256_free(&sha);
+  if (memcmp(calculado, cab.sha, sizeof(calculado)) != 0) return fallar("SHA-256 de la imagen no coincide");
+  abierta = false;
+  if (esp_ota_end(manejador) != ESP_OK) return fallar("Imagen rechazada por esp_ota_end");
+
+  // Antes de cambiar el arranque: a dónde volver si la nueva no se reporta
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, false);
+  prefs.putString("previa", esp_ota_get_running_partition()->label);
+  prefs.putUChar("intentos", 0);
+  prefs.putUChar("modos", redModosActivos());
+  prefs.remove("resultado");
+  prefs.end();
+  if (esp_ota_set_boot_partition(destino) != ESP_OK) {
+    // Se sigue arrancando esta: sin "previa" el próximo arranque no es una vuelta
+    prefs.begin(NVS_ESPACIO, false);
+    prefs.remove("previa");
+    prefs.end();
+    return fallar("No se pudo cambiar la particion de arranque");
+  }
+
+  ultimoTipo = (OtaTipo)cab.tipo;
+  ultimoPaquete = recibidos;
+  ultimaImagen = escritos;
+  ultimoMs = millis() - inicioMs;
+  resultado = RES_NINGUNO;
+  Serial.printf("OTA: %lu B recibidos, %lu B escritos en %lu ms; reiniciando en %s\n", (unsigned long)recibidos,
+                (unsigned long)escritos, (unsigned long)ultimoMs, destino->label);
+  reiniciar = true;
+  reinicioEn = millis();
+  cambiarEstado(OTA_REINICIANDO);
+  return true;
+}
+
+bool otaTerminar() {
+  if (!entrar()) return false;
+  bool ok = terminar();
+  salir();
+  return ok;
+}
+
+void otaAbortar(const char* motivo) {
+  if (estado != OTA_DESCARGANDO && estado != OTA_ESCRIBIENDO) return;
+  if (abierta) {
+    esp_ota_abort(manejador);
+    mbedtls_sha256_free(&sha);
+    abierta = false;
+  }
+  if (origen == OTA_ORIGEN_CLOUD) http.stop();
+  error = motivo;
+  metricaContar(CNT_OTA_FALLOS);
+  Serial.printf("OTA abortada: %s\n", motivo);
+  cambiarEstado(OTA_FALLIDA);
+}
+
+// ---------------------------------------------------------
+// DESCARGA HTTP (tarea de red)
+// ---------------------------------------------------------
+static int8_t hex(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// "http://servidor[:puerto]/ruta": el paquete no necesita TLS porque su
+// cabecera va firmada con OTA_CLAVE (abrir() la comprueba antes de escribir)
+static bool partirUrl(const char* texto) {
+  if (strncmp(texto, "http://", 7) != 0 || strlen(texto) >= sizeof(url)) return false;
+  strlcpy(url, texto, sizeof(url));
+  const char* host = url + 7;
+  const char* barra = strchr(host, '/');
+  const char* dosPuntos = strchr(host, ':');
+  size_t largoHost = barra ? (size_t)(barra - host) : strlen(host);
+  puerto = 80;
+  if (dosPuntos && (!barra || dosPuntos < barra)) {
+    puerto = (uint16_t)atoi(dosPuntos + 1);
+    largoHost = dosPuntos - host;
+  }
+  if (!largoHost || largoHost >= sizeof(servidor) || !puerto) return false;
+  memcpy(servidor, host, largoHost);
+  servidor[largoHost] = '\0';
+  ruta = barra ? barra : "/";
+  return true;
+}
+
+bool otaDescargar(const char* texto, const char* shaHex) {
+  uint8_t shaBin[32];
+  if (strlen(shaHex) != 64) return false;
+  for (int i = 0; i < 32; i++) {
+    int8_t alto = hex(shaHex[2 * i]), bajo = hex(shaHex[2 * i + 1]);
+    if (alto < 0 || bajo < 0) return false;
+    shaBin[i] = alto << 4 | bajo;
+  }
+  if (!tomar(OTA_ORIGEN_CLOUD, OTA_DESCARGANDO)) return false;
+  if (!partirUrl(texto)) {
+    otaAbortar("URL invalida (http://servidor[:puerto]/ruta)");
+    return false;
+  }
+  memcpy(shaDescarga, shaBin, sizeof(shaDescarga));
+  faseHttp = HTTP_CONECTAR;
+  error = "";
+  secuencia++;
+  return true;
+}
+
+// Cabeceras de la respuesta: solo importa el 200 y el fin (línea vacía)
+static void leerCabeceras() {
+  while (http.available()) {
+    char c = (char)http.read();
+    if (c == '\r') continue;
+    if (c != '\n') {
+      if (lineaN < sizeof(linea) - 1) linea[lineaN++] = c;
+      continue;
+    }
+    linea[lineaN] = '\0';
+    if (primeraLinea) {
+      primeraLinea = false;
+      const char* codigo = strchr(linea, ' ');
+      if (!codigo || atoi(codigo + 1) != 200) {
+        otaAbortar("El servidor no devolvio 200");
+        return;
+      }
+    } else if (lineaN == 0) {
+      empezar(shaDescarga);
+      faseHttp = HTTP_CUERPO;
+      return;
+    }
+    lineaN = 0;
+  }
+}
+
+static void pasoDescarga() {
+  unsigned long ahora = millis();
+  if (faseHttp == HTTP_CONECTAR) {
+    if (!http.connect(servidor, puerto)) {
+      otaAbortar("Sin conexion con el servidor de imagenes");
+      return;
+    }
+    // HTTP/1.0: sin chunked; el fin del cuerpo es el cierre
+    http.print("GET ");
+    http.print(ruta);
+    http.print(" HTTP/1.0\r\nHost: ");
+    http.print(servidor);
+    http.print("\r\nConnection: close\r\n\r\n");
+    faseHttp = HTTP_CABECERAS;
+    lineaN = 0;
+    primeraLinea = true;
+    ultimoDatoMs = ahora;
+    return;
+  }
+
+  if (faseHttp == HTTP_CABECERAS) {
+    if (http.available()) ultimoDatoMs = ahora;
+    leerCabeceras();
+  }
+  if (faseHttp == HTTP_CUERPO && estado == OTA_ESCRIBIENDO) {
+    // Tope de imagen escrita por paso: el borrado de flash no puede retener
+    // la tarea de red. Se lee de a poco porque un parche se expande mucho
+    uint32_t desde = escritos;
+    int n;
+    while (escritos - desde < OTA_PASO_BYTES && (n = http.read(red, sizeof(red))) > 0) {
+      if (!otaEscribir(red, n)) return;
+    }
+    if (!http.connected() && !http.available()) {
+      http.stop();
+      otaTerminar();
+      return;
+    }
+  }
+  // otaEscribir() pudo mover ultimoDatoMs más allá de 'ahora' (borrado de flash)
+  if (estado != OTA_REINICIANDO && estado != OTA_FALLIDA && (long)(millis() - ultimoDatoMs) > 30000) {
+    otaAbortar("Descarga sin datos por 30 s");
+  }
+}
+
+// ---------------------------------------------------------
+// ARRANQUE A PRUEBA
+// ---------------------------------------------------------
+static void revertir(OtaResultado motivo) {
+  aPrueba = false;
+  const esp_partition_t* anterior = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, previa);
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, false);
+  if (!anterior || esp_ota_set_boot_partition(anterior) != ESP_OK) {
+    // Sin imagen a la que volver: se queda la nueva
+    prefs.remove("previa");
+    prefs.end();
+    Serial.println("OTA: no hay imagen anterior a la que volver");
+    return;
+  }
+  prefs.putUChar("resultado", motivo);
+  prefs.end();
+  Serial.printf("OTA: %s, volviendo a %s\n", textosResultado[motivo], previa);
+  ESP.restart();
+}
+
+void otaIniciar() {
+  estado = OTA_INACTIVA;
+  reiniciar = false;
+  aPrueba = false;
+  previa[0] = '\0';
+  modosPrevios = 0;
+
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, false);
+  prefs.getString("previa", previa, sizeof(previa));
+  resultado = (OtaResultado)prefs.getUChar("resultado", RES_NINGUNO);
+  if (!previa[0]) {
+    prefs.end();
+    return;
+  }
+
+  if (strcmp(esp_ota_get_running_partition()->label, previa) == 0) {
+    // Otra vez en la anterior: la vuelta fue nuestra o del bootloader
+    if (resultado < RES_SIN_REPORTE) {
+      resultado = RES_NO_ARRANCO;
+      prefs.putUChar("resultado", resultado);
+    }
+    prefs.remove("previa");
+    prefs.end();
+    metricaContar(CNT_OTA_FALLOS);
+    return;
+  }
+
+  uint8_t intentos = prefs.getUChar("intentos") + 1;
+  modosPrevios = prefs.getUChar("modos");
+  prefs.putUChar("intentos", intentos);
+  prefs.end();
+  if (intentos > OTA_INTENTOS_MAX) {
+    revertir(RES_REINICIOS);
+    return;
+  }
+
+  aPrueba = true;
+  plazoMs = millis() + OTA_CONFIRMAR_MS;
+  Serial.printf("OTA: imagen nueva a prueba (arranque %u de %u)\n", intentos, OTA_INTENTOS_MAX);
+}
+
+// Se vuelve a los modos de antes para que la imagen pueda reportarse
+void otaRestaurarModos() {
+  if (aPrueba && modosPrevios) redFijarModos(modosPrevios);
+}
+
+void otaConfirmar() {
+  if (!aPrueba) return;
+  aPrueba = false;
+  resultado = RES_CONFIRMADA;
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, false);
+  prefs.remove("previa");
+  prefs.remove("intentos");
+  prefs.remove("modos");
+  prefs.putUChar("resultado", resultado);
+  prefs.end();
+  secuencia++;
+  Serial.println("OTA: imagen nueva confirmada");
+}
+
+// ---------------------------------------------------------
+// TAREA DE RED
+// ---------------------------------------------------------
+// Solo si AsyncTCP no está escribiendo; desde aquí ya no entra
+static bool subidaParada(unsigned long ahora) {
+  portENTER_CRITICAL(&muxOta);
+  bool parada = estado == OTA_ESCRIBIENDO && !dentro && (long)(ahora - ultimoDatoMs) > 30000;
+  if (parada) cortando = true;
+  portEXIT_CRITICAL(&muxOta);
+  return parada;
+}
+
+void otaPaso() {
+  unsigned long ahora = millis();
+  if (aPrueba && (long)(ahora - plazoMs) >= 0) revertir(RES_SIN_REPORTE);
+
+  OtaEstado e = estado;
+  if ((e == OTA_DESCARGANDO || e == OTA_ESCRIBIENDO) && origen == OTA_ORIGEN_CLOUD) {
+    pasoDescarga();
+  } else if (e == OTA_ESCRIBIENDO && subidaParada(ahora)) {
+    // Subida cortada a medias: AsyncTCP no avisa
+    otaAbortar("Subida sin datos por 30 s");
+  } else if (e == OTA_REINICIANDO && reiniciar && ahora - reinicioEn >= OTA_REINICIO_MS) {
+    reiniciar = false;
+    ESP.restart();
+  }
+}
+
+// ---------------------------------------------------------
+// CONSULTA
+// ---------------------------------------------------------
+OtaEstado otaEstado() {
+  return estado;
+}
+
+uint32_t otaSecuencia() {
+  return secuencia;
+}
+
+size_t otaJson(char* buf, size_t cap) {
+  const esp_partition_t* corriendo = esp_ota_get_running_partition();
+  int n = snprintf(buf, cap,
+                   "{\"estado\":\"%s\",\"particion\":\"%s\",\"a_prueba\":%s,\"progreso\":%lu,\"largo\":%lu,"
+                   "\"recibidos\":%lu,\"error\":\"%s\",\"resultado\":\"%s\",\"ultima_tipo\":\"%s\","
+                   "\"ultima_paquete\":%lu,\"ultima_imagen\":%lu,\"ultima_ms\":%lu}",
+                   textosEstado[estado], corriendo ? corriendo->label : "?", aPrueba ? "true" : "false",
+                   (unsigned long)escritos, (unsigned long)(cabLeidos == sizeof(cab) ? cab.largo : 0),
+                   (unsigned long)recibidos, error, textosResultado[resultado], textosTipo[ultimoTipo],
+                   (unsigned long)ultimoPaquete, (unsigned long)ultimaImagen, (unsigned long)ultimoMs);
+  return n < 0 ? 0 : min((size_t)n, cap - 1);
+}
+
+void otaImprimir(Print& out) {
+  const esp_partition_t* corriendo = esp_ota_get_running_partition();
+  out.println("--- OTA ---");
+  out.printf("Particion: %s%s\n", corriendo ? corriendo->label : "?", aPrueba ? " (a prueba)" : "");
+  if (aPrueba) out.printf("Se revierte en %ld s si no se reporta\n", (long)(plazoMs - millis()) / 1000);
+  out.printf("Estado: %s", textosEstado[estado]);
+  if (estado == OTA_ESCRIBIENDO && cabLeidos == sizeof(cab)) {
+    out.printf(" %lu/%lu B", (unsigned long)escritos, (unsigned long)cab.largo);
+  }
+  if (estado == OTA_FALLIDA) out.printf(" (%s)", error);
+  out.println();
+  if (ultimaImagen) {
+    out.printf("Ultima: %s, %lu B por %lu B de imagen en %lu ms\n", textosTipo[ultimoTipo],
+               (unsigned long)ultimoPaquete, (unsigned long)ultimaImagen, (unsigned long)ultimoMs);
+  }
+  out.printf("Resultado anterior: %s\n", textosResultado[resultado]);
+}
@@ -0,0 +1,124 @@
+#ifndef OTA_H
+#define OTA_H
+
+#include <Arduino.h>
+
+/* =======================
+   ACTUALIZACIÓN OTA
+   =======================
+   Un paquete .oota es una cabecera fija y un flujo LZSS (estilo
+   heatshrink: bit de bandera, literal de 8 bits o referencia
+   índice/largo a una ventana de 2^W bytes). Tres tipos:
+     OTA_PLANA  la imagen tal cual (sin comprimir)
+     OTA_LZSS   la imagen comprimida
+     OTA_DELTA  un parche contra la imagen que corre, comprimido
+   El parche es una lista de órdenes al estilo bsdiff: DIFF (salto en la
+   base y n bytes que se suman a los de la base: casi todo ceros cuando
+   solo se movieron direcciones) e INSERT (n bytes nuevos).
+
+   Todo se decodifica al vuelo hacia la partición OTA inactiva con
+   buffers estáticos: ventana LZSS, bloque de escritura y lectura de la
+   base (~3 KB). La cabecera va firmada (HMAC-SHA256 con OTA_CLAVE) y se
+   rechaza antes de tocar la flash si la firma no cierra; el SHA-256 de
+   la imagen resultante se compara con la cabecera (y con el que fijó la
+   orden MQTT) antes de cambiar la partición de arranque.
+
+   La imagen nueva arranca "a prueba": si no se reporta (MQTT conectado o
+   servidor local arriba, otaConfirmar()) en OTA_CONFIRMAR_MS, o se
+   reinicia OTA_INTENTOS_MAX veces sin hacerlo, vuelve a la anterior. El
+   estado vive en NVS porque el bootloader de Arduino no trae rollback.
+
+   Las escrituras llegan desde AsyncTCP (POST /ota) o desde la tarea de
+   red (descarga por ota/set); solo una sesión a la vez. */
+
+#define OTA_MAGIA "OOTA"
+#define OTA_VERSION 2
+#define OTA_VENTANA_MAX_BITS 11      // Ventana LZSS de 2 KB
+#define OTA_LZ_MIN 2                 // Una referencia copia al menos 2 bytes
+#define OTA_BLOQUE_BYTES 1024        // Se escribe en flash de a un bloque
+#define OTA_BASE_BYTES 256           // Lectura de la imagen base (DIFF)
+#define OTA_CONFIRMAR_MS 300000      // La imagen nueva tiene 5 min para reportarse
+#define OTA_INTENTOS_MAX 3           // Arranques sin reportarse antes de volver
+#define OTA_REINICIO_MS 1500         // Margen para que salga la respuesta
+#define OTA_PASO_BYTES 16384         // Imagen que una descarga escribe por paso de red
+#define OTA_URL_MAX 128
+
+// Clave de firma de los paquetes (hasta 64 caracteres), sin valor de
+// fábrica: -DOTA_CLAVE=\"...\" o src/ota_clave.h (fuera de git) con su
+// #define. orion_ota firma con la misma, así que se compilan juntos
+#if !defined(OTA_CLAVE) && __has_include("ota_clave.h")
+#include "ota_clave.h"
+#endif
+#ifndef OTA_CLAVE
+#error "define OTA_CLAVE (-DOTA_CLAVE o src/ota_clave.h)"
+#endif
+
+enum OtaTipo : uint8_t {
+  OTA_PLANA,
+  OTA_LZSS,
+  OTA_DELTA
+};
+
+// Cabecera del paquete (little endian, 112 B)
+struct __attribute__((packed)) OtaCabecera {
+  char magia[4];
+  uint8_t version;
+  uint8_t tipo;           // OtaTipo
+  uint8_t ventanaBits;    // W: 8..OTA_VENTANA_MAX_BITS
+  uint8_t largoBits;      // L: 3..8 (referencias de OTA_LZ_MIN a 2^L + 1 bytes)
+  uint32_t largo;         // Bytes de la imagen resultante
+  uint32_t largoBase;     // OTA_DELTA: bytes de la imagen base
+  uint8_t sha[32];        // SHA-256 de la imagen resultante
+  uint8_t shaBase[32];    // OTA_DELTA: SHA-256 de la base
+  uint8_t firma[32];      // HMAC-SHA256 con OTA_CLAVE de todo lo anterior
+};
+
+// Órdenes del parche (tras descomprimir); números en varint LEB128
+#define OTA_DELTA_INSERT 0   // largo, bytes
+#define OTA_DELTA_DIFF   1   // salto (zigzag, desde el fin del DIFF anterior), largo, diferencias
+
+enum OtaEstado : uint8_t {
+  OTA_INACTIVA,
+  OTA_DESCARGANDO,   // Conectando o leyendo cabeceras HTTP
+  OTA_ESCRIBIENDO,
+  OTA_REINICIANDO,   // Imagen verificada y partición de arranque cambiada
+  OTA_FALLIDA
+};
+
+enum OtaOrigen : uint8_t {
+  OTA_ORIGEN_LOCAL,
+  OTA_ORIGEN_CLOUD
+};
+
+// Firma de la cabecera (la de la placa y la de orion_ota)
+void otaFirmar(const OtaCabecera& cabecera, uint8_t firma[32]);
+
+// Lo primero de setup(): cuenta el arranque de una imagen a prueba y vuelve
+// a la anterior si pasó de OTA_INTENTOS_MAX (un cuelgue más adelante cuenta)
+void otaIniciar();
+
+// Con la tarea de red creada: la imagen a prueba vuelve a los modos de antes
+void otaRestaurarModos();
+
+// La imagen que corre funciona: cancela la vuelta atrás
+void otaConfirmar();
+
+// Sesión de escritura (POST /ota o la descarga). 'shaEsperado' (o nullptr)
+// fija el SHA-256 de la imagen: la cabecera tiene que coincidir
+bool otaComenzar(OtaOrigen origen, const uint8_t* shaEsperado = nullptr);
+bool otaEscribir(const uint8_t* datos, size_t n);
+bool otaTerminar();   // Verifica, cambia la partición y programa el reinicio
+void otaAbortar(const char* motivo);
+
+// Descarga por HTTP en pasos de la tarea de red. 'sha': 64 hex
+bool otaDescargar(const char* url, const char* sha);
+
+// Tarea de red: descarga, plazo de confirmación y reinicio pendiente
+void otaPaso();
+
+OtaEstado otaEstado();
+uint32_t otaSecuencia();   // Cambia con cada cambio de estado o resultado
+size_t otaJson(char* buf, size_t cap);
+void otaImprimir(Print& out);
+
+#endif
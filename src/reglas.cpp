@@ -0,0 +1,717 @@
+#include "reglas.h"
+#include "metrics.h"
+#include <Preferences.h>
+
+#define NVS_ESPACIO "reglas"
+#define CABECERA (sizeof(Regla) - REGLA_CODIGO_MAX)
+
+// --- BYTECODE (postfijo) ---
+enum OpRegla : uint8_t {
+  OP_CMP = 1,   // campo, cmp, valor (int16), hyst (uint8) -> bool
+  OP_ENTRE,     // inicio, fin (uint16, minutos) -> bool
+  OP_Y,
+  OP_O,
+  OP_NO
+};
+
+enum CmpRegla : uint8_t { CMP_LT, CMP_GT, CMP_LE, CMP_GE, CMP_EQ, CMP_NE };
+
+static const char* const NOMBRES_CAMPO[CAMPO_TOTAL] = {
+  "temp", "hum", "luz", "sats", "gps", "relay1", "relay2", "relay3", "relay4",
+  "lock", "servo1", "servo2", "servo3", "hora"
+};
+static const char* const NOMBRES_CMP[] = { "<", ">", "<=", ">=", "==", "!=" };
+
+// Estado de ejecución (solo RAM)
+struct EstadoRegla {
+  bool cumple;          // Último estado confirmado
+  bool pendiente;       // El crudo difiere y corre el retardo
+  bool oscilo;          // Desactivada por disparar sin parar
+  uint8_t histeresis;   // Bit por comparación: se cumplía la vez anterior
+  uint32_t desdeMs;
+  uint32_t disparos;
+  uint32_t evaluaciones;
+  uint32_t ventanaMs;   // Conteo de disparos por segundo
+  uint8_t enVentana;
+};
+
+// --- TABLA (protegida por spinlock) ---
+static portMUX_TYPE muxReglas = portMUX_INITIALIZER_UNLOCKED;
+static Regla tabla[REGLAS_MAX];
+static EstadoRegla estados[REGLAS_MAX];
+static volatile int16_t zonaMin = 0;
+static volatile uint32_t secuencia = 0;
+static volatile uint16_t marcadas = 0;   // Reglas que hay que revisar (las toca la gestión)
+
+// --- CAMPOS (solo tarea IO) ---
+static int32_t valores[CAMPO_TOTAL];
+static uint16_t validos = 0;
+static uint16_t cambios = 0;
+
+// ---------------------------------------------------------
+// EVALUACIÓN
+// ---------------------------------------------------------
+static int16_t leer16(const uint8_t* p) {
+  return (int16_t)(p[0] | (p[1] << 8));
+}
+
+static bool comparar(int32_t x, uint8_t cmp, int32_t umbral) {
+  switch (cmp) {
+    case CMP_LT: return x < umbral;
+    case CMP_GT: return x > umbral;
+    case CMP_LE: return x <= umbral;
+    case CMP_GE: return x >= umbral;
+    case CMP_EQ: return x == umbral;
+    default: return x != umbral;
+  }
+}
+
+// Una pasada por el código; la histéresis corre el umbral a favor del
+// estado anterior de cada comparación
+static bool evaluar(const Regla& r, EstadoRegla& e) {
+  bool pila[REGLA_PILA_MAX];
+  uint8_t sp = 0, slot = 0;
+  const uint8_t* c = r.codigo;
+  const uint8_t* fin = r.codigo + r.largo;
+
+  while (c < fin) {
+    switch (*c++) {
+      case OP_CMP: {
+        uint8_t campo = c[0], cmp = c[1], hyst = c[4];
+        int32_t umbral = leer16(c + 2);
+        c += 5;
+        bool previo = e.histeresis & (1 << slot);
+        bool res = false;
+        if (validos & (1 << campo)) {
+          if (previo && (cmp == CMP_LT || cmp == CMP_LE)) umbral += hyst;
+          if (previo && (cmp == CMP_GT || cmp == CMP_GE)) umbral -= hyst;
+          res = comparar(valores[campo], cmp, umbral);
+        }
+        if (res) e.histeresis |= (1 << slot);
+        else e.histeresis &= ~(1 << slot);
+        slot++;
+        pila[sp++] = res;
+        break;
+      }
+      case OP_ENTRE: {
+        int32_t ini = leer16(c), finMin = leer16(c + 2);
+        c += 4;
+        bool res = false;
+        if (validos & (1 << CAMPO_HORA)) {
+          int32_t m = ((valores[CAMPO_HORA] + zonaMin) % 1440 + 1440) % 1440;
+          res = ini <= finMin ? (m >= ini && m < finMin) : (m >= ini || m < finMin);
+        }
+        pila[sp++] = res;
+        break;
+      }
+      case OP_Y: sp--; pila[sp - 1] = pila[sp - 1] && pila[sp]; break;
+      case OP_O: sp--; pila[sp - 1] = pila[sp - 1] || pila[sp]; break;
+      case OP_NO: pila[sp - 1] = !pila[sp - 1]; break;
+      default: return false;  // El compilador no lo genera
+    }
+  }
+  return sp == 1 && pila[0];
+}
+
+void reglasDato(CampoRegla campo, int32_t valor) {
+  if (campo >= CAMPO_TOTAL) return;
+  if ((validos & (1 << campo)) && valores[campo] == valor) return;
+  valores[campo] = valor;
+  validos |= (1 << campo);
+  cambios |= (1 << campo);
+}
+
+void reglasPaso(uint32_t ahoraMs, void (*ejecutar)(const ComandoIO& cmd)) {
+  if (!cambios && !marcadas) return;
+
+  uint32_t t0 = micros();
+  ComandoIO acciones[REGLAS_MAX];
+  uint8_t nAcciones = 0;
+  uint8_t evaluadas = 0;
+
+  portENTER_CRITICAL(&muxReglas);
+  uint16_t revisar = marcadas;
+  uint16_t siguen = 0;
+  for (uint8_t i = 0; i < REGLAS_MAX; i++) {
+    Regla& r = tabla[i];
+    EstadoRegla& e = estados[i];
+    if (!r.id || !r.activa || e.oscilo) continue;
+    if (!(r.campos & cambios) && !(revisar & (1 << i))) continue;
+
+    evaluadas++;
+    e.evaluaciones++;
+    bool crudo = evaluar(r, e);
+    if (crudo == e.cumple) {
+      e.pendiente = false;
+      continue;
+    }
+    if (!e.pendiente) {
+      e.pendiente = true;
+      e.desdeMs = ahoraMs;
+    }
+    if (ahoraMs - e.desdeMs < (uint32_t)r.retardoS * 1000) {
+      siguen |= (1 << i);  // Se vuelve a mirar en cada paso hasta que venza
+      continue;
+    }
+
+    e.pendiente = false;
+    e.cumple = crudo;
+    e.disparos++;
+    secuencia++;
+    if (ahoraMs - e.ventanaMs >= 1000) {
+      e.ventanaMs = ahoraMs;
+      e.enVentana = 0;
+    }
+    if (++e.enVentana > REGLAS_OSCILACION) {
+      e.oscilo = true;  // Se pelea consigo misma (o con otra regla)
+      continue;
+    }
+    const AccionRegla& a = crudo ? r.entonces : r.sino;
+    if (a.tipo) acciones[nAcciones++] = { (TipoComandoIO)(a.tipo - 1), (ActuadorId)a.actuador, ORIGEN_REGLA, a.valor };
+  }
+  marcadas = siguen;
+  cambios = 0;
+  portEXIT_CRITICAL(&muxReglas);
+
+  // Las acciones cambian campos de actuadores: se evalúan en el siguiente paso
+  for (uint8_t i = 0; i < nAcciones; i++) ejecutar(acciones[i]);
+  if (evaluadas) metricaLatencia(HIST_REGLAS, micros() - t0);
+}
+
+// ---------------------------------------------------------
+// COMPILADOR
+// ---------------------------------------------------------
+struct Compilador {
+  const char* p;
+  char tok[16];
+  Regla* r;
+  uint8_t profundidad;
+  const char* error;
+};
+
+// Palabras, números, paréntesis y operadores (<, >=, !=...) sin exigir espacios
+static void avanzar(Compilador& c) {
+  while (*c.p == ' ' || *c.p == '\t') c.p++;
+  size_t n = 0;
+  if (*c.p == '(' || *c.p == ')') {
+    c.tok[n++] = *c.p++;
+  } else if (strchr("<>=!", *c.p) && *c.p) {
+    while (*c.p && strchr("<>=!", *c.p) && n < sizeof(c.tok) - 1) c.tok[n++] = *c.p++;
+  } else {
+    while (*c.p && !strchr(" \t()<>=!", *c.p) && n < sizeof(c.tok) - 1) c.tok[n++] = tolower(*c.p++);
+  }
+  c.tok[n] = '\0';
+}
+
+static bool es(Compilador& c, const char* palabra) {
+  return strcmp(c.tok, palabra) == 0;
+}
+
+static bool fallar(Compilador& c, const char* motivo) {
+  if (!c.error) c.error = motivo;
+  return false;
+}
+
+static bool emitir(Compilador& c, const uint8_t* bytes, uint8_t n) {
+  if (c.r->largo + n > REGLA_CODIGO_MAX) return fallar(c, "regla demasiado larga");
+  memcpy(c.r->codigo + c.r->largo, bytes, n);
+  c.r->largo += n;
+  return true;
+}
+
+static bool emitirOp(Compilador& c, uint8_t op) {
+  return emitir(c, &op, 1);
+}
+
+static bool numero(const char* tok, long& out) {
+  char* fin;
+  out = strtol(tok, &fin, 10);
+  return *tok && *fin == '\0';
+}
+
+// "18:30" -> minutos
+static bool horaMinutos(const char* tok, uint16_t& out) {
+  unsigned h, m;
+  char extra;
+  if (sscanf(tok, "%u:%u%c", &h, &m, &extra) != 2 || h > 23 || m > 59) return false;
+  out = h * 60 + m;
+  return true;
+}
+
+static bool expresion(Compilador& c);
+
+// Cada operando deja un bool en la pila
+static bool apilar(Compilador& c) {
+  if (++c.profundidad > REGLA_PILA_MAX) return fallar(c, "expresion demasiado anidada");
+  return true;
+}
+
+static bool factor(Compilador& c) {
+  if (es(c, "not")) {
+    avanzar(c);
+    return factor(c) && emitirOp(c, OP_NO);
+  }
+  if (es(c, "(")) {
+    avanzar(c);
+    if (!expresion(c)) return false;
+    if (!es(c, ")")) return fallar(c, "falta ')'");
+    avanzar(c);
+    return true;
+  }
+  if (es(c, "between")) {
+    uint16_t ini, fin;
+    avanzar(c);
+    if (!horaMinutos(c.tok, ini)) return fallar(c, "between HH:MM HH:MM");
+    avanzar(c);
+    if (!horaMinutos(c.tok, fin)) return fallar(c, "between HH:MM HH:MM");
+    avanzar(c);
+    uint8_t op[5] = { OP_ENTRE, (uint8_t)ini, (uint8_t)(ini >> 8), (uint8_t)fin, (uint8_t)(fin >> 8) };
+    c.r->campos |= (1 << CAMPO_HORA);
+    return apilar(c) && emitir(c, op, sizeof(op));
+  }
+
+  uint8_t campo = 0;
+  while (campo < CAMPO_HORA && !es(c, NOMBRES_CAMPO[campo])) campo++;
+  if (campo == CAMPO_HORA) return fallar(c, "campo desconocido (temp hum luz sats gps relay1-4 lock servo1-3)");
+  avanzar(c);
+
+  uint8_t cmp = 0;
+  while (cmp < 6 && !es(c, NOMBRES_CMP[cmp])) cmp++;
+  if (cmp == 6) return fallar(c, "comparador desconocido (< > <= >= == !=)");
+  avanzar(c);
+
+  long valor, hyst = 0;
+  if (!numero(c.tok, valor) || valor < INT16_MIN || valor > INT16_MAX) return fallar(c, "se esperaba un numero");
+  avanzar(c);
+  if (es(c, "hyst")) {
+    avanzar(c);
+    if (!numero(c.tok, hyst) || hyst < 0 || hyst > 255) return fallar(c, "hyst: 0-255");
+    avanzar(c);
+  }
+  if (c.r->comparaciones >= 8) return fallar(c, "maximo 8 comparaciones");
+  c.r->comparaciones++;
+  c.r->campos |= (1 << campo);
+  uint8_t op[6] = { OP_CMP, campo, cmp, (uint8_t)valor, (uint8_t)((uint16_t)valor >> 8), (uint8_t)hyst };
+  return apilar(c) && emitir(c, op, sizeof(op));
+}
+
+// "and" liga más que "or"; cada operador binario saca un bool de la pila
+static bool termino(Compilador& c) {
+  if (!factor(c)) return false;
+  while (es(c, "and")) {
+    avanzar(c);
+    if (!factor(c) || !emitirOp(c, OP_Y)) return false;
+    c.profundidad--;
+  }
+  return true;
+}
+
+static bool expresion(Compilador& c) {
+  if (!termino(c)) return false;
+  while (es(c, "or")) {
+    avanzar(c);
+    if (!termino(c) || !emitirOp(c, OP_O)) return false;
+    c.profundidad--;
+  }
+  return true;
+}
+
+static bool accion(Compilador& c, AccionRegla& a) {
+  long n = 0;
+  if (es(c, "relay")) {
+    avanzar(c);
+    if (!numero(c.tok, n) || n < 1 || n > 4) return fallar(c, "relay <1-4> on|off");
+    avanzar(c);
+    if (!es(c, "on") && !es(c, "off")) return fallar(c, "relay <1-4> on|off");
+    a = { CMD_IO_ESCRIBIR + 1, (uint8_t)(ACT_RELAY_1 + n - 1), (int16_t)es(c, "on") };
+  } else if (es(c, "lock")) {
+    avanzar(c);
+    if (es(c, "open")) a = { CMD_IO_PULSO_LOCK + 1, ACT_LOCK, 3000 };
+    else if (es(c, "on") || es(c, "off")) a = { CMD_IO_ESCRIBIR + 1, ACT_LOCK, (int16_t)es(c, "on") };
+    else return fallar(c, "lock open|on|off");
+  } else if (es(c, "servo")) {
+    long angulo;
+    avanzar(c);
+    if (!numero(c.tok, n) || n < 1 || n > 3) return fallar(c, "servo <1-3> <0-180>");
+    avanzar(c);
+    if (!numero(c.tok, angulo) || angulo < 0 || angulo > 180) return fallar(c, "servo <1-3> <0-180>");
+    a = { CMD_IO_ESCRIBIR + 1, (uint8_t)(ACT_SERVO_1 + n - 1), (int16_t)angulo };
+  } else {
+    return fallar(c, "accion: relay, lock o servo");
+  }
+  avanzar(c);
+  return true;
+}
+
+// "10", "10s", "5m", "1h" -> segundos
+static bool duracion(const char* tok, uint16_t& out) {
+  char* fin;
+  unsigned long n = strtoul(tok, &fin, 10);
+  if (fin == tok) return false;
+  if (*fin == 'm') n *= 60;
+  else if (*fin == 'h') n *= 3600;
+  else if (*fin && strcmp(fin, "s") != 0) return false;
+  if (n > 65535) return false;
+  out = n;
+  return true;
+}
+
+bool reglasCompilar(const char* texto, Regla& out, char* error, size_t cap) {
+  memset(&out, 0, sizeof(out));
+  Compilador c = { texto, "", &out, 0, nullptr };
+  avanzar(c);
+
+  long id;
+  if (!numero(c.tok, id) || id < 1 || id > 255) fallar(c, "id 1-255");
+  else {
+    out.id = id;
+    out.activa = 1;
+    avanzar(c);
+    if (expresion(c)) {
+      if (es(c, "for")) {
+        avanzar(c);
+        if (duracion(c.tok, out.retardoS)) avanzar(c);
+        else fallar(c, "for <segundos> (10, 10s, 5m)");
+      }
+      if (!c.error && !es(c, "then")) fallar(c, "falta 'then'");
+      if (!c.error) {
+        avanzar(c);
+        if (accion(c, out.entonces) && es(c, "else")) {
+          avanzar(c);
+          accion(c, out.sino);
+        }
+      }
+      if (!c.error && c.tok[0]) fallar(c, "sobra texto al final");
+    }
+  }
+
+  if (c.error) {
+    snprintf(error, cap, "%s (en '%s')", c.error, c.tok);
+    return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------
+// DESCOMPILADOR
+// ---------------------------------------------------------
+static void textoAccion(const AccionRegla& a, char* buf, size_t cap) {
+  if (a.tipo == CMD_IO_PULSO_LOCK + 1) snprintf(buf, cap, "lock open");
+  else if (a.actuador <= ACT_RELAY_4) snprintf(buf, cap, "relay %d %s", a.actuador - ACT_RELAY_1 + 1, a.valor ? "on" : "off");
+  else if (a.actuador == ACT_LOCK) snprintf(buf, cap, "lock %s", a.valor ? "on" : "off");
+  else snprintf(buf, cap, "servo %d %d", a.actuador - ACT_SERVO_1 + 1, a.valor);
+}
+
+// La pila de textos (1.3 KB) es estática: la comparten "rule list" (AsyncTCP)
+// y rules/state (tarea de red), que en Híbrido pueden coincidir
+static SemaphoreHandle_t mutexTexto = nullptr;
+static char pila[REGLA_PILA_MAX][REGLA_TEXTO_MAX];
+
+// Vuelve a infijo con una pila de textos; el paréntesis solo donde hace falta
+static size_t descompilar(const Regla& r, char* buf, size_t cap) {
+  uint8_t prec[REGLA_PILA_MAX];   // 0 átomo, 1 and, 2 or
+  uint8_t sp = 0;
+  char tmp[REGLA_TEXTO_MAX];
+  const uint8_t* c = r.codigo;
+  const uint8_t* fin = r.codigo + r.largo;
+
+  while (c < fin) {
+    uint8_t op = *c++;
+    if (op == OP_CMP) {
+      if (c[4]) snprintf(pila[sp], REGLA_TEXTO_MAX, "%s %s %d hyst %u", NOMBRES_CAMPO[c[0]], NOMBRES_CMP[c[1]], leer16(c + 2), c[4]);
+      else snprintf(pila[sp], REGLA_TEXTO_MAX, "%s %s %d", NOMBRES_CAMPO[c[0]], NOMBRES_CMP[c[1]], leer16(c + 2));
+      prec[sp++] = 0;
+      c += 5;
+    } else if (op == OP_ENTRE) {
+      int16_t ini = leer16(c), f = leer16(c + 2);
+      snprintf(pila[sp], REGLA_TEXTO_MAX, "between %02d:%02d %02d:%02d", ini / 60, ini % 60, f / 60, f % 60);
+      prec[sp++] = 0;
+      c += 4;
+    } else if (op == OP_NO && sp >= 1) {
+      snprintf(tmp, sizeof(tmp), prec[sp - 1] ? "not (%s)" : "not %s", pila[sp - 1]);
+      strlcpy(pila[sp - 1], tmp, REGLA_TEXTO_MAX);
+      prec[sp - 1] = 0;
+    } else if ((op == OP_Y || op == OP_O) && sp >= 2) {
+      uint8_t p = op == OP_Y ? 1 : 2;
+      const char* conector = op == OP_Y ? "and" : "or";
+      // El derecho se agrupa si liga igual o menos (la evaluación es por la izquierda)
+      bool izq = prec[sp - 2] > p, der = prec[sp - 1] >= p;
+      snprintf(tmp, sizeof(tmp), "%s%s%s %s %s%s%s", izq ? "(" : "", pila[sp - 2], izq ? ")" : "", conector,
+               der ? "(" : "", pila[sp - 1], der ? ")" : "");
+      strlcpy(pila[sp - 2], tmp, REGLA_TEXTO_MAX);
+      prec[sp - 2] = p;
+      sp--;
+    }
+  }
+
+  size_t n = snprintf(buf, cap, "%u %s", r.id, pila[0]);
+  if (r.retardoS && n < cap) n += snprintf(buf + n, cap - n, " for %us", r.retardoS);
+  char a[24];
+  textoAccion(r.entonces, a, sizeof(a));
+  if (n < cap) n += snprintf(buf + n, cap - n, " then %s", a);
+  if (r.sino.tipo && n < cap) {
+    textoAccion(r.sino, a, sizeof(a));
+    n += snprintf(buf + n, cap - n, " else %s", a);
+  }
+  return min(n, cap - 1);
+}
+
+size_t reglasTexto(const Regla& r, char* buf, size_t cap) {
+  xSemaphoreTake(mutexTexto, portMAX_DELAY);
+  size_t n = descompilar(r, buf, cap);
+  xSemaphoreGive(mutexTexto);
+  return n;
+}
+
+// ---------------------------------------------------------
+// TABLA Y NVS
+// ---------------------------------------------------------
+static void claveNvs(uint8_t id, char* clave) {
+  snprintf(clave, 8, "r%u", id);
+}
+
+// Lo leído de NVS se recorre una vez antes de confiar en ello
+static bool verificar(const Regla& r) {
+  if (r.largo > REGLA_CODIGO_MAX || !r.largo) return false;
+  int sp = 0;
+  for (uint8_t i = 0; i < r.largo;) {
+    switch (r.codigo[i]) {
+      case OP_CMP:
+        if (i + 6 > r.largo || r.codigo[i + 1] >= CAMPO_HORA || r.codigo[i + 2] > CMP_NE) return false;
+        sp++;
+        i += 6;
+        break;
+      case OP_ENTRE:
+        if (i + 5 > r.largo) return false;
+        sp++;
+        i += 5;
+        break;
+      case OP_Y:
+      case OP_O:
+        if (--sp < 1) return false;
+        i++;
+        break;
+      case OP_NO:
+        if (sp < 1) return false;
+        i++;
+        break;
+      default:
+        return false;
+    }
+    if (sp > REGLA_PILA_MAX) return false;
+  }
+  return sp == 1;
+}
+
+static void guardar(const Regla& r) {
+  Preferences prefs;
+  char clave[8];
+  claveNvs(r.id, clave);
+  prefs.begin(NVS_ESPACIO, false);
+  prefs.putBytes(clave, &r, CABECERA + r.largo);
+  prefs.end();
+}
+
+static void olvidar(uint8_t id) {
+  Preferences prefs;
+  char clave[8];
+  claveNvs(id, clave);
+  prefs.begin(NVS_ESPACIO, false);
+  prefs.remove(clave);
+  prefs.end();
+}
+
+// Instala en la tabla (mismo id: la reemplaza). false si no cabe.
+static bool instalar(const Regla& r) {
+  bool ok = false;
+  portENTER_CRITICAL(&muxReglas);
+  int libre = -1;
+  for (int i = 0; i < REGLAS_MAX && !ok; i++) {
+    if (tabla[i].id == r.id) libre = i, ok = true;
+    else if (!tabla[i].id && libre < 0) libre = i;
+  }
+  if (libre >= 0) {
+    tabla[libre] = r;
+    estados[libre] = {};
+    marcadas |= (1 << libre);  // Se evalúa con los valores actuales
+    secuencia++;
+    ok = true;
+  }
+  portEXIT_CRITICAL(&muxReglas);
+  return ok;
+}
+
+void reglasIniciar() {
+  if (!mutexTexto) mutexTexto = xSemaphoreCreateMutex();
+  Regla r;
+  char clave[8];
+  memset(tabla, 0, sizeof(tabla));
+  memset(estados, 0, sizeof(estados));
+  memset(valores, 0, sizeof(valores));
+  validos = cambios = marcadas = 0;
+
+  Preferences prefs;
+  prefs.begin(NVS_ESPACIO, true);
+  zonaMin = prefs.getInt("zona", 0);
+  for (uint16_t id = 1; id <= 255; id++) {
+    claveNvs(id, clave);
+    size_t n = prefs.getBytesLength(clave);
+    // Descarta lo que no cuadre (p. ej. una versión anterior del formato)
+    if (n < CABECERA || n > sizeof(Regla) || prefs.getBytes(clave, &r, sizeof(r)) != n) continue;
+    if (r.id != id || CABECERA + r.largo != n || !verificar(r)) continue;
+    instalar(r);
+  }
+  prefs.end();
+}
+
+static int indiceDe(uint8_t id) {
+  for (int i = 0; i < REGLAS_MAX; i++) {
+    if (tabla[i].id == id) return i;
+  }
+  return -1;
+}
+
+bool reglasComando(const char* linea, char* resp, size_t cap) {
+  while (*linea == ' ') linea++;
+  char orden[8] = "";
+  size_t n = 0;
+  while (linea[n] && linea[n] != ' ' && n < sizeof(orden) - 1) {
+    orden[n] = tolower(linea[n]);
+    n++;
+  }
+  orden[n] = '\0';
+  const char* resto = linea + n;
+  long id = strtol(resto, nullptr, 10);
+
+  if (strcmp(orden, "add") == 0) {
+    Regla r;
+    char error[96];
+    if (!reglasCompilar(resto, r, error, sizeof(error))) {
+      snprintf(resp, cap, "Error: %s", error);
+      return false;
+    }
+    if (!instalar(r)) {
+      snprintf(resp, cap, "Error: maximo %d reglas", REGLAS_MAX);
+      return false;
+    }
+    guardar(r);
+    snprintf(resp, cap, "OK: regla %u (%u bytes)", r.id, (unsigned)(CABECERA + r.largo));
+    return true;
+  }
+
+  if (strcmp(orden, "del") == 0 || strcmp(orden, "on") == 0 || strcmp(orden, "off") == 0) {
+    Regla copia;
+    bool existe;
+    portENTER_CRITICAL(&muxReglas);
+    int i = indiceDe(id);
+    existe = id > 0 && i >= 0;
+    if (existe) {
+      if (orden[0] == 'd') tabla[i].id = 0;
+      else {
+        tabla[i].activa = strcmp(orden, "on") == 0;
+        estados[i] = {};  // Reactivar limpia también la oscilación
+        marcadas |= (1 << i);
+      }
+      copia = tabla[i];
+      secuencia++;
+    }
+    portEXIT_CRITICAL(&muxReglas);
+    if (!existe) {
+      snprintf(resp, cap, "Error: no existe la regla %ld", id);
+      return false;
+    }
+    if (orden[0] == 'd') olvidar(id);
+    else guardar(copia);
+    snprintf(resp, cap, "OK: regla %ld %s", id, orden[0] == 'd' ? "borrada" : copia.activa ? "activa" : "inactiva");
+    return true;
+  }
+
+  if (strcmp(orden, "clear") == 0) {
+    portENTER_CRITICAL(&muxReglas);
+    memset(tabla, 0, sizeof(tabla));
+    secuencia++;
+    portEXIT_CRITICAL(&muxReglas);
+    Preferences prefs;
+    prefs.begin(NVS_ESPACIO, false);
+    int32_t zona = zonaMin;
+    prefs.clear();
+    if (zona) prefs.putInt("zona", zona);
+    prefs.end();
+    snprintf(resp, cap, "OK: reglas borradas");
+    return true;
+  }
+
+  if (strcmp(orden, "tz") == 0) {
+    float horas = atof(resto);
+    if (horas < -12 || horas > 14) {
+      snprintf(resp, cap, "Error: tz <horas> (-12 a 14)");
+      return false;
+    }
+    zonaMin = (int16_t)lroundf(horas * 60);
+    Preferences prefs;
+    prefs.begin(NVS_ESPACIO, false);
+    prefs.putInt("zona", zonaMin);
+    prefs.end();
+    portENTER_CRITICAL(&muxReglas);
+    marcadas = 0xFFFF;  // Las franjas horarias cambian de golpe
+    portEXIT_CRITICAL(&muxReglas);
+    snprintf(resp, cap, "OK: zona UTC%+.1f", horas);
+    return true;
+  }
+
+  snprintf(resp, cap, "Error: rule add|del|on|off|clear|tz|list");
+  return false;
+}
+
+// ---------------------------------------------------------
+// SALIDA
+// ---------------------------------------------------------
+// Copia de una regla y su estado (para descompilar fuera del spinlock)
+static bool copiar(uint8_t i, Regla& r, EstadoRegla& e) {
+  portENTER_CRITICAL(&muxReglas);
+  r = tabla[i];
+  e = estados[i];
+  portEXIT_CRITICAL(&muxReglas);
+  return r.id != 0;
+}
+
+void reglasImprimir(Print& out) {
+  char texto[REGLA_TEXTO_MAX];
+  uint8_t n = 0;
+  out.printf("--- REGLAS (zona UTC%+.1f) ---\n", zonaMin / 60.0);
+  for (uint8_t i = 0; i < REGLAS_MAX; i++) {
+    Regla r;
+    EstadoRegla e;
+    if (!copiar(i, r, e)) continue;
+    n++;
+    reglasTexto(r, texto, sizeof(texto));
+    out.println(texto);
+    out.printf("  %s, %s, %lu disparos, %lu evaluaciones, %u bytes\n",
+               e.oscilo ? "DESACTIVADA (oscila)" : r.activa ? "activa" : "inactiva",
+               e.cumple ? "cumple" : "no cumple", (unsigned long)e.disparos, (unsigned long)e.evaluaciones,
+               (unsigned)(CABECERA + r.largo));
+  }
+  if (!n) out.println("Sin reglas: rule add <id> <condicion> then <accion>");
+}
+
+size_t reglasJson(char* buf, size_t cap) {
+  char texto[REGLA_TEXTO_MAX];
+  size_t n = snprintf(buf, cap, "[");
+  bool primero = true;
+  for (uint8_t i = 0; i < REGLAS_MAX && n < cap; i++) {
+    Regla r;
+    EstadoRegla e;
+    if (!copiar(i, r, e)) continue;
+    reglasTexto(r, texto, sizeof(texto));
+    n += snprintf(buf + n, cap - n, "%s{\"id\":%u,\"regla\":\"%s\",\"activa\":%s,\"cumple\":%s,\"disparos\":%lu}",
+                  primero ? "" : ",", r.id, texto, r.activa && !e.oscilo ? "true" : "false",
+                  e.cumple ? "true" : "false", (unsigned long)e.disparos);
+    primero = false;
+  }
+  if (n < cap) n += snprintf(buf + n, cap - n, "]");
+  return n < cap ? n : 0;
+}
+
+uint32_t reglasSecuencia() {
+  return secuencia;
+}
@@ -0,0 +1,96 @@
+#ifndef REGLAS_H
+#define REGLAS_H
+
+#include <Arduino.h>
+#include "messages.h"
+
+/* =======================
+   REGLAS LOCALES
+   =======================
+   Automatizaciones que resuelve la propia placa, sin ida y vuelta a
+   Node-RED y aunque no haya internet. El texto de cada regla se compila
+   a un bytecode postfijo de pocas decenas de bytes que se guarda en NVS
+   (una clave por regla) y se evalúa en la tarea IO.
+
+   Por eventos: una regla solo se revisa cuando cambia un campo que lee,
+   mientras corre su retardo ("for") o, con franja horaria, al cambiar el
+   minuto. Las acciones van en los flancos: "then" al empezar a cumplirse
+   y "else" al dejar de cumplirse, así una orden manual no se pisa
+   mientras la condición siga igual.
+
+     <id> <condición> [for <dur>] then <acción> [else <acción>]
+     condición: <campo> <op> <n> [hyst <n>] | between HH:MM HH:MM
+                | not c | c and c | c or c | ( c )
+     campo:     temp hum luz sats gps relay1-4 lock servo1-3
+     op:        < > <= >= == !=
+     acción:    relay <1-4> on|off | lock open|on|off | servo <1-3> <0-180>
+
+   Ejemplo: 1 luz < 20 hyst 5 for 10s then relay 1 on else relay 1 off */
+
+#define REGLAS_MAX          16
+#define REGLA_CODIGO_MAX    40     // Bytes de bytecode por regla
+#define REGLA_PILA_MAX      8      // Profundidad de la expresión
+#define REGLA_TEXTO_MAX     160    // Regla descompilada
+#define REGLAS_OSCILACION   10     // Disparos en 1 s que desactivan la regla
+
+enum CampoRegla : uint8_t {
+  CAMPO_TEMP,     // °C
+  CAMPO_HUM,      // %
+  CAMPO_LUZ,      // %
+  CAMPO_SATS,
+  CAMPO_GPS,      // 1 con fix
+  CAMPO_RELAY1,   // Actuadores: mismo orden que ActuadorId
+  CAMPO_RELAY2,
+  CAMPO_RELAY3,
+  CAMPO_RELAY4,
+  CAMPO_LOCK,
+  CAMPO_SERVO1,
+  CAMPO_SERVO2,
+  CAMPO_SERVO3,
+  CAMPO_HORA,     // Minuto del día UTC (GPS); "between" le suma la zona
+  CAMPO_TOTAL
+};
+
+// tipo: TipoComandoIO + 1 (0 = sin acción)
+struct AccionRegla {
+  uint8_t tipo;
+  uint8_t actuador;
+  int16_t valor;
+};
+
+// Lo que se guarda en NVS: cabecera fija + 'largo' bytes de código
+struct Regla {
+  uint8_t id;           // 0 = hueco libre
+  uint8_t activa;
+  uint8_t largo;
+  uint8_t comparaciones;
+  uint16_t retardoS;
+  uint16_t campos;      // Máscara de CampoRegla que lee
+  AccionRegla entonces;
+  AccionRegla sino;
+  uint8_t codigo[REGLA_CODIGO_MAX];
+};
+
+void reglasIniciar();   // Carga de NVS (en iniciarIO)
+
+// --- Tarea IO ---
+// Valor nuevo de un campo; solo marca las reglas afectadas si cambió
+void reglasDato(CampoRegla campo, int32_t valor);
+// Evalúa lo marcado y ejecuta las acciones fuera de la sección crítica
+void reglasPaso(uint32_t ahoraMs, void (*ejecutar)(const ComandoIO& cmd));
+
+// --- Gestión (cualquier otra tarea) ---
+// Texto -> bytecode, sin instalarla. false con el motivo en 'error'.
+bool reglasCompilar(const char* texto, Regla& out, char* error, size_t cap);
+// Descompila a la forma canónica (lo que muestra "rule list")
+size_t reglasTexto(const Regla& r, char* buf, size_t cap);
+
+// "add <regla>", "del <id>", "on|off <id>", "clear", "tz <horas>".
+// Deja la respuesta en 'resp'; false si la orden no se aplicó.
+bool reglasComando(const char* linea, char* resp, size_t cap);
+
+void reglasImprimir(Print& out);
+size_t reglasJson(char* buf, size_t cap);   // orion/rules/state
+uint32_t reglasSecuencia();                 // Sube con cada cambio o disparo
+
+#endif
@@ -0,0 +1,104 @@
+#include "reloj.h"
+#include "metrics.h"
+#include <esp_timer.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
+
+// La escribe el callback del SNTP (tarea de lwIP); la leen red y consola
+static portMUX_TYPE muxReloj = portMUX_INITIALIZER_UNLOCKED;
+static bool iniciado = false;
+static bool sincronizado = false;
+static uint64_t baseMonoUs = 0;   // Instante monotónico de la última sincronización
+static int64_t baseUtcUs = 0;     // Hora NTP en ese instante
+static int32_t derivaPpb = 0;     // > 0: el monotónico adelanta
+static bool derivaMedida = false;
+static int32_t desfaseUs = 0;     // NTP menos lo previsto en la última sincronización
+static uint32_t sincronizaciones = 0;
+
+// Dentro de muxReloj
+static int64_t utcDe(uint64_t monoUs) {
+  int64_t transcurrido = (int64_t)(monoUs - baseMonoUs);
+  return baseUtcUs + transcurrido - transcurrido * derivaPpb / 1000000000LL;
+}
+
+static void alSincronizar(struct timeval* tv) {
+  uint64_t monoUs = (uint64_t)esp_timer_get_time();
+  int64_t utcUs = (int64_t)tv->tv_sec * 1000000LL + tv->tv_usec;
+
+  portENTER_CRITICAL(&muxReloj);
+  if (sincronizado) {
+    int64_t desfase = utcUs - utcDe(monoUs);
+    if (desfase > INT32_MAX) desfase = INT32_MAX;
+    if (desfase < INT32_MIN) desfase = INT32_MIN;
+    desfaseUs = (int32_t)desfase;
+
+    int64_t transcurrido = (int64_t)(monoUs - baseMonoUs);
+    if (transcurrido >= (int64_t)RELOJ_DERIVA_MIN_S * 1000000LL) {
+      int64_t diferencia = transcurrido - (utcUs - baseUtcUs);
+      if (llabs(diferencia) <= transcurrido / (1000000000LL / RELOJ_DERIVA_MAX_PPB)) {
+        int64_t medida = diferencia * 1000000000LL / transcurrido;
+        // Promedio móvil: una sincronización con mucho jitter no mueve todo
+        derivaPpb = derivaMedida ? (int32_t)((3LL * derivaPpb + medida) / 4) : (int32_t)medida;
+        derivaMedida = true;
+      }
+    }
+  }
+  baseMonoUs = monoUs;
+  baseUtcUs = utcUs;
+  sincronizado = true;
+  sincronizaciones++;
+  portEXIT_CRITICAL(&muxReloj);
+
+  metricaFijar(MED_RELOJ_DESFASE, desfaseUs);
+  metricaFijar(MED_RELOJ_DERIVA, derivaPpb);
+}
+
+void relojIniciar(const char* tz, const char* ntp1, const char* ntp2) {
+  if (iniciado) return;
+  iniciado = true;
+  sntp_set_time_sync_notification_cb(alSincronizar);
+  sntp_set_sync_interval(RELOJ_NTP_INTERVALO_MS);
+  configTzTime(tz, ntp1, ntp2);
+}
+
+uint64_t relojMonoUs() {
+  return (uint64_t)esp_timer_get_time();
+}
+
+bool relojSincronizado() {
+  return sincronizado;
+}
+
+bool relojUtcMs(uint64_t monoUs, uint64_t& utcMs) {
+  portENTER_CRITICAL(&muxReloj);
+  bool ok = sincronizado;
+  int64_t utcUs = ok ? utcDe(monoUs) : 0;
+  portEXIT_CRITICAL(&muxReloj);
+  if (ok) utcMs = (uint64_t)(utcUs / 1000);
+  return ok;
+}
+
+void relojImprimir(Print& out) {
+  portENTER_CRITICAL(&muxReloj);
+  bool ok = sincronizado;
+  uint64_t base = baseMonoUs;
+  uint32_t n = sincronizaciones;
+  int32_t desfase = desfaseUs;
+  int32_t deriva = derivaPpb;
+  bool medida = derivaMedida;
+  portEXIT_CRITICAL(&muxReloj);
+
+  out.println("--- RELOJ ---");
+  if (!ok) {
+    out.println(iniciado ? "Esperando NTP (las muestras guardan su hora monotonica)" : "NTP sin arrancar");
+    return;
+  }
+  uint64_t ahoraMs = 0;
+  relojUtcMs(relojMonoUs(), ahoraMs);
+  out.printf("UTC %llu ms\n", (unsigned long long)ahoraMs);
+  out.printf("NTP: %lu sincronizaciones, ultima hace %lu s\n", (unsigned long)n,
+             (unsigned long)((relojMonoUs() - base) / 1000000));
+  out.printf("Desfase al sincronizar: %ld us\n", (long)desfase);
+  if (medida) out.printf("Deriva: %ld ppb\n", (long)deriva);
+  else out.printf("Deriva: sin medir (hace falta %d s entre sincronizaciones)\n", RELOJ_DERIVA_MIN_S);
+}
@@ -0,0 +1,32 @@
+#ifndef RELOJ_H
+#define RELOJ_H
+
+#include <Arduino.h>
+
+/* =======================
+   RELOJ
+   =======================
+   Cada muestra se marca al adquirirla con esp_timer_get_time(): monotónico,
+   no salta ni espera al NTP. El SNTP de ESP-IDF corre en segundo plano y en
+   cada sincronización entrega su hora; con ella se fija la correspondencia
+   monotónico -> UTC y, entre dos sincronizaciones, la deriva del cristal.
+   Una muestra tomada antes de la primera sincronización se convierte en
+   cuanto la hay: queda con la hora en que se tomó, no con la del envío. */
+
+#define RELOJ_NTP_INTERVALO_MS 3600000UL   // Resincronización del SNTP
+#define RELOJ_DERIVA_MIN_S     600         // Menos tiempo: el error del NTP tapa la deriva
+#define RELOJ_DERIVA_MAX_PPB   500000      // 500 ppm: más es un salto del servidor, no deriva
+
+// Arranca el SNTP (una vez por arranque; las demás llamadas no hacen nada).
+// No bloquea: la hora llega sola unos cientos de ms o segundos después.
+void relojIniciar(const char* tz, const char* ntp1, const char* ntp2 = nullptr);
+
+uint64_t relojMonoUs();        // Marca de una muestra
+bool relojSincronizado();
+
+// UTC (ms desde 1970) del instante 'monoUs'; false mientras no haya NTP
+bool relojUtcMs(uint64_t monoUs, uint64_t& utcMs);
+
+void relojImprimir(Print& out);
+
+#endif
@@ -0,0 +1,143 @@
+#include "tasks.h"
+#include "ui_task.h"
+#include "net_task.h"
+#include "io_task.h"
+#include "bus_i2c.h"
+#include "metrics.h"
+#include "energia.h"
+#include <esp_task_wdt.h>
+
+struct InfoTarea {
+  const char* nombre;
+  void (*paso)();
+  uint32_t periodoMs;
+  uint32_t pila;
+  UBaseType_t prioridad;
+  BaseType_t core;
+  HistogramaId histograma;  // Duración de cada paso
+  TaskHandle_t handle;
+  volatile uint32_t pilaLibre;  // Mínimo histórico (bytes)
+  bool avisado;
+};
+
+// IO con mayor prioridad: no debe perder bytes del GPS ni retrasar actuadores.
+// Red en el core 0, junto a la pila WiFi/LwIP. I2C pasa el rato esperando al bus.
+static InfoTarea tareas[TAREA_TOTAL] = {
+  { "ui",  pasoTareaUI,  UI_PERIODO_MS,  TAREA_UI_PILA,  2, 1, HIST_PASO_UI,  nullptr, 0, false },
+  { "red", pasoTareaRed, RED_PERIODO_MS, TAREA_RED_PILA, 1, 0, HIST_PASO_RED, nullptr, 0, false },
+  { "io",  pasoTareaIO,  IO_PERIODO_MS,  TAREA_IO_PILA,  3, 1, HIST_PASO_IO,  nullptr, 0, false },
+  { "i2c", pasoTareaI2C, I2C_PERIODO_MS, TAREA_I2C_PILA, 2, 1, HIST_PASO_I2C, nullptr, 0, false },
+};
+
+// Revisión de pila cada N pasos (uxTaskGetStackHighWaterMark recorre la pila)
+#define PILA_REVISION_PASOS 100
+
+// ---------------------------------------------------------
+// CUERPO COMÚN DE LAS TAREAS
+// ---------------------------------------------------------
+static void revisarPila(InfoTarea* t) {
+  // En ESP32 StackType_t es de 1 byte: el valor ya viene en bytes
+  t->pilaLibre = uxTaskGetStackHighWaterMark(nullptr);
+  if (t->pilaLibre < PILA_MIN_AVISO && !t->avisado) {
+    t->avisado = true;
+    Serial.print("AVISO pila baja en tarea ");
+    Serial.print(t->nombre);
+    Serial.print(": ");
+    Serial.println(t->pilaLibre);
+  }
+}
+
+static void cuerpoTarea(void* arg) {
+  InfoTarea* t = (InfoTarea*)arg;
+  esp_task_wdt_add(nullptr);
+
+  TickType_t ultimoDespertar = xTaskGetTickCount();
+  const TickType_t periodo = pdMS_TO_TICKS(t->periodoMs);
+  uint32_t pasos = 0;
+
+  for (;;) {
+    uint32_t t0 = micros();
+    t->paso();
+    uint32_t t1 = micros();
+    metricaLatencia(t->histograma, t1 - t0);
+    esp_task_wdt_reset();
+
+    if (++pasos >= PILA_REVISION_PASOS) {
+      pasos = 0;
+      revisarPila(t);
+    }
+
+    // Bajo consumo: hasta lo próximo agendado; tareaDespertar() lo adelanta
+    // Después de la espera: el paso cuenta con el cerrojo del GPS ya soltado
+    uint32_t esperaMs = energiaEsperaMs((TareaId)(t - tareas), t->periodoMs);
+    energiaContarPaso(t0, t1);
+    if (esperaMs > t->periodoMs) {
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(esperaMs));
+      ultimoDespertar = xTaskGetTickCount();
+    }
+    // Un paso largo (red bloqueada) no acumula despertares atrasados
+    else if (xTaskGetTickCount() - ultimoDespertar >= periodo) {
+      metricaContar(CNT_PASOS_ATRASADOS);
+      ultimoDespertar = xTaskGetTickCount();
+      vTaskDelay(1);
+    } else {
+      vTaskDelayUntil(&ultimoDespertar, periodo);
+    }
+  }
+}
+
+// ---------------------------------------------------------
+// API PUBLICA
+// ---------------------------------------------------------
+void iniciarTareas() {
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+  // En el core 3.x el watchdog ya está iniciado: solo se reconfigura
+  esp_task_wdt_config_t wdtCfg = {
+    .timeout_ms = WDT_TIMEOUT_S * 1000,
+    .idle_core_mask = 0,
+    .trigger_panic = true
+  };
+  esp_task_wdt_reconfigure(&wdtCfg);
+#else
+  esp_task_wdt_init(WDT_TIMEOUT_S, true);
+#endif
+
+  i2cCederBus();
+  for (int i = 0; i < TAREA_TOTAL; i++) {
+    InfoTarea* t = &tareas[i];
+    t->pilaLibre = t->pila;
+    xTaskCreatePinnedToCore(cuerpoTarea, t->nombre, t->pila, t, t->prioridad, &t->handle, t->core);
+  }
+}
+
+void tareaLatido() {
+  esp_task_wdt_reset();
+}
+
+void tareaDespertar(TareaId id) {
+  if (id < TAREA_TOTAL && tareas[id].handle) xTaskNotifyGive(tareas[id].handle);
+}
+
+void IRAM_ATTR tareaDespertarDesdeISR(TareaId id) {
+  if (id >= TAREA_TOTAL || !tareas[id].handle) return;
+  BaseType_t cambiar = pdFALSE;
+  vTaskNotifyGiveFromISR(tareas[id].handle, &cambiar);
+  if (cambiar) portYIELD_FROM_ISR();
+}
+
+uint32_t tareaPilaLibre(TareaId id) {
+  if (id >= TAREA_TOTAL) return 0;
+  return tareas[id].pilaLibre;
+}
+
+void tareasReportarPilas() {
+  for (int i = 0; i < TAREA_TOTAL; i++) {
+    Serial.print(tareas[i].nombre);
+    Serial.print(" core ");
+    Serial.print(tareas[i].core);
+    Serial.print(" pila libre ");
+    Serial.print(tareas[i].pilaLibre);
+    Serial.print("/");
+    Serial.println(tareas[i].pila);
+  }
+}
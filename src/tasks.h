@@ -0,0 +1,54 @@
+#ifndef TASKS_H
+#define TASKS_H
+
+#include <Arduino.h>
+
+/* =======================
+   TAREAS FREERTOS
+   =======================
+   UI   (core 1): botones, potenciómetro, OLED y máquina UIState
+   Red  (core 0): WiFi, MQTT, InfluxDB y servidor local
+   IO   (core 1): sensores, GPS y actuadores
+   I2C  (core 1): dueña del bus de la OLED y de los sensores de expansión
+
+   Cada tarea es un bucle que llama a su pasoTareaX() y duerme su periodo
+   (o más, en bajo consumo: energia.h). */
+
+enum TareaId : uint8_t {
+  TAREA_UI,
+  TAREA_RED,
+  TAREA_IO,
+  TAREA_I2C,
+  TAREA_TOTAL
+};
+
+// Pila (bytes) por tarea
+#define TAREA_UI_PILA  4096
+#define TAREA_RED_PILA 8192  // TLS/HTTP de Influx y JSON de discovery
+#define TAREA_IO_PILA  4096  // LittleFS de la captura
+#define TAREA_I2C_PILA 3072
+
+// Timeout del watchdog. Cubre el peor bloqueo de red (connect/writePoint).
+#define WDT_TIMEOUT_S 30
+
+// Por debajo de esta pila libre (bytes) se avisa por Serial
+#define PILA_MIN_AVISO 512
+
+// Crea las tareas, las suscribe al watchdog. Llamar al final de setup().
+void iniciarTareas();
+
+// Alimenta el watchdog de la tarea actual. Para esperas largas dentro de un paso.
+void tareaLatido();
+
+// Adelanta el próximo paso de una tarea que duerme más que su periodo
+// (bajo consumo). Quien le deja trabajo en una cola la despierta.
+void tareaDespertar(TareaId id);
+void tareaDespertarDesdeISR(TareaId id);
+
+// Mínimo histórico de pila libre (bytes) de cada tarea
+uint32_t tareaPilaLibre(TareaId id);
+
+// Imprime nombre, core y pila libre de cada tarea por Serial
+void tareasReportarPilas();
+
+#endif
@@ -3,27 +3,10 @@
 #include <Arduino.h>
 #include <Wire.h>
 
-// Librerías de Hardware
-#include <DHT11.h>
-#include <ESP32Servo.h>
-#include <TinyGPS++.h>
-
-// --- DEFINICIÓN DE HARDWARE (Idéntico a local_server) ---
-#define PIN_RELAY_1 26
-#define PIN_RELAY_2 27
-#define PIN_RELAY_3 14
-#define PIN_RELAY_4 12
-#define PIN_LOCK    13
-
-#define PIN_DHT     23
-#define PIN_LDR     34 // Potenciometro está en 35, LDR en 34
-
-#define PIN_GPS_RX  16
-#define PIN_GPS_TX  17
-
-#define PIN_SERVO_1 15
-#define PIN_SERVO_2 2
-#define PIN_SERVO_3 4
+// Los actuadores y sensores los maneja la tarea IO
+#include "io_task.h"
+#include "autotest.h"
+#include "bus_i2c.h"
 
 #define POT_PIN     35 // Para navegar el menú
 
@@ -37,16 +20,26 @@ extern bool redrawMenu;             // Para forzar redibujado en Main
 // --- OBJETOS GLOBALES LOCALES ---
 Adafruit_SSD1306* tDisplay;
 const char* testMenuItems[] = {
+  "Autodiagnostico",
   "Test Relays",
   "Test Cerradura",
-  "Test DHT",
+  "Test Sensores",
   "Test GPS",
   "Test Servos",
+  "Ver Reporte",
   "Volver Atras"
 };
-const int TEST_MENU_SIZE = 6;
+// Fases del autodiagnóstico por elemento (0 = no es un test)
+const uint8_t testMenuFases[] = { AT_COMPLETO, AT_RELES, AT_CERRADURA, AT_DHT | AT_LDR, AT_GPS, AT_SERVOS, 0, 0 };
+const int TEST_MENU_SIZE = 8;
+const int TEST_MENU_VISIBLES = 6;
 int testIndex = 0;
 
+// Lo que muestra la pantalla de test
+enum PantallaTest { PANT_MENU, PANT_CORRIENDO, PANT_RESULTADO };
+PantallaTest pantallaTest = PANT_MENU;
+unsigned long ultimoDibujoTest = 0;
+
 // --- FUNCIONES AUXILIARES DE LECTURA POT ---
 int leerPotTest() {
   static int filtered = 0;
@@ -70,175 +63,86 @@ int leerIndiceTest(int items) {
 }
 
 // ---------------------------------------------------------
-// FUNCIONES DE TEST INDIVIDUALES
+// PANTALLAS DEL AUTODIAGNÓSTICO (la máquina vive en autotest.cpp)
 // ---------------------------------------------------------
 
-void ejecutarTestRelays() {
-  tDisplay->clearDisplay();
-  tDisplay->setCursor(0,0);
-  tDisplay->println("TEST RELAYS");
-  tDisplay->display();
-
-  int relays[] = {PIN_RELAY_1, PIN_RELAY_2, PIN_RELAY_3, PIN_RELAY_4};
-  
-  for(int i=0; i<4; i++) {
-    tDisplay->setCursor(0, 20 + (i*10));
-    tDisplay->print("Relay "); tDisplay->print(i+1); tDisplay->print(" ON");
-    tDisplay->display();
-    
-    digitalWrite(relays[i], HIGH);
-    delay(500);
-    digitalWrite(relays[i], LOW);
-    delay(200);
-  }
-  
-  tDisplay->setCursor(0, 55);
-  tDisplay->println("Finalizado.");
-  tDisplay->display();
-  delay(1000);
-}
+void dibujarProgresoTest() {
+  const ResultadoAutotest& r = autotestResultado();
 
-void ejecutarTestCerradura() {
   tDisplay->clearDisplay();
-  tDisplay->setCursor(0,0);
-  tDisplay->println("TEST CERRADURA");
-  tDisplay->println("\nAbriendo...");
-  tDisplay->display();
+  tDisplay->setCursor(0, 0);
+  tDisplay->println("AUTODIAGNOSTICO");
+  tDisplay->print("Etapa: "); tDisplay->println(autotestEtapa());
 
-  digitalWrite(PIN_LOCK, HIGH);
-  
-  // Cuenta regresiva visual
-  for(int i=3; i>0; i--) {
-    tDisplay->setCursor(60, 30);
-    tDisplay->setTextSize(2);
-    tDisplay->fillRect(60, 30, 30, 20, SSD1306_BLACK); // Borra numero anterior
-    tDisplay->print(i);
-    tDisplay->display();
-    delay(1000);
+  if (r.fases & AT_DHT) {
+    tDisplay->print("DHT "); tDisplay->print(r.dhtLecturas); tDisplay->print("/"); tDisplay->print(AUTOTEST_DHT_LECTURAS);
+    tDisplay->print(" err "); tDisplay->println(r.dhtErrores);
   }
-  
-  digitalWrite(PIN_LOCK, LOW);
-  tDisplay->setTextSize(1);
-  tDisplay->println("\nCerrado.");
-  tDisplay->display();
-  delay(1000);
-}
-
-void ejecutarTestDHT() {
-  DHT11 dhtTest(PIN_DHT);
-  tDisplay->clearDisplay();
-  tDisplay->setCursor(0,0);
-  tDisplay->println("TEST DHT11");
-  tDisplay->println("Leyendo...");
-  tDisplay->display();
-  
-  delay(1000); // El DHT necesita tiempo
-  
-  int temp = 0;
-  int hum = 0;
-  int res = dhtTest.readTemperatureHumidity(temp, hum);
-
-  tDisplay->clearDisplay();
-  tDisplay->setCursor(0,0);
-  tDisplay->println("TEST DHT11");
-  tDisplay->println("Resultados:\n");
-  
-  if(res == 0) {
-    tDisplay->print("Temp: "); tDisplay->print(temp); tDisplay->println(" C");
-    tDisplay->print("Hum:  "); tDisplay->print(hum); tDisplay->println(" %");
-  } else {
-    tDisplay->println("Error en Sensor!");
-    tDisplay->print("Codigo: "); tDisplay->println(res);
+  if (r.fases & AT_LDR) {
+    tDisplay->print("LDR "); tDisplay->print(r.ldrMuestras); tDisplay->print("/"); tDisplay->println(AUTOTEST_LDR_MUESTRAS);
+  }
+  if (r.fases & AT_GPS) {
+    tDisplay->print("GPS sats ");
+    tDisplay->print(r.gpsMuestras ? r.gpsSats[r.gpsMuestras - 1] : 0);
+    tDisplay->println(r.gpsTtffMs ? " fix" : " sin fix");
   }
-  tDisplay->println("\n[CONFIRM] salir");
-  tDisplay->display();
 
-  // Esperar botón para salir
-  confirmPressed = false;
-  while(!confirmPressed) { delay(10); } 
-  confirmPressed = false; // Limpiar bandera
+  tDisplay->setCursor(0, 56);
+  tDisplay->print("[BORRAR] cancelar");
+  i2cPantalla(*tDisplay);
 }
 
-void ejecutarTestGPS() {
-  TinyGPSPlus gpsTest;
-  HardwareSerial gpsSerialTest(2);
-  gpsSerialTest.begin(9600, SERIAL_8N1, PIN_GPS_RX, PIN_GPS_TX);
+void dibujarResultadoTest() {
+  const ResultadoAutotest& r = autotestResultado();
 
   tDisplay->clearDisplay();
-  tDisplay->setCursor(0,0);
-  tDisplay->println("TEST GPS");
-  tDisplay->println("Buscando Sats...");
-  tDisplay->println("[CONFIRM] salir");
-  tDisplay->display();
-
-  confirmPressed = false;
-  unsigned long lastPrint = 0;
-
-  while(!confirmPressed) {
-    // Alimentar GPS constantemente
-    while (gpsSerialTest.available() > 0) {
-      gpsTest.encode(gpsSerialTest.read());
-    }
-
-    // Actualizar pantalla cada 500ms
-    if(millis() - lastPrint > 500) {
-      lastPrint = millis();
-      tDisplay->fillRect(0, 25, 128, 39, SSD1306_BLACK); // Limpiar zona de datos
-      tDisplay->setCursor(0, 25);
-      
-      if(gpsTest.satellites.isValid()){
-        tDisplay->print("Sats: "); tDisplay->println(gpsTest.satellites.value());
-      } else {
-        tDisplay->println("Sats: Buscando...");
+  tDisplay->setCursor(0, 0);
+  if (autotestSecuencia() == 0) {
+    tDisplay->println("Sin reporte.");
+    tDisplay->println("\nCorre un test primero");
+  } else {
+    tDisplay->print("RESULTADO: "); tDisplay->println(r.ok ? "OK" : "FALLA");
+
+    if (r.fases & AT_RELES) {
+      bool ok = true;
+      uint32_t peor = 0;
+      for (int i = 0; i < 4; i++) {
+        ok &= r.reles[i].ok;
+        peor = max(peor, max(r.reles[i].onUs, r.reles[i].offUs));
       }
-
-      if(gpsTest.location.isValid()) {
-         tDisplay->print("Lat: "); tDisplay->println(gpsTest.location.lat(), 5);
-         tDisplay->print("Lon: "); tDisplay->println(gpsTest.location.lng(), 5);
-         tDisplay->print("Alt: "); tDisplay->print(gpsTest.altitude.meters(), 2); tDisplay->println(" m");
+      tDisplay->print("Relays "); tDisplay->print(ok ? "OK " : "FALLA ");
+      tDisplay->print(peor); tDisplay->println("us");
+    }
+    if (r.fases & AT_CERRADURA) {
+      tDisplay->print("Cerradura "); tDisplay->println(r.cerradura.ok ? "OK" : "FALLA");
+    }
+    if (r.fases & AT_SERVOS) {
+      uint32_t peor = max(r.servoMaxUs[0], max(r.servoMaxUs[1], r.servoMaxUs[2]));
+      tDisplay->print("Servos "); tDisplay->print(r.servosOk ? "OK " : "FALLA ");
+      tDisplay->print(peor); tDisplay->println("us");
+    }
+    if (r.fases & AT_DHT) {
+      tDisplay->print("DHT "); tDisplay->print(r.dhtOk ? "OK " : "FALLA ");
+      tDisplay->print(r.dhtErrores); tDisplay->print("/"); tDisplay->print(r.dhtLecturas); tDisplay->println(" err");
+    }
+    if (r.fases & AT_LDR) {
+      tDisplay->print("LDR "); tDisplay->print(r.ldrOk ? "OK " : "FALLA ");
+      tDisplay->print(r.ldrMax - r.ldrMin); tDisplay->println(" pp");
+    }
+    if (r.fases & AT_GPS) {
+      tDisplay->print("GPS ");
+      if (r.gpsOk) {
+        tDisplay->print("fix "); tDisplay->print(r.gpsTtffMs / 1000); tDisplay->print("s ");
+        tDisplay->print(r.gpsMuestras ? r.gpsSats[r.gpsMuestras - 1] : 0); tDisplay->println(" sats");
       } else {
-         tDisplay->println("Pos: Sin Fix");
+        tDisplay->println("SIN FIX");
       }
-      tDisplay->display();
     }
   }
-  confirmPressed = false; // Limpiar bandera al salir
-}
-
-void ejecutarTestServos() {
-  Servo s1, s2, s3;
-  s1.attach(PIN_SERVO_1);
-  s2.attach(PIN_SERVO_2);
-  s3.attach(PIN_SERVO_3);
-
-  int angulos[] = {0, 90, 180};
-
-  tDisplay->clearDisplay();
-  tDisplay->setCursor(0,0);
-  tDisplay->println("TEST SERVOS");
-  tDisplay->display();
-
-  for(int j=0; j<3; j++) { // Recorre angulos
-    int angulo = angulos[j];
-    
-    tDisplay->fillRect(0, 20, 128, 40, SSD1306_BLACK);
-    tDisplay->setCursor(0, 20);
-    tDisplay->print("Moviendo a: "); tDisplay->print(angulo);
-    tDisplay->display();
-
-    s1.write(angulo);
-    s2.write(angulo);
-    s3.write(angulo);
-    delay(1000);
-  }
 
-  // Desconectar para evitar ruido
-  s1.detach(); s2.detach(); s3.detach();
-  
-  tDisplay->setCursor(0, 40);
-  tDisplay->println("\nFinalizado.");
-  tDisplay->display();
-  delay(1000);
+  tDisplay->setCursor(0, 56);
+  tDisplay->print("[CONFIRM] volver");
+  i2cPantalla(*tDisplay);
 }
 
 // ---------------------------------------------------------
@@ -247,38 +151,65 @@ void ejecutarTestServos() {
 
 void iniciarModoTest(Adafruit_SSD1306* displayPtr) {
   tDisplay = displayPtr;
+  pantallaTest = PANT_MENU;
   
-  // Asegurar configuración de Hardware
-  pinMode(PIN_RELAY_1, OUTPUT); digitalWrite(PIN_RELAY_1, LOW);
-  pinMode(PIN_RELAY_2, OUTPUT); digitalWrite(PIN_RELAY_2, LOW);
-  pinMode(PIN_RELAY_3, OUTPUT); digitalWrite(PIN_RELAY_3, LOW);
-  pinMode(PIN_RELAY_4, OUTPUT); digitalWrite(PIN_RELAY_4, LOW);
-  pinMode(PIN_LOCK, OUTPUT);    digitalWrite(PIN_LOCK, LOW);
-  
-  // No iniciamos Serial del GPS ni Servos aqui, 
-  // se inician dentro de su test específico para ahorrar recursos.
+  // Partir con todo apagado (la tarea IO ya configuró los pines)
+  ioEscribir(ACT_RELAY_1, 0, ORIGEN_UI);
+  ioEscribir(ACT_RELAY_2, 0, ORIGEN_UI);
+  ioEscribir(ACT_RELAY_3, 0, ORIGEN_UI);
+  ioEscribir(ACT_RELAY_4, 0, ORIGEN_UI);
+  ioEscribir(ACT_LOCK, 0, ORIGEN_UI);
 }
 
 void dibujarMenuTest() {
   tDisplay->clearDisplay();
   tDisplay->setTextSize(1);
   tDisplay->setTextColor(SSD1306_WHITE);
-  tDisplay->setCursor(0, 0);
-  //tDisplay->println("== MODO TEST ==");
-  
-  for (int i = 0; i < TEST_MENU_SIZE; i++) {
-    tDisplay->setCursor(0, 0 + (i * 10)); // Espaciado ajustado
-    if (i == testIndex) {
-      tDisplay->print("-> ");
-    } else {
-      tDisplay->print("   ");
-    }
+
+  // Ventana de TEST_MENU_VISIBLES elementos que sigue al cursor
+  int primero = constrain(testIndex - (TEST_MENU_VISIBLES - 1), 0, TEST_MENU_SIZE - TEST_MENU_VISIBLES);
+  for (int i = primero; i < primero + TEST_MENU_VISIBLES; i++) {
+    tDisplay->setCursor(0, (i - primero) * 10);
+    tDisplay->print(i == testIndex ? "-> " : "   ");
     tDisplay->println(testMenuItems[i]);
   }
-  tDisplay->display();
+  i2cPantalla(*tDisplay);
 }
 
 void loopModoTest() {
+  // 0. Corridas pedidas desde aquí, WebSerial o MQTT se ven en pantalla
+  if (autotestEnCurso()) {
+    if (pantallaTest != PANT_CORRIENDO) {
+      pantallaTest = PANT_CORRIENDO;
+      ultimoDibujoTest = 0;
+    }
+    if (deletePressed) {
+      deletePressed = false;
+      autotestCancelar();
+    }
+    if (millis() - ultimoDibujoTest >= 250) {
+      ultimoDibujoTest = millis();
+      dibujarProgresoTest();
+    }
+    return;
+  }
+  if (pantallaTest == PANT_CORRIENDO) {
+    // Terminó, o se canceló y queda el reporte anterior
+    pantallaTest = PANT_RESULTADO;
+    confirmPressed = false;
+    dibujarResultadoTest();
+    return;
+  }
+  if (pantallaTest == PANT_RESULTADO) {
+    if (confirmPressed || deletePressed) {
+      confirmPressed = false;
+      deletePressed = false;
+      pantallaTest = PANT_MENU;
+      dibujarMenuTest();
+    }
+    return;
+  }
+
   // 1. Leer Potenciometro para navegación
   int idx = leerIndiceTest(TEST_MENU_SIZE);
   if (idx >= 0 && idx != testIndex) {
@@ -296,21 +227,16 @@ void loopModoTest() {
   // 3. Manejo de Selección
   if (confirmPressed) {
     confirmPressed = false; // Consumir evento
-    
-    switch (testIndex) {
-      case 0: ejecutarTestRelays(); break;
-      case 1: ejecutarTestCerradura(); break;
-      case 2: ejecutarTestDHT(); break;
-      case 3: ejecutarTestGPS(); break;
-      case 4: ejecutarTestServos(); break;
-      case 5: // Volver Atras
-        uiState = UI_MAIN_MENU; 
-        redrawMenu = true;
-        firstRun = true; // Reset para la proxima vez
-        break;
+
+    if (testMenuFases[testIndex]) {
+      autotestSolicitar(testMenuFases[testIndex]);
+    } else if (testIndex == 6) { // Ver Reporte
+      pantallaTest = PANT_RESULTADO;
+      dibujarResultadoTest();
+    } else { // Volver Atras
+      uiState = UI_MAIN_MENU;
+      redrawMenu = true;
+      firstRun = true; // Reset para la proxima vez
     }
-    
-    // Al volver de un test, redibujar menú
-    if(uiState == UI_TEST_MODE) dibujarMenuTest();
   }
-}
\ No newline at end of file
+}
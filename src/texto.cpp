@@ -0,0 +1,59 @@
+#include "texto.h"
+#include "metrics.h"
+
+char* Arena::reservar(size_t n) {
+  if (n > _capacidad - _usado) {
+    metricaContar(CNT_ARENA_DESBORDES);
+    return nullptr;
+  }
+  char* p = _memoria + _usado;
+  _usado += n;
+  if (_usado > _pico) _pico = _usado;
+  return p;
+}
+
+const char* Arena::copiar(const char* s, size_t n) {
+  char* p = reservar(n + 1);
+  if (!p) return "";
+  memcpy(p, s, n);
+  p[n] = '\0';
+  return p;
+}
+
+const char* Arena::formatear(const char* fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  const char* texto = vformatear(fmt, args);
+  va_end(args);
+  return texto;
+}
+
+// Se escribe en lo que queda y se reserva solo lo usado
+const char* Arena::vformatear(const char* fmt, va_list args) {
+  size_t libre = _capacidad - _usado;
+  if (!libre) {
+    metricaContar(CNT_ARENA_DESBORDES);
+    return "";
+  }
+  char* p = _memoria + _usado;
+  int n = vsnprintf(p, libre, fmt, args);
+  if (n < 0) n = 0;
+  if ((size_t)n >= libre) {
+    metricaContar(CNT_ARENA_DESBORDES);  // Queda cortado
+    n = libre - 1;
+  }
+  _usado += n + 1;
+  if (_usado > _pico) _pico = _usado;
+  return p;
+}
+
+const char* Arena::palabra(const char* texto, char separador, int indice) {
+  const char* inicio = texto;
+  for (int i = 0; i < indice; i++) {
+    inicio = strchr(inicio, separador);
+    if (!inicio) return "";
+    inicio++;
+  }
+  const char* fin = strchr(inicio, separador);
+  return copiar(inicio, fin ? (size_t)(fin - inicio) : strlen(inicio));
+}
@@ -0,0 +1,55 @@
+#ifndef TEXTO_H
+#define TEXTO_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+/* =======================
+   TEXTO SIN HEAP
+   =======================
+   Cada concatenación de String reserva y libera. Con días de uso esos
+   bloques cortos quedan entre reservas largas (TLS, HTTP) y el bloque
+   libre mayor se achica hasta que una de ellas falla aunque sobre heap.
+
+   Los textos de un comando o de un ciclo de publicación salen de una
+   arena: un buffer fijo que se llena de corrido y se vacía de una vez al
+   terminar. Una arena por contexto (consola, red), nunca compartida
+   entre tareas. Lo que no cabe se corta y suma a CNT_ARENA_DESBORDES. */
+
+class Arena {
+public:
+  Arena(char* memoria, size_t capacidad) : _memoria(memoria), _capacidad(capacidad) {}
+
+  char* reservar(size_t n);                     // nullptr si no cabe
+  const char* copiar(const char* s, size_t n);  // n bytes y el '\0'
+  const char* formatear(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+  const char* vformatear(const char* fmt, va_list args);
+
+  // Palabra 'indice' (desde 0) entre separadores; "" si no hay tantas
+  const char* palabra(const char* texto, char separador, int indice);
+
+  // marca()/volver(): lo reservado desde la marca se descarta (anidable)
+  size_t marca() const { return _usado; }
+  void volver(size_t marca) { if (marca < _usado) _usado = marca; }
+  void reiniciar() { _usado = 0; }
+
+  size_t capacidad() const { return _capacidad; }
+  size_t pico() const { return _pico; }
+
+private:
+  char* _memoria;
+  size_t _capacidad;
+  size_t _usado = 0;
+  size_t _pico = 0;
+};
+
+template <size_t N>
+class ArenaFija : public Arena {
+public:
+  ArenaFija() : Arena(_buffer, N) {}
+
+private:
+  char _buffer[N];
+};
+
+#endif
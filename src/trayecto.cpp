@@ -0,0 +1,202 @@
+#include "trayecto.h"
+
+#define METROS_POR_GRADO 111320.0f
+
+// --- ANILLO (compartido, protegido por spinlock) ---
+static portMUX_TYPE muxTrayecto = portMUX_INITIALIZER_UNLOCKED;
+static PuntoTrayecto anillo[TRAYECTO_MAX];
+static uint32_t total = 0;
+static uint32_t recibidos = 0;
+static uint32_t latidos = 0;
+static volatile float tolerancia = TRAYECTO_TOLERANCIA_M;
+
+// --- VENTANA (solo tarea IO) ---
+// Fixes desde el ancla en metros locales respecto a ella
+static bool hayAncla = false;
+static PuntoTrayecto ancla;
+static float cosLatAncla = 1.0f;
+static float ventanaX[TRAYECTO_VENTANA];
+static float ventanaY[TRAYECTO_VENTANA];
+static uint8_t enVentana = 0;
+static PuntoTrayecto previo;  // Último fix de la ventana
+
+// ---------------------------------------------------------
+// GEOMETRÍA
+// ---------------------------------------------------------
+static void aLocal(const PuntoTrayecto& p, float& x, float& y) {
+  x = (p.lng - ancla.lng) * 1e-5f * METROS_POR_GRADO * cosLatAncla;
+  y = (p.lat - ancla.lat) * 1e-5f * METROS_POR_GRADO;
+}
+
+// Distancia de (qx,qy) al segmento ancla(0,0) -> (px,py)
+static float distanciaSegmento(float qx, float qy, float px, float py) {
+  float largo2 = px * px + py * py;
+  float t = largo2 > 0 ? (qx * px + qy * py) / largo2 : 0;
+  t = constrain(t, 0.0f, 1.0f);
+  float dx = qx - t * px, dy = qy - t * py;
+  return sqrtf(dx * dx + dy * dy);
+}
+
+// ---------------------------------------------------------
+// GUARDADO
+// ---------------------------------------------------------
+static void guardar(const PuntoTrayecto& p, bool latido) {
+  portENTER_CRITICAL(&muxTrayecto);
+  anillo[total % TRAYECTO_MAX] = p;
+  total++;
+  if (latido) latidos++;
+  portEXIT_CRITICAL(&muxTrayecto);
+
+  ancla = p;
+  cosLatAncla = cosf(p.lat * 1e-5f * DEG_TO_RAD);
+  hayAncla = true;
+  enVentana = 0;
+}
+
+void trayectoAgregar(double lat, double lng, double alt, uint32_t ms) {
+  PuntoTrayecto p = { (int32_t)lround(lat * 1e5), (int32_t)lround(lng * 1e5), (int16_t)lround(alt), ms };
+  recibidos++;
+
+  if (!hayAncla) {
+    guardar(p, false);
+    return;
+  }
+
+  float tol = tolerancia;
+  float px, py;
+  aLocal(p, px, py);
+
+  // Latido: aunque no se mueva, que se sepa que sigue ahí
+  if (ms - ancla.ms >= TRAYECTO_LATIDO_MS) {
+    guardar(p, true);
+    return;
+  }
+
+  // Quieto: si la ventana y el fix caben en el radio de tolerancia del
+  // ancla, el ancla ya los representa y no hace falta recordarlos
+  bool cercaAncla = px * px + py * py <= tol * tol;
+  for (uint8_t i = 0; cercaAncla && i < enVentana; i++) {
+    cercaAncla = ventanaX[i] * ventanaX[i] + ventanaY[i] * ventanaY[i] <= tol * tol;
+  }
+  if (cercaAncla) {
+    enVentana = 0;
+    return;
+  }
+
+  // ¿Algún fix de la ventana se sale del segmento ancla -> p?
+  bool excede = false;
+  for (uint8_t i = 0; !excede && i < enVentana; i++) {
+    excede = distanciaSegmento(ventanaX[i], ventanaY[i], px, py) > tol;
+  }
+
+  if (excede || enVentana == TRAYECTO_VENTANA) {
+    // El último fix que todavía cumplía pasa a ser el ancla
+    guardar(previo, false);
+    aLocal(p, px, py);
+  }
+  ventanaX[enVentana] = px;
+  ventanaY[enVentana] = py;
+  enVentana++;
+  previo = p;
+}
+
+// ---------------------------------------------------------
+// LECTURA
+// ---------------------------------------------------------
+uint32_t trayectoTotal() {
+  return total;
+}
+
+bool trayectoUltimo(PuntoTrayecto& out) {
+  portENTER_CRITICAL(&muxTrayecto);
+  bool hay = total > 0;
+  if (hay) out = anillo[(total - 1) % TRAYECTO_MAX];
+  portEXIT_CRITICAL(&muxTrayecto);
+  return hay;
+}
+
+size_t trayectoLote(uint32_t* desde, PuntoTrayecto* out, size_t max) {
+  portENTER_CRITICAL(&muxTrayecto);
+  if (total > TRAYECTO_MAX && *desde < total - TRAYECTO_MAX) *desde = total - TRAYECTO_MAX;
+  size_t n = 0;
+  while (*desde < total && n < max) {
+    out[n++] = anillo[*desde % TRAYECTO_MAX];
+    (*desde)++;
+  }
+  portEXIT_CRITICAL(&muxTrayecto);
+  return n;
+}
+
+void trayectoFijarTolerancia(float metros) {
+  tolerancia = constrain(metros, 1.0f, 1000.0f);
+}
+
+void trayectoEstadistica(EstadisticaTrayecto& out) {
+  portENTER_CRITICAL(&muxTrayecto);
+  out.recibidos = recibidos;
+  out.guardados = total;
+  out.latidos = latidos;
+  portEXIT_CRITICAL(&muxTrayecto);
+  out.toleranciaM = tolerancia;
+}
+
+void trayectoReiniciar() {
+  portENTER_CRITICAL(&muxTrayecto);
+  total = 0;
+  recibidos = 0;
+  latidos = 0;
+  portEXIT_CRITICAL(&muxTrayecto);
+  // La ventana es de la tarea IO: se rehace con el siguiente fix
+  hayAncla = false;
+}
+
+// ---------------------------------------------------------
+// POLYLINE
+// ---------------------------------------------------------
+// Un valor con signo: zigzag y grupos de 5 bits + 63
+static size_t polylineValor(int32_t v, char* buf, size_t cap) {
+  uint32_t u = (uint32_t)v << 1;
+  if (v < 0) u = ~u;
+  size_t n = 0;
+  while (u >= 0x20) {
+    if (n >= cap) return 0;
+    buf[n++] = (char)((0x20 | (u & 0x1f)) + 63);
+    u >>= 5;
+  }
+  if (n >= cap) return 0;
+  buf[n++] = (char)(u + 63);
+  return n;
+}
+
+size_t trayectoPolyline(const PuntoTrayecto* puntos, size_t n, char* buf, size_t cap) {
+  size_t k = 0;
+  int32_t lat = 0, lng = 0;
+  for (size_t i = 0; i < n; i++) {
+    size_t a = polylineValor(puntos[i].lat - lat, buf + k, cap - k);
+    if (!a) return 0;
+    k += a;
+    size_t b = polylineValor(puntos[i].lng - lng, buf + k, cap - k);
+    if (!b) return 0;
+    k += b;
+    lat = puntos[i].lat;
+    lng = puntos[i].lng;
+  }
+  if (k >= cap) return 0;
+  buf[k] = '\0';
+  return k;
+}
+
+size_t trayectoPolylineTiempos(const PuntoTrayecto* puntos, size_t n, char* buf, size_t cap) {
+  size_t k = 0;
+  int32_t anterior = 0;
+  for (size_t i = 0; i < n; i++) {
+    int32_t s = (int32_t)((puntos[i].ms - puntos[0].ms) / 1000);
+    size_t a = polylineValor(s - anterior, buf + k, cap - k);
+    if (!a) return 0;
+    k += a;
+    anterior = s;
+  }
+  if (k >= cap) return 0;
+  buf[k] = '\0';
+  return k;
+}
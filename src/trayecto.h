@@ -0,0 +1,59 @@
+#ifndef TRAYECTO_H
+#define TRAYECTO_H
+
+#include <Arduino.h>
+
+/* =======================
+   TRAYECTO GPS
+   =======================
+   Simplifica el recorrido en línea, con ventana abierta (Douglas-Peucker
+   en streaming): se guarda un punto solo cuando alguno de los fixes desde
+   el último guardado se aparta más de la tolerancia del segmento que
+   los une. En línea recta sale un punto por ventana llena; estacionado,
+   solo el latido. Los puntos quedan en un anillo fijo en RAM y la tarea
+   de red los publica por lotes en formato polyline (orion/gps/track).
+
+   trayectoAgregar() solo desde la tarea IO; el resto, desde cualquiera. */
+
+#define TRAYECTO_MAX            128     // Anillo de puntos guardados
+#define TRAYECTO_VENTANA        32      // Fixes pendientes como máximo
+#define TRAYECTO_TOLERANCIA_M   10.0f   // Por defecto
+#define TRAYECTO_LATIDO_MS      600000  // Un punto cada 10 min aunque no se mueva
+#define TRAYECTO_LOTE_MAX       32      // Puntos por mensaje
+
+// Coordenadas en 1e-5 grados: la precisión de polyline (~1 m)
+struct PuntoTrayecto {
+  int32_t lat;
+  int32_t lng;
+  int16_t alt;     // m
+  uint32_t ms;     // millis() del fix
+};
+
+struct EstadisticaTrayecto {
+  uint32_t recibidos;   // Fixes que entraron
+  uint32_t guardados;   // Puntos guardados desde el arranque
+  uint32_t latidos;     // De ellos, por latido
+  float toleranciaM;
+};
+
+void trayectoAgregar(double lat, double lng, double alt, uint32_t ms);
+
+// Número de puntos guardados desde el arranque (el siguiente lleva este índice)
+uint32_t trayectoTotal();
+bool trayectoUltimo(PuntoTrayecto& out);
+
+// Copia hasta 'max' puntos desde el índice '*desde' y lo avanza. Si el anillo
+// ya los pisó, salta al más antiguo que queda.
+size_t trayectoLote(uint32_t* desde, PuntoTrayecto* out, size_t max);
+
+void trayectoFijarTolerancia(float metros);
+void trayectoEstadistica(EstadisticaTrayecto& out);
+void trayectoReiniciar();
+
+// Polyline (Google, precisión 5) de lat/lng. 0 si no cabe en buf.
+size_t trayectoPolyline(const PuntoTrayecto* puntos, size_t n, char* buf, size_t cap);
+
+// Segundos de cada punto desde el primero, con la misma codificación (una dimensión)
+size_t trayectoPolylineTiempos(const PuntoTrayecto* puntos, size_t n, char* buf, size_t cap);
+
+#endif
@@ -0,0 +1,880 @@
+#include "ui_task.h"
+#include <Wire.h>
+#include <WiFi.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+
+//Librerias propias y encabezados personalizados
+#include "icons.h"
+#include "test_mode.h"
+#include "definitions.h"
+#include "net_task.h"
+#include "io_task.h"
+#include "metrics.h"
+#include "autotest.h"
+#include "historial.h"
+#include "bus_i2c.h"
+#include "ajustes.h"
+#include "energia.h"
+
+/* =======================
+   DISPLAY
+   ======================= */
+#define SCREEN_WIDTH 128
+#define SCREEN_HEIGHT 64
+#define OLED_RESET -1
+#define OLED_ADDR 0x3C
+
+Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+
+/* =======================
+   PINES
+   ======================= */
+#define POT_PIN 35
+
+#define BTN_CONFIRM 32
+#define BTN_DELETE 33
+#define BTN_SEND 25
+
+/* =======================
+   MENÚ PRINCIPAL
+   ======================= */
+const char* menuItems[] = {
+  "Modo Local",
+  "Modo Cloud",
+  "Modo Hibrido",
+  "Modo Test",
+  "Configuracion"
+};
+const uint8_t MENU_SIZE = 5;
+
+/* =======================
+   MENÚ CONFIGURACIÓN
+   ======================= */
+const char* configMenuItems[] = {
+  "Estado WiFi",
+  "IP",
+  "Seleccionar WiFi",
+  "Diagnostico",
+  "Volver Atras"
+};
+const uint8_t CONFIG_MENU_SIZE = 5;
+
+/* =======================
+   WIFI
+   ======================= */
+char ssidList[MAX_NETWORKS][SSID_MAX_LEN + 1];
+int wifiCount = 0;
+bool escaneoPendiente = false;
+bool conexionPendiente = false;
+
+/* =======================
+   PASSWORD
+   ======================= */
+const char charset[] = "aAbBcCdDeEfFgGhHiIjJkKlLmMnNoOpPqQrRsStTuUvVwWxXyYzZ0123456789.*-@=_#$%&¿?";
+#define CHARSET_SIZE (sizeof(charset) - 1)
+#define MAX_PASS_LEN PASS_MAX_LEN
+
+char wifiPassword[MAX_PASS_LEN + 1];
+uint8_t passLen = 0;
+uint8_t charIndex = 0;
+
+UIState uiState = UI_MAIN_MENU;
+
+/* =======================
+   CONTROL
+   ======================= */
+int menuDelta = 0;
+
+volatile bool confirmPressed = false;
+volatile bool deletePressed = false;
+volatile bool sendPressed = false;
+
+volatile unsigned long lastISRTime = 0;
+
+int currentIndex = 0;
+int configIndex = 0;
+int wifiIndex = 0;
+
+bool redrawMenu = true;
+int16_t estadoCloud = -1;  // Último EVT_CLOUD_ESTADO (-1: aún sin ciclo de publicación)
+unsigned long ultimoDiagnostico = 0;
+
+// --- DECLARACIÓN DE FUNCIONES ---
+void manejarMenuPrincipal();
+void drawMenu();
+void manejarModoLocal();
+void drawModoLocal();
+void dibujarSparkline(int16_t y, SerieId serie, int32_t spanMin);
+void manejarModoCloud();
+void drawCloudScreen(int16_t estado);
+void manejarModoHibrido();
+void drawHibrido();
+void entrarModo(uint8_t modos);
+bool atenderBotonesModo(uint8_t siguiente);
+void manejarMenuConfiguracion();
+void drawConfigMenu();
+void manejarDiagnostico();
+void drawDiagnostico();
+void scanWifiNetworks();
+void manejarWifiScan();
+void drawWifiList();
+void manejarWifiPassword();
+void drawPasswordScreen();
+void conectarWifi();
+void atenderEventoUI(const EventoUI& evt);
+void dibujarImagenOLED();
+void dibujarInicio();
+
+/* =======================
+   ISR BOTONES
+   ======================= */
+void IRAM_ATTR isrConfirm() {
+  if (millis() - lastISRTime > ajustes.reboteMs) {
+    confirmPressed = true;
+    lastISRTime = millis();
+  }
+  energiaBotonISR(BTN_CONFIRM);
+}
+
+void IRAM_ATTR isrDelete() {
+  if (millis() - lastISRTime > ajustes.reboteMs) {
+    deletePressed = true;
+    lastISRTime = millis();
+  }
+  energiaBotonISR(BTN_DELETE);
+}
+
+void IRAM_ATTR isrSend() {
+  if (millis() - lastISRTime > ajustes.reboteMs) {
+    sendPressed = true;
+    lastISRTime = millis();
+  }
+  energiaBotonISR(BTN_SEND);
+}
+
+/* =======================
+   INICIO
+   ======================= */
+void iniciarUI() {
+  pinMode(POT_PIN, INPUT);
+  pinMode(BTN_CONFIRM, INPUT_PULLUP);
+  pinMode(BTN_DELETE, INPUT_PULLUP);
+  pinMode(BTN_SEND, INPUT_PULLUP);
+
+  attachInterrupt(digitalPinToInterrupt(BTN_CONFIRM), isrConfirm, FALLING);
+  attachInterrupt(digitalPinToInterrupt(BTN_DELETE), isrDelete, FALLING);
+  attachInterrupt(digitalPinToInterrupt(BTN_SEND), isrSend, FALLING);
+  energiaBoton(BTN_CONFIRM);
+  energiaBoton(BTN_DELETE);
+  energiaBoton(BTN_SEND);
+
+  Wire.begin(I2C_PIN_SDA, I2C_PIN_SCL);
+
+  if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR)) {
+    Serial.println(F("Error al iniciar SSD1306"));
+    for (;;)
+      ;
+  }
+  // Desde aquí la OLED se vuelca con i2cPantalla()
+  iniciarI2C();
+
+  display.clearDisplay();
+  dibujarImagenOLED();
+  delay(1000);
+  dibujarInicio();
+}
+
+void uiMostrarMensaje(const char* texto) {
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+
+  display.setCursor(0, 0);
+  display.println(texto);
+  i2cPantalla(display);
+}
+
+void uiMostrarResultadoWiFi(bool wifiOK) {
+  display.clearDisplay();
+  display.setCursor(0, 0);
+
+  if (wifiOK) {
+    display.println("      Conectado OK");
+    display.println();
+    display.println("     Usando red Wifi");
+    display.println("       por defecto");
+  } else {
+    display.println("WiFi no disponible");
+    display.println("Elija una red WiFi");
+  }
+
+  i2cPantalla(display);
+  delay(1500);
+
+
+  redrawMenu = true;
+}
+
+/* =======================
+   PASO DE LA TAREA UI
+   ======================= */
+void pasoTareaUI() {
+
+  EventoUI evt;
+  while (redRecibirEventoUI(evt)) {
+    atenderEventoUI(evt);
+  }
+
+  // El autodiagnóstico avanza en cualquier pantalla (se puede pedir por red)
+  autotestPaso();
+
+  switch (uiState) {
+
+    case UI_MAIN_MENU:
+      manejarMenuPrincipal();
+      break;
+
+    case UI_CONFIG_MENU:
+      manejarMenuConfiguracion();
+      break;
+
+    case UI_WIFI_SCAN:
+      manejarWifiScan();
+      break;
+
+    case UI_WIFI_PASSWORD:
+      manejarWifiPassword();
+      break;
+
+    case UI_LOCAL_MODE:
+      manejarModoLocal();
+      break;
+
+    case UI_CLOUD_MODE:
+      manejarModoCloud();
+      break;
+
+    case UI_HYBRID_MODE:
+      manejarModoHibrido();
+      break;
+
+    case UI_TEST_MODE:
+      // Toda la lógica se delega al archivo test_mode.cpp
+      loopModoTest();
+      break;
+
+    case UI_DIAGNOSTICO:
+      manejarDiagnostico();
+      break;
+  }
+}
+
+/* =======================
+   EVENTOS DE LA TAREA DE RED
+   ======================= */
+void atenderEventoUI(const EventoUI& evt) {
+  switch (evt.tipo) {
+
+    case EVT_WIFI_RESULTADO:
+      if (conexionPendiente) {
+        conexionPendiente = false;
+        display.clearDisplay();
+        uiState = UI_CONFIG_MENU;
+        redrawMenu = true;
+      }
+      break;
+
+    case EVT_ESCANEO_LISTO:
+      if (!escaneoPendiente) break;
+      escaneoPendiente = false;
+      wifiCount = evt.valor;
+      for (int i = 0; i < wifiCount; i++) {
+        strlcpy(ssidList[i], redSsidEscaneado(i), sizeof(ssidList[i]));
+      }
+      wifiIndex = 0;
+      redrawMenu = true;
+      break;
+
+    case EVT_LOCAL_RESULTADO:
+      if (evt.valor == 0 && uiState == UI_LOCAL_MODE) {
+        uiMostrarMensaje("Error servidor local");
+        delay(1500);
+        uiState = UI_MAIN_MENU;
+        redrawMenu = true;
+      }
+      break;
+
+    case EVT_CLOUD_PROGRESO:
+      if (uiState == UI_CLOUD_MODE || uiState == UI_HYBRID_MODE) {
+        display.println(evt.texto);
+        i2cPantalla(display);
+      }
+      break;
+
+    case EVT_CLOUD_ESTADO:
+      estadoCloud = evt.valor;
+      if (uiState == UI_CLOUD_MODE) drawCloudScreen(evt.valor);
+      if (uiState == UI_HYBRID_MODE) drawHibrido();
+      break;
+  }
+}
+
+/* =======================
+   LECTURA POT
+   ======================= */
+
+int readPotFiltered() {
+  static int filtered = 0;
+  int raw = analogRead(POT_PIN);
+
+  // Filtro EMA: 8
+  filtered = (filtered * 7 + raw) / 8;
+  return filtered;
+}
+
+int readIndexStable(uint8_t items) {
+  static int lastIndex = -1;
+
+  int value = readPotFiltered();
+  int stepSize = 4096 / items;
+  int index = value / stepSize;
+
+  index = constrain(index, 0, items - 1);
+
+  if (index != lastIndex) {
+    lastIndex = index;
+    return index;
+  }
+  return -1;
+}
+
+int readCharIndex() {
+  static int last = -1;
+
+  int value = readPotFiltered();
+  int step = 4096 / CHARSET_SIZE;
+  int idx = value / step;
+
+  idx = constrain(idx, 0, CHARSET_SIZE - 1);
+
+  if (idx != last) {
+    last = idx;
+    return idx;
+  }
+  return -1;
+}
+
+
+/* =======================
+   MENÚ PRINCIPAL
+   ======================= */
+void manejarMenuPrincipal() {
+  int idx = readIndexStable(MENU_SIZE);
+  if (idx >= 0) {
+    currentIndex = idx;
+    redrawMenu = true;
+  }
+
+  if (redrawMenu) {
+    drawMenu();
+    redrawMenu = false;
+  }
+
+  if (confirmPressed) {
+    confirmPressed = false;
+
+    if (currentIndex <= 2) {  // Local, Cloud o Híbrido
+      if (!WiFi.isConnected()) {
+        display.clearDisplay();
+        display.println("ERROR:");
+        display.println("No hay WiFi");
+        display.println("Conectese primero");
+        i2cPantalla(display);
+        delay(1500);
+        redrawMenu = true;
+      } else {
+        const uint8_t modos[] = { MODO_LOCAL, MODO_CLOUD, MODO_HIBRIDO };
+        entrarModo(modos[currentIndex]);
+      }
+    } else if (currentIndex == 3) { //"Modo Test" es indice 3
+
+      iniciarModoTest(&display);
+      uiState = UI_TEST_MODE;
+      redrawMenu = true;
+
+    } else if (currentIndex == 4) { //Modo de configuración
+
+      uiState = UI_CONFIG_MENU;
+      redrawMenu = true;
+    }
+  }
+}
+
+void drawMenu() {
+  display.clearDisplay();
+  for (uint8_t i = 0; i < MENU_SIZE; i++) {
+    display.setCursor(0, i * 10);
+    display.print(i == currentIndex ? "--> " : "    ");
+    display.println(menuItems[i]);
+  }
+  display.drawFastHLine(0, 50, 128, SSD1306_WHITE);
+  display.setCursor(0, 54);
+  display.println("   == ORION IOT ==");
+  i2cPantalla(display);
+}
+// -------------------------------
+//      Modos de red
+// -------------------------------
+// La tarea de red solo arranca o detiene el servicio que cambia, así que
+// pasar de un modo a otro con Enviar no reinicia nada
+void entrarModo(uint8_t modos) {
+  if (!(modos & MODO_CLOUD)) estadoCloud = -1;  // La sesión MQTT se cierra
+  redFijarModos(modos);  // El resultado del servidor llega como EVT_LOCAL_RESULTADO
+
+  if (modos == MODO_LOCAL) uiState = UI_LOCAL_MODE;
+  else if (modos == MODO_CLOUD) uiState = UI_CLOUD_MODE;
+  else uiState = UI_HYBRID_MODE;
+
+  // Cloud sin ciclo aún: la pantalla se llena con EVT_CLOUD_PROGRESO
+  display.clearDisplay();
+  display.setCursor(0, 0);
+  i2cPantalla(display);
+  redrawMenu = true;
+}
+
+// Enviar: Local -> Híbrido -> Cloud -> Local. Borrar: menú, todo apagado.
+// true si cambió de pantalla.
+bool atenderBotonesModo(uint8_t siguiente) {
+  if (sendPressed) {
+    sendPressed = false;
+    entrarModo(siguiente);
+    return true;
+  }
+  if (deletePressed) {
+    deletePressed = false;
+    estadoCloud = -1;
+    redFijarModos(MODO_NINGUNO);
+    uiState = UI_MAIN_MENU;
+    redrawMenu = true;
+    return true;
+  }
+  return false;
+}
+
+// -------------------------------
+//      Pantalla Modo Local
+// -------------------------------
+void manejarModoLocal() {
+  // Las sparklines cambian con cada minuto que cierra el historial
+  static uint32_t secuenciaDibujada = 0;
+  if (redrawMenu || historialSecuencia() != secuenciaDibujada) {
+    secuenciaDibujada = historialSecuencia();
+    drawModoLocal();
+    redrawMenu = false;
+  }
+
+  atenderBotonesModo(MODO_HIBRIDO);
+}
+
+#define SPARK_X 34
+#define SPARK_ALTO 8
+#define SPARK_RANGO_S (3 * 3600)
+
+void drawModoLocal() {
+  LecturaSensores lectura;
+  ioObtenerLectura(lectura);
+
+  display.clearDisplay();
+  display.setCursor(0, 0);
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  display.println("Modo Local");
+  display.println("orion-iot.local");
+  display.println("/webserial");
+
+  // Últimas 3 h; el tramo mínimo evita agrandar el ruido de una serie plana
+  display.setCursor(0, 26); display.print("T:"); display.print(lectura.temp);
+  dibujarSparkline(26, SERIE_TEMP, 10);
+  display.setCursor(0, 36); display.print("H:"); display.print(lectura.hum);
+  dibujarSparkline(36, SERIE_HUM, 20);
+  display.setCursor(0, 46); display.print("L:"); display.print(lectura.lux);
+  dibujarSparkline(46, SERIE_LUZ, 50);
+
+  display.setCursor(0, 56);
+  display.print("Borrar/Enviar:+Cloud");
+  i2cPantalla(display);
+}
+
+// Una columna por tramo, unida a la anterior con datos
+void dibujarSparkline(int16_t y, SerieId serie, int32_t spanMin) {
+  static TramoHistorial tramos[SCREEN_WIDTH - SPARK_X];
+  const int16_t ancho = SCREEN_WIDTH - SPARK_X;
+  historialConsultar(serie, SPARK_RANGO_S, tramos, ancho);
+
+  int32_t lo = INT32_MAX, hi = INT32_MIN;
+  for (int16_t i = 0; i < ancho; i++) {
+    if (!tramos[i].n) continue;
+    lo = min(lo, tramos[i].media);
+    hi = max(hi, tramos[i].media);
+  }
+  if (lo > hi) return;  // Aún sin datos
+  if (hi - lo < spanMin) {
+    lo -= (spanMin - (hi - lo)) / 2;
+    hi = lo + spanMin;
+  }
+
+  int16_t xPrevio = -1, yPrevio = 0;
+  for (int16_t i = 0; i < ancho; i++) {
+    if (!tramos[i].n) continue;
+    int16_t yi = y + SPARK_ALTO - 1 - (int16_t)((int64_t)(tramos[i].media - lo) * (SPARK_ALTO - 1) / (hi - lo));
+    if (xPrevio < 0) display.drawPixel(SPARK_X + i, yi, SSD1306_WHITE);
+    else display.drawLine(SPARK_X + xPrevio, yPrevio, SPARK_X + i, yi, SSD1306_WHITE);
+    xPrevio = i;
+    yPrevio = yi;
+  }
+}
+// -------------------------------
+
+// -------------------------------
+//      Pantalla Modo Cloud
+// -------------------------------
+void manejarModoCloud() {
+  // Llegando desde Híbrido la sesión sigue abierta: se pinta el último estado
+  if (redrawMenu) {
+    redrawMenu = false;
+    if (estadoCloud >= 0) drawCloudScreen(estadoCloud);
+  }
+
+  atenderBotonesModo(MODO_LOCAL);
+}
+
+// Se redibuja tras cada ciclo de publicación (EVT_CLOUD_ESTADO)
+void drawCloudScreen(int16_t estado) {
+  LecturaSensores lectura;
+  ioObtenerLectura(lectura);
+
+  display.clearDisplay();
+  display.setCursor(0, 0);
+  display.println("== MODO CLOUD ==");
+  display.print("MQTT: "); display.println((estado & 1) ? "ON" : "OFF");
+  display.print("Influx: "); display.println((estado & 2) ? "Enviado" : "Error");
+
+  display.print("T:"); display.print(lectura.temp);
+  display.print(" H:"); display.println(lectura.hum);
+
+  if (lectura.gpsValido) {
+    display.print("GPS: OK Sats:"); display.println(lectura.sats);
+  } else {
+    display.println("GPS: Buscando...");
+  }
+
+  i2cPantalla(display);
+}
+// -------------------------------
+
+// -------------------------------
+//      Pantalla Modo Híbrido
+// -------------------------------
+void manejarModoHibrido() {
+  if (redrawMenu) {
+    redrawMenu = false;
+    if (estadoCloud >= 0) drawHibrido();
+  }
+
+  atenderBotonesModo(MODO_CLOUD);
+}
+
+// WebSerial y MQTT/Influx a la vez; se redibuja con cada EVT_CLOUD_ESTADO
+void drawHibrido() {
+  LecturaSensores lectura;
+  ioObtenerLectura(lectura);
+
+  display.clearDisplay();
+  display.setCursor(0, 0);
+  display.println("== MODO HIBRIDO ==");
+  display.println("orion-iot.local");
+  display.print("MQTT: "); display.print((estadoCloud & 1) ? "ON" : "OFF");
+  display.print(" Influx: "); display.println((estadoCloud & 2) ? "OK" : "Err");
+
+  display.print("T:"); display.print(lectura.temp);
+  display.print(" H:"); display.print(lectura.hum);
+  display.print(" L:"); display.println(lectura.lux);
+
+  display.setCursor(0, 56);
+  display.print("Enviar: solo Cloud");
+  i2cPantalla(display);
+}
+// -------------------------------
+
+
+/* =======================
+   CONFIGURACIÓN
+   ======================= */
+void manejarMenuConfiguracion() {
+  int idx = readIndexStable(CONFIG_MENU_SIZE);
+  if (idx >= 0) {
+    configIndex = idx;
+    redrawMenu = true;
+  }
+
+  if (redrawMenu) {
+    drawConfigMenu();
+    redrawMenu = false;
+  }
+
+  if (confirmPressed) {
+    confirmPressed = false;
+
+    if (configIndex == 2) {
+      uiState = UI_WIFI_SCAN;
+      scanWifiNetworks();
+      redrawMenu = true;
+    } else if (configIndex == 3) {
+      uiState = UI_DIAGNOSTICO;
+      redrawMenu = true;
+    } else if (configIndex == 4) {
+      uiState = UI_MAIN_MENU;
+      redrawMenu = true;
+    }
+  }
+}
+
+void drawConfigMenu() {
+  display.clearDisplay();
+  bool wifiIsConnected = WiFi.isConnected();
+  for (uint8_t i = 0; i < CONFIG_MENU_SIZE; i++) {
+    display.setCursor(0, i * 12);
+    display.print(i == configIndex ? "--> " : "    ");
+    if (i == 0) {
+      display.print("Estado WiFi: ");
+      display.println(wifiIsConnected ? "OK" : "NO");
+    } else if (i == 1) {
+      display.print("IP: ");
+      display.println(wifiIsConnected ? WiFi.localIP() : "-");
+    } else {
+      display.println(configMenuItems[i]);
+    }
+  }
+  i2cPantalla(display);
+}
+
+/* =======================
+   DIAGNÓSTICO
+   ======================= */
+void manejarDiagnostico() {
+  if (redrawMenu || millis() - ultimoDiagnostico >= 1000) {
+    ultimoDiagnostico = millis();
+    drawDiagnostico();
+    redrawMenu = false;
+  }
+
+  if (deletePressed || confirmPressed) {
+    deletePressed = false;
+    confirmPressed = false;
+    uiState = UI_CONFIG_MENU;
+    redrawMenu = true;
+  }
+}
+
+// Latencias en ms: en 21 columnas no caben los µs
+void drawDiagnostico() {
+  ResumenHistograma ui, red, sens, influx;
+  metricaResumen(HIST_PASO_UI, ui);
+  metricaResumen(HIST_PASO_RED, red);
+  metricaResumen(HIST_SENSORES, sens);
+  metricaResumen(HIST_INFLUX_ESCRIBIR, influx);
+
+  display.clearDisplay();
+  display.setCursor(0, 0);
+  display.println("== DIAGNOSTICO ==");
+  display.setCursor(0, 10);
+  display.print("Heap:"); display.print(metricaMedidor(MED_HEAP_LIBRE) / 1024);
+  display.print("K Blq:"); display.print(metricaMedidor(MED_HEAP_BLOQUE) / 1024); display.println("K");
+  display.setCursor(0, 20);
+  display.print("Pila U"); display.print(metricaMedidor(MED_PILA_UI));
+  display.print(" R"); display.print(metricaMedidor(MED_PILA_RED));
+  display.print(" I"); display.println(metricaMedidor(MED_PILA_IO));
+  display.setCursor(0, 30);
+  display.print("Paso95 U"); display.print(ui.p95Us / 1000);
+  display.print(" R"); display.print(red.p95Us / 1000); display.println("ms");
+  display.setCursor(0, 40);
+  display.print("Sens:"); display.print(sens.p95Us / 1000);
+  display.print(" Influx:"); display.print(influx.p95Us / 1000); display.println("ms");
+  display.setCursor(0, 50);
+  display.print("Atrasos:"); display.print(metricaContador(CNT_PASOS_ATRASADOS));
+  display.print(" Cola:"); display.println(metricaContador(CNT_COLA_LLENA));
+  i2cPantalla(display);
+}
+
+/* =======================
+   WIFI SCAN
+   ======================= */
+void scanWifiNetworks() {
+  display.clearDisplay();
+  display.setCursor(0, 0);
+  display.println("Escaneando WiFi...");
+  i2cPantalla(display);
+
+  // El escaneo corre en la tarea de red; la lista llega con EVT_ESCANEO_LISTO
+  wifiCount = 0;
+  escaneoPendiente = true;
+  redEnviarPeticion(RED_ESCANEAR_WIFI);
+}
+
+void manejarWifiScan() {
+  if (escaneoPendiente) return;
+
+  if (wifiCount > 0) {
+    int idx = readIndexStable(wifiCount);
+    if (idx >= 0) {
+      wifiIndex = idx;
+      redrawMenu = true;
+    }
+  }
+
+  if (redrawMenu) {
+    drawWifiList();
+    redrawMenu = false;
+  }
+
+  if (confirmPressed) {
+    confirmPressed = false;
+    if (wifiCount == 0) {
+      uiState = UI_CONFIG_MENU;
+      redrawMenu = true;
+      return;
+    }
+    passLen = 0;
+    charIndex = 0;
+    wifiPassword[0] = '\0';
+    uiState = UI_WIFI_PASSWORD;
+    redrawMenu = true;
+  }
+}
+
+void drawWifiList() {
+  display.clearDisplay();
+  if (wifiCount == 0) {
+    display.setCursor(0, 0);
+    display.println("Sin redes");
+  }
+  for (int i = 0; i < wifiCount; i++) {
+    display.setCursor(0, i * 12);
+    display.print(i == wifiIndex ? "--> " : "    ");
+    display.println(ssidList[i]);
+  }
+  i2cPantalla(display);
+}
+
+/* =======================
+   PASSWORD
+   ======================= */
+void manejarWifiPassword() {
+
+  // Esperando EVT_WIFI_RESULTADO
+  if (conexionPendiente) return;
+
+  int idx = readCharIndex();
+  if (idx >= 0) {
+    charIndex = idx;
+    redrawMenu = true;
+  }
+
+  if (confirmPressed) {
+    confirmPressed = false;
+    if (passLen < MAX_PASS_LEN) {
+      wifiPassword[passLen++] = charset[charIndex];
+      wifiPassword[passLen] = '\0';
+    }
+    redrawMenu = true;
+  }
+
+  if (deletePressed) {
+    deletePressed = false;
+    if (passLen > 0) {
+      passLen--;
+      wifiPassword[passLen] = '\0';
+    }
+    redrawMenu = true;
+  }
+
+  if (sendPressed) {
+    sendPressed = false;
+    conectarWifi();
+    return;
+  }
+
+  if (redrawMenu) {
+    drawPasswordScreen();
+    redrawMenu = false;
+  }
+}
+
+void drawPasswordScreen() {
+
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  display.setCursor(0, 0);
+  display.print("SSID: ");
+  display.print(ssidList[wifiIndex]);
+  display.println();
+
+  display.setCursor(0, 16);
+  display.print("PASS: ");
+  display.print(wifiPassword);
+
+  display.setCursor(0, 36);
+  display.print("CHAR: ");
+  display.print(charset[charIndex]);
+
+  i2cPantalla(display);
+}
+
+void conectarWifi() {
+  display.clearDisplay();
+  display.setCursor(20, 30);
+  display.println("Conectando...");
+  i2cPantalla(display);
+
+  // La conexión bloquea la tarea de red, no la UI
+  PeticionRed pet = {};
+  pet.tipo = RED_CONECTAR_WIFI;
+  strlcpy(pet.ssid, ssidList[wifiIndex], sizeof(pet.ssid));
+  strlcpy(pet.pass, wifiPassword, sizeof(pet.pass));
+  conexionPendiente = redEnviarPeticion(pet);
+
+  if (!conexionPendiente) {
+    display.clearDisplay();
+    uiState = UI_CONFIG_MENU;
+    redrawMenu = true;
+  }
+}
+
+/* =======================
+   SPLASH
+   ======================= */
+void dibujarImagenOLED() {
+  display.drawBitmap(4, 2, init_icon, 120, 60, SSD1306_WHITE);
+  i2cPantalla(display);
+}
+
+void dibujarInicio() {
+  display.clearDisplay();
+
+  display.setTextSize(4);
+  display.setTextColor(SSD1306_WHITE);
+  display.setCursor(6, 0);
+  display.println("ORION");
+
+  display.setTextSize(3);
+  display.setCursor(40, 30);
+  display.println("IoT");
+
+  display.setTextSize(1);
+  display.setCursor(55, 55);
+  display.println("V1.0");
+  i2cPantalla(display);
+  delay(2000);
+}
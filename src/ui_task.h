@@ -0,0 +1,19 @@
+#ifndef UI_TASK_H
+#define UI_TASK_H
+
+#include <Arduino.h>
+
+// Periodo del paso de la tarea UI (lectura de pot y botones)
+#define UI_PERIODO_MS 20
+
+// Botones, potenciómetro, OLED y splash
+void iniciarUI();
+
+// Mensajes de arranque antes de que existan las tareas
+void uiMostrarMensaje(const char* texto);
+void uiMostrarResultadoWiFi(bool wifiOK);
+
+// Un paso de la tarea UI: eventos de red + máquina de estados UIState
+void pasoTareaUI();
+
+#endif